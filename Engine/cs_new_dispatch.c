@@ -99,10 +99,13 @@ static void dag_print_state(CSOUND *csound)
         break;
       case WAITING:
         {
-          char *tt = csound->dag_task_dep[i];
-          int j;
-          printf("status=WAITING for tasks [");
-          for (j=0; j<i; j++) if (tt[j]) printf("%d ", j);
+          taskGroup *g = &csound->dag_groups[csound->dag_task_group[i]];
+          int *deps = csound->dag_group_deps + g->deps;
+          int d;
+          printf("status=WAITING for instrs [");
+          for (d=0; d<g->ndeps; d++)
+            printf("%d ", csound->dag_groups[deps[d]].insno);
+          if (g->self) printf("self");
           printf("]\n");
         }
         break;
@@ -112,6 +115,21 @@ static void dag_print_state(CSOUND *csound)
     }
 }
 
+/* Allocate (or grow) one ready queue per performance thread */
+static void dag_alloc_ready(CSOUND *csound)
+{
+    int i, nthreads = csound->oparms->numThreads;
+    int max = csound->dag_task_max_size;
+    if (nthreads < 1) nthreads = 1;
+    if (csound->dag_ready == NULL)
+      csound->dag_ready =
+        (taskDeque *)csound->Calloc(csound, sizeof(taskDeque)*nthreads);
+    for (i=0; i<nthreads; i++)
+      csound->dag_ready[i].tasks =
+        (taskID *)csound->ReAlloc(csound, csound->dag_ready[i].tasks,
+                                  sizeof(taskID)*max);
+}
+
 /* For now allocate a fixed maximum number of tasks; FIXME */
 void create_dag(CSOUND *csound)
 {
@@ -120,8 +138,10 @@ void create_dag(CSOUND *csound)
     csound->dag_task_status = csound->Calloc(csound, sizeof(enum state)*max);
     csound->dag_task_watch  = csound->Calloc(csound, sizeof(watchList*)*max);
     csound->dag_task_map    = csound->Calloc(csound, sizeof(INSDS*)*max);
-    csound->dag_task_dep    = (char **)csound->Calloc(csound, sizeof(char*)*max);
+    csound->dag_task_group  = (int *)csound->Calloc(csound, sizeof(int)*max);
+    csound->dag_groups = (taskGroup *)csound->Calloc(csound, sizeof(taskGroup)*max);
     csound->dag_wlmm = (watchList *)csound->Calloc(csound, sizeof(watchList)*max);
+    dag_alloc_ready(csound);
 }
 
 void recreate_dag(CSOUND *csound)
@@ -136,10 +156,34 @@ void recreate_dag(CSOUND *csound)
                sizeof(watchList*)*max);
     csound->dag_task_map    =
       csound->ReAlloc(csound, (INSDS *)csound->dag_task_map, sizeof(INSDS*)*max);
-    csound->dag_task_dep    =
-      (char **)csound->ReAlloc(csound, csound->dag_task_dep, sizeof(char*)*max);
+    csound->dag_task_group  =
+      (int *)csound->ReAlloc(csound, csound->dag_task_group, sizeof(int)*max);
+    csound->dag_groups      =
+      (taskGroup *)csound->ReAlloc(csound, csound->dag_groups,
+                                   sizeof(taskGroup)*max);
     csound->dag_wlmm        =
       (watchList *)csound->ReAlloc(csound, csound->dag_wlmm, sizeof(watchList)*max);
+    dag_alloc_ready(csound);
+}
+
+/* Empty the ready queues and deal the initially AVAILABLE tasks round robin
+   across them.  Only called from the main thread between k-cycles */
+static void dag_queue_available(CSOUND *csound)
+{
+    int i, q = 0, nthreads = csound->oparms->numThreads;
+    taskDeque *ready = csound->dag_ready;
+    if (nthreads < 1) nthreads = 1;
+    for (i=0; i<nthreads; i++)
+      ready[i].top = ready[i].bottom = 0;
+    csound->dag_num_ready = 0;
+    csound->dag_num_done = 0;
+    for (i=0; i<csound->dag_num_active; i++) {
+      if (csound->dag_task_status[i] != AVAILABLE) continue;
+      ready[q].tasks[ready[q].bottom++] = i;
+      csound->dag_num_ready++;
+      if (++q == nthreads) q = 0;
+    }
+    __sync_synchronize();
 }
 
 static INSTR_SEMANTICS *dag_get_info(CSOUND* csound, int insno)
@@ -177,11 +221,111 @@ static int dag_intersect(CSOUND *csound, struct set_t *current,
     return res;
 }
 
+void dag_reinit(CSOUND *csound);
+
+/* Forget the cached instrument dependencies, as when instruments have been
+   (re)defined by a new compilation */
+void dag_instr_reset(CSOUND *csound)
+{
+    if (csound->dag_instr_dep != NULL)
+      csound->Free(csound, csound->dag_instr_dep);
+    csound->dag_instr_dep = NULL;
+    csound->dag_instr_max = 0;
+    csound->dag_instr_cnt = 0;
+    csound->dag_changed++;
+}
+
+/* The answers are kept in an open addressing hash table of instrument
+   pairs, so that its size follows the pairs actually seen together on
+   the active list rather than the highest instrument number */
+typedef struct {
+    int         earlier, later;
+    char        dep;            /* 0 empty slot, 1 independent, 2 not */
+} DAG_DEP;
+
+#define DAG_DEP_MIN 64          /* slots, a power of two */
+
+static DAG_DEP *dag_dep_slot(DAG_DEP *tab, int size, int earlier, int later)
+{
+    unsigned int h = ((unsigned int) earlier * 2654435761U) ^
+                     ((unsigned int) later * 40503U);
+    DAG_DEP *d;
+
+    for (h &= (size-1); ; h = (h+1) & (size-1)) {
+      d = &tab[h];
+      if (d->dep == 0 || (d->earlier == earlier && d->later == later))
+        return d;
+    }
+}
+
+static DAG_DEP *dag_dep_find(CSOUND *csound, int earlier, int later)
+{
+    DAG_DEP *tab = (DAG_DEP *) csound->dag_instr_dep, *d;
+    int i, size = csound->dag_instr_max;
+
+    /* keep the table at most half full */
+    if (2*(csound->dag_instr_cnt+1) > size) {
+      int nsize = (size ? size*2 : DAG_DEP_MIN);
+      DAG_DEP *ntab = (DAG_DEP *) csound->Calloc(csound,
+                                                 sizeof(DAG_DEP)*nsize);
+      for (i = 0; i < size; i++)
+        if (tab[i].dep != 0)
+          *dag_dep_slot(ntab, nsize, tab[i].earlier, tab[i].later) = tab[i];
+      if (tab != NULL)
+        csound->Free(csound, tab);
+      csound->dag_instr_dep = (void *) ntab;
+      csound->dag_instr_max = size = nsize;
+      tab = ntab;
+    }
+    d = dag_dep_slot(tab, size, earlier, later);
+    if (d->dep == 0) {
+      d->earlier = earlier;
+      d->later = later;
+      csound->dag_instr_cnt++;
+    }
+    return d;
+}
+
+/* Does an instance of instr later have to wait for one of instr earlier?
+   This only depends on the instruments' read and write sets, so the answer
+   is computed once per pair and cached (0 unknown, 1 no, 2 yes) */
+static int dag_depends(CSOUND *csound, int earlier, int later)
+{
+    char *c = &dag_dep_find(csound, earlier, later)->dep;
+    if (*c == 0) {
+      INSTR_SEMANTICS *current_instr = dag_get_info(csound, earlier);
+      INSTR_SEMANTICS *later_instr = dag_get_info(csound, later);
+      int cnt = 0;
+      if (dag_intersect(csound, current_instr->write,
+                        later_instr->read, cnt++)       ||
+          dag_intersect(csound, current_instr->read_write,
+                        later_instr->read, cnt++)       ||
+          dag_intersect(csound, current_instr->read,
+                        later_instr->write, cnt++)      ||
+          dag_intersect(csound, current_instr->write,
+                        later_instr->write, cnt++)      ||
+          dag_intersect(csound, current_instr->read_write,
+                        later_instr->write, cnt++)      ||
+          dag_intersect(csound, current_instr->read,
+                        later_instr->read_write, cnt++) ||
+          dag_intersect(csound, current_instr->write,
+                        later_instr->read_write, cnt++))
+        *c = 2;
+      else *c = 1;
+    }
+    return *c == 2;
+}
+
+/* The active list is kept in instrument order, so consecutive instances of
+   the same instrument form a group and dependencies are held between groups
+   rather than between instances.  A rebuild is linear in the number of
+   instances plus the square of the number of distinct active instruments,
+   with no set operations once the instrument pairs have been seen */
 void dag_build(CSOUND *csound, INSDS *chain)
 {
     INSDS *save = chain;
-    INSDS **task_map;
-    int i;
+    taskGroup *groups;
+    int i, g, h, need;
 
     //printf("DAG BUILD***************************************\n");
     csound->dag_num_active = 0;
@@ -196,73 +340,46 @@ void dag_build(CSOUND *csound, INSDS *chain)
     }
     if (csound->dag_task_status == NULL)
       create_dag(csound); /* Should move elsewhere */
-    else {
-      memset((void*)csound->dag_task_watch, '\0',
-             sizeof(watchList*)*csound->dag_task_max_size);
-      for (i=0; i<csound->dag_task_max_size; i++) {
-        if (csound->dag_task_dep[i]) {
-          csound->dag_task_dep[i]= NULL;
-        }
-        csound->dag_wlmm[i].id = INVALID;
-      }
-    }
-    task_map = csound->dag_task_map;
-    for (i=0; i<csound->dag_num_active; i++) {
-      csound->dag_task_status[i] = AVAILABLE;
-      csound->dag_wlmm[i].id=i;
-    }
     csound->dag_changed = 0;
     if (UNLIKELY(csound->oparms->odebug))
       printf("dag_num_active = %d\n", csound->dag_num_active);
-    i = 0; chain = save;
-    while (chain != NULL) {     /* for each instance check against later */
-      int j = i+1;              /* count of instance */
-      if (UNLIKELY(csound->oparms->odebug))
-        printf("\nWho depends on %d (instr %d)?\n", i, chain->insno);
-      INSDS *next = chain->nxtact;
-      INSTR_SEMANTICS *current_instr = dag_get_info(csound, chain->insno);
-      //csp_set_print(csound, current_instr->read);
-      //csp_set_print(csound, current_instr->write);
-      while (next) {
-        INSTR_SEMANTICS *later_instr = dag_get_info(csound, next->insno);
-        int cnt = 0;
-        if (UNLIKELY(csound->oparms->odebug)) printf("%d ", j);
-        //csp_set_print(csound, later_instr->read);
-        //csp_set_print(csound, later_instr->write);
-        //csp_set_print(csound, later_instr->read_write);
-        if (dag_intersect(csound, current_instr->write,
-                          later_instr->read, cnt++)       ||
-            dag_intersect(csound, current_instr->read_write,
-                          later_instr->read, cnt++)       ||
-            dag_intersect(csound, current_instr->read,
-                          later_instr->write, cnt++)      ||
-            dag_intersect(csound, current_instr->write,
-                          later_instr->write, cnt++)      ||
-            dag_intersect(csound, current_instr->read_write,
-                          later_instr->write, cnt++)      ||
-            dag_intersect(csound, current_instr->read,
-                          later_instr->read_write, cnt++) ||
-            dag_intersect(csound, current_instr->write,
-                          later_instr->read_write, cnt++)) {
-          char *tt = csound->dag_task_dep[j];
-          if (tt==NULL) {
-            /* get dep vector if missing and set watch first time */
-            tt = csound->dag_task_dep[j] =
-              (char*)csound->Calloc(csound, sizeof(char)*(j+1));
-            csound->dag_task_status[j] = WAITING;
-            csound->dag_wlmm[j].next = csound->dag_task_watch[i];
-            csound->dag_wlmm[j].id = j;
-            csound->dag_task_watch[i] = &(csound->dag_wlmm[j]);
-            //printf("set watch %d to %d\n", j, i);
-          }
-          tt[i] = 1;
-          //printf("-yes ");
-        }
-        j++; next = next->nxtact;
+    groups = csound->dag_groups;
+    g = -1;
+    for (i = 0, chain = save; chain != NULL; i++, chain = chain->nxtact) {
+      if (g < 0 || groups[g].insno != chain->insno) {
+        g++;
+        groups[g].insno = chain->insno;
+        groups[g].start = i;
+        groups[g].count = 0;
       }
-      task_map[i] = chain;
-      i++; chain = chain->nxtact;
+      groups[g].count++;
+      csound->dag_task_map[i] = chain;
+      csound->dag_task_group[i] = g;
+    }
+    csound->dag_num_groups = g+1;
+    need = csound->dag_num_groups*(csound->dag_num_groups-1)/2;
+    if (need > csound->dag_group_deps_size) {
+      csound->dag_group_deps =
+        (int *)csound->ReAlloc(csound, csound->dag_group_deps,
+                               sizeof(int)*need);
+      csound->dag_group_deps_size = need;
+    }
+    need = 0;
+    for (g=0; g<csound->dag_num_groups; g++) {
+      groups[g].self = dag_depends(csound, groups[g].insno, groups[g].insno);
+      groups[g].deps = need;
+      groups[g].ndeps = 0;
+      for (h=0; h<g; h++)
+        if (dag_depends(csound, groups[h].insno, groups[g].insno)) {
+          csound->dag_group_deps[need++] = h;
+          groups[g].ndeps++;
+        }
+      if (UNLIKELY(csound->oparms->odebug))
+        printf("instr %d (%d instances) depends on %d earlier instrs%s\n",
+               groups[g].insno, groups[g].count, groups[g].ndeps,
+               groups[g].self ? " and itself" : "");
     }
+    dag_reinit(csound);
     if (UNLIKELY(csound->oparms->odebug)) dag_print_state(csound);
 }
 
@@ -273,26 +390,31 @@ void dag_reinit(CSOUND *csound)
     volatile enum state *task_status = csound->dag_task_status;
     watchList * volatile *task_watch = csound->dag_task_watch;
     watchList *wlmm = csound->dag_wlmm;
+    taskGroup *groups = csound->dag_groups;
     if (UNLIKELY(csound->oparms->odebug))
       printf("DAG REINIT************************\n");
     for (i=csound->dag_num_active; i<max; i++)
       task_status[i] = DONE;
-    task_status[0] = AVAILABLE;
-    task_watch[0] = NULL;
-    for (i=1; i<csound->dag_num_active; i++) {
-      int j;
-      task_status[i] = AVAILABLE;
+    for (i=0; i<csound->dag_num_active; i++)
       task_watch[i] = NULL;
-      if (csound->dag_task_dep[i]==NULL) continue;
-      for (j=0; j<i; j++)
-        if (csound->dag_task_dep[i][j]) {
-          task_status[i] = WAITING;
-          wlmm[i].id = i;
-          wlmm[i].next = task_watch[j];
-          task_watch[j] = &wlmm[i];
-          break;
-        }
+    for (i=0; i<csound->dag_num_active; i++) {
+      taskGroup *g = &groups[csound->dag_task_group[i]];
+      int j = INVALID;
+      /* watch the latest prerequisite */
+      if (g->self && i > g->start) j = i-1;
+      else if (g->ndeps > 0) {
+        taskGroup *h = &groups[csound->dag_group_deps[g->deps+g->ndeps-1]];
+        j = h->start+h->count-1;
+      }
+      if (j == INVALID) task_status[i] = AVAILABLE;
+      else {
+        task_status[i] = WAITING;
+        wlmm[i].id = i;
+        wlmm[i].next = task_watch[j];
+        task_watch[j] = &wlmm[i];
+      }
     }
+    dag_queue_available(csound);
     //dag_print_state(csound);
 }
 
@@ -300,30 +422,92 @@ void dag_reinit(CSOUND *csound)
 #define ATOMIC_WRITE(x,v) __sync_fetch_and_and(&(x), v)
 #define ATOMIC_CAS(x,current,new)  __sync_bool_compare_and_swap(x,current,new)
 
-taskID dag_get_task(CSOUND *csound)
+/* Work-stealing deque operations (after Chase and Lev, without the
+   resizing as capacity is bounded by the number of tasks) */
+
+/* Only called by the owner */
+static inline void dag_push(taskDeque *d, taskID t)
 {
-    int i;
-    int morework = 0;
-    int active = csound->dag_num_active;
-    volatile enum state *task_status = csound->dag_task_status;
-    //printf("**GetTask from %d\n", csound->dag_num_active);
-    for (i=0; i<active; i++) {
-      if (ATOMIC_CAS(&(task_status[i]), AVAILABLE, INPROGRESS)) {
-        return (taskID)i;
+    int b = d->bottom;
+    d->tasks[b] = t;
+    __sync_synchronize();
+    d->bottom = b+1;
+}
+
+/* Only called by the owner */
+static inline taskID dag_pop(taskDeque *d)
+{
+    int t, b = d->bottom-1;
+    taskID x;
+    d->bottom = b;
+    __sync_synchronize();
+    t = d->top;
+    if (t > b) {                /* empty */
+      d->bottom = t;
+      return (taskID)INVALID;
+    }
+    x = d->tasks[b];
+    if (t == b) {               /* last one; race any thief for it */
+      if (!ATOMIC_CAS(&d->top, t, t+1)) x = (taskID)INVALID;
+      d->bottom = t+1;
+    }
+    return x;
+}
+
+/* Called by any other thread */
+static inline taskID dag_steal(taskDeque *d)
+{
+    int t = d->top, b;
+    taskID x;
+    __sync_synchronize();
+    b = d->bottom;
+    if (t >= b) return (taskID)INVALID;
+    x = d->tasks[t];
+    if (!ATOMIC_CAS(&d->top, t, t+1)) return (taskID)INVALID;
+    return x;
+}
+
+/* Spin politely for a while, then give the processor away */
+static inline void dag_backoff(int n)
+{
+    if (n < 64) {
+      int i;
+      for (i=0; i< (1<<(n>>3)); i++) {
+#if defined(__i386__) || defined(__x86_64__)
+        __builtin_ia32_pause();
+#else
+        __sync_synchronize();
+#endif
       }
-      //else if (ATOMIC_READ(task_status[i])==WAITING)
-      //  printf("**%d waiting\n", i);
-      //else if (ATOMIC_RE\AD(task_status[i])==INPROGRESS)
-      //  print(f"**%d active\n", i);
-      else if (ATOMIC_READ(task_status[i])==DONE) {
-        //printf("**%d done\n", i);
-        morework++;
+    }
+    else csoundSleep(0);
+}
+
+/* Take a task for thread index; own queue first, then steal.  Returns
+   INVALID once every task in this k-cycle has been completed */
+taskID dag_get_task(CSOUND *csound, int index)
+{
+    int i, n = 0;
+    int nthreads = csound->oparms->numThreads;
+    int active = csound->dag_num_active;
+    taskDeque *ready = csound->dag_ready;
+    taskID x;
+    if (nthreads < 1) nthreads = 1;
+    while (1) {
+      if (ATOMIC_READ(csound->dag_num_ready) > 0) {
+        x = dag_pop(&ready[index]);
+        for (i=1; x==INVALID && i<nthreads; i++)
+          x = dag_steal(&ready[(index+i)%nthreads]);
+        if (x != INVALID) {
+          __sync_fetch_and_sub(&csound->dag_num_ready, 1);
+          csound->dag_task_status[x] = INPROGRESS;
+          return x;
+        }
       }
+      if (ATOMIC_READ(csound->dag_num_done) == active)
+        return (taskID)INVALID;
+      dag_backoff(n++);
     }
-    //dag_print_state(csound);
-    if (morework==active) return (taskID)INVALID;
-    //printf("taskstodo=%d)\n", morework);
-    return (taskID)WAIT;
 }
 
 /* This static is OK as not written */
@@ -349,11 +533,35 @@ inline static int moveWatch(CSOUND *csound, watchList * volatile *w,
     return 1;
 }
 
-void dag_end_task(CSOUND *csound, taskID i)
+/* Move the watch for task j to some prerequisite that has not finished;
+   returns 0 if every prerequisite is DONE */
+static int dag_move_to_prereq(CSOUND *csound, int j, watchList *w)
+{
+    watchList * volatile *task_watch = csound->dag_task_watch;
+    taskGroup *g = &csound->dag_groups[csound->dag_task_group[j]];
+    int *deps = csound->dag_group_deps + g->deps;
+    int d, k;
+    if (g->self)
+      for (k=j-1; k>=g->start; k--)
+        if (ATOMIC_READ(csound->dag_task_status[k]) != DONE &&
+            moveWatch(csound, &task_watch[k], w))
+          return 1;
+    for (d=g->ndeps-1; d>=0; d--) {
+      taskGroup *h = &csound->dag_groups[deps[d]];
+      for (k=h->start+h->count-1; k>=h->start; k--)
+        /* if moveWatch fails we raced with the end of task k */
+        if (ATOMIC_READ(csound->dag_task_status[k]) != DONE &&
+            moveWatch(csound, &task_watch[k], w))
+          return 1;
+    }
+    return 0;
+}
+
+void dag_end_task(CSOUND *csound, int index, taskID i)
 {
     watchList *to_notify, *next;
     int canQueue;
-    int j, k;
+    int j;
     watchList * volatile *task_watch = csound->dag_task_watch;
     ATOMIC_WRITE(csound->dag_task_status[i], DONE); /* as DONE is zero */
     {                                      /* ATOMIC_SWAP */
@@ -367,31 +575,15 @@ void dag_end_task(CSOUND *csound, taskID i)
       next = to_notify->next;
       j = to_notify->id;
       //printf("%d notifying task %d it finished\n", i, j);
-      canQueue = 1;
-      for (k=0; k<j; k++) {     /* seek next watch */
-        if (csound->dag_task_dep[j][k]==0) continue;
-        //printf("investigating task %d (%d)\n", k, csound->dag_task_status[k]);
-        if (ATOMIC_READ(csound->dag_task_status[k]) != DONE) {
-          //printf("found task %d to watch %d status %d\n",
-          //       k, j, csound->dag_task_status[k]);
-          if (moveWatch(csound, &task_watch[k], to_notify)) {
-            //printf("task %d now watches %d\n", j, k);
-            canQueue = 0;
-            break;
-          }
-          else {
-            /* assert csound->dag_task_status[j] == DONE and we are in race */
-            //printf("Racing status %d %d %d %d\n",
-            //       csound->dag_task_status[j], i, j, k);
-          }
-        }
-        //else { printf("not %d\n", k); }
-      }
-      if (canQueue) {           /*  could use monitor here */
+      canQueue = !dag_move_to_prereq(csound, j, to_notify);
+      if (canQueue) {           /* runnable now, so keep it local */
         csound->dag_task_status[j] = AVAILABLE;
+        dag_push(&csound->dag_ready[index], j);
+        __sync_fetch_and_add(&csound->dag_num_ready, 1);
       }
       to_notify = next;
     }
+    __sync_fetch_and_add(&csound->dag_num_done, 1);
     //dag_print_state(csound);
     return;
 }
@@ -94,155 +94,193 @@ PUBLIC void cs_cons_free_complete(CSOUND* csound, CONS_CELL* head) {
 
 /* FUNCTION FOR HASH SET */
 
+#define HASH_INIT_SIZE 16
+
 PUBLIC CS_HASH_TABLE* cs_hash_table_create(CSOUND* csound) {
-    return (CS_HASH_TABLE*) csound->Calloc(csound, sizeof(CS_HASH_TABLE));
+    CS_HASH_TABLE* hashTable = csound->Calloc(csound, sizeof(CS_HASH_TABLE));
+
+    hashTable->size = HASH_INIT_SIZE;
+    hashTable->items = csound->Calloc(csound,
+                                      HASH_INIT_SIZE * sizeof(CS_HASH_TABLE_ITEM));
+    return hashTable;
 }
 
-static unsigned int cs_name_hash(char *s)
-{
-    unsigned int h = 0;
+/* 32-bit FNV-1a */
+PUBLIC unsigned int cs_hash_table_hash(const char* key) {
+    const unsigned char* s = (const unsigned char*) key;
+    unsigned int h = 2166136261U;
+
     while (*s != '\0') {
-        h = (h<<4) ^ *s++;
+        h ^= *s++;
+        h *= 16777619U;
     }
-    return (h%HASH_SIZE);
+    return h;
 }
 
-PUBLIC void* cs_hash_table_get(CSOUND* csound,
-                               CS_HASH_TABLE* hashTable, char* key) {
-    unsigned int index;
+/* Returns the slot holding key, or the empty slot where it would go. */
+static CS_HASH_TABLE_ITEM* cs_hash_table_find(CS_HASH_TABLE* hashTable,
+                                              const char* key,
+                                              unsigned int hash) {
+    unsigned int mask = hashTable->size - 1;
+    unsigned int index = hash & mask;
     CS_HASH_TABLE_ITEM* item;
 
-    if (key == NULL) {
-        return NULL;
+    for (;;) {
+        item = &hashTable->items[index];
+        if (item->key == NULL ||
+            (item->hash == hash && strcmp(key, item->key) == 0)) {
+            return item;
+        }
+        index = (index + 1) & mask;
     }
+}
+
+int cs_hash_table_full(CS_HASH_TABLE* hashTable) {
+    return ((hashTable->count + 1) * 2 > hashTable->size);
+}
 
-    index = cs_name_hash(key);
-    item = hashTable->buckets[index];
+CS_HASH_TABLE_ITEM* cs_hash_table_grow_into(CS_HASH_TABLE* hashTable,
+                                            CS_HASH_TABLE_ITEM* newItems) {
+    CS_HASH_TABLE_ITEM* old = hashTable->items;
+    unsigned int oldSize = hashTable->size, i;
 
-    while (item != NULL) {
-        if (strcmp(key, item->key) == 0) {
-            return item->value;
+    hashTable->size = oldSize << 1;
+    hashTable->items = newItems;
+    for (i = 0; i < oldSize; i++) {
+        if (old[i].key != NULL) {
+            *cs_hash_table_find(hashTable, old[i].key, old[i].hash) = old[i];
         }
-        item = item->next;
     }
-
-    return NULL;
+    return old;
 }
 
-PUBLIC char* cs_hash_table_get_key(CSOUND* csound,
-                                   CS_HASH_TABLE* hashTable, char* key) {
-    unsigned int index;
-    CS_HASH_TABLE_ITEM* item;
+/* Frees the old items, so a table shared between threads must be locked
+   for lookups as well as for inserts (see chn_db_lock in bus.c). */
+static void cs_hash_table_grow(CSOUND* csound, CS_HASH_TABLE* hashTable) {
+    CS_HASH_TABLE_ITEM* newItems =
+      csound->Calloc(csound, 2 * hashTable->size * sizeof(CS_HASH_TABLE_ITEM));
+
+    csound->Free(csound, cs_hash_table_grow_into(hashTable, newItems));
+}
 
+PUBLIC void* cs_hash_table_get_hashed(CSOUND* csound,
+                                      CS_HASH_TABLE* hashTable,
+                                      const char* key, unsigned int hash) {
     if (key == NULL) {
         return NULL;
     }
+    return cs_hash_table_find(hashTable, key, hash)->value;
+}
 
-    index = cs_name_hash(key);
-    item = hashTable->buckets[index];
-
-    while (item != NULL) {
-        if (strcmp(key, item->key) == 0) {
-            return item->key;
-        }
-        item = item->next;
+PUBLIC void* cs_hash_table_get(CSOUND* csound,
+                               CS_HASH_TABLE* hashTable, char* key) {
+    if (key == NULL) {
+        return NULL;
     }
-
-    return NULL;
+    return cs_hash_table_find(hashTable, key, cs_hash_table_hash(key))->value;
 }
 
-char* cs_hash_table_put_no_key_copy(CSOUND* csound,
-                                   CS_HASH_TABLE* hashTable,
-                                    char* key, void* value) {
+PUBLIC char* cs_hash_table_get_key(CSOUND* csound,
+                                   CS_HASH_TABLE* hashTable, char* key) {
     if (key == NULL) {
         return NULL;
     }
+    return cs_hash_table_find(hashTable, key, cs_hash_table_hash(key))->key;
+}
 
-    unsigned int index = cs_name_hash(key);
-
-    CS_HASH_TABLE_ITEM* item = hashTable->buckets[index];
-
-    if (item == NULL) {
-        CS_HASH_TABLE_ITEM* newItem = csound->Malloc(csound,
-                                                     sizeof(CS_HASH_TABLE_ITEM));
-        newItem->key = key;
-        newItem->value = value;
-        newItem->next = NULL;
-        hashTable->buckets[index] = newItem;
-        return newItem->key;
-    } else {
-        while (item != NULL) {
-            if (strcmp(key, item->key) == 0) {
-                item->value = value;
-                return item->key;
-            } else if(item->next == NULL) {
-                CS_HASH_TABLE_ITEM* newItem = csound->Malloc(csound,
-                                                      sizeof(CS_HASH_TABLE_ITEM));
-                newItem->key = key;
-                newItem->value = value;
-                newItem->next = NULL;
-                item->next = newItem;
-                return newItem->key;
-            }
-            item = item->next;
+/* Stores value under key; if key is new, newKey (or key itself when
+   newKey is NULL) becomes the item's key, otherwise newKey is freed. */
+static char* cs_hash_table_insert(CSOUND* csound, CS_HASH_TABLE* hashTable,
+                                  char* key, char* newKey, void* value) {
+    unsigned int hash;
+    CS_HASH_TABLE_ITEM* item;
+
+    if (key == NULL) {
+        return NULL;
+    }
+    hash = cs_hash_table_hash(key);
+    item = cs_hash_table_find(hashTable, key, hash);
+    if (item->key != NULL) {
+        if (newKey != NULL) {
+            csound->Free(csound, newKey);
         }
+        item->value = value;
+        return item->key;
+    }
+    if (cs_hash_table_full(hashTable)) {
+        cs_hash_table_grow(csound, hashTable);
+        item = cs_hash_table_find(hashTable, key, hash);
     }
-    return NULL;
+    item->key = (newKey != NULL ? newKey : key);
+    item->value = value;
+    item->hash = hash;
+    hashTable->count++;
+    return item->key;
+}
+
+char* cs_hash_table_put_no_key_copy(CSOUND* csound,
+                                    CS_HASH_TABLE* hashTable,
+                                    char* key, void* value) {
+    return cs_hash_table_insert(csound, hashTable, key, NULL, value);
 }
 
 PUBLIC void cs_hash_table_put(CSOUND* csound,
                               CS_HASH_TABLE* hashTable, char* key, void* value) {
-    cs_hash_table_put_no_key_copy(csound, hashTable,
-                                  cs_strdup(csound, key), value);
+    if (key == NULL) {
+        return;
+    }
+    cs_hash_table_insert(csound, hashTable, key,
+                         cs_strdup(csound, key), value);
 }
 
 PUBLIC char* cs_hash_table_put_key(CSOUND* csound,
                                    CS_HASH_TABLE* hashTable, char* key) {
-    return cs_hash_table_put_no_key_copy(csound, hashTable,
-                                         cs_strdup(csound, key), NULL);
+    if (key == NULL) {
+        return NULL;
+    }
+    return cs_hash_table_insert(csound, hashTable, key,
+                                cs_strdup(csound, key), NULL);
 }
 
+/* Removal shifts later members of the probe run back into the hole, so
+   no tombstones are needed. */
 PUBLIC void cs_hash_table_remove(CSOUND* csound,
                                  CS_HASH_TABLE* hashTable, char* key) {
-    CS_HASH_TABLE_ITEM *previous, *item;
-    unsigned int index;
+    unsigned int mask, i, j, k;
+    CS_HASH_TABLE_ITEM* items;
 
     if (key == NULL) {
         return;
     }
-
-    index = cs_name_hash(key);
-
-    previous = NULL;
-    item = hashTable->buckets[index];
-
-    while (item != NULL) {
-        if (strcmp(key, item->key) == 0) {
-            if (previous == NULL) {
-                hashTable->buckets[index] = NULL;
-                csound->Free(csound, item);
-                return;
-            } else {
-                previous->next = item->next;
-                csound->Free(csound, item);
-            }
+    items = hashTable->items;
+    mask = hashTable->size - 1;
+    i = (unsigned int) (cs_hash_table_find(hashTable, key,
+                                           cs_hash_table_hash(key)) - items);
+    if (items[i].key == NULL) {
+        return;
+    }
+    for (j = (i + 1) & mask; items[j].key != NULL; j = (j + 1) & mask) {
+        k = items[j].hash & mask;
+        /* leave items whose home slot lies cyclically in (i, j] */
+        if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) {
+            continue;
         }
-        previous = item;
-        item = item->next;
+        items[i] = items[j];
+        i = j;
     }
+    items[i].key = NULL;
+    items[i].value = NULL;
+    hashTable->count--;
 }
 
 PUBLIC CONS_CELL* cs_hash_table_keys(CSOUND* csound, CS_HASH_TABLE* hashTable) {
     CONS_CELL* head = NULL;
 
-    int i = 0;
-
-    for (i = 0; i < HASH_SIZE; i++) {
-        CS_HASH_TABLE_ITEM* item = hashTable->buckets[i];
+    unsigned int i = 0;
 
-        while (item != NULL) {
-            head = cs_cons(csound, item->key, head);
-            item = item->next;
+    for (i = 0; i < hashTable->size; i++) {
+        if (hashTable->items[i].key != NULL) {
+            head = cs_cons(csound, hashTable->items[i].key, head);
         }
     }
     return head;
@@ -251,14 +289,11 @@ PUBLIC CONS_CELL* cs_hash_table_keys(CSOUND* csound, CS_HASH_TABLE* hashTable) {
 PUBLIC CONS_CELL* cs_hash_table_values(CSOUND* csound, CS_HASH_TABLE* hashTable) {
     CONS_CELL* head = NULL;
 
-    int i = 0;
-
-    for (i = 0; i < HASH_SIZE; i++) {
-        CS_HASH_TABLE_ITEM* item = hashTable->buckets[i];
+    unsigned int i = 0;
 
-        while (item != NULL) {
-            head = cs_cons(csound, item->value, head);
-            item = item->next;
+    for (i = 0; i < hashTable->size; i++) {
+        if (hashTable->items[i].key != NULL) {
+            head = cs_cons(csound, hashTable->items[i].value, head);
         }
     }
     return head;
@@ -267,72 +302,63 @@ PUBLIC CONS_CELL* cs_hash_table_values(CSOUND* csound, CS_HASH_TABLE* hashTable)
 PUBLIC void cs_hash_table_merge(CSOUND* csound,
                                 CS_HASH_TABLE* target, CS_HASH_TABLE* source) {
     // TODO - check if this is the best strategy for merging
-    int i = 0;
+    unsigned int i = 0;
 
-    for (i = 0; i < HASH_SIZE; i++) {
-        CS_HASH_TABLE_ITEM* item = source->buckets[i];
+    for (i = 0; i < source->size; i++) {
+        CS_HASH_TABLE_ITEM* item = &source->items[i];
 
-        while (item != NULL) {
+        if (item->key != NULL) {
             cs_hash_table_put_no_key_copy(csound, target, item->key, item->value);
-            item = item->next;
         }
     }
 
 }
 
 PUBLIC void cs_hash_table_free(CSOUND* csound, CS_HASH_TABLE* hashTable) {
-    int i;
+    unsigned int i;
 
-    for (i = 0; i < HASH_SIZE; i++) {
-        CS_HASH_TABLE_ITEM* item = hashTable->buckets[i];
-
-        while(item != NULL) {
-            CS_HASH_TABLE_ITEM* next = item->next;
-            csound->Free(csound, item->key);
-            csound->Free(csound, item);
-            item = next;
+    for (i = 0; i < hashTable->size; i++) {
+        if (hashTable->items[i].key != NULL) {
+            csound->Free(csound, hashTable->items[i].key);
         }
     }
+    csound->Free(csound, hashTable->items);
     csound->Free(csound, hashTable);
 }
 
 PUBLIC void cs_hash_table_mfree_complete(CSOUND* csound, CS_HASH_TABLE* hashTable) {
 
-    int i;
+    unsigned int i;
 
-    for (i = 0; i < HASH_SIZE; i++) {
-        CS_HASH_TABLE_ITEM* item = hashTable->buckets[i];
+    for (i = 0; i < hashTable->size; i++) {
+        CS_HASH_TABLE_ITEM* item = &hashTable->items[i];
 
-        while(item != NULL) {
-            CS_HASH_TABLE_ITEM* next = item->next;
+        if (item->key != NULL) {
             csound->Free(csound, item->key);
             csound->Free(csound, item->value);
-            csound->Free(csound, item);
-            item = next;
         }
     }
+    csound->Free(csound, hashTable->items);
     csound->Free(csound, hashTable);
 }
 
 PUBLIC void cs_hash_table_free_complete(CSOUND* csound, CS_HASH_TABLE* hashTable) {
 
-    int i;
+    unsigned int i;
 
-    for (i = 0; i < HASH_SIZE; i++) {
-        CS_HASH_TABLE_ITEM* item = hashTable->buckets[i];
+    for (i = 0; i < hashTable->size; i++) {
+        CS_HASH_TABLE_ITEM* item = &hashTable->items[i];
 
-        while(item != NULL) {
-            CS_HASH_TABLE_ITEM* next = item->next;
+        if (item->key != NULL) {
             csound->Free(csound, item->key);
-            
+
             /* NOTE: This needs to be free, not csound->Free.
-               To use mfree on keys, use cs_hash_table_mfree_complete 
+               To use mfree on keys, use cs_hash_table_mfree_complete
                TODO: Check if this is even necessary anymore... */
             free(item->value);
-            csound->Free(csound, item);
-            item = next;
         }
     }
+    csound->Free(csound, hashTable->items);
     csound->Free(csound, hashTable);
 }
 
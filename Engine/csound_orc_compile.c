@@ -51,6 +51,7 @@ char argtyp2(char *s);
 void debugPrintCsound(CSOUND* csound);
 
 void named_instr_assign_numbers(CSOUND *csound, ENGINE_STATE *engineState);
+void dag_instr_reset(CSOUND *csound);
 int named_instr_alloc(CSOUND *csound, char *s, INSTRTXT *ip, int32 insno,
                       ENGINE_STATE *engineState);
 int check_instr_name(char *s);
@@ -909,7 +910,7 @@ void free_instrtxt(CSOUND *csound, INSTRTXT *instrtxt)
         fdchclose(csound, active);
       if (active->auxchp != NULL)
         auxchfree(csound, active);
-      csound->Free(csound, active);
+      mpfree(csound, active);
       active = nxt;
     }
     OPTXT *t = ip->nxtop;
@@ -1338,6 +1339,8 @@ int engineState_merge(CSOUND *csound, ENGINE_STATE *engineState)
       }
     }
     (&(current_state->instxtanchor))->nxtinstxt = csound->instr0;
+    /* instruments may have been redefined, so recompute dependencies */
+    dag_instr_reset(csound);
     return 0;
 }
 
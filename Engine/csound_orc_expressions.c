@@ -28,6 +28,7 @@
 #include "csound_orc_expressions.h"
 #include "csound_type_system.h"
 #include "csound_orc_semantics.h"
+#include "aops.h"
 
 extern char argtyp2(char *);
 extern void print_tree(CSOUND *, char *, TREE *);
@@ -375,6 +376,168 @@ char* create_out_arg_for_expression(CSOUND* csound, char* op, TREE* left,
     return create_out_arg(csound, outType, typeTable);
 }
 
+/* EXPRESSION FUSION
+
+   A tree of +, -, * and / with an a-rate result would otherwise become
+   one opcode per operator, each writing a temporary a-rate variable.
+   Instead it is compiled into a single ##expr opcode (see aops.c), whose
+   first argument is the tree in reverse Polish and the rest its operands.
+   Operands that are not a-rate arithmetic (k-rate sub-expressions,
+   function calls, ...) are expanded as usual, and their results become
+   operands of the fused opcode.  */
+
+typedef struct {
+    TREE    *args[EXPR_MAXARGS];
+    int     nargs, nops, depth;
+    int     ncode;
+    char    code[EXPR_MAXCODE + 1];
+    TREE    *anchor;                    /* sub-expressions, emit pass only */
+} FUSION;
+
+static int is_fusable_op(TREE *node)
+{
+    switch (node->type) {
+    case '+':
+    case '-':
+    case '*':
+    case '/':
+    case S_UMINUS:
+      return 1;
+    }
+    return 0;
+}
+
+/* rate of the result of node if it is a plain number, else 0 */
+
+static char fusion_type(CSOUND *csound, TREE *node, TYPE_TABLE *typeTable)
+{
+    char *s, c = '\0';
+
+    if (is_fusable_op(node)) {
+      char l = (node->left != NULL ?
+                fusion_type(csound, node->left, typeTable) : 'c');
+      char r = fusion_type(csound, node->right, typeTable);
+      if (l == '\0' || r == '\0')
+        return '\0';
+      return (l == 'a' || r == 'a' ? 'a' : 'k');
+    }
+    s = get_arg_type2(csound, node, typeTable);
+    if (s != NULL && s[0] != '\0' && s[1] == '\0' &&
+        strchr("aikcpr", s[0]) != NULL)
+      c = s[0];
+    return c;
+}
+
+static int fusion_push(FUSION *f, TREE *arg)
+{
+    int i;
+
+    if (arg->type != T_IDENT && arg->type != INTEGER_TOKEN &&
+        arg->type != NUMBER_TOKEN)
+      i = f->nargs;
+    else                              /* the same variable or number */
+      for (i = 0; i < f->nargs; i++)
+        if (f->args[i]->type == arg->type &&
+            !strcmp(f->args[i]->value->lexeme, arg->value->lexeme))
+          break;
+    if (i == f->nargs) {
+      if (f->nargs == EXPR_MAXARGS)
+        return 0;
+      f->args[f->nargs++] = arg;
+    }
+    if (f->ncode == EXPR_MAXCODE || ++f->depth > EXPR_DEPTH)
+      return 0;
+    f->code[f->ncode++] = 'A' + i;
+    return 1;
+}
+
+/* Walk the tree under node, adding its operands and program to f.  With
+   emit zero this only checks that the tree fits, and changes nothing. */
+
+static int fusion_walk(CSOUND *csound, FUSION *f, TREE *node, int emit,
+                       int line, int locn, TYPE_TABLE *typeTable)
+{
+    char t = fusion_type(csound, node, typeTable);
+
+    if (t == '\0')
+      return 0;
+    if (t == 'a' && is_fusable_op(node)) {
+      if (node->type == S_UMINUS) {   /* -x is -1 * x, as in ##mul */
+        /* the check pass counts node itself as the -1 operand, so that
+           nothing is allocated unless the tree is really fused */
+        if (!fusion_push(f, emit ? create_minus_token(csound) : node))
+          return 0;
+      }
+      else if (!fusion_walk(csound, f, node->left, emit, line, locn,
+                            typeTable))
+        return 0;
+      if (!fusion_walk(csound, f, node->right, emit, line, locn, typeTable))
+        return 0;
+      if (f->ncode == EXPR_MAXCODE)
+        return 0;
+      f->code[f->ncode++] = (node->type == S_UMINUS ? '*' : node->type);
+      f->depth--;
+      f->nops++;
+      return 1;
+    }
+    if (is_expression_node(node)) {
+      TREE *chain;
+      if (!emit)                      /* count it as an operand */
+        return fusion_push(f, node);
+      chain = create_expression(csound, node, line, locn, typeTable);
+      if (chain == NULL)
+        return 0;
+      f->anchor = appendToTree(csound, f->anchor, chain);
+      node = create_ans_token(csound, tree_tail(chain)->left->value->lexeme);
+    }
+    return fusion_push(f, node);
+}
+
+/**
+ * If root is a tree of a-rate arithmetic with at least two operators,
+ * return the chain of statements computing it with a fused ##expr
+ * opcode, writing to the variable out, or to a new temporary if out is
+ * NULL.  Otherwise return NULL without changing anything.
+ */
+static TREE *create_fused_expression(CSOUND *csound, TREE *root, TREE *out,
+                                     int line, int locn,
+                                     TYPE_TABLE* typeTable)
+{
+    FUSION  f;
+    TREE    *opTree, *args;
+    char    prog[EXPR_MAXCODE + 3];
+    int     i;
+
+    if (!is_fusable_op(root))
+      return NULL;
+    memset(&f, 0, sizeof(FUSION));
+    if (!fusion_walk(csound, &f, root, 0, line, locn, typeTable) ||
+        f.nops < 2)
+      return NULL;
+    memset(&f, 0, sizeof(FUSION));
+    if (UNLIKELY(!fusion_walk(csound, &f, root, 1, line, locn, typeTable)))
+      return NULL;
+
+    snprintf(prog, EXPR_MAXCODE + 3, "\"%s\"", f.code);
+    opTree = create_opcode_token(csound, "##expr");
+    opTree->left = (out != NULL ? out :
+                    create_ans_token(csound,
+                                     create_out_arg(csound, "a", typeTable)));
+    opTree->right = args = make_leaf(csound, line, locn, STRING_TOKEN,
+                                     make_token(csound, prog));
+    for (i = 0; i < f.nargs; i++) {
+      args->next = f.args[i];
+      args = args->next;
+    }
+    args->next = NULL;
+    opTree->line = line;
+    opTree->locn = locn;
+    if (UNLIKELY(PARSER_DEBUG))
+      csound->Message(csound, "Fused expression: %s, %d operands\n",
+                      prog, f.nargs);
+    return appendToTree(csound, f.anchor, opTree);
+}
+
 /**
  * Create a chain of Opcode (OPTXT) text from the AST node given. Called from
  * create_opcode when an expression node has been found as an argument
@@ -390,6 +553,9 @@ TREE * create_expression(CSOUND *csound, TREE *root, int line, int locn,
 
     if (root->type=='?') return create_cond_expression(csound, root, line,
                                                        locn, typeTable);
+    if ((anchor = create_fused_expression(csound, root, NULL, line, locn,
+                                          typeTable)) != NULL)
+      return anchor;
 
     current = root->left;
     newArgList = NULL;
@@ -808,6 +974,19 @@ TREE* expand_statement(CSOUND* csound, TREE* current, TYPE_TABLE* typeTable) {
 
     current->next = NULL;
 
+    /* a local a-rate assignment from fusable arithmetic writes its
+       result straight into the variable, without the copy */
+    if (current->type == '=' && current->left != NULL &&
+        current->left->type == T_IDENT && current->left->next == NULL &&
+        current->left->value->lexeme[0] == 'a' &&
+        currentArg != NULL && currentArg->next == NULL &&
+        (anchor = create_fused_expression(csound, currentArg, current->left,
+                                          current->line, current->locn,
+                                          typeTable)) != NULL) {
+      appendToTree(csound, anchor, originalNext);
+      return anchor;
+    }
+
     if (UNLIKELY(PARSER_DEBUG))
         csound->Message(csound, "Found Statement.\n");
     while (currentArg != NULL) {
@@ -24,6 +24,11 @@
 
 #include "csoundCore.h"
 #include "csound_orc.h"
+#include "csound_type_system.h"
+#include "csound_standard_types.h"
+#include "csound_orc_semantics.h"
+
+extern OENTRIES* find_opcode2(CSOUND *, char *);
 
 static TREE * create_fun_token(CSOUND *csound, TREE *right, char *fname)
 {
@@ -216,10 +221,604 @@ static TREE * verify_tree1(CSOUND *csound, TREE *root)
     return root;
 }
 
+/* DATAFLOW OPTIMISATION
+
+   After verification every statement of an instrument body is a single
+   opcode, a label or a goto, and each opcode node carries its OENTRY.
+   Each body is taken as an array of statements, and the passes below
+   are repeated until none of them finds anything more to do:
+
+   - i-rate operators and pure functions with constant arguments are
+     evaluated by the opcode's own init routine, and an i-variable with
+     one constant definition is replaced by its value wherever that
+     definition is certain to have run first;
+   - conditional gotos on constant conditions become plain gotos or are
+     dropped, and statements no path can reach are removed;
+   - pure statements whose outputs are never read are removed;
+   - k-rate temporaries in a loop whose inputs do not change in the loop
+     are computed once before it.  */
+
+typedef struct {
+    CS_TYPE *type;              /* NULL unless a local variable */
+    int     defs, uses, pinned;
+    int     def;                /* defining statement when defs == 1 */
+    int     isconst;
+    MYFLT   value;
+} OPT_VAR;
+
+typedef struct {
+    CSOUND  *csound;
+    CS_VAR_POOL *pool;
+    TREE    **stmt;
+    int     count;
+    CS_HASH_TABLE *vars;        /* OPT_VAR by name */
+    CS_HASH_TABLE *labels;      /* statement index + 1 by label name */
+    char    *seen;
+    int     *queue;
+    int     seenfor;            /* statement skipped by the last walk */
+    INSDS   *ip;                /* dummy owner for folded opcodes */
+} OPT_BODY;
+
+typedef struct {
+    int     propagated, dead, branches, unreachable, hoisted;
+} OPT_STATS;
+
+/* i-rate operators and functions that depend only on their arguments */
+static const char *const fold_ops[] = {
+    "##add", "##sub", "##mul", "##div", "##mod",
+    "int", "frac", "round", "floor", "ceil", "abs", "exp", "log", "sqrt",
+    "sin", "cos", "tan", "sininv", "cosinv", "taninv", "taninv2",
+    "log10", "log2", "sinh", "cosh", "tanh", "ampdb", "dbamp", "cpsoct",
+    "octpch", "cpspch", "pchoct", "octcps", "cpsmidinn", "powoftwo",
+    "octave", "semitone", "cent",
+    ">", ">=", "<", "<=", "==", "!=", "&&", "||", NULL
+};
+
+/* assignments, folded by copying their argument */
+static const char *const assign_ops[] = { "=", "init", NULL };
+
+/* other opcodes with no effect beyond their outputs */
+static const char *const pure_ops[] = {
+    "=", "init", "##expr", "##and", "##or", "##xor", "##shl", "##shr",
+    "##not", "i", "qinf", "qnan", NULL
+};
+
+/* may warn about their arguments, so are not moved */
+static const char *const div_ops[] = { "##div", "##mod", NULL };
+
+/* opcodes that use the names of their arguments */
+static const char *const named_arg_ops[] = {
+    "print", "display", "dispfft", "specdisp", "OSClisten", NULL
+};
+
+static const struct {
+    const char  *cond, *jump;
+    int         negate;
+} cond_gotos[] = {
+    { "cggoto", "goto", 0 },    { "cigoto", "igoto", 0 },
+    { "ckgoto", "kgoto", 0 },   { "cngoto", "goto", 1 },
+    { "cingoto", "igoto", 1 },  { NULL, NULL, 0 }
+};
+
+static int opt_op_in(OENTRY *ep, const char *const *names)
+{
+    size_t  n = strcspn(ep->opname, ".");
+
+    for ( ; *names != NULL; names++)
+      if (strlen(*names) == n && strncmp(ep->opname, *names, n) == 0)
+        return 1;
+    return 0;
+}
+
+static OENTRY *opt_entry(TREE *t)
+{
+    if (t == NULL)
+      return NULL;
+    switch (t->type) {
+    case T_OPCODE:
+    case T_OPCODE0:
+    case '=':
+    case GOTO_TOKEN:
+    case IGOTO_TOKEN:
+    case KGOTO_TOKEN:
+      return (OENTRY*) t->markup;
+    default:
+      return NULL;
+    }
+}
+
+static OPT_VAR *opt_var(OPT_BODY *b, char *name)
+{
+    OPT_VAR *v = cs_hash_table_get(b->csound, b->vars, name);
+
+    if (v == NULL) {
+      CS_VARIABLE *var = csoundFindVariableWithName(b->csound, b->pool, name);
+      v = b->csound->Calloc(b->csound, sizeof(OPT_VAR));
+      v->type = (var != NULL ? var->varType : NULL);
+      v->def = -1;
+      cs_hash_table_put(b->csound, b->vars, name, v);
+    }
+    return v;
+}
+
+static int opt_label(OPT_BODY *b, char *name)
+{
+    return (int) (intptr_t) cs_hash_table_get(b->csound, b->labels, name) - 1;
+}
+
+static int opt_is_const(TREE *t)
+{
+    return (t->type == INTEGER_TOKEN || t->type == NUMBER_TOKEN);
+}
+
+/* add delta to the use count of every name in t and its children */
+static void opt_walk(OPT_BODY *b, TREE *t, int delta, int pin)
+{
+    TREE    *c;
+
+    if (t->value != NULL && t->value->lexeme != NULL &&
+        !opt_is_const(t) && t->type != STRING_TOKEN) {
+      OPT_VAR *v = opt_var(b, t->value->lexeme);
+      v->uses += delta;
+      v->pinned |= pin;
+    }
+    for (c = t->left; c != NULL; c = c->next)
+      opt_walk(b, c, delta, pin);
+    for (c = t->right; c != NULL; c = c->next)
+      opt_walk(b, c, delta, pin);
+}
+
+/* drop removed statements and recount definitions, uses and labels */
+static void opt_analyse(OPT_BODY *b)
+{
+    CSOUND  *csound = b->csound;
+    TREE    *t, *arg;
+    int     i, n;
+
+    for (i = n = 0; i < b->count; i++)
+      if (b->stmt[i] != NULL)
+        b->stmt[n++] = b->stmt[i];
+    b->count = n;
+    if (b->vars != NULL)
+      cs_hash_table_mfree_complete(csound, b->vars);
+    if (b->labels != NULL)
+      cs_hash_table_free(csound, b->labels);
+    b->vars = cs_hash_table_create(csound);
+    b->labels = cs_hash_table_create(csound);
+    b->seenfor = -2;
+    for (i = 0; i < b->count; i++) {
+      t = b->stmt[i];
+      if (t->type == LABEL_TOKEN) {
+        cs_hash_table_put(csound, b->labels, t->value->lexeme,
+                          (void*) (intptr_t) (i + 1));
+        continue;
+      }
+      if (opt_entry(t) == NULL)
+        continue;
+      for (arg = t->left; arg != NULL; arg = arg->next) {
+        if (arg->type == T_IDENT) {
+          OPT_VAR *v = opt_var(b, arg->value->lexeme);
+          v->defs++;
+          v->def = i;
+        }
+        else opt_walk(b, arg, 1, 1);
+      }
+      for (arg = t->right; arg != NULL; arg = arg->next)
+        opt_walk(b, arg, 1, 0);
+    }
+}
+
+static inline void opt_visit(OPT_BODY *b, int j, int skip, int *tail)
+{
+    if (j != skip && !b->seen[j]) {
+      b->seen[j] = 1;
+      b->queue[(*tail)++] = j;
+    }
+}
+
+/* mark the statements reachable from the start without passing through
+   statement skip, following the jumps taken at init time if init is
+   set, or in either pass if not */
+static void opt_reach(OPT_BODY *b, int skip, int init)
+{
+    int     head = 0, tail = 0, i, j;
+
+    memset(b->seen, 0, b->count);
+    b->seenfor = -2;
+    if (b->count == 0 || skip == 0)
+      return;
+    b->seen[0] = 1;
+    b->queue[tail++] = 0;
+    while (head < tail) {
+      TREE    *t = b->stmt[i = b->queue[head++]], *arg;
+      OENTRY  *ep = opt_entry(t);
+      if (ep != NULL) {
+        for (arg = t->right; arg != NULL; arg = arg->next)
+          if (arg->type == T_IDENT &&
+              (j = opt_label(b, arg->value->lexeme)) >= 0)
+            opt_visit(b, j, skip, &tail);
+        if (strcmp(ep->opname, "goto") == 0 ||
+            (init && strcmp(ep->opname, "igoto") == 0))
+          continue;
+      }
+      if (i + 1 < b->count)
+        opt_visit(b, i + 1, skip, &tail);
+    }
+}
+
+/* is statement d certain to have run at init time when u runs? */
+static int opt_dominates(OPT_BODY *b, int d, int u)
+{
+    int     i;
+
+    if (d < 0 || d >= u)
+      return 0;
+    for (i = d + 1; i <= u; i++)
+      if (b->stmt[i] != NULL && b->stmt[i]->type == LABEL_TOKEN)
+        break;
+    if (i > u)
+      return 1;
+    if (b->seenfor != d) {
+      opt_reach(b, d, 1);
+      b->seenfor = d;
+    }
+    return !b->seen[u];
+}
+
+/* the value of an argument of statement u, if it is known */
+static int opt_const_arg(OPT_BODY *b, TREE *arg, int u, MYFLT *val)
+{
+    OPT_VAR *v;
+
+    if (opt_is_const(arg)) {
+      *val = (MYFLT) cs_strtod(arg->value->lexeme, NULL);
+      return 1;
+    }
+    if (arg->type != T_IDENT ||
+        (v = cs_hash_table_get(b->csound, b->vars,
+                               arg->value->lexeme)) == NULL ||
+        !v->isconst || !opt_dominates(b, v->def, u))
+      return 0;
+    *val = v->value;
+    return 1;
+}
+
+static TREE *opt_const_leaf(CSOUND *csound, TREE *old, MYFLT val)
+{
+    char    buf[32];
+    ORCTOKEN *tok;
+    TREE    *t;
+
+    snprintf(buf, sizeof(buf), "%.17g", (double) val);
+    tok = make_token(csound, buf);
+    tok->type = NUMBER_TOKEN;
+    tok->fvalue = (double) val;
+    t = make_leaf(csound, old->line, old->locn, NUMBER_TOKEN, tok);
+    t->next = old->next;
+    return t;
+}
+
+/* if statement u computes an i-rate or boolean constant, note its value */
+static void opt_fold(OPT_BODY *b, int u)
+{
+    TREE    *t = b->stmt[u], *arg;
+    OENTRY  *ep = opt_entry(t);
+    OPT_VAR *v;
+    MYFLT   val;
+
+    if (ep == NULL || t->left == NULL || t->left->next != NULL ||
+        t->left->type != T_IDENT)
+      return;
+    v = cs_hash_table_get(b->csound, b->vars, t->left->value->lexeme);
+    if (v == NULL || v->defs != 1 || v->pinned || v->isconst ||
+        (v->type != &CS_VAR_TYPE_I && v->type != &CS_VAR_TYPE_b))
+      return;
+    if (opt_op_in(ep, assign_ops)) {
+      if (v->type != &CS_VAR_TYPE_I || t->right == NULL ||
+          t->right->next != NULL || !opt_const_arg(b, t->right, u, &val))
+        return;
+    }
+    else {
+      /* run the opcode on its constant arguments */
+      union { MYFLT f; int b; } cell[4];
+      struct { OPDS h; MYFLT *args[4]; } op;
+      int     n;
+
+      if (!opt_op_in(ep, fold_ops) || ep->iopadr == NULL ||
+          ep->dsblksiz > sizeof(op))
+        return;
+      memset(&op, 0, sizeof(op));
+      memset(cell, 0, sizeof(cell));
+      op.h.insdshead = b->ip;
+      op.args[0] = &cell[0].f;
+      for (n = 1, arg = t->right; arg != NULL; arg = arg->next, n++) {
+        if (n > 3 || !opt_const_arg(b, arg, u, &val))
+          return;
+        if (ep->intypes[n - 1] == 'b')
+          cell[n].b = (int) val;
+        else
+          cell[n].f = val;
+        op.args[n] = &cell[n].f;
+      }
+      /* leave a division by zero to be reported when it runs */
+      if (opt_op_in(ep, div_ops) && cell[2].f == FL(0.0))
+        return;
+      if (ep->iopadr(b->csound, &op) != OK)
+        return;
+      val = (ep->outypes[0] == 'b' ? (MYFLT) cell[0].b : cell[0].f);
+    }
+    if (isnan(val) || isinf(val))
+      return;
+    v->isconst = 1;
+    v->value = val;
+}
+
+/* fold constants and put them in place of the i-variables holding them */
+static int opt_propagate(OPT_BODY *b, OPT_STATS *stats)
+{
+    TREE    **argp;
+    OENTRY  *ep;
+    OPT_VAR *v;
+    int     u, changed = 0;
+
+    for (u = 0; u < b->count; u++) {
+      if ((ep = opt_entry(b->stmt[u])) == NULL)
+        continue;
+      if (!opt_op_in(ep, named_arg_ops)) {
+        for (argp = &b->stmt[u]->right; *argp != NULL;
+             argp = &(*argp)->next) {
+          TREE *arg = *argp;
+          if (arg->type != T_IDENT ||
+              (v = cs_hash_table_get(b->csound, b->vars,
+                                     arg->value->lexeme)) == NULL ||
+              v->type != &CS_VAR_TYPE_I || !v->isconst ||
+              !opt_dominates(b, v->def, u))
+            continue;
+          /* the old leaf may be shared, so it is left to the memory pool */
+          *argp = opt_const_leaf(b->csound, arg, v->value);
+          v->uses--;
+          stats->propagated++;
+          changed = 1;
+        }
+      }
+      opt_fold(b, u);
+    }
+    return changed;
+}
+
+/* resolve conditional gotos on constant conditions */
+static int opt_branches(OPT_BODY *b, OPT_STATS *stats)
+{
+    OENTRY  *ep;
+    OPT_VAR *v;
+    TREE    *t;
+    int     u, k, changed = 0;
+
+    for (u = 0; u < b->count; u++) {
+      if ((ep = opt_entry(t = b->stmt[u])) == NULL || t->right == NULL ||
+          t->right->type != T_IDENT)
+        continue;
+      for (k = 0; cond_gotos[k].cond != NULL; k++)
+        if (strcmp(ep->opname, cond_gotos[k].cond) == 0)
+          break;
+      if (cond_gotos[k].cond == NULL ||
+          (v = cs_hash_table_get(b->csound, b->vars,
+                                 t->right->value->lexeme)) == NULL ||
+          v->type != &CS_VAR_TYPE_b || !v->isconst ||
+          !opt_dominates(b, v->def, u))
+        continue;
+      if ((v->value != FL(0.0)) == cond_gotos[k].negate)
+        b->stmt[u] = NULL;                  /* never taken */
+      else {
+        OENTRIES *entries = find_opcode2(b->csound,
+                                         (char*) cond_gotos[k].jump);
+        if (entries->count > 0) {
+          t->markup = entries->entries[0];
+          t->value = make_token(b->csound, (char*) cond_gotos[k].jump);
+          t->value->type = T_OPCODE;
+          t->right = t->right->next;
+        }
+        b->csound->Free(b->csound, entries);
+      }
+      stats->branches++;
+      changed = 1;
+    }
+    return changed;
+}
+
+/* remove the statements no path reaches */
+static int opt_unreachable(OPT_BODY *b, OPT_STATS *stats)
+{
+    int     i, changed = 0;
+
+    opt_reach(b, -1, 0);
+    for (i = 0; i < b->count; i++)
+      if (!b->seen[i] && opt_entry(b->stmt[i]) != NULL) {
+        b->stmt[i] = NULL;
+        stats->unreachable++;
+        changed = 1;
+      }
+    return changed;
+}
+
+static int opt_is_pure(OENTRY *ep)
+{
+    return (opt_op_in(ep, fold_ops) || opt_op_in(ep, pure_ops));
+}
+
+/* remove pure statements whose outputs are not read */
+static int opt_dead(OPT_BODY *b, OPT_STATS *stats)
+{
+    OENTRY  *ep;
+    OPT_VAR *v;
+    TREE    *t, *arg;
+    int     i, again, changed = 0;
+
+    do {
+      again = 0;
+      for (i = b->count - 1; i >= 0; i--) {
+        if ((ep = opt_entry(t = b->stmt[i])) == NULL || t->left == NULL ||
+            !opt_is_pure(ep))
+          continue;
+        for (arg = t->left; arg != NULL; arg = arg->next) {
+          if (arg->type != T_IDENT)
+            break;
+          v = opt_var(b, arg->value->lexeme);
+          if (v->type == NULL || v->uses > 0 || v->pinned)
+            break;
+        }
+        if (arg != NULL)
+          continue;
+        for (arg = t->left; arg != NULL; arg = arg->next)
+          opt_var(b, arg->value->lexeme)->defs--;
+        for (arg = t->right; arg != NULL; arg = arg->next)
+          opt_walk(b, arg, -1, 0);
+        b->stmt[i] = NULL;
+        stats->dead++;
+        again = changed = 1;
+      }
+    } while (again);
+    return changed;
+}
+
+/* may the statements from i to j change the variable name? */
+static int opt_changes(OPT_BODY *b, char *name, int i, int j)
+{
+    OENTRY  *ep;
+    TREE    *arg;
+
+    for ( ; i <= j; i++) {
+      if ((ep = opt_entry(b->stmt[i])) == NULL)
+        continue;
+      for (arg = b->stmt[i]->left; arg != NULL; arg = arg->next)
+        if (arg->value != NULL && strcmp(arg->value->lexeme, name) == 0)
+          return 1;
+      /* some opcodes write to their input arguments */
+      if (!opt_is_pure(ep))
+        for (arg = b->stmt[i]->right; arg != NULL; arg = arg->next)
+          if (arg->value != NULL && strcmp(arg->value->lexeme, name) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+/* move one loop invariant k-rate temporary of the loop from label i to
+   the backward jump j in front of the loop */
+static int opt_hoist_loop(OPT_BODY *b, int i, int j)
+{
+    OENTRY  *ep;
+    OPT_VAR *v;
+    TREE    *t, *arg;
+    int     s, k;
+
+    /* the loop may only be entered through its top */
+    for (s = 0; s < b->count; s++) {
+      if ((s >= i && s <= j) || (ep = opt_entry(t = b->stmt[s])) == NULL)
+        continue;
+      for (arg = t->right; arg != NULL; arg = arg->next)
+        if (arg->type == T_IDENT &&
+            (k = opt_label(b, arg->value->lexeme)) >= i && k <= j)
+          return 0;
+    }
+    for (s = i + 1; s < j; s++) {
+      if ((ep = opt_entry(t = b->stmt[s])) == NULL || ep->thread != 2 ||
+          !opt_is_pure(ep) || opt_op_in(ep, div_ops) ||
+          t->left == NULL || t->left->next != NULL ||
+          t->left->type != T_IDENT || t->left->value->lexeme[0] != '#')
+        continue;
+      v = opt_var(b, t->left->value->lexeme);
+      if (v->type != &CS_VAR_TYPE_K || v->defs != 1 || v->pinned)
+        continue;
+      for (arg = t->right; arg != NULL; arg = arg->next) {
+        if (opt_is_const(arg) || arg->type == STRING_TOKEN)
+          continue;
+        if (arg->type != T_IDENT ||
+            opt_var(b, arg->value->lexeme)->type == NULL ||
+            opt_changes(b, arg->value->lexeme, i, j))
+          break;
+      }
+      if (arg == NULL) {
+        memmove(&b->stmt[i + 1], &b->stmt[i], (s - i) * sizeof(TREE*));
+        b->stmt[i] = t;
+        return 1;
+      }
+    }
+    return 0;
+}
+
+static int opt_hoist(OPT_BODY *b, OPT_STATS *stats)
+{
+    OENTRY  *ep;
+    TREE    *arg;
+    int     i, j, changed = 0;
+
+ again:
+    for (j = 0; j < b->count; j++) {
+      if ((ep = opt_entry(b->stmt[j])) == NULL)
+        continue;
+      for (arg = b->stmt[j]->right; arg != NULL; arg = arg->next)
+        if (arg->type == T_IDENT &&
+            (i = opt_label(b, arg->value->lexeme)) >= 0 && i < j &&
+            opt_hoist_loop(b, i, j)) {
+          stats->hoisted++;
+          changed = 1;
+          opt_analyse(b);
+          goto again;
+        }
+    }
+    return changed;
+}
+
+/* optimise the statement list of one body, returning its new head */
+static TREE *optimize_body(CSOUND *csound, TREE *list, CS_VAR_POOL *pool,
+                           INSDS *ip, OPT_STATS *stats)
+{
+    OPT_BODY b;
+    TREE    *t;
+    int     i, changed;
+
+    memset(&b, 0, sizeof(OPT_BODY));
+    b.csound = csound;
+    b.pool = pool;
+    b.ip = ip;
+    for (t = list; t != NULL; t = t->next)
+      b.count++;
+    if (b.count == 0 || pool == NULL)
+      return list;
+    b.stmt = csound->Malloc(csound, b.count * sizeof(TREE*));
+    b.seen = csound->Malloc(csound, b.count);
+    b.queue = csound->Malloc(csound, b.count * sizeof(int));
+    for (i = 0, t = list; t != NULL; t = t->next)
+      b.stmt[i++] = t;
+    do {
+      opt_analyse(&b);
+      changed = opt_propagate(&b, stats);
+      changed |= opt_branches(&b, stats);
+      opt_analyse(&b);
+      changed |= opt_unreachable(&b, stats);
+      opt_analyse(&b);
+      changed |= opt_dead(&b, stats);
+      opt_analyse(&b);
+      changed |= opt_hoist(&b, stats);
+    } while (changed);
+    for (i = 0; i < b.count; i++)
+      b.stmt[i]->next = (i + 1 < b.count ? b.stmt[i + 1] : NULL);
+    list = (b.count > 0 ? b.stmt[0] : NULL);
+    cs_hash_table_mfree_complete(csound, b.vars);
+    cs_hash_table_free(csound, b.labels);
+    csound->Free(csound, b.queue);
+    csound->Free(csound, b.seen);
+    csound->Free(csound, b.stmt);
+    return list;
+}
+
 /* Optimizes tree (expressions, etc.) */
-TREE * csound_orc_optimize(CSOUND *csound, TREE *root)
+TREE * csound_orc_optimize(CSOUND *csound, TREE *root, TYPE_TABLE *typeTable)
 {
     TREE *original=root, *last = NULL;
+    OPT_STATS stats;
+    INSDS *ip;
+
     while (root) {
         TREE *xx = verify_tree1(csound, root);
         if (xx != root) {
@@ -230,5 +829,24 @@ TREE * csound_orc_optimize(CSOUND *csound, TREE *root)
         last = root;
         root = root->next;
     }
+
+    memset(&stats, 0, sizeof(OPT_STATS));
+    ip = csound->Calloc(csound, sizeof(INSDS));
+    for (root = original; root != NULL; root = root->next)
+      if (root->type == INSTR_TOKEN || root->type == UDO_TOKEN)
+        root->right = optimize_body(csound, root->right,
+                                    (CS_VAR_POOL*) root->markup, ip, &stats);
+    original = optimize_body(csound, original, typeTable->instr0LocalPool,
+                             ip, &stats);
+    csound->Free(csound, ip);
+    if (stats.propagated + stats.dead + stats.branches +
+        stats.unreachable + stats.hoisted > 0)
+      csound->Message(csound,
+                      Str("Orchestra optimisation: %d constants propagated, "
+                          "%d branches resolved, %d unreachable and "
+                          "%d unused statements removed, "
+                          "%d loop invariants hoisted\n"),
+                      stats.propagated, stats.branches, stats.unreachable,
+                      stats.dead, stats.hoisted);
     return original;
 }
@@ -219,6 +219,7 @@ OENTRY opcodlst_1[] = {
   { "##mul.aa",  S(AOP),0,    4,      "a",    "aa",   NULL,   NULL,   mulaa   },
   { "##div.aa",  S(AOP),0,    4,      "a",    "aa",   NULL,   NULL,   divaa   },
   { "##mod.aa",  S(AOP),0,    4,      "a",    "aa",   NULL,   NULL,   modaa   },
+  { "##expr",   S(EXPR),0,   5,      "a",    "SM",   expr_init, NULL, expr_perf },
   { "divz",   0xfffc                                                      },
   { "divz.ii", S(DIVZ),0,   1,      "i",    "iii",  divzkk, NULL,   NULL    },
   { "divz.kk", S(DIVZ),0,   2,      "k",    "kkk",  NULL,   divzkk, NULL    },
@@ -432,11 +433,11 @@ OENTRY opcodlst_1[] = {
   { "oscil1", S(OSCIL1), TR, 3,     "k",    "ikij", ko1set, kosc1          },
   { "oscil1i",S(OSCIL1), TR, 3,     "k",    "ikij", ko1set, kosc1i         },
   { "osciln", S(OSCILN), TR, 5,     "a",    "kiii", oscnset,NULL,   osciln },
-  { "oscil.a",S(OSC),0,    5,       "a",    "kkjo", oscset, NULL,   osckk  },
-  { "oscil.kk",S(OSC),0,    7,      "s",    "kkjo", oscset, koscil, osckk  },
-  { "oscil.ka",S(OSC),0,    5,      "a",    "kajo", oscset, NULL,   oscka  },
-  { "oscil.ak",S(OSC),0,    5,      "a",    "akjo", oscset, NULL,   oscak  },
-  { "oscil.aa",S(OSC),0,    5,      "a",    "aajo", oscset, NULL,   oscaa  },
+  { "oscil.a",S(OSC),0,    5,       "a",    "kkjoo", oscset, NULL,   osckk  },
+  { "oscil.kk",S(OSC),0,    7,      "s",    "kkjoo", oscset, koscil, osckk  },
+  { "oscil.ka",S(OSC),0,    5,      "a",    "kajoo", oscset, NULL,   oscka  },
+  { "oscil.ak",S(OSC),0,    5,      "a",    "akjoo", oscset, NULL,   oscak  },
+  { "oscil.aa",S(OSC),0,    5,      "a",    "aajoo", oscset, NULL,   oscaa  },
   { "oscil.kkA",S(OSC),0,   7,      "a",    "kki[]o", oscsetA, koscil, osckk },
   { "oscil.kaA",S(OSC),0,   5,      "a",    "kai[]o", oscsetA, NULL, oscka },
   { "oscil.akA",S(OSC),0,   5,      "a",    "aki[]o", oscsetA, NULL, oscak },
@@ -448,21 +449,21 @@ OENTRY opcodlst_1[] = {
      { "oscil.aa", S(POSC),0, 5, "a", "aajo", posc_set, NULL,  poscaa },
      { "oscil3.kk",  S(POSC),0,  7, "s", "kkjo", posc_set, kposc3, posc3 },
   */
-  { "oscili.a",S(OSC),0,   5,      "a",    "kkjo", oscset, NULL, osckki  },
-  { "oscili.kk",S(OSC),0,   3,      "k",   "kkjo", oscset, koscli, NULL  },
-  { "oscili.ka",S(OSC),0,   5,      "a",   "kajo", oscset, NULL,   osckai  },
-  { "oscili.ak",S(OSC),0,   5,      "a",   "akjo", oscset, NULL,   oscaki  },
-  { "oscili.aa",S(OSC),0,   5,      "a",   "aajo", oscset, NULL,   oscaai  },
+  { "oscili.a",S(OSC),0,   5,      "a",    "kkjoo", oscset, NULL, osckki  },
+  { "oscili.kk",S(OSC),0,   3,      "k",   "kkjoo", oscset, koscli, NULL  },
+  { "oscili.ka",S(OSC),0,   5,      "a",   "kajoo", oscset, NULL,   osckai  },
+  { "oscili.ak",S(OSC),0,   5,      "a",   "akjoo", oscset, NULL,   oscaki  },
+  { "oscili.aa",S(OSC),0,   5,      "a",   "aajoo", oscset, NULL,   oscaai  },
   { "oscili.aA",S(OSC),0,   5,      "a",   "kki[]o", oscsetA, NULL, osckki  },
   { "oscili.kkA",S(OSC),0,   3,      "k",  "kki[]o", oscsetA, koscli, NULL  },
   { "oscili.kaA",S(OSC),0,   5,      "a",  "kai[]o", oscsetA, NULL,   osckai  },
   { "oscili.akA",S(OSC),0,   5,      "a",  "aki[]o", oscsetA, NULL,   oscaki  },
   { "oscili.aaA",S(OSC),0,   5,      "a",  "aai[]o", oscsetA, NULL,   oscaai  },
-  { "oscil3.a",S(OSC),0,   5,      "a",    "kkjo", oscset, NULL, osckk3  },
-  { "oscil3.kk",S(OSC),0,   3,      "k",   "kkjo", oscset, koscl3, NULL  },
-  { "oscil3.ka",S(OSC),0,   5,      "a",   "kajo", oscset, NULL,   oscka3  },
-  { "oscil3.ak",S(OSC),0,   5,      "a",   "akjo", oscset, NULL,   oscak3  },
-  { "oscil3.aa",S(OSC),0,   5,      "a",   "aajo", oscset, NULL,   oscaa3  },
+  { "oscil3.a",S(OSC),0,   5,      "a",    "kkjoo", oscset, NULL, osckk3  },
+  { "oscil3.kk",S(OSC),0,   3,      "k",   "kkjoo", oscset, koscl3, NULL  },
+  { "oscil3.ka",S(OSC),0,   5,      "a",   "kajoo", oscset, NULL,   oscka3  },
+  { "oscil3.ak",S(OSC),0,   5,      "a",   "akjoo", oscset, NULL,   oscak3  },
+  { "oscil3.aa",S(OSC),0,   5,      "a",   "aajoo", oscset, NULL,   oscaa3  },
   { "oscil3.aA",S(OSC),0,   5,      "a",   "kki[]o", oscsetA, NULL, osckk3 },
   { "oscil3.kkA",S(OSC),0,   3,      "k",  "kki[]o", oscsetA, koscl3, NULL },
   { "oscil3.kaA",S(OSC),0,   5,      "a",  "kai[]o", oscsetA, NULL, oscka3 },
@@ -846,9 +847,9 @@ OENTRY opcodlst_1[] = {
     (SUBR)fassign_set, (SUBR)fassign },
   { "init.f",   S(FASSIGN),0, 1,    "f",   "f",
     (SUBR)fassign_set, NULL, NULL    },
-  { "pvsanal",  S(PVSANAL), 0, 5,   "f",   "aiiiioo",
+  { "pvsanal",  S(PVSANAL), 0, 5,   "f",   "aiiiiooo",
     pvsanalset, NULL, pvsanal   },
-  { "pvsynth",  S(PVSYNTH),0, 5,    "a",   "fo",     pvsynthset, NULL, pvsynth },
+  { "pvsynth",  S(PVSYNTH),0, 5,    "a",   "foo",    pvsynthset, NULL, pvsynth },
   { "pvsadsyn", S(PVADS),0,   7,    "a",   "fikopo", pvadsynset, pvadsyn, pvadsyn},
   { "pvscross", S(PVSCROSS),0,3,    "f",   "ffkk",   pvscrosset, pvscross, NULL },
   { "pvsfread", S(PVSFREAD),0,3,    "f",   "kSo",    pvsfreadset_S, pvsfread, NULL},
@@ -1112,17 +1113,17 @@ OENTRY opcodlst_1[] = {
       (SUBR) chnsend_opcode_init, (SUBR) notinit_opcode_stub, (SUBR) NULL },
   */
   { "chano",       0xFFFD,  CW, 0,      NULL, NULL, (SUBR) NULL, (SUBR) NULL },
-  { "chano.k",     S(ASSIGN),0,           2,      "",             "kk",
-    (SUBR) NULL, (SUBR) chano_opcode_perf_k, (SUBR) NULL                },
-  { "chano.a",     S(ASSIGN),0,           4,      "",             "ak",
-    (SUBR) NULL, (SUBR) NULL, (SUBR) chano_opcode_perf_a                },
+  { "chano.k",     S(CHNVAL),0,           3,      "",             "kk",
+    (SUBR) chnval_opcode_init, (SUBR) chano_opcode_perf_k, (SUBR) NULL  },
+  { "chano.a",     S(CHNVAL),0,           5,      "",             "ak",
+    (SUBR) chnval_opcode_init, (SUBR) NULL, (SUBR) chano_opcode_perf_a  },
   { "pvsout",     S(FCHAN),0,           3,      "",             "fk",
     (SUBR) pvsout_init, (SUBR) pvsout_perf, (SUBR) NULL                        },
   { "chani",      0xFFFF,  CR,      0,   NULL, NULL, (SUBR) NULL, (SUBR) NULL },
-  { "chani.k",     S(ASSIGN),0,           2,      "k",            "k",
-    (SUBR) NULL, (SUBR) chani_opcode_perf_k, (SUBR) NULL                },
-  { "chani.a",     S(ASSIGN),0,           4,      "a",            "k",
-    (SUBR) NULL, (SUBR) NULL, (SUBR) chani_opcode_perf_a                },
+  { "chani.k",     S(CHNVAL),0,           3,      "k",            "k",
+    (SUBR) chnval_opcode_init, (SUBR) chani_opcode_perf_k, (SUBR) NULL  },
+  { "chani.a",     S(CHNVAL),0,           5,      "a",            "k",
+    (SUBR) chnval_opcode_init, (SUBR) NULL, (SUBR) chani_opcode_perf_a  },
   { "pvsin",     S(FCHAN),0,           3,      "f",            "kooopo",
     (SUBR)  pvsin_init, (SUBR) pvsin_perf, (SUBR) NULL                  },
   { "sense",       S(KSENSE),0,           2,      "kz",           "",
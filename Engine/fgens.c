@@ -30,9 +30,11 @@
 #include "cwindow.h"
 #include "cmath.h"
 #include "fgens.h"
+#include "ftcache.h"
 #include "pstream.h"
 #include "pvfileio.h"
 #include <stdlib.h>
+#include <stddef.h>
 
 extern double besseli(double);
 
@@ -91,7 +93,10 @@ typedef struct namedgen {
 
 static CS_NOINLINE int  fterror(const FGDATA *, const char *, ...);
 static CS_NOINLINE void ftresdisp(const FGDATA *, FUNC *);
+static void ftdisp(const FGDATA *, FUNC *);
 static CS_NOINLINE FUNC *ftalloc(const FGDATA *);
+static void ftbl_free_bl(CSOUND *, FUNC *);
+static CS_FFT_PLAN *gen_spec_plan(CSOUND *, int32);
 
 static int GENUL(FGDATA *ff, FUNC *ftp)
 {
@@ -99,57 +104,165 @@ static int GENUL(FGDATA *ff, FUNC *ftp)
     return fterror(ff, Str("unknown GEN number"));
 }
 
-/**
- * Create ftable using evtblk data, and store pointer to new table in *ftpp.
- * If mode is zero, a zero table number is ignored, otherwise a new table
- * number is automatically assigned.
- * Returns zero on success.
- */
+/* GENs whose tables depend only on their own p-fields */
 
-int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode)
+static int gen_pure(CSOUND *csound, int genum)
+{
+    if (csound->gensub != NULL && genum <= GENMAX &&
+        csound->gensub[genum] != or_sub[genum])
+      return 0;                                 /* replaced by a plugin */
+    switch (genum) {
+    case 2: case 3: case 5: case 6: case 7: case 8: case 9: case 10:
+    case 11: case 12: case 13: case 16: case 17: case 19: case 20:
+    case 25: case 27:
+      return 1;
+    }
+    return 0;
+}
+
+/* name of the sound file read by GEN01 or GEN49 */
+
+static void gen_sfname(const FGDATA *ff, char *sfname, int size)
+{
+    CSOUND  *csound = ff->csound;
+    int32   filno = (int32) MYFLT2LRND(ff->e.p[5]);
+
+    if (ISSTRCOD(ff->e.p[5])) {
+      if (ff->e.strarg[0] == '"') {
+        int len = (int) strlen(ff->e.strarg) - 2;
+        strncpy(sfname, ff->e.strarg + 1, size - 1);
+        sfname[size - 1] = '\0';
+        if (len >= 0 && len < size && sfname[len] == '"')
+          sfname[len] = '\0';
+      }
+      else
+        strncpy(sfname, ff->e.strarg, size - 1);
+    }
+    else if (filno >= 0 && filno <= csound->strsmax &&
+             csound->strsets && csound->strsets[filno])
+      strncpy(sfname, csound->strsets[filno], size - 1);
+    else
+      snprintf(sfname, size, "soundin.%d", filno);   /* soundin.filno */
+    sfname[size - 1] = '\0';
+}
+
+/* Sound file tables, and large tables of the GENs that depend only on
+   their p-fields, are kept in the ftable cache if FTCACHEDIR is set.  */
+
+#define FTCACHE_MINLEN  4096
+
+/* Make the cache key of a table, and install the cached copy if there
+   is one.  Returns non-zero if the table was found; otherwise the key is
+   left in *key for ftcache_store() once the table has been made.  */
+
+static int ftcache_lookup(CSOUND *csound, FGDATA *ff, int genum,
+                          FTCACHE_KEY *key, FUNC **ftpp)
+{
+    char    sfname[1024], *src = NULL;
+    FUNC    hdr, *ftp;
+    MYFLT   *data;
+
+    key->key = NULL;
+    if (genum == 1 || genum == 49) {
+      if (csound->oparms->gen01defer || ff->e.pcnt < 7 ||
+          csound->gensub[genum] != or_sub[genum])
+        return 0;
+      gen_sfname(ff, sfname, 1024);
+      src = sfname;
+    }
+    else if (!gen_pure(csound, genum) ||
+             (ff->flen < 0 ? -ff->flen : ff->flen) < FTCACHE_MINLEN)
+      return 0;
+    if (ftcache_key(csound, key, ff, genum, src) != OK ||
+        (data = ftcache_find(csound, key, &hdr)) == NULL)
+      return 0;
+    ftcache_key_free(csound, key);
+    if ((ftp = csound->flist[ff->fno]) != NULL) {
+      csound->Warning(csound, Str("replacing previous ftable %d"), ff->fno);
+      ftbl_free_bl(csound, ftp);
+      if (hdr.flen == ftp->flen && !ftcache_mapped(csound, ftp->ftable)) {
+        /* keep the old space, as for a table made again */
+        memcpy(ftp->ftable, data, sizeof(MYFLT) * (hdr.flen + 1));
+        data = ftp->ftable;
+      }
+      else {
+        if (!ftcache_mapped(csound, ftp->ftable))
+          csound->Free(csound, ftp->ftable);
+        csound->Free(csound, (void*) ftp);
+        csound->flist[ff->fno] = ftp = NULL;
+        if (csound->actanchor.nxtact != NULL) {
+          csound->Warning(csound, Str("ftable %d relocating due to size change"
+                                      "\n         currently active instruments "
+                                      "may find this disturbing"), ff->fno);
+        }
+      }
+    }
+    if (ftp == NULL)
+      csound->flist[ff->fno] = ftp = (FUNC*) csound->Calloc(csound, sizeof(FUNC));
+    memcpy((void*) ftp, (void*) &hdr, offsetof(FUNC, ftable));
+    ftp->ftable = data;
+    ftp->bltables = NULL;
+    ftp->fno = (int32) ff->fno;
+    ff->flen = (int32) ftp->flen;
+    if (csound->oparms->msglevel & 7)
+      csoundMessage(csound, Str("ftable %d: %d points from cache\n"),
+                    ff->fno, (int) ftp->flen);
+    ftdisp(ff, ftp);
+    *ftpp = ftp;
+    return 1;
+}
+
+/* First part of hfgens(): parse the event and allocate the table, unless
+   its size is left to the GEN routine.  Returns the GEN number, with the
+   table in *ftpp, if the GEN routine is still to be called; zero if the
+   event has been dealt with, and -1 on errors.  */
+
+static int hfgens_setup(CSOUND *csound, FGDATA *ff, FUNC **ftpp,
+                        const EVTBLK *evtblkp, int mode, FTCACHE_KEY *key)
 {
     int32    genum, ltest;
     int     lobits, msg_enabled, i;
     FUNC    *ftp;
-    FGDATA  ff;
     int nonpowof2_flag=0; /* gab: fixed for non-powoftwo function tables*/
 
     *ftpp = NULL;
+    key->key = NULL;
     if (UNLIKELY(csound->gensub == NULL)) {
       csound->gensub = (GEN*) csound->Malloc(csound, sizeof(GEN) * (GENMAX + 1));
       memcpy(csound->gensub, or_sub, sizeof(GEN) * (GENMAX + 1));
       csound->genmax = GENMAX + 1;
     }
     msg_enabled = csound->oparms->msglevel & 7;
-    ff.csound = csound;
-    memcpy((char*) &(ff.e), (char*) evtblkp,
+    ff->csound = csound;
+    memcpy((char*) &(ff->e), (char*) evtblkp,
            (size_t) ((char*) &(evtblkp->p[2]) - (char*) evtblkp));
-    ff.fno = (int) MYFLT2LRND(ff.e.p[1]);
-    if (!ff.fno) {
+    ff->fno = (int) MYFLT2LRND(ff->e.p[1]);
+    if (!ff->fno) {
       if (!mode)
         return 0;                               /*  fno = 0: return,        */
-      ff.fno = FTAB_SEARCH_BASE;
+      ff->fno = FTAB_SEARCH_BASE;
       do {                                      /*      or automatic number */
-        ++ff.fno;
-      } while (ff.fno <= csound->maxfnum && csound->flist[ff.fno] != NULL);
-      ff.e.p[1] = (MYFLT) (ff.fno);
-    }
-    else if (ff.fno < 0) {                      /*  fno < 0: remove         */
-      ff.fno = -(ff.fno);
-      if (UNLIKELY(ff.fno > csound->maxfnum ||
-                   (ftp = csound->flist[ff.fno]) == NULL)) {
-        return fterror(&ff, Str("ftable does not exist"));
-      }
-      csound->flist[ff.fno] = NULL;
+        ++ff->fno;
+      } while (ff->fno <= csound->maxfnum && csound->flist[ff->fno] != NULL);
+      ff->e.p[1] = (MYFLT) (ff->fno);
+    }
+    else if (ff->fno < 0) {                      /*  fno < 0: remove         */
+      ff->fno = -(ff->fno);
+      if (UNLIKELY(ff->fno > csound->maxfnum ||
+                   (ftp = csound->flist[ff->fno]) == NULL)) {
+        return fterror(ff, Str("ftable does not exist"));
+      }
+      csound->flist[ff->fno] = NULL;
+      ftbl_free_bl(csound, ftp);
       csound->Free(csound, (void*) ftp);
       if (UNLIKELY(msg_enabled))
-        csoundMessage(csound, Str("ftable %d now deleted\n"), ff.fno);
+        csoundMessage(csound, Str("ftable %d now deleted\n"), ff->fno);
       return 0;
     }
-    if (UNLIKELY(ff.fno > csound->maxfnum)) {   /* extend list if necessary */
+    if (UNLIKELY(ff->fno > csound->maxfnum)) {   /* extend list if necessary */
       FUNC  **nn;
       int   size;
-      for (size = csound->maxfnum; size < ff.fno; size += MAXFNUM)
+      for (size = csound->maxfnum; size < ff->fno; size += MAXFNUM)
         ;
       nn = (FUNC**) csound->ReAlloc(csound,
                                     csound->flist, (size + 1) * sizeof(FUNC*));
@@ -158,117 +271,281 @@ int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode)
         csound->flist[i] = NULL;                /*  Clear new section       */
       csound->maxfnum = size;
     }
-    if (UNLIKELY(ff.e.pcnt <= 4)) {             /*  chk minimum arg count   */
-      return fterror(&ff, Str("insufficient gen arguments"));
+    if (UNLIKELY(ff->e.pcnt <= 4)) {             /*  chk minimum arg count   */
+      return fterror(ff, Str("insufficient gen arguments"));
     }
-    if (ff.e.pcnt>PMAX) {
+    if (ff->e.pcnt>PMAX) {
 #ifdef BETA
       csound->DebugMsg(csound, "T%d/%d(%d): x=%p memcpy from %p to %p length %d\n",
-              (int)evtblkp->p[1], (int)evtblkp->p[4], ff.e.pcnt, evtblkp->c.extra,
-              &(ff.e.p[2]), &(evtblkp->p[2]), sizeof(MYFLT) * PMAX);
+              (int)evtblkp->p[1], (int)evtblkp->p[4], ff->e.pcnt, evtblkp->c.extra,
+              &(ff->e.p[2]), &(evtblkp->p[2]), sizeof(MYFLT) * PMAX);
 #endif
-      memcpy(&(ff.e.p[2]), &(evtblkp->p[2]), sizeof(MYFLT) * (PMAX-2));
-      ff.e.c.extra = (MYFLT*)malloc(sizeof(MYFLT) * evtblkp->c.extra[0]);
-      memcpy(ff.e.c.extra, evtblkp->c.extra, sizeof(MYFLT) * evtblkp->c.extra[0]);
+      memcpy(&(ff->e.p[2]), &(evtblkp->p[2]), sizeof(MYFLT) * (PMAX-2));
+      ff->e.c.extra = (MYFLT*)malloc(sizeof(MYFLT) * evtblkp->c.extra[0]);
+      memcpy(ff->e.c.extra, evtblkp->c.extra, sizeof(MYFLT) * evtblkp->c.extra[0]);
     }
     else
-      memcpy(&(ff.e.p[2]), &(evtblkp->p[2]),
-             sizeof(MYFLT) * ((int) ff.e.pcnt - 1));
-    if (ISSTRCOD(ff.e.p[4])) {
+      memcpy(&(ff->e.p[2]), &(evtblkp->p[2]),
+             sizeof(MYFLT) * ((int) ff->e.pcnt - 1));
+    if (ISSTRCOD(ff->e.p[4])) {
       /* A named gen given so search the list of extra gens */
       NAMEDGEN *n = (NAMEDGEN*) csound->namedgen;
       while (n) {
-        if (strcmp(n->name, ff.e.strarg) == 0) {    /* Look up by name */
+        if (strcmp(n->name, ff->e.strarg) == 0) {    /* Look up by name */
           genum = n->genum;
           break;
         }
         n = n->next;                            /*  and round again         */
       }
       if (UNLIKELY(n == NULL)) {
-        return fterror(&ff, Str("Named gen \"%s\" not defined"), ff.e.strarg);
+        return fterror(ff, Str("Named gen \"%s\" not defined"), ff->e.strarg);
       }
     }
     else {
-      genum = (int32) MYFLT2LRND(ff.e.p[4]);
+      genum = (int32) MYFLT2LRND(ff->e.p[4]);
       if (genum < 0)
         genum = -genum;
       if (UNLIKELY(!genum || genum > csound->genmax)) { /*   & legal gen number x*/
-        return fterror(&ff, Str("illegal gen number"));
+        return fterror(ff, Str("illegal gen number"));
       }
     }
-    ff.flen = (int32) MYFLT2LRND(ff.e.p[3]);
-    if (!ff.flen) {
+    ff->flen = (int32) MYFLT2LRND(ff->e.p[3]);
+    if (ftcache_lookup(csound, ff, genum, key, ftpp))
+      return 0;
+    if (!ff->flen) {
       /* defer alloc to gen01|gen23|gen28 */
-      ff.guardreq = 1;
+      ff->guardreq = 1;
       if (UNLIKELY(genum != 1 && genum != 23 && genum != 28 && genum != 49)) {
-        return fterror(&ff, Str("deferred size for GENs 1, 23, 28 or 49 only"));
+        return fterror(ff, Str("deferred size for GENs 1, 23, 28 or 49 only"));
       }
       if (msg_enabled)
-        csoundMessage(csound, Str("ftable %d:\n"), ff.fno);
-      i = (*csound->gensub[genum])(&ff, NULL);
-      ftp = csound->flist[ff.fno];
+        csoundMessage(csound, Str("ftable %d:\n"), ff->fno);
+      i = (*csound->gensub[genum])(ff, NULL);
+      ftp = csound->flist[ff->fno];
       if (i != 0) {
-        csound->flist[ff.fno] = NULL;
+        ftcache_key_free(csound, key);
+        csound->flist[ff->fno] = NULL;
         csound->Free(csound, ftp);
         return -1;
       }
+      ftcache_store(csound, key, ftp);
       *ftpp = ftp;
       return 0;
     }
     /* if user flen given */
-    if (ff.flen < 0L) {                 /* gab for non-pow-of-two-length    */
-      ff.guardreq = 1;
-      ff.flen = -(ff.flen);             /* gab: fixed */
-      if (!(ff.flen & (ff.flen - 1L)) || ff.flen > MAXLEN)
+    if (ff->flen < 0L) {                 /* gab for non-pow-of-two-length    */
+      ff->guardreq = 1;
+      ff->flen = -(ff->flen);             /* gab: fixed */
+      if (!(ff->flen & (ff->flen - 1L)) || ff->flen > MAXLEN)
         goto powOfTwoLen;
       lobits = 0;                       /* Hope this is not needed! */
       nonpowof2_flag = 1; /* gab: fixed for non-powoftwo function tables*/
     }
     else {
-      ff.guardreq = ff.flen & 01;       /*  set guard request flg   */
-      ff.flen &= -2L;                   /*  flen now w/o guardpt    */
+      ff->guardreq = ff->flen & 01;       /*  set guard request flg   */
+      ff->flen &= -2L;                   /*  flen now w/o guardpt    */
  powOfTwoLen:
-      if (UNLIKELY(ff.flen <= 0L || ff.flen > MAXLEN)) {
-        return fterror(&ff, Str("illegal table length"));
+      if (UNLIKELY(ff->flen <= 0L || ff->flen > MAXLEN)) {
+        ftcache_key_free(csound, key);
+        return fterror(ff, Str("illegal table length"));
       }
-      for (ltest = ff.flen, lobits = 0;
+      for (ltest = ff->flen, lobits = 0;
            (ltest & MAXLEN) == 0L;
            lobits++, ltest <<= 1)
         ;
       if (UNLIKELY(ltest != MAXLEN)) {  /*  flen is not power-of-2 */
-        // return fterror(&ff, Str("illegal table length"));
-        //csound->Warning(csound, Str("table %d size not power of two"), ff.fno);
+        // return fterror(ff, Str("illegal table length"));
+        //csound->Warning(csound, Str("table %d size not power of two"), ff->fno);
         lobits = 0;
         nonpowof2_flag = 1;
-        ff.guardreq = 1;
+        ff->guardreq = 1;
       }
     }
-    ftp = ftalloc(&ff);                 /*  alloc ftable space now  */
-    ftp->lenmask  = ((ff.flen & (ff.flen - 1L)) ?
-                     0L : (ff.flen - 1L));      /*  init hdr w powof2 data  */
+    ftp = ftalloc(ff);                 /*  alloc ftable space now  */
+    ftp->lenmask  = ((ff->flen & (ff->flen - 1L)) ?
+                     0L : (ff->flen - 1L));      /*  init hdr w powof2 data  */
     ftp->lobits   = lobits;
     i = (1 << lobits);
     ftp->lomask   = (int32) (i - 1);
     ftp->lodiv    = FL(1.0) / (MYFLT) i;        /*    & other useful vals   */
     ftp->nchanls  = 1;                          /*    presume mono for now  */
-    ftp->flenfrms = ff.flen;
+    ftp->flenfrms = ff->flen;
     if (nonpowof2_flag)
       ftp->lenmask = 0xFFFFFFFF; /* gab: fixed for non-powoftwo function tables */
 
     if (msg_enabled)
-      csoundMessage(csound, Str("ftable %d:\n"), ff.fno);
-    if ((*csound->gensub[genum])(&ff, ftp) != 0) {
-      csound->flist[ff.fno] = NULL;
+      csoundMessage(csound, Str("ftable %d:\n"), ff->fno);
+    *ftpp = ftp;
+
+    return (int) genum;
+}
+
+/* Check the result of the GEN routine for a table made by
+   hfgens_setup(), then rescale and display the table.  */
+
+static int hfgens_finish(CSOUND *csound, FGDATA *ff, FUNC **ftpp, int err,
+                         FTCACHE_KEY *key)
+{
+    FUNC    *ftp = *ftpp;
+
+    if (err != 0) {
+      ftcache_key_free(csound, key);
+      *ftpp = NULL;
+      csound->flist[ff->fno] = NULL;
       csound->Free(csound, ftp);
       return -1;
     }
     /* VL 11.01.05 for deferred GEN01, it's called in gen01raw */
-    ftresdisp(&ff, ftp);                        /* rescale and display      */
-    *ftpp = ftp;
-
+    ftresdisp(ff, ftp);                         /* rescale and display      */
+    ftcache_store(csound, key, ftp);
     return 0;
 }
 
+/**
+ * Create ftable using evtblk data, and store pointer to new table in *ftpp.
+ * If mode is zero, a zero table number is ignored, otherwise a new table
+ * number is automatically assigned.
+ * Returns zero on success.
+ */
+
+int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode)
+{
+    FGDATA  ff;
+    FTCACHE_KEY key;
+    int     genum;
+
+    if ((genum = hfgens_setup(csound, &ff, ftpp, evtblkp, mode, &key)) <= 0)
+      return genum;
+    return hfgens_finish(csound, &ff, ftpp,
+                         (*csound->gensub[genum])(&ff, *ftpp), &key);
+}
+
+/* f-statements are set up and finished in order, and the GEN routines of
+   up to FGENS_BATCH consecutive ones are run in parallel if they make
+   different tables and their GENs only read their own p-fields.  */
+
+#define FGENS_BATCH 64
+
+typedef struct {
+    CSOUND  *csound;
+    FGDATA  *ff;
+    FUNC    **ftp;
+    int     *genum, *err;
+    int     end;
+    volatile int next;
+} FGENS_JOBS;
+
+static int fgens_parallel(CSOUND *csound, const EVTBLK *e)
+{
+    if (e->opcod != 'f' || e->p[1] < FL(1.0) || e->pcnt <= 4 ||
+        e->p[3] == FL(0.0) || ISSTRCOD(e->p[4]))
+      return 0;
+    return gen_pure(csound, abs((int) MYFLT2LRND(e->p[4])));
+}
+
+static uintptr_t fgens_thread(void *userData)
+{
+    FGENS_JOBS  *jobs = (FGENS_JOBS*) userData;
+    CSOUND      *csound = jobs->csound;
+    int         i;
+
+    for (;;) {
+#ifdef HAVE_ATOMIC_BUILTIN
+      i = __sync_fetch_and_add(&(jobs->next), 1);
+#else
+      i = jobs->next++;                         /* only one thread then */
+#endif
+      if (i >= jobs->end)
+        break;
+      if (jobs->genum[i] > 0)
+        jobs->err[i] = (*csound->gensub[jobs->genum[i]])(&(jobs->ff[i]),
+                                                         jobs->ftp[i]);
+    }
+    return (uintptr_t) 0;
+}
+
+/**
+ * Create the ftables of n events, with the same result as calling
+ * hfgens() with a mode of zero on each in turn.  If more than one
+ * thread is allowed (-j), independent tables are made in parallel.
+ * Returns the number of events that failed.
+ */
+
+int hfgens_batch(CSOUND *csound, const EVTBLK *evts, int n)
+{
+    FGENS_JOBS  jobs;
+    FTCACHE_KEY keys[FGENS_BATCH];
+    void    *threads[FGENS_BATCH];
+    FUNC    *ftp;
+    int     i, j, k, nthreads, nerr = 0;
+
+    nthreads = csound->oparms->numThreads;
+#ifndef HAVE_ATOMIC_BUILTIN
+    nthreads = 1;
+#endif
+    if (nthreads > FGENS_BATCH)
+      nthreads = FGENS_BATCH;
+    memset(&jobs, 0, sizeof(FGENS_JOBS));
+    jobs.csound = csound;
+    if (nthreads > 1 && n > 1) {
+      jobs.ff = (FGDATA*) malloc(sizeof(FGDATA) * FGENS_BATCH);
+      jobs.ftp = (FUNC**) malloc(sizeof(FUNC*) * FGENS_BATCH);
+      jobs.genum = (int*) malloc(sizeof(int) * FGENS_BATCH * 2);
+      jobs.err = jobs.genum + FGENS_BATCH;
+    }
+    for (i = 0; i < n; i = j) {
+      /* find a run of independent events */
+      for (j = i; jobs.ff != NULL && j < n && j - i < FGENS_BATCH; j++) {
+        if (!fgens_parallel(csound, &evts[j]))
+          break;
+        for (k = i; k < j; k++)
+          if (MYFLT2LRND(evts[k].p[1]) == MYFLT2LRND(evts[j].p[1]))
+            break;
+        if (k < j)
+          break;
+      }
+      if (j - i < 2) {
+        j = i + 1;
+        if (hfgens(csound, &ftp, &evts[i], 0) != 0)
+          nerr++;
+        continue;
+      }
+      for (k = i; k < j; k++) {
+        jobs.genum[k - i] = hfgens_setup(csound, &jobs.ff[k - i],
+                                         &jobs.ftp[k - i], &evts[k], 0,
+                                         &keys[k - i]);
+        jobs.err[k - i] = 0;
+        /* FFT plans cannot be made by the worker threads */
+        if (jobs.genum[k - i] == 9 || jobs.genum[k - i] == 10 ||
+            jobs.genum[k - i] == 19)
+          gen_spec_plan(csound, jobs.ff[k - i].flen);
+      }
+      jobs.end = j - i;
+      jobs.next = 0;
+      for (k = 0; k < nthreads - 1 && k < jobs.end - 1; k++)
+        threads[k] = csound->CreateThread(fgens_thread, (void*) &jobs);
+      fgens_thread((void*) &jobs);
+      while (k--) {
+        if (threads[k] != NULL)
+          csound->JoinThread(threads[k]);
+      }
+      for (k = 0; k < jobs.end; k++) {
+        if (jobs.genum[k] < 0)
+          nerr++;
+        else if (jobs.genum[k] > 0 &&
+                 hfgens_finish(csound, &jobs.ff[k], &jobs.ftp[k],
+                               jobs.err[k], &keys[k]) != 0)
+          nerr++;
+      }
+    }
+    if (jobs.ff != NULL) {
+      free(jobs.ff);
+      free(jobs.ftp);
+      free(jobs.genum);
+    }
+    return nerr;
+}
+
 /**
  * Allocates space for 'tableNum' with a length (not including the guard
  * point) of 'len' samples. The table data is not cleared to zero.
@@ -299,6 +576,7 @@ int csoundFTAlloc(CSOUND *csound, int tableNum, int len)
       csound->flist[tableNum] = (FUNC*) csound->Malloc(csound, sizeof(FUNC));
       csound->flist[tableNum]->ftable =
         (MYFLT*)csound->Malloc(csound, sizeof(MYFLT)*(len+1));
+      csound->flist[tableNum]->bltables = NULL;
     }
     else if (len != (int) ftp->flen) {
       if (csound->actanchor.nxtact != NULL) { /*   & chk for danger    */
@@ -308,9 +586,13 @@ int csoundFTAlloc(CSOUND *csound, int tableNum, int len)
                                         "may find this disturbing"), tableNum);
       }
       csound->flist[tableNum] = NULL;
+      ftbl_free_bl(csound, ftp);
       csound->Free(csound, ftp);
       csound->flist[tableNum] = (FUNC*) csound->Malloc(csound, (size_t) size);
+      csound->flist[tableNum]->bltables = NULL;
     }
+    else
+      ftbl_free_bl(csound, ftp);            /* contents will change */
     /* initialise table header */
     ftp = csound->flist[tableNum];
     //memset((void*) ftp, 0, (size_t) ((char*) &(ftp->ftable) - (char*) ftp));
@@ -346,11 +628,103 @@ int csoundFTDelete(CSOUND *csound, int tableNum)
     if (UNLIKELY(ftp == NULL))
       return -1;
     csound->flist[tableNum] = NULL;
+    ftbl_free_bl(csound, ftp);
     csound->Free(csound, ftp);
 
     return 0;
 }
 
+/* Band-limited copies of power of two tables for oscillators.  Copy k
+   (bl[k - 1]) keeps the harmonics up to flen >> (k + 1), so it does not
+   alias when read with an increment of up to 2^k table samples per output
+   sample.  The copies are made from a single FFT of the table: the upper
+   bins are cleared for each one in turn and transformed back.  All of
+   them are in one allocation, so that they can be freed along with the
+   table.                                                                */
+
+#define FTBL_BL_MAXLEN  65536
+
+static void ftbl_free_bl(CSOUND *csound, FUNC *ftp)
+{
+    if (ftp->bltables != NULL) {
+      csound->Free(csound, ftp->bltables);
+      ftp->bltables = NULL;
+    }
+}
+
+static MYFLT **ftbl_make_bl(CSOUND *csound, FUNC *ftp)
+{
+    CS_FFT_PLAN *fwd, *inv;
+    MYFLT   **bl, *spec, *x, scl;
+    int32   flen = (int32) ftp->flen, nlevels, i, k, h;
+
+    if (flen < 4 || (flen & (flen - 1)) || flen > FTBL_BL_MAXLEN ||
+        ftp->nchanls != 1)
+      return NULL;
+    fwd = csound->CreateFFTPlan(csound, flen, 0);
+    inv = csound->CreateFFTPlan(csound, flen, CS_FFT_INVERSE);
+    if (UNLIKELY(fwd == NULL || inv == NULL))
+      return NULL;
+    for (nlevels = 0; (flen >> (nlevels + 1)) > 1; nlevels++)
+      ;
+    /* nlevels copies, a NULL terminator, and the spectrum */
+    bl = (MYFLT**) csound->Malloc(csound, (nlevels + 1) * sizeof(MYFLT*) +
+                                  (size_t) (nlevels + 1) * (flen + 1) *
+                                  sizeof(MYFLT));
+    x = (MYFLT*) (bl + (nlevels + 1));
+    spec = x + (size_t) nlevels * (flen + 1);
+    memcpy(spec, ftp->ftable, flen * sizeof(MYFLT));
+    csound->ExecuteFFTPlan(csound, fwd, spec);
+    scl = csound->GetInverseRealFFTScale(csound, flen);
+    spec[1] = FL(0.0);                          /* Nyquist              */
+    for (k = 0; k < nlevels; k++, x += (flen + 1)) {
+      bl[k] = x;
+      h = flen >> (k + 2);                      /* highest harmonic     */
+      for (i = (h + 1) << 1; i < flen; i++)
+        spec[i] = FL(0.0);
+      memcpy(x, spec, flen * sizeof(MYFLT));
+      csound->ExecuteFFTPlan(csound, inv, x);
+      for (i = 0; i < flen; i++)
+        x[i] *= scl;
+      x[flen] = x[0];                           /* guard point          */
+    }
+    bl[nlevels] = NULL;
+    return bl;
+}
+
+/**
+ * Returns the copy of a power of two size table that is band-limited for
+ * reading with a phase increment of 'inc' table samples per output sample,
+ * making the copies on first use.  Copies are made from the table contents
+ * at that time.  Returns ftp->ftable if no copies can be made.
+ */
+
+MYFLT *csoundGetBandLimitedTable(CSOUND *csound, FUNC *ftp, MYFLT inc)
+{
+    MYFLT   **bl = ftp->bltables, x;
+
+    if (UNLIKELY(bl == NULL)) {
+      if ((bl = ftbl_make_bl(csound, ftp)) == NULL)
+        return ftp->ftable;
+#ifdef HAVE_ATOMIC_BUILTIN
+      /* another thread may have made them first */
+      if (!__sync_bool_compare_and_swap(&(ftp->bltables), NULL, bl)) {
+        csound->Free(csound, bl);
+        bl = ftp->bltables;
+      }
+#else
+      ftp->bltables = bl;
+#endif
+    }
+    if (inc < FL(0.0))
+      inc = -inc;
+    if (inc <= FL(1.0))
+      return ftp->ftable;
+    for (x = FL(2.0); x < inc && bl[1] != NULL; x += x)
+      bl++;
+    return bl[0];
+}
+
 /* read ftable values directly from p-args */
 
 static int gen02(FGDATA *ff, FUNC *ftp)
@@ -712,23 +1086,83 @@ static int gen08(FGDATA *ff, FUNC *ftp)
     return OK;
 }
 
+/* GEN09, GEN10 and GEN19 sum the partials with integral partial numbers
+   by inverse FFT instead of point by point.  Partial h with amplitude amp
+   and phase phs (radians) adds (flen / 2) * amp * (sin(phs) - i cos(phs))
+   to bin h of a spectrum in the format of csoundRealFFT(); negative and
+   aliased partial numbers are folded as the direct sum would fold them.
+   Partials that are not integral are still summed directly.             */
+
+static CS_FFT_PLAN *gen_spec_plan(CSOUND *csound, int32 flen)
+{
+    if (flen < 2 || (flen & 1))
+      return NULL;
+    return csound->CreateFFTPlan(csound, (int) flen, CS_FFT_INVERSE);
+}
+
+/* add a partial to the spectrum x; returns zero if that cannot be done */
+
+static int gen_spec_add(MYFLT *x, int32 flen, double hno,
+                        double amp, double phs)
+{
+    int32   h;
+    double  a;
+
+    if (x == NULL || hno != floor(hno))
+      return 0;
+    h = (int32) fmod(hno, (double) flen);
+    if (h < 0)
+      h += flen;
+    if (h > (flen >> 1)) {                      /* negative frequency */
+      h = flen - h;
+      phs = PI - phs;
+    }
+    if (h == 0 || h == (flen >> 1))             /* DC or Nyquist      */
+      x[h ? 1 : 0] += (MYFLT) ((double) flen * amp * sin(phs));
+    else {
+      a = 0.5 * (double) flen * amp;
+      x[h << 1] += (MYFLT) (a * sin(phs));
+      x[(h << 1) + 1] -= (MYFLT) (a * cos(phs));
+    }
+    return 1;
+}
+
+/* transform the spectrum, mix it to the table with its guard point,
+   and free it */
+
+static void gen_spec_mix(CSOUND *csound, CS_FFT_PLAN *plan, MYFLT *x,
+                         FUNC *ftp, int32 flen)
+{
+    MYFLT   *ft = ftp->ftable;
+    int32   i;
+
+    csound->ExecuteFFTPlan(csound, plan, x);
+    for (i = 0; i < flen; i++)
+      ft[i] += x[i];
+    ft[flen] += x[0];
+    free(x);
+}
+
 static int gen09(FGDATA *ff, FUNC *ftp)
 {
     int     hcnt;
-    MYFLT   *valp, *fp, *finp;
-    double  phs, inc, amp;
+    MYFLT   *valp, *fp, *finp, *x = NULL;
+    double  phs, hno, amp;
     double  tpdlen = TWOPI / (double) ff->flen;
     CSOUND  *csound = ff->csound;
+    CS_FFT_PLAN *plan;
     int nsw = 1;
 
     if (ff->e.pcnt>=PMAX)
       csound->Warning(csound, Str("using extended arguments\n"));
     if ((hcnt = (ff->e.pcnt - 4) / 3) <= 0)         /* hcnt = nargs / 3 */
       return OK;
+    if ((plan = gen_spec_plan(csound, ff->flen)) != NULL)
+      x = (MYFLT*) calloc(ff->flen, sizeof(MYFLT));
     valp = &ff->e.p[5];
     finp = &ftp->ftable[ff->flen];
     do {
-      inc = *(valp++) * tpdlen;
+      hno = *(valp++);
       if (UNLIKELY(nsw && valp>&ff->e.p[PMAX])) {
 #ifdef BETA
         csound->DebugMsg(csound, "Switch to extra args\n");
@@ -752,12 +1186,17 @@ static int gen09(FGDATA *ff, FUNC *ftp)
         nsw = 0;                /* only switch once */
         valp = &(ff->e.c.extra[1]);
       }
-      for (fp = ftp->ftable; fp <= finp; fp++) {
-        *fp += (MYFLT) (sin(phs) * amp);
-        if ((phs += inc) >= TWOPI)
-          phs -= TWOPI;
+      if (!gen_spec_add(x, ff->flen, hno, amp, phs)) {
+        double  inc = hno * tpdlen;
+        for (fp = ftp->ftable; fp <= finp; fp++) {
+          *fp += (MYFLT) (sin(phs) * amp);
+          if ((phs += inc) >= TWOPI)
+            phs -= TWOPI;
+        }
       }
     } while (--hcnt);
+    if (x != NULL)
+      gen_spec_mix(csound, plan, x, ftp, ff->flen);
 
     return OK;
 }
@@ -765,25 +1204,32 @@ static int gen09(FGDATA *ff, FUNC *ftp)
 static int gen10(FGDATA *ff, FUNC *ftp)
 {
     int32   phs, hcnt;
-    MYFLT   amp, *fp, *finp;
+    MYFLT   amp, *fp, *finp, *x = NULL;
     int32   flen = ff->flen;
     double  tpdlen = TWOPI / (double) flen;
     CSOUND  *csound = ff->csound;
+    CS_FFT_PLAN *plan;
 
     if (ff->e.pcnt>=PMAX)
       csound->Warning(csound, Str("using extended arguments\n"));
     hcnt = ff->e.pcnt - 4;                              /* hcnt is nargs    */
+    if ((plan = gen_spec_plan(csound, flen)) != NULL)
+      x = (MYFLT*) calloc(flen, sizeof(MYFLT));
     finp = &ftp->ftable[flen];
     do {
       MYFLT *valp = (hcnt+4>=PMAX ? &ff->e.c.extra[hcnt+5-PMAX] :
                                     &ff->e.p[hcnt + 4]);
-      if ((amp = *valp) != FL(0.0))         /* for non-0 amps,  */
+      if ((amp = *valp) == FL(0.0))         /* for non-0 amps,  */
+        continue;
+      if (!gen_spec_add(x, flen, (double) hcnt, (double) amp, 0.0))
         for (phs = 0, fp = ftp->ftable; fp <= finp; fp++) {
           *fp += (MYFLT) sin(phs * tpdlen) * amp;         /* accum sin pts    */
           phs += hcnt;                                    /* phsinc is hno    */
           phs %= flen;
         }
     } while (--hcnt);
+    if (x != NULL)
+      gen_spec_mix(csound, plan, x, ftp, flen);
 
     return OK;
 }
@@ -1001,7 +1447,8 @@ static int gen15(FGDATA *ff, FUNC *ftp)
     lp13 = (void*) ftp;
     ff->fno++;                                  /* alloc eq. space for fno+1 */
     ftp = ftalloc(ff);                          /* & copy header */
-    memcpy((void*) ftp, lp13, (size_t) sizeof(FUNC)-sizeof(MYFLT*));
+    memcpy((void*) ftp, lp13,
+           (size_t) sizeof(FUNC)-sizeof(MYFLT*)-sizeof(MYFLT**));
     ftp->fno = (int32) ff->fno;
     fp    = &ff->e.p[5];
     nsw = 1;
@@ -1159,20 +1606,23 @@ static int gen18(FGDATA *ff, FUNC *ftp)
 static int gen19(FGDATA *ff, FUNC *ftp)
 {
     int     hcnt;
-    MYFLT   *valp, *fp, *finp;
-    double  phs, inc, amp, dc, tpdlen = TWOPI / (double) ff->flen;
+    MYFLT   *valp, *fp, *finp, *x = NULL;
+    double  phs, hno, amp, dc, tpdlen = TWOPI / (double) ff->flen;
     int     nargs = ff->e.pcnt - 4;
     CSOUND  *csound = ff->csound;
+    CS_FFT_PLAN *plan;
     int nsw = 1;
 
     if (ff->e.pcnt>=PMAX)
       csound->Warning(csound, Str("using extended arguments\n"));
     if ((hcnt = nargs / 4) <= 0)                /* hcnt = nargs / 4 */
       return OK;
+    if ((plan = gen_spec_plan(csound, ff->flen)) != NULL)
+      x = (MYFLT*) calloc(ff->flen, sizeof(MYFLT));
     valp = &ff->e.p[5];
     finp = &ftp->ftable[ff->flen];
     do {
-      inc = *(valp++) * tpdlen;
+      hno = *(valp++);
       if (UNLIKELY(nsw && valp>=&ff->e.p[PMAX-1]))
         nsw =0, valp = &(ff->e.c.extra[1]);
       amp = *(valp++);
@@ -1184,12 +1634,19 @@ static int gen19(FGDATA *ff, FUNC *ftp)
       dc = *(valp++);
       if (UNLIKELY(nsw && valp>=&ff->e.p[PMAX-1]))
         nsw =0, valp = &(ff->e.c.extra[1]);
-      for (fp = ftp->ftable; fp <= finp; fp++) {
-        *fp += (MYFLT) (sin(phs) * amp + dc);   /* dc after str scale */
-        if ((phs += inc) >= TWOPI)
-          phs -= TWOPI;
+      if (gen_spec_add(x, ff->flen, hno, amp, phs))
+        x[0] += (MYFLT) ((double) ff->flen * dc);
+      else {
+        double  inc = hno * tpdlen;
+        for (fp = ftp->ftable; fp <= finp; fp++) {
+          *fp += (MYFLT) (sin(phs) * amp + dc); /* dc after str scale */
+          if ((phs += inc) >= TWOPI)
+            phs -= TWOPI;
+        }
       }
     } while (--hcnt);
+    if (x != NULL)
+      gen_spec_mix(csound, plan, x, ftp, ff->flen);
 
     return OK;
 }
@@ -2221,11 +2678,8 @@ static CS_NOINLINE int fterror(const FGDATA *ff, const char *s, ...)
 
 static CS_NOINLINE void ftresdisp(const FGDATA *ff, FUNC *ftp)
 {
-    CSOUND  *csound = ff->csound;
     MYFLT   *fp, *finp = &ftp->ftable[ff->flen];
     MYFLT   abs, maxval;
-    WINDAT  dwindow;
-    char    strmsg[64];
 
     if (!ff->guardreq)                      /* if no guardpt yet, do it */
       ftp->ftable[ff->flen] = ftp->ftable[0];
@@ -2240,6 +2694,15 @@ static CS_NOINLINE void ftresdisp(const FGDATA *ff, FUNC *ftp)
         for (fp=ftp->ftable; fp<=finp; fp++)
           *fp /= maxval;
     }
+    ftdisp(ff, ftp);
+}
+
+static void ftdisp(const FGDATA *ff, FUNC *ftp)
+{
+    CSOUND  *csound = ff->csound;
+    WINDAT  dwindow;
+    char    strmsg[64];
+
     if (!csound->oparms->displays)
       return;
     memset(&dwindow, 0, sizeof(WINDAT));
@@ -2287,8 +2750,10 @@ static CS_NOINLINE FUNC *ftalloc(const FGDATA *ff)
 
     if (UNLIKELY(ftp != NULL)) {
       csound->Warning(csound, Str("replacing previous ftable %d"), ff->fno);
+      ftbl_free_bl(csound, ftp);
       if (ff->flen != (int32)ftp->flen) {       /* if redraw & diff len, */
-        csound->Free(csound, ftp->ftable);
+        if (!ftcache_mapped(csound, ftp->ftable))
+          csound->Free(csound, ftp->ftable);
         csound->Free(csound, (void*) ftp);             /*   release old space   */
         csound->flist[ff->fno] = ftp = NULL;
         if (csound->actanchor.nxtact != NULL) { /*   & chk for danger    */
@@ -2556,23 +3021,8 @@ static int gen01raw(FGDATA *ff, FUNC *ftp)
     p = &tmpspace;
     memset(p, 0, sizeof(SOUNDIN));
     {
-      int32 filno = (int32) MYFLT2LRND(ff->e.p[5]);
       int   fmt = (int) MYFLT2LRND(ff->e.p[7]);
-      if (ISSTRCOD(ff->e.p[5])) {
-        if (ff->e.strarg[0] == '"') {
-          int len = (int) strlen(ff->e.strarg) - 2;
-          strncpy(p->sfname, ff->e.strarg + 1, 512);
-          if (len >= 0 && p->sfname[len] == '"')
-            p->sfname[len] = '\0';
-        }
-        else
-          strncpy(p->sfname, ff->e.strarg, 512);
-      }
-      else if (filno >= 0 && filno <= csound->strsmax &&
-               csound->strsets && csound->strsets[filno])
-        strncpy(p->sfname, csound->strsets[filno], 512);
-      else
-        snprintf(p->sfname, 512, "soundin.%d", filno);   /* soundin.filno */
+      gen_sfname(ff, p->sfname, (int) sizeof(p->sfname));
       if (!fmt)
         p->format = csound->oparms->outformat;
       else {
@@ -2817,25 +3267,7 @@ static int gen49raw(FGDATA *ff, FUNC *ftp)
       return fterror(ff, Str("insufficient arguments"));
     }
     /* memset(&mpainfo, 0, sizeof(mpadec_info_t)); */ /* Is this necessary? */
-    {
-      int32 filno = (int32) MYFLT2LRND(ff->e.p[5]);
-      if (ISSTRCOD(ff->e.p[5])) {
-        if (ff->e.strarg[0] == '"') {
-          int len = (int) strlen(ff->e.strarg) - 2;
-          strncpy(sfname, ff->e.strarg + 1, 1023);
-          if (len >= 0 && sfname[len] == '"')
-            sfname[len] = '\0';
-        }
-        else
-          strncpy(sfname, ff->e.strarg, 1023);
-      }
-      else if ((filno= (int32) MYFLT2LRND(ff->e.p[5])) >= 0 &&
-               filno <= csound->strsmax &&
-               csound->strsets && csound->strsets[filno])
-        strncpy(sfname, csound->strsets[filno], 1023);
-      else
-        snprintf(sfname, 1024, "soundin.%d", filno);   /* soundin.filno */
-    }
+    gen_sfname(ff, sfname, 1024);
     chan  = (int) MYFLT2LRND(ff->e.p[7]);
     if (UNLIKELY(chan < 0)) {
       return fterror(ff, Str("channel %d illegal"), (int) chan);
@@ -3313,9 +3745,17 @@ int resize_table(CSOUND *csound, RESIZE *p)
     }
     if ((ftp = csound->FTFind(csound, p->fn)) == NULL)
       return NOTOK;
-    if (ftp->flen<fsize)
-      ftp->ftable = (MYFLT *) csound->ReAlloc(csound, ftp->ftable,
-                                              sizeof(MYFLT)*(fsize+1));
+    ftbl_free_bl(csound, ftp);
+    if (ftp->flen<fsize) {
+      if (ftcache_mapped(csound, ftp->ftable)) {  /* not ours to ReAlloc */
+        MYFLT *tab = (MYFLT *) csound->Calloc(csound, sizeof(MYFLT)*(fsize+1));
+        memcpy(tab, ftp->ftable, sizeof(MYFLT)*(ftp->flen+1));
+        ftp->ftable = tab;
+      }
+      else
+        ftp->ftable = (MYFLT *) csound->ReAlloc(csound, ftp->ftable,
+                                                sizeof(MYFLT)*(fsize+1));
+    }
     ftp->flen = fsize+1;
     csound->flist[fno] = ftp;
     return OK;
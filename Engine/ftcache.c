@@ -0,0 +1,397 @@
+/*
+    ftcache.c:
+
+    Copyright (C) 2026 The Csound developers
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+#include "csoundCore.h"                         /*      FTCACHE.C       */
+#include "ftcache.h"
+
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_UNISTD_H)
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stddef.h>
+
+/* A cache file is an FTCACHE_HDR, the key, the FUNC header (the fields
+   before ftable) and, at offset dataoff, the flen + 1 table values.  */
+
+#define FTCACHE_VERSION 1
+#define FTCACHE_ALIGN   64
+
+typedef struct {
+    char      magic[8];
+    uint32_t  endian;
+    uint32_t  myflt;            /* sizeof(MYFLT) */
+    uint32_t  hdrsize;          /* offsetof(FUNC, ftable) */
+    uint32_t  keylen;
+    uint64_t  flen;
+    uint64_t  dataoff;
+} FTCACHE_HDR;
+
+static const char ftcache_magic[8] = { 'C', 'S', 'F', 'T', 'C', 0, 0,
+                                       FTCACHE_VERSION };
+
+typedef struct ftcache_map_s {
+    void      *base;
+    size_t    size;
+    MYFLT     *data;
+    struct ftcache_map_s *nxt;
+} FTCACHE_MAP;
+
+typedef struct {
+    FTCACHE_MAP *maps;
+} FTCACHE;
+
+#define FNV_OFFSET  UINT64_C(0xcbf29ce484222325)
+#define FNV_PRIME   UINT64_C(0x100000001b3)
+
+static uint64_t fnv1a(uint64_t h, const void *p, size_t n)
+{
+    const unsigned char *s = (const unsigned char*) p;
+
+    while (n--) {
+      h ^= (uint64_t) *s++;
+      h *= FNV_PRIME;
+    }
+    return h;
+}
+
+/* hash of the contents of a file, a word at a time */
+
+static int ftcache_hash_file(const char *path, uint64_t *hash, int64_t *size)
+{
+    FILE      *f;
+    uint64_t  buf[8192], h = FNV_OFFSET;
+    int64_t   total = 0;
+    size_t    n, i;
+
+    if ((f = fopen(path, "rb")) == NULL)
+      return NOTOK;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+      for (i = 0; i < n / sizeof(uint64_t); i++) {
+        h ^= buf[i];
+        h *= FNV_PRIME;
+        h ^= h >> 32;
+      }
+      h = fnv1a(h, (char*) buf + i * sizeof(uint64_t), n % sizeof(uint64_t));
+      total += (int64_t) n;
+    }
+    i = ferror(f);
+    fclose(f);
+    if (i)
+      return NOTOK;
+    *hash = h;
+    *size = total;
+    return OK;
+}
+
+static void ftcache_put(CSOUND *csound, FTCACHE_KEY *key, int32 *size,
+                        const void *p, size_t n)
+{
+    if (key->len + (int32) n > *size) {
+      while (key->len + (int32) n > *size)
+        *size *= 2;
+      key->key = (unsigned char*) csound->ReAlloc(csound, key->key, *size);
+    }
+    memcpy(key->key + key->len, p, n);
+    key->len += (int32) n;
+}
+
+static char *ftcache_path(CSOUND *csound, const FTCACHE_KEY *key,
+                          const char *suffix)
+{
+    const char  *dir = csoundGetEnv(csound, "FTCACHEDIR");
+    char        *path;
+    size_t      n;
+
+    if (dir == NULL || dir[0] == '\0')
+      return NULL;
+    n = strlen(dir) + strlen(suffix) + 32;
+    path = (char*) csound->Malloc(csound, n);
+    snprintf(path, n, "%s%c%016llx%s", dir, DIRSEP,
+             (unsigned long long) key->hash, suffix);
+    return path;
+}
+
+int ftcache_key(CSOUND *csound, FTCACHE_KEY *key, const FGDATA *ff,
+                int genum, const char *srcname)
+{
+    const char  *dir = csoundGetEnv(csound, "FTCACHEDIR");
+    int32       size = 256, i, n;
+    uint32_t    u;
+    int32       i32;
+    int64_t     srcsize;
+    uint64_t    srchash;
+    const char  *s;
+
+    key->key = NULL;
+    key->len = 0;
+    if (dir == NULL || dir[0] == '\0')
+      return NOTOK;
+    if (srcname != NULL) {
+      char  *path = csound->FindInputFile(csound, srcname, "SFDIR;SSDIR");
+      if (path == NULL)
+        return NOTOK;
+      i = ftcache_hash_file(path, &srchash, &srcsize);
+      csound->Free(csound, path);
+      if (i != OK)
+        return NOTOK;
+    }
+    key->key = (unsigned char*) csound->Malloc(csound, size);
+    u = FTCACHE_VERSION;
+    ftcache_put(csound, key, &size, &u, sizeof(uint32_t));
+    u = (uint32_t) sizeof(MYFLT);
+    ftcache_put(csound, key, &size, &u, sizeof(uint32_t));
+    ftcache_put(csound, key, &size, &csound->esr, sizeof(MYFLT));
+    ftcache_put(csound, key, &size, &csound->e0dbfs, sizeof(MYFLT));
+    i32 = (int32) genum;
+    ftcache_put(csound, key, &size, &i32, sizeof(int32));
+    i32 = (int32) ff->e.pcnt;
+    ftcache_put(csound, key, &size, &i32, sizeof(int32));
+    /* p1 and p2 do not change the contents of the table */
+    n = (ff->e.pcnt < PMAX ? ff->e.pcnt : PMAX - 1);
+    if (n >= 3)
+      ftcache_put(csound, key, &size, &(ff->e.p[3]), sizeof(MYFLT) * (n - 2));
+    if (ff->e.pcnt > PMAX && ff->e.c.extra != NULL)
+      ftcache_put(csound, key, &size, ff->e.c.extra,
+                  sizeof(MYFLT) * (size_t) ff->e.c.extra[0]);
+    for (i = 0, s = ff->e.strarg; s != NULL && i < ff->e.scnt; i++) {
+      n = (int32) strlen(s) + 1;
+      ftcache_put(csound, key, &size, s, (size_t) n);
+      s += n;
+    }
+    if (srcname != NULL) {
+      /* GEN01 reads headerless files in the output format */
+      i32 = (int32) csound->oparms->outformat;
+      ftcache_put(csound, key, &size, &i32, sizeof(int32));
+      ftcache_put(csound, key, &size, &srcsize, sizeof(int64_t));
+      ftcache_put(csound, key, &size, &srchash, sizeof(uint64_t));
+    }
+    key->hash = fnv1a(FNV_OFFSET, key->key, (size_t) key->len);
+    return OK;
+}
+
+void ftcache_key_free(CSOUND *csound, FTCACHE_KEY *key)
+{
+    if (key->key != NULL)
+      csound->Free(csound, key->key);
+    key->key = NULL;
+    key->len = 0;
+}
+
+static int ftcache_reset(CSOUND *csound, void *userData)
+{
+    FTCACHE     *p;
+    FTCACHE_MAP *m;
+
+    (void) userData;
+    if ((p = (FTCACHE*) csound->QueryGlobalVariable(csound,
+                                                    "::ftcache")) == NULL)
+      return OK;
+    while ((m = p->maps) != NULL) {
+      p->maps = m->nxt;
+      munmap(m->base, m->size);
+      free(m);
+    }
+    return OK;
+}
+
+static FTCACHE *ftcache_state(CSOUND *csound)
+{
+    FTCACHE *p;
+
+    if ((p = (FTCACHE*) csound->QueryGlobalVariable(csound,
+                                                    "::ftcache")) == NULL) {
+      if (csound->CreateGlobalVariable(csound, "::ftcache",
+                                       sizeof(FTCACHE)) != 0)
+        return NULL;
+      p = (FTCACHE*) csound->QueryGlobalVariable(csound, "::ftcache");
+      p->maps = NULL;
+      csound->RegisterResetCallback(csound, NULL, ftcache_reset);
+    }
+    return p;
+}
+
+MYFLT *ftcache_find(CSOUND *csound, const FTCACHE_KEY *key, FUNC *hdr)
+{
+    FTCACHE     *p;
+    FTCACHE_MAP *m;
+    FTCACHE_HDR fh;
+    struct stat st;
+    char        *path, *base;
+    int         fd;
+
+    if (key->key == NULL || (path = ftcache_path(csound, key, ".ftc")) == NULL)
+      return NULL;
+    fd = open(path, O_RDONLY);
+    csound->Free(csound, path);
+    if (fd < 0)
+      return NULL;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(FTCACHE_HDR)) {
+      close(fd);
+      return NULL;
+    }
+    /* writable but private: a table changed by tablew gets its own pages */
+    base = (char*) mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == (char*) MAP_FAILED)
+      return NULL;
+    memcpy(&fh, base, sizeof(FTCACHE_HDR));
+    if (memcmp(fh.magic, ftcache_magic, 8) != 0 || fh.endian != 0x01020304 ||
+        fh.myflt != sizeof(MYFLT) || fh.hdrsize != offsetof(FUNC, ftable) ||
+        fh.keylen != (uint32_t) key->len || fh.flen < 1 ||
+        fh.flen > (uint64_t) MAXLEN + 1 || fh.dataoff % FTCACHE_ALIGN ||
+        fh.dataoff < sizeof(FTCACHE_HDR) + fh.keylen + fh.hdrsize ||
+        fh.dataoff + fh.flen * sizeof(MYFLT) > (uint64_t) st.st_size ||
+        memcmp(base + sizeof(FTCACHE_HDR), key->key, (size_t) key->len) != 0 ||
+        (p = ftcache_state(csound)) == NULL ||
+        (m = (FTCACHE_MAP*) malloc(sizeof(FTCACHE_MAP))) == NULL) {
+      munmap(base, (size_t) st.st_size);
+      return NULL;
+    }
+    memcpy(hdr, base + sizeof(FTCACHE_HDR) + fh.keylen, fh.hdrsize);
+    if ((uint64_t) hdr->flen + 1 != fh.flen) {
+      free(m);
+      munmap(base, (size_t) st.st_size);
+      return NULL;
+    }
+    m->base = base;
+    m->size = (size_t) st.st_size;
+    m->data = (MYFLT*) (base + fh.dataoff);
+    m->nxt = p->maps;
+    p->maps = m;
+    return m->data;
+}
+
+void ftcache_store(CSOUND *csound, FTCACHE_KEY *key, const FUNC *ftp)
+{
+    FTCACHE_HDR fh;
+    char        pad[FTCACHE_ALIGN], *path = NULL, *tmp = NULL;
+    FILE        *f = NULL;
+    size_t      n;
+    int         fd, err;
+
+    if (key->key == NULL || ftp == NULL || ftp->ftable == NULL ||
+        (path = ftcache_path(csound, key, ".ftc")) == NULL)
+      goto done;
+    /* write to a file of our own, then rename it into place, so that
+       other processes never see a partly written table; mkstemp() makes
+       the name unique across processes, instances and threads */
+    if ((tmp = ftcache_path(csound, key, ".tmp.XXXXXX")) == NULL)
+      goto done;
+    if ((fd = mkstemp(tmp)) < 0) {
+      csound->Warning(csound, Str("ftable %d: cannot write cache file %s"),
+                      (int) ftp->fno, tmp);
+      goto done;
+    }
+    fchmod(fd, 0644);                   /* mkstemp() leaves it private */
+    if ((f = fdopen(fd, "wb")) == NULL) {
+      csound->Warning(csound, Str("ftable %d: cannot write cache file %s"),
+                      (int) ftp->fno, tmp);
+      close(fd);
+      remove(tmp);
+      goto done;
+    }
+    memset(&fh, 0, sizeof(FTCACHE_HDR));
+    memset(pad, 0, FTCACHE_ALIGN);
+    memcpy(fh.magic, ftcache_magic, 8);
+    fh.endian = 0x01020304;
+    fh.myflt = (uint32_t) sizeof(MYFLT);
+    fh.hdrsize = (uint32_t) offsetof(FUNC, ftable);
+    fh.keylen = (uint32_t) key->len;
+    fh.flen = (uint64_t) ftp->flen + 1;
+    n = sizeof(FTCACHE_HDR) + fh.keylen + fh.hdrsize;
+    fh.dataoff = (uint64_t) ((n + FTCACHE_ALIGN - 1) & ~(FTCACHE_ALIGN - 1));
+    err = (fwrite(&fh, sizeof(FTCACHE_HDR), 1, f) != 1 ||
+           fwrite(key->key, 1, fh.keylen, f) != fh.keylen ||
+           fwrite(ftp, 1, fh.hdrsize, f) != fh.hdrsize ||
+           fwrite(pad, 1, (size_t) fh.dataoff - n, f) != (size_t) fh.dataoff - n ||
+           fwrite(ftp->ftable, sizeof(MYFLT), (size_t) fh.flen, f)
+             != (size_t) fh.flen);
+    err |= fclose(f);
+    if (err || rename(tmp, path) != 0) {
+      csound->Warning(csound, Str("ftable %d: cannot write cache file %s"),
+                      (int) ftp->fno, tmp);
+      remove(tmp);
+    }
+ done:
+    if (tmp != NULL)
+      csound->Free(csound, tmp);
+    if (path != NULL)
+      csound->Free(csound, path);
+    ftcache_key_free(csound, key);
+}
+
+int ftcache_mapped(CSOUND *csound, const MYFLT *ftable)
+{
+    FTCACHE     *p;
+    FTCACHE_MAP *m;
+
+    if ((p = (FTCACHE*) csound->QueryGlobalVariable(csound,
+                                                    "::ftcache")) == NULL)
+      return 0;
+    for (m = p->maps; m != NULL; m = m->nxt)
+      if (m->data == ftable)
+        return 1;
+    return 0;
+}
+
+#else   /* no mmap(): the cache is disabled */
+
+int ftcache_key(CSOUND *csound, FTCACHE_KEY *key, const FGDATA *ff,
+                int genum, const char *srcname)
+{
+    (void) csound; (void) ff; (void) genum; (void) srcname;
+    key->key = NULL;
+    key->len = 0;
+    return NOTOK;
+}
+
+MYFLT *ftcache_find(CSOUND *csound, const FTCACHE_KEY *key, FUNC *hdr)
+{
+    (void) csound; (void) key; (void) hdr;
+    return NULL;
+}
+
+void ftcache_store(CSOUND *csound, FTCACHE_KEY *key, const FUNC *ftp)
+{
+    (void) ftp;
+    ftcache_key_free(csound, key);
+}
+
+void ftcache_key_free(CSOUND *csound, FTCACHE_KEY *key)
+{
+    (void) csound;
+    key->key = NULL;
+    key->len = 0;
+}
+
+int ftcache_mapped(CSOUND *csound, const MYFLT *ftable)
+{
+    (void) csound; (void) ftable;
+    return 0;
+}
+
+#endif
@@ -38,6 +38,8 @@ static  void    schedofftim(CSOUND *, INSDS *);
 void    beatexpire(CSOUND *, double);
 void    timexpire(CSOUND *, double);
 static  void    instance(CSOUND *, int);
+static  void    init_pass_queue(CSOUND *, INSDS *);
+static  void    init_pass_cancel(CSOUND *, INSDS *);
 extern int argsRequired(char* argString);
 
 int init0(CSOUND *csound)
@@ -277,6 +279,8 @@ int insert(CSOUND *csound, int insno, EVTBLK *newevtp)
       ip->reinitflag = 0;
       csound->tieflag = csound->reinitflag = 0;
     }
+    else
+      init_pass_queue(csound, ip);
 
     if (UNLIKELY(csound->inerrcnt || ip->p3 == FL(0.0))) {
       xturnoff_now(csound, ip);
@@ -361,7 +365,8 @@ int insert(CSOUND *csound, int insno, EVTBLK *newevtp)
 /* insert a MIDI instr copy into active list */
 /*  then run an init pass                    */
 
-int MIDIinsert(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep)
+int MIDIinsert(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep,
+               int ksmps_offset)
 {
     INSTRTXT  *tp;
     INSDS     *ip, **ipp, *prvp, *nxtp;
@@ -453,9 +458,13 @@ int MIDIinsert(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep)
     ip->relesing     = 0;
     ip->offbet       = -1.0;
     ip->offtim       = -1.0;              /* set indef duration */
+    ip->ksmps_offset = ksmps_offset;      /* start within this k-cycle */
+    ip->ksmps_no_end = 0;
+    ip->no_end       = 0;
     ip->opcod_iobufs = NULL;              /* IV - Sep 8 2002:            */
     ip->p1           = (MYFLT) insno;     /* set these required p-fields */
-    ip->p2           = (MYFLT) (csound->icurTime/csound->esr - csound->timeOffs);
+    ip->p2           = (MYFLT) ((csound->icurTime + ksmps_offset)/csound->esr
+                                - csound->timeOffs);
     ip->p3           = FL(-1.0);
     ip->ksmps = csound->ksmps;
     ip->ekr = csound->ekr;
@@ -571,6 +580,8 @@ int MIDIinsert(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep)
       ip->tieflag = ip->reinitflag = 0;
       csound->tieflag = csound->reinitflag = 0;
     }
+    else
+      init_pass_queue(csound, ip);
 
     if (UNLIKELY(csound->inerrcnt)) {
       xturnoff_now(csound, ip);
@@ -664,6 +675,8 @@ static void deact(CSOUND *csound, INSDS *ip)
     INSDS  *nxtp;               /*      and mark it inactive            */
     /*   close any files in fd chain        */
 
+    if (csound->init_pass_queue != NULL && !ip->init_done)
+      init_pass_cancel(csound, ip);
     if (ip->nxtd != NULL)
       csoundDeinitialiseOpcodes(csound, ip);
     /* remove an active instrument */
@@ -811,7 +824,7 @@ void orcompact(CSOUND *csound)          /* free all inactive instr spaces */
               nxtip->prvinstance = prvip;
             *prvnxtloc = nxtip;
 
-            csound->Free(csound, (char *)ip);
+            mpfree(csound, (char *)ip);
 
           }
           else {
@@ -2018,7 +2031,7 @@ static void instance(CSOUND *csound, int insno)
     pextra = n-3;
     /* alloc new space,  */
     pextent = sizeof(INSDS) + tp->pextrab + pextra*sizeof(MYFLT *);
-    ip = (INSDS*) csound->Calloc(csound,
+    ip = (INSDS*) mpalloc(csound,
                           (size_t) pextent + tp->varPool->poolSize + tp->opdstot);
     ip->csound = csound;
     ip->m_chnbp = (MCHNBLK*) NULL;
@@ -2267,7 +2280,7 @@ int delete_instr(CSOUND *csound, DELETEIN *p)
         fdchclose(csound, active);
       if (active->auxchp != NULL)
         auxchfree(csound, active);
-      csound->Free(csound, active);
+      mpfree(csound, active);
       active = nxt;
     }
     csound->engineState.instrtxtp[n] = NULL;
@@ -2357,59 +2370,195 @@ PUBLIC int csoundKillInstance(CSOUND *csound, MYFLT instr, char *instrName,
 
 
 
-/**
-   In realtime mode, this function takes care of the init pass in a
-   separate thread.
-   Any new instances will have their init-pass code executed here.
-   This thread is started by musmon() and killed by csoundCleanup()
-*/
-void *init_pass_thread(void *p){
-    CSOUND *csound = (CSOUND *) p;
-    INSDS *ip;
+/* In realtime mode, the init passes of new instances are run by a
+   separate thread, started by musmon() and stopped by csoundCleanup(),
+   so that a k-cycle does not wait for them.  insert() and MIDIinsert()
+   queue the instances, and kperf() skips an instance until its init pass
+   is done; if that takes more than --init-deadline k-cycles, kperf() runs
+   the init pass itself, or waits for the thread to finish it.  Init
+   passes share csound->ids and csound->curip, so they are run one at a
+   time with init_pass_threadlock held.  An instance turned off while it
+   is queued is only marked as cancelled (its entry is cleared) and
+   dropped by the thread, so that deact() does not have to wait for the
+   init pass that the thread is running.  */
+
+#define INIT_QUEUE_SIZE 1024    /* power of two */
+
+typedef struct {
+    INSDS           *ip[INIT_QUEUE_SIZE];
+    unsigned int    rd, wr;
+    INSDS           *running;   /* init pass being run by the thread */
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    pthread_cond_t  done;       /* signalled when running is cleared */
+} INIT_QUEUE;
+
+/* run the init pass of ip if it has not been done yet;
+   call with init_pass_threadlock held */
+
+static void init_pass_run(CSOUND *csound, INSDS *ip)
+{
     int done;
-    float wakeup = (1000*csound->ksmps/csound->esr);
-    while (csound->init_pass_loop) {
 
-#if defined(MACOSX) || defined(LINUX) || defined(HAIKU)
-      usleep(1000*wakeup);
-#else
-      csoundSleep(((int)wakeup > 0) ? wakeup : 1);
-#endif
-      ip = csound->actanchor.nxtact;
-      /* do init pass for this instr */
-      while (ip != NULL){
-        INSDS *nxt = ip->nxtact;
 #ifdef HAVE_ATOMIC_BUILTIN
-        done = __sync_fetch_and_add((int *) &ip->init_done, 0);
+    done = __sync_fetch_and_add((int *) &ip->init_done, 0);
 #else
-        done = ip->init_done;
+    done = ip->init_done;
 #endif
-        if (done == 0) {
-          csoundLockMutex(csound->init_pass_threadlock);
-          csound->ids = (OPDS *) (ip->nxti);
-          csound->curip = ip;
-          while (csound->ids != NULL) {
-            if (UNLIKELY(csound->oparms->odebug))
-              csound->Message(csound, "init %s:\n",
-                              csound->ids->optext->t.oentry->opname);
-            (*csound->ids->iopadr)(csound, csound->ids);
-            csound->ids = csound->ids->nxti;
-          }
-          ip->tieflag = 0;
+    if (done || !ip->actflg)
+      return;
+    csound->ids = (OPDS *) (ip->nxti);
+    csound->curip = ip;
+    while (csound->ids != NULL) {
+      if (UNLIKELY(csound->oparms->odebug))
+        csound->Message(csound, "init %s:\n",
+                        csound->ids->optext->t.oentry->opname);
+      (*csound->ids->iopadr)(csound, csound->ids);
+      csound->ids = csound->ids->nxti;
+    }
+    ip->tieflag = 0;
+    ip->reinitflag = 0;
 #ifdef HAVE_ATOMIC_BUILTIN
-          __sync_lock_test_and_set((int*)&ip->init_done,1);
+    __sync_lock_test_and_set((int*)&ip->init_done,1);
 #else
-          ip->init_done = 1;
+    ip->init_done = 1;
 #endif
-          if (ip->reinitflag==1) {
-            ip->reinitflag = 0;
-          }
-          csoundUnlockMutex(csound->init_pass_threadlock);
-        }
-        ip = nxt;
+}
+
+/* hand the init pass of ip to the init pass thread */
 
+static void init_pass_queue(CSOUND *csound, INSDS *ip)
+{
+    INIT_QUEUE  *q = (INIT_QUEUE*) csound->init_pass_queue;
+
+    ip->initqcnt = csound->kcounter;    /* for the deadline */
+    if (q != NULL) {
+      pthread_mutex_lock(&q->lock);
+      if (q->wr - q->rd < INIT_QUEUE_SIZE) {
+        q->ip[q->wr++ & (INIT_QUEUE_SIZE - 1)] = ip;
+        pthread_cond_signal(&q->cond);
+        pthread_mutex_unlock(&q->lock);
+        return;
       }
+      pthread_mutex_unlock(&q->lock);
+      csoundLockMutex(csound->init_pass_threadlock);
+      init_pass_run(csound, ip);        /* queue full: do it now */
+      csoundUnlockMutex(csound->init_pass_threadlock);
+    }
+    else
+      init_pass_run(csound, ip);
+}
+
+/* cancel the queued init pass of ip before it is deactivated; only if
+   the thread is running that very init pass, wait for it to finish */
+
+static void init_pass_cancel(CSOUND *csound, INSDS *ip)
+{
+    INIT_QUEUE   *q = (INIT_QUEUE*) csound->init_pass_queue;
+    unsigned int i;
+
+    pthread_mutex_lock(&q->lock);
+    for (i = q->rd; i != q->wr; i++)
+      if (q->ip[i & (INIT_QUEUE_SIZE - 1)] == ip)
+        q->ip[i & (INIT_QUEUE_SIZE - 1)] = NULL;
+    if (!pthread_equal(pthread_self(), csound->init_pass_thread))
+      while (q->running == ip)
+        pthread_cond_wait(&q->done, &q->lock);
+    pthread_mutex_unlock(&q->lock);
+}
 
+/**
+ * Called by kperf() for an instance whose init pass is not done yet.  If
+ * the instance has waited for longer than the init deadline, its init
+ * pass is run (or waited for) now.  Returns non-zero if the instance is
+ * ready to perform.
+ */
+int init_pass_join(CSOUND *csound, INSDS *ip)
+{
+    int deadline = csound->oparms->initDeadline;
+
+    if (deadline <= 0 || csound->init_pass_queue == NULL ||
+        csound->kcounter - ip->initqcnt < (long) deadline)
+      return 0;
+    csoundLockMutex(csound->init_pass_threadlock);
+    init_pass_run(csound, ip);
+    csoundUnlockMutex(csound->init_pass_threadlock);
+    return ip->init_done;
+}
+
+static void *init_pass_thread(void *p)
+{
+    CSOUND      *csound = (CSOUND *) p;
+    INIT_QUEUE  *q = (INIT_QUEUE*) csound->init_pass_queue;
+    INSDS       *ip;
+
+    for (;;) {
+      pthread_mutex_lock(&q->lock);
+      while (q->rd == q->wr && csound->init_pass_loop)
+        pthread_cond_wait(&q->cond, &q->lock);
+      pthread_mutex_unlock(&q->lock);
+      if (!csound->init_pass_loop)
+        break;
+      csoundLockMutex(csound->init_pass_threadlock);
+      pthread_mutex_lock(&q->lock);
+      /* a NULL entry is a cancelled instance */
+      ip = (q->rd != q->wr ? q->ip[q->rd++ & (INIT_QUEUE_SIZE - 1)] : NULL);
+      q->running = ip;
+      pthread_mutex_unlock(&q->lock);
+      if (ip != NULL) {
+        init_pass_run(csound, ip);
+        pthread_mutex_lock(&q->lock);
+        q->running = NULL;
+        pthread_cond_broadcast(&q->done);
+        pthread_mutex_unlock(&q->lock);
+      }
+      csoundUnlockMutex(csound->init_pass_threadlock);
     }
     return NULL;
 }
+
+void init_pass_start(CSOUND *csound)
+{
+    INIT_QUEUE  *q;
+
+    if (csound->init_pass_loop)
+      return;
+    q = (INIT_QUEUE*) csound->Calloc(csound, sizeof(INIT_QUEUE));
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->cond, NULL);
+    pthread_cond_init(&q->done, NULL);
+    /* recursive, as an init pass may turn off another queued instance */
+    csound->init_pass_threadlock = csoundCreateMutex(1);
+    csound->init_pass_queue = (void*) q;
+    csound->init_pass_loop = 1;
+    if (pthread_create(&csound->init_pass_thread, NULL,
+                       init_pass_thread, csound) != 0) {
+      csound->Warning(csound, Str("could not start the init pass thread"));
+      csound->init_pass_loop = 0;
+      csound->init_pass_queue = NULL;
+      pthread_cond_destroy(&q->done);
+      pthread_cond_destroy(&q->cond);
+      pthread_mutex_destroy(&q->lock);
+      csound->Free(csound, q);
+    }
+}
+
+void init_pass_stop(CSOUND *csound)
+{
+    INIT_QUEUE  *q = (INIT_QUEUE*) csound->init_pass_queue;
+
+    if (csound->init_pass_loop != 1)
+      return;
+    pthread_mutex_lock(&q->lock);
+    csound->init_pass_loop = 0;
+    pthread_cond_signal(&q->cond);
+    pthread_mutex_unlock(&q->lock);
+    pthread_join(csound->init_pass_thread, NULL);
+    csound->init_pass_queue = NULL;
+    pthread_cond_destroy(&q->done);
+    pthread_cond_destroy(&q->cond);
+    pthread_mutex_destroy(&q->lock);
+    csound->Free(csound, q);
+    csoundDestroyMutex(csound->init_pass_threadlock);
+    csound->init_pass_threadlock = NULL;
+}
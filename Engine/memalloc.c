@@ -216,12 +216,146 @@ void *mrealloc(CSOUND *csound, void *oldp, size_t size)
     return DATA_PTR(pp);
 }
 
+/* Recycling pool for instance and AUXCH memory.  Requests are rounded up
+   to one of four sizes per octave; a released block goes on the free list
+   of its size class rather than back to the system, so a burst of notes
+   after the first is served without malloc or the global memory lock.
+   Pool blocks are ordinary mcalloc() blocks, so memRESET frees them.
+   There is one pool for all instruments rather than one per INSTRTXT, as
+   AUXCH buffers are not tied to an instrument and instances of different
+   instruments often fall in the same size class.  So that one large note
+   does not keep its memory for the life of the instance, the free list
+   of a class holds at most MPOOL_KEEP bytes of blocks, and the rest go
+   back to the system. */
+
+#define MPOOL_MIN       (64)
+#define MPOOL_MAX       (((size_t) 1) << 26)    /* larger are not pooled */
+#define MPOOL_CLASSES   (4*20+1)
+#define MPOOL_KEEP      (((size_t) 1) << 22)    /* bytes kept per class  */
+
+typedef struct memPoolBlock_s {
+    struct memPoolBlock_s   *nxt;       /* next free block of this class */
+    int                     cls;        /* size class, -1 if not pooled  */
+} memPoolBlock_t;
+
+#define POOL_HDR_SIZE   (((int) sizeof(memPoolBlock_t) + 7) & (~7))
+#define POOL_DATA_PTR(p) ((void*) ((unsigned char*) (p) + (int) POOL_HDR_SIZE))
+#define POOL_HDR_PTR(p) \
+    ((memPoolBlock_t*) ((unsigned char*) (p) - (int) POOL_HDR_SIZE))
+
+typedef struct {
+    memPoolBlock_t  *freelist[MPOOL_CLASSES];
+    int             nfree[MPOOL_CLASSES];       /* blocks on each list   */
+    int             nkeep[MPOOL_CLASSES];       /* most to keep on each  */
+    int32_t         lock;
+    unsigned long   requests;           /* calls to mpalloc()            */
+    unsigned long   hits;               /* ... served from a free list   */
+    unsigned long   recycled;           /* blocks given back by mpfree() */
+} MEMPOOL;
+
+static int mpool_class(size_t size, size_t *csize)
+{
+    size_t  base = MPOOL_MIN;
+    int     cls = 0, i;
+
+    if (size <= base) {
+      *csize = base;
+      return 0;
+    }
+    if (size > MPOOL_MAX) {
+      *csize = size;
+      return -1;
+    }
+    for ( ; ; base <<= 1)
+      for (i = 1; i <= 4; i++) {
+        cls++;
+        if (size <= base + i * (base >> 2)) {
+          *csize = base + i * (base >> 2);
+          return cls;
+        }
+      }
+}
+
+void *mpalloc(CSOUND *csound, size_t size)
+{
+    MEMPOOL         *pool = (MEMPOOL*) csound->memalloc_pool;
+    memPoolBlock_t  *pp;
+    size_t          csize;
+    int             cls;
+
+    if (UNLIKELY(pool == NULL)) {
+      int   i;
+      pool = (MEMPOOL*) mcalloc(csound, sizeof(MEMPOOL));
+      for (i = 0, csize = MPOOL_MIN; i < MPOOL_CLASSES; i++) {
+        mpool_class(csize, &csize);
+        pool->nkeep[i] = (int) (MPOOL_KEEP / csize);
+        csize++;
+      }
+      csound->memalloc_pool = pool;
+    }
+    cls = mpool_class(size, &csize);
+    csoundSpinLock(&pool->lock);
+    pool->requests++;
+    if (cls >= 0 && (pp = pool->freelist[cls]) != NULL) {
+      pool->freelist[cls] = pp->nxt;
+      pool->nfree[cls]--;
+      pool->hits++;
+      csoundSpinUnLock(&pool->lock);
+      memset(POOL_DATA_PTR(pp), 0, size);
+      return POOL_DATA_PTR(pp);
+    }
+    csoundSpinUnLock(&pool->lock);
+    pp = (memPoolBlock_t*) mcalloc(csound, (size_t) POOL_HDR_SIZE + csize);
+    pp->cls = cls;
+    return POOL_DATA_PTR(pp);
+}
+
+void mpfree(CSOUND *csound, void *p)
+{
+    MEMPOOL         *pool = (MEMPOOL*) csound->memalloc_pool;
+    memPoolBlock_t  *pp;
+
+    if (UNLIKELY(p == NULL))
+      return;
+    pp = POOL_HDR_PTR(p);
+    if (UNLIKELY(pp->cls < 0)) {
+      mfree(csound, pp);
+      return;
+    }
+    csoundSpinLock(&pool->lock);
+    if (UNLIKELY(pool->nfree[pp->cls] >= pool->nkeep[pp->cls])) {
+      csoundSpinUnLock(&pool->lock);
+      mfree(csound, pp);
+      return;
+    }
+    pp->nxt = pool->freelist[pp->cls];
+    pool->freelist[pp->cls] = pp;
+    pool->nfree[pp->cls]++;
+    pool->recycled++;
+    csoundSpinUnLock(&pool->lock);
+}
+
+void mpool_report(CSOUND *csound)
+{
+    MEMPOOL *pool = (MEMPOOL*) csound->memalloc_pool;
+
+    if (pool == NULL || pool->requests == 0UL)
+      return;
+    csound->Message(csound,
+                    Str("instance memory: %lu requests, %lu from pool "
+                        "(%.1f%%), %lu blocks recycled\n"),
+                    pool->requests, pool->hits,
+                    100.0 * (double) pool->hits / (double) pool->requests,
+                    pool->recycled);
+}
+
 void memRESET(CSOUND *csound)
 {
     memAllocBlock_t *pp, *nxtp;
 
     pp = (memAllocBlock_t*) MEMALLOC_DB;
     MEMALLOC_DB = NULL;
+    csound->memalloc_pool = NULL;
     while (pp != NULL) {
       nxtp = pp->nxt;
 #ifdef MEMDEBUG
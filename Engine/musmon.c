@@ -30,13 +30,14 @@
 #include "remote.h"
 #include <math.h>
 #include "corfile.h"
+#include "fgens.h"
 
 #include "csdebug.h"
 
 #define SEGAMPS AMPLMSG
 #define SORMSG  RNGEMSG
 
-extern  int     MIDIinsert(CSOUND *, int, MCHNBLK*, MEVENT*);
+extern  int     MIDIinsert(CSOUND *, int, MCHNBLK*, MEVENT*, int);
 extern  int     insert(CSOUND *, int, EVTBLK*);
 extern  void    MidiOpen(CSOUND *);
 extern  void    m_chn_init_all(CSOUND *);
@@ -350,15 +351,8 @@ int musmon(CSOUND *csound)
       csoundSetScoreOffsetSeconds(csound, csound->csoundScoreOffsetSeconds_);
 
 
-    if(csound->realtime_audio_flag && csound->init_pass_loop == 0){
-      extern void *init_pass_thread(void *);
-      pthread_attr_t attr;
-      csound->init_pass_loop = 1;
-      csound->init_pass_threadlock = csoundCreateMutex(0);
-      pthread_attr_init(&attr);
-      //pthread_attr_setstacksize(&attr, 1048576);
-      pthread_create(&csound->init_pass_thread,&attr,init_pass_thread, csound);
-    }
+    if (csound->realtime_audio_flag && csound->init_pass_loop == 0)
+      init_pass_start(csound);
 
 
     /* since we are running in components, we exit here to playevents later */
@@ -376,12 +370,71 @@ static void deactivate_all_notes(CSOUND *csound)
     }
 }
 
+/* Pending real time events are kept in a binary min-heap ordered on
+   start_kcnt, so that scheduling is O(log n) however many events are
+   queued.  Events due in the same k-cycle are started in the order they
+   were inserted, using the sequence number as a tie-break. */
+
+static inline int rt_event_before(const EVTNODE *a, const EVTNODE *b)
+{
+    if (a->start_kcnt != b->start_kcnt)
+      return (a->start_kcnt < b->start_kcnt);
+    return ((int32) (a->seq - b->seq) < 0);
+}
+
+static int rt_event_push(CSOUND *csound, EVTNODE *e)
+{
+    EVTNODE **heap = csound->OrcTrigEvts;
+    int     i = csound->OrcTrigEvtsCnt, j;
+
+    if (i >= csound->OrcTrigEvtsMax) {
+      int   n = (csound->OrcTrigEvtsMax ? csound->OrcTrigEvtsMax << 1 : 64);
+      heap = (EVTNODE**) realloc(heap, sizeof(EVTNODE*) * (size_t) n);
+      if (UNLIKELY(heap == NULL))
+        return CSOUND_MEMORY;
+      csound->OrcTrigEvts = heap;
+      csound->OrcTrigEvtsMax = n;
+    }
+    e->seq = csound->OrcTrigEvtsSeq++;
+    while (i > 0) {                     /* sift up */
+      j = (i - 1) >> 1;
+      if (!rt_event_before(e, heap[j]))
+        break;
+      heap[i] = heap[j];
+      i = j;
+    }
+    heap[i] = e;
+    csound->OrcTrigEvtsCnt++;
+    return 0;
+}
+
+static EVTNODE *rt_event_pop(CSOUND *csound)
+{
+    EVTNODE **heap = csound->OrcTrigEvts;
+    EVTNODE *e = heap[0], *last;
+    int     n = --csound->OrcTrigEvtsCnt, i = 0, j;
+
+    if (n > 0) {
+      last = heap[n];
+      while ((j = (i << 1) + 1) < n) { /* sift down */
+        if (j + 1 < n && rt_event_before(heap[j + 1], heap[j]))
+          j++;
+        if (!rt_event_before(heap[j], last))
+          break;
+        heap[i] = heap[j];
+        i = j;
+      }
+      heap[i] = last;
+    }
+    return e;
+}
+
 static void delete_pending_rt_events(CSOUND *csound)
 {
-    EVTNODE *ep = csound->OrcTrigEvts;
+    int i;
 
-    while (ep != NULL) {
-      EVTNODE *nxt = ep->nxt;
+    for (i = 0; i < csound->OrcTrigEvtsCnt; i++) {
+      EVTNODE *ep = csound->OrcTrigEvts[i];
       if (ep->evt.strarg != NULL) {
         free(ep->evt.strarg);
         ep->evt.strarg = NULL;
@@ -389,9 +442,8 @@ static void delete_pending_rt_events(CSOUND *csound)
       /* push to stack of free event nodes */
       ep->nxt = csound->freeEvtNodes;
       csound->freeEvtNodes = ep;
-      ep = nxt;
     }
-    csound->OrcTrigEvts = NULL;
+    csound->OrcTrigEvtsCnt = 0;
 }
 
 static void cs_beep(CSOUND *csound)
@@ -421,7 +473,11 @@ PUBLIC int csoundCleanup(CSOUND *csound)
       return 0;
     /* will not clean up more than once */
     csound->engineStatus &= ~(CS_STATE_CLN);
+    /* a csoundStop() only ends the performance that it was sent to */
+    csound->performState = 0;
 
+    /* no init passes may run while the instances are deactivated */
+    init_pass_stop(csound);
     deactivate_all_notes(csound);
 
     if (csound->engineState.instrtxtp &&
@@ -431,20 +487,14 @@ PUBLIC int csoundCleanup(CSOUND *csound)
       xturnoff_now(csound, csound->engineState.instrtxtp[0]->instance);
     delete_pending_rt_events(csound);
 
-    if(csound->init_pass_loop == 1) {
-      csoundLockMutex(csound->init_pass_threadlock);
-      csound->init_pass_loop = 0;
-      csoundUnlockMutex(csound->init_pass_threadlock);
-      pthread_join(csound->init_pass_thread, NULL);
-      csoundDestroyMutex(csound->init_pass_threadlock);
-      csound->init_pass_threadlock = 0;
-    }
-
     while (csound->freeEvtNodes != NULL) {
       p = (void*) csound->freeEvtNodes;
       csound->freeEvtNodes = ((EVTNODE*) p)->nxt;
       free(p);
     }
+    free(csound->OrcTrigEvts);
+    csound->OrcTrigEvts = NULL;
+    csound->OrcTrigEvtsMax = 0;
 
     orcompact(csound);
 
@@ -470,6 +520,8 @@ PUBLIC int csoundCleanup(CSOUND *csound)
       }
       csound->Message(csound, Str("\n%d errors in performance\n"),
                       csound->perferrcnt);
+      if (csound->oparms->msglevel & TIMEMSG)
+        mpool_report(csound);
       print_benchmark_info(csound, Str("end of performance"));
     }
 /* close line input (-L) */
@@ -790,12 +842,52 @@ static int process_score_event(CSOUND *csound, EVTBLK *evt, int rtEvt)
     return 0;
 }
 
+/* The f-statements at the start of the score are read ahead and made
+   together by hfgens_batch(), so that independent tables can be made in
+   parallel.  On return e holds the next event, not yet processed.  */
+
+#define FTABLE_BATCH 256
+
+static void read_initial_ftables(CSOUND *csound, EVTBLK *e)
+{
+    EVTBLK  *evts;
+    int     i, n = 0;
+
+    evts = (EVTBLK*) malloc(sizeof(EVTBLK) * FTABLE_BATCH);
+    while (e->opcod == 'f' && e->p[1] != FL(0.0) && e->p[2] == FL(0.0)) {
+      memcpy(&evts[n], e, sizeof(EVTBLK));
+      if (e->pcnt >= PMAX && e->c.extra != NULL) {
+        /* the next rdscor() may free the extra p-fields */
+        evts[n].c.extra = (MYFLT*) malloc(sizeof(MYFLT) * e->c.extra[0]);
+        memcpy(evts[n].c.extra, e->c.extra, sizeof(MYFLT) * e->c.extra[0]);
+      }
+      else
+        evts[n].c.extra = NULL;
+      if (++n == FTABLE_BATCH) {
+        hfgens_batch(csound, evts, n);
+        while (n--)
+          free(evts[n].c.extra);
+        n = 0;
+      }
+      if (!(rdscor(csound, e)))
+        e->opcod = 'e';
+      csound->currevent = e;
+    }
+    if (n > 0)
+      hfgens_batch(csound, evts, n);
+    for (i = 0; i < n; i++)
+      free(evts[i].c.extra);
+    free(evts);
+}
+
 /* RM: this now broken out for access from process_rt_event & sensevents -- bv  */
-static void process_midi_event(CSOUND *csound, MEVENT *mep, MCHNBLK *chn)
+/* ksmps_offset is where a note on starts within this k-cycle */
+static void process_midi_event(CSOUND *csound, MEVENT *mep, MCHNBLK *chn,
+                               int ksmps_offset)
 {
     int n, insno = chn->insno;
     if (mep->type == NOTEON_TYPE && mep->dat2) {      /* midi note ON: */
-      if (UNLIKELY((n = MIDIinsert(csound, insno, chn, mep)))) {
+      if (UNLIKELY((n = MIDIinsert(csound, insno, chn, mep, ksmps_offset)))) {
         /* alloc,init,activ */
         csound->Message(csound,
                         Str("\t\t   T%7.3f - note deleted. "), csound->curp2);
@@ -838,8 +930,8 @@ static int process_rt_event(CSOUND *csound, int sensType)
       print_amp_values(csound, 0);
     }
     if (sensType == 4) {                  /* RM: Realtime orc event   */
-      EVTNODE *e = csound->OrcTrigEvts;
-      /* RM: Events are sorted on insertion, so just check the first */
+      EVTNODE *e = csound->OrcTrigEvts[0];
+      /* RM: the earliest event is at the top of the heap */
       evt = &(e->evt);
       insno = (int)(evt->p[1]);
       if ((rfd = getRemoteInsRfd(csound, insno))) {
@@ -849,8 +941,8 @@ static int process_rt_event(CSOUND *csound, int sensType)
           insSendevt(csound, evt, rfd);  /* RM: or send to single remote Csound */
         return 0;
       }
-      /* pop from the list */
-      csound->OrcTrigEvts = e->nxt;
+      /* pop from the heap */
+      rt_event_pop(csound);
       retval = process_score_event(csound, evt, 1);
       if (evt->strarg != NULL) {
         free(evt->strarg);
@@ -873,7 +965,8 @@ static int process_rt_event(CSOUND *csound, int sensType)
         return 0;
       }
       else  /* RM: this part is broken out  -- bv  */
-        process_midi_event(csound, mep, chn);
+        process_midi_event(csound, mep, chn,
+                           csound->midiGlobals->tsOffset);
     }
     return retval;
 }
@@ -967,6 +1060,10 @@ int sensevents(CSOUND *csound)
           if (!(rdscor(csound, e)))           /* or rd nxt evt from scstr */
             e->opcod = 'e';
         csound->currevent = e;
+        if (e->opcod == 'f' && O->numThreads > 1 && !O->usingcscore &&
+            csound->icurTime == 0 && csound->timeOffs == 0.0 &&
+            !getRemoteInsRfdCount(csound))
+          read_initial_ftables(csound, e);
         switch (e->opcod) {
         case 'w':
           if (!O->Beatmode)                   /* Not beatmode: read 'w' */
@@ -1045,8 +1142,8 @@ int sensevents(CSOUND *csound)
         } while (fp != NULL);
       }
       /* check for pending real time events */
-      while (csound->OrcTrigEvts != NULL &&
-             csound->OrcTrigEvts->start_kcnt <=
+      while (csound->OrcTrigEvtsCnt > 0 &&
+             csound->OrcTrigEvts[0]->start_kcnt <=
              (uint32) csound->global_kcounter) {
         if ((retval = process_rt_event(csound, 4)) != 0)
           goto scode;
@@ -1072,7 +1169,7 @@ int sensevents(CSOUND *csound)
               else if (bp->type == MIDI_EVT) {
                 MEVENT *mep = (MEVENT *)bp->data;
                 MCHNBLK *chn = csound->m_chnbp[mep->chan];
-                process_midi_event(csound, mep, chn);
+                process_midi_event(csound, mep, chn, 0);
               }
               else if (bp->type == MIDI_MSG) {
                 MEVENT *mep = (MEVENT *)bp->data;
@@ -1166,7 +1263,7 @@ static inline uint64_t time2kcnt(CSOUND *csound, double tval)
 int insert_score_event_at_sample(CSOUND *csound, EVTBLK *evt, int64_t time_ofs)
 {
     double        start_time;
-    EVTNODE       *e, *prv;
+    EVTNODE       *e;
     CSOUND        *st = csound;
     MYFLT         *p;
     uint32        start_kcnt;
@@ -1278,17 +1375,9 @@ int insert_score_event_at_sample(CSOUND *csound, EVTBLK *evt, int64_t time_ofs)
     }
     /* queue new event */
     e->start_kcnt = start_kcnt;
-    prv = csound->OrcTrigEvts;
-    /* if list is empty, or at beginning of list: */
-    if (prv == NULL || start_kcnt < prv->start_kcnt) {
-      e->nxt = prv;
-      csound->OrcTrigEvts = e;
-    }
-    else {                                      /* otherwise sort by time */
-      while (prv->nxt != NULL && start_kcnt >= prv->nxt->start_kcnt)
-        prv = prv->nxt;
-      e->nxt = prv->nxt;
-      prv->nxt = e;
+    if (UNLIKELY(rt_event_push(csound, e) != 0)) {
+      retval = CSOUND_MEMORY;
+      goto err_return;
     }
     /* Make sure sensevents() looks for RT events */
     csound->oparms->RTevents = 1;
@@ -93,6 +93,25 @@ typedef struct {
     MYFLT   *r, *a;
 } EVAL;
 
+/* ##expr evaluates a tree of a-rate +, -, * and / that the compiler has
+   fused into one opcode (see csound_orc_expressions.c).  The program is
+   in reverse Polish: 'A' to 'Z' push an operand, and an operator pops
+   two values and pushes the result.  It is run EXPR_BLOCK samples at a
+   time, with the intermediate values kept in a small stack of buffers. */
+#define EXPR_MAXARGS    (26)
+#define EXPR_MAXCODE    (63)
+#define EXPR_DEPTH      (8)
+#define EXPR_BLOCK      (64)
+
+typedef struct {
+    OPDS    h;
+    MYFLT   *r;
+    STRINGDAT *prog;
+    MYFLT   *args[EXPR_MAXARGS];
+    const char *code;
+    uint32_t amask;             /* which operands are a-rate */
+} EXPR;
+
 typedef struct {
     OPDS    h;
     MYFLT   *ar;
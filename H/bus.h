@@ -38,6 +38,8 @@ extern "C" {
 typedef struct {
     OPDS    h;
     MYFLT   *r, *a;
+    struct channelEntry_s *chn;         /* channel for index n */
+    int     n;
 } CHNVAL;
 
 typedef struct {
@@ -45,6 +47,8 @@ typedef struct {
     PVSDAT   *r;
     MYFLT    *a,*N, *overlap, *winsize, *wintype, *format;
     PVSDAT   init;
+    struct channelEntry_s *chn;
+    int      n;
 } FCHAN;
 
 typedef struct {
@@ -70,6 +74,11 @@ typedef struct channelEntry_s {
 #endif
     int     type;
     int     datasize;  /* size of allocated chn data */
+    volatile unsigned int seq;  /* odd while an audio write is under way */
+    MYFLT   *hostdata;          /* audio written by the host, not yet taken */
+    int     nhost;              /* samples in hostdata */
+    volatile int hoststate;     /* CHN_HOST_NONE, _SET or _MIX */
+    int32_t hostlock;           /* for hostdata and hoststate */
     char    name[1];
 } CHNENTRY;
 
@@ -80,6 +89,7 @@ typedef struct {
     MYFLT   *fp;
     int     *lock;
     int      pos;
+    CHNENTRY *chn;
 } CHNGET;
 
 typedef struct {
@@ -87,6 +97,7 @@ typedef struct {
     STRINGDAT   *iname;
     MYFLT   *fp;
     int     *lock;
+    CHNENTRY *chn;
 } CHNCLEAR;
 
 typedef struct {
@@ -150,6 +161,7 @@ typedef struct {
     void *channelptr;
 } OUTVAL;
 
+int     chnval_opcode_init(CSOUND *, CHNVAL *);
 int     chano_opcode_perf_k(CSOUND *, CHNVAL *);
 int     chano_opcode_perf_a(CSOUND *, CHNVAL *);
 int     chani_opcode_perf_k(CSOUND *, CHNVAL *);
@@ -39,4 +39,15 @@ typedef struct RtJackGlobals_ {
     RtJackBuffer    **bufs;             /* 'nBuffers' I/O buffers           */
     int     xrunFlag;                   /* non-zero if an xrun has occured  */
     jack_client_t   *listclient;
+    int     callbackMode;               /* non-zero: perform in callback    */
+    volatile int cbState;               /* -1: off, 0: host, 1: cb, 2: done */
+    volatile int inCallback;            /* non-zero in process callback     */
+    int     cbInPos;                    /* next frame for spin in callback  */
+    int     cbOutPos;                   /* next frame for spout in callback */
+    int     cbResult;                   /* result of the performance        */
+#ifdef LINUX
+    pthread_mutex_t cbLock;             /* signaled when callback is done   */
+#else
+    void    *cbLock;                    /* signaled when callback is done   */
+#endif
 } RtJackGlobals;
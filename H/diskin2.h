@@ -30,6 +30,7 @@
 #define POS_FRAC_SHIFT  28              /* allows pitch accuracy of 2^-28 */
 #define POS_FRAC_SCALE  0x10000000
 #define POS_FRAC_MASK   0x0FFFFFFF
+#define DISKIN2_READAHEAD 0.5     /* seconds buffered in async mode   */
 
 typedef struct {
     OPDS    h;
@@ -72,6 +73,11 @@ typedef struct {
   MYFLT aOut_bufsize;
   void *cb;
   int  async;
+  int  aOut_pending;            /* samples of aOut_buf not yet queued */
+  uint32_t underruns;
+  uint32_t underruns_told;      /* underruns already reported */
+  long  underrun_kcnt;          /* k-cycle of the last report */
+  void *io;
 } DISKIN2;
 
 typedef struct {
@@ -114,6 +120,11 @@ typedef struct {
   MYFLT aOut_bufsize;
   void *cb;
   int  async;
+  int  aOut_pending;            /* samples of aOut_buf not yet queued */
+  uint32_t underruns;
+  uint32_t underruns_told;      /* underruns already reported */
+  long  underrun_kcnt;          /* k-cycle of the last report */
+  void *io;
 } DISKIN2_ARRAY;
 
 int diskin2_init(CSOUND *csound, DISKIN2 *p);
@@ -116,6 +116,27 @@ extern "C" {
    */
   void csoundInverseRealFFTnp2(CSOUND *csound, MYFLT *buf, int FFTsize);
 
+  /**
+   * Returns a plan for in-place transforms of FFTsize points, or NULL if
+   * the size is not supported.  flags is a combination of CS_FFT_INVERSE
+   * and CS_FFT_COMPLEX; the data layout and scaling are those of the
+   * matching function above.  Complex transforms may have any length,
+   * real ones any even length.  Plans are shared and owned by Csound.
+   */
+  CS_FFT_PLAN *csoundCreateFFTPlan(CSOUND *csound, int FFTsize, int flags);
+
+  /**
+   * Compute an in-place transform with a plan.
+   */
+  void csoundExecuteFFTPlan(CSOUND *csound, CS_FFT_PLAN *plan, MYFLT *buf);
+
+  /**
+   * Compute 'howmany' in-place transforms with the same plan, each 'dist'
+   * MYFLT values after the previous one.
+   */
+  void csoundExecuteFFTPlanBatch(CSOUND *csound, CS_FFT_PLAN *plan,
+                                 MYFLT *buf, int howmany, int dist);
+
 #ifdef __cplusplus
 }
 #endif
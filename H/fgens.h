@@ -35,6 +35,14 @@
  */
 int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode);
 
+/**
+ * Create the ftables of n events, with the same result as calling
+ * hfgens() with a mode of zero on each in turn.  If more than one
+ * thread is allowed (-j), independent tables are made in parallel.
+ * Returns the number of events that failed.
+ */
+int hfgens_batch(CSOUND *csound, const EVTBLK *evts, int n);
+
 /**
  * Allocates space for 'tableNum' with a length (not including the guard
  * point) of 'len' samples. The table data is not cleared to zero.
@@ -48,5 +56,13 @@ int csoundFTAlloc(CSOUND *csound, int tableNum, int len);
  */
 int csoundFTDelete(CSOUND *csound, int tableNum);
 
+/**
+ * Returns the copy of a power of two size table that is band-limited for
+ * reading with a phase increment of 'inc' table samples per output sample,
+ * making the copies on first use.  Copies are made from the table contents
+ * at that time.  Returns ftp->ftable if no copies can be made.
+ */
+MYFLT *csoundGetBandLimitedTable(CSOUND *csound, FUNC *ftp, MYFLT inc);
+
 #endif  /* CSOUND_FGENS_H */
 
@@ -0,0 +1,76 @@
+/*
+    ftcache.h:
+
+    Copyright (C) 2026 The Csound developers
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+                                                /*      FTCACHE.H       */
+#ifndef CSOUND_FTCACHE_H
+#define CSOUND_FTCACHE_H
+
+/* On-disk cache of generated ftables.  When the environment variable
+   FTCACHEDIR names a directory, tables are stored there under a hash of
+   everything they were made from (GEN number, p-fields, strings, sample
+   rate, and for sound file GENs the contents of the file), and later
+   runs map the stored copy read-only instead of running the GEN routine
+   again.  The mapping is private, so the pages are shared by every
+   process using the table until one of them writes to it.  */
+
+typedef struct {
+    uint64_t      hash;
+    int32         len;
+    unsigned char *key;         /* NULL if the table is not to be cached */
+} FTCACHE_KEY;
+
+/**
+ * Make the cache key of the table described by ff.  If srcname is not
+ * NULL, it is the sound file the GEN routine reads, and its contents
+ * become part of the key.  Returns zero on success, and non-zero (with
+ * key->key set to NULL) if the cache is disabled or the key cannot be
+ * made.
+ */
+int ftcache_key(CSOUND *csound, FTCACHE_KEY *key, const FGDATA *ff,
+                int genum, const char *srcname);
+
+/**
+ * Look up key in the cache.  On success, the table header is copied to
+ * *hdr (up to, but not including, the ftable field) and a pointer to the
+ * mapped table data (hdr->flen + 1 values) is returned.  Returns NULL if
+ * there is no valid cached copy.
+ */
+MYFLT *ftcache_find(CSOUND *csound, const FTCACHE_KEY *key, FUNC *hdr);
+
+/**
+ * Write the table ftp to the cache under key, replacing any old copy,
+ * and free the key.
+ */
+void ftcache_store(CSOUND *csound, FTCACHE_KEY *key, const FUNC *ftp);
+
+/**
+ * Free a key made by ftcache_key() without storing anything.
+ */
+void ftcache_key_free(CSOUND *csound, FTCACHE_KEY *key);
+
+/**
+ * Returns non-zero if ftable is mapped from the cache, in which case it
+ * must not be passed to csound->Free() or csound->ReAlloc().
+ */
+int ftcache_mapped(CSOUND *csound, const MYFLT *ftable);
+
+#endif  /* CSOUND_FTCACHE_H */
@@ -34,6 +34,9 @@ void    *mmalloc(CSOUND *, size_t);
 void    *mcalloc(CSOUND *, size_t);
 void    *mrealloc(CSOUND *, void *, size_t);
 void    mfree(CSOUND *, void *);
+void    *mpalloc(CSOUND *, size_t);
+void    mpfree(CSOUND *, void *);
+void    mpool_report(CSOUND *);
 char    *cs_strdup(CSOUND*, char*);
 char    *cs_strndup(CSOUND*, char*, size_t);
 void    csoundAuxAlloc(CSOUND *, size_t, AUXCH *), auxchfree(CSOUND *, INSDS *);
@@ -75,6 +78,9 @@ void    remove_tmpfiles(CSOUND *);
 void    add_tmpfile(CSOUND *, char *);
 void    xturnoff(CSOUND *, INSDS *);
 void    xturnoff_now(CSOUND *, INSDS *);
+void    init_pass_start(CSOUND *);
+void    init_pass_stop(CSOUND *);
+int     init_pass_join(CSOUND *, INSDS *);
 int     insert_score_event(CSOUND *, EVTBLK *, double);
   //MEMFIL  *ldmemfile(CSOUND *, const char *);
   //MEMFIL  *ldmemfile2(CSOUND *, const char *, int);
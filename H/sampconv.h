@@ -0,0 +1,108 @@
+/*
+    sampconv.h:
+
+    Copyright (C) 2026 The Csound developers
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+                                                /*      SAMPCONV.H      */
+#ifndef CSOUND_SAMPCONV_H
+#define CSOUND_SAMPCONV_H
+
+/* Conversion between interleaved MYFLT samples and the sample formats of
+   audio devices and files, shared by the real time audio modules (which
+   get it through the CSOUND function table) and libsnd.c.  The formats
+   are AE_CHAR, AE_UNCH, AE_SHORT, AE_24INT (three bytes), AE_LONG and
+   AE_FLOAT, in the byte order of the machine.  The arithmetic is done a
+   block at a time with the kernels of vecops.c.  A converter keeps state
+   between calls, so each stream needs one of its own.
+
+   Dither follows -Z and the --dither options: triangular (TPDF, of one
+   LSB peak), uniform, or triangular with second order noise shaping,
+   which moves the noise to high frequencies.  Each converter has its own
+   generator, so converters in different threads do not interfere.
+
+   The type is declared in csoundCore.h.  */
+
+#define CS_DITHER_NONE          (0)
+#define CS_DITHER_TRIANGULAR    (1)
+#define CS_DITHER_UNIFORM       (2)
+#define CS_DITHER_SHAPED        (3)
+
+#define SAMPCONV_BLOCK          (256)
+#define SAMPCONV_LANES          (8)
+
+struct CS_SAMPCONV_ {
+    int       format;
+    int       nchnls;
+    int       dither;
+    int       chn;              /* channel of the next sample, for shaping */
+    MYFLT     scale;            /* full scale of the format, in LSBs */
+    MYFLT     lo, hi;           /* limits of the format, in LSBs */
+    uint32_t  rnd[SAMPCONV_LANES];      /* dither generators */
+    MYFLT     *err;             /* shaping: last two errors of each channel */
+    MYFLT     d[SAMPCONV_BLOCK];
+    int32_t   q[SAMPCONV_BLOCK];
+};
+
+/**
+ * Creates a converter for nchnls channels of the given sample format
+ * and dither type, or returns NULL if the format is not supported.
+ */
+CS_SAMPCONV *cs_sampconv_create(CSOUND *, int format, int nchnls, int dither);
+
+void cs_sampconv_destroy(CSOUND *, CS_SAMPCONV *);
+
+/**
+ * Returns the size in bytes of a sample of the format of the converter.
+ */
+int cs_sampconv_size(CS_SAMPCONV *);
+
+/**
+ * Converts nframes frames from MYFLT, of which full scale is 1.0, to the
+ * format of the converter, with dither if it was asked for.
+ */
+void cs_sampconv_out(CS_SAMPCONV *, void *out, const MYFLT *in, int nframes);
+
+/**
+ * Converts nframes frames from the format of the converter to MYFLT.
+ */
+void cs_sampconv_in(CS_SAMPCONV *, MYFLT *out, const void *in, int nframes);
+
+/**
+ * Adds dither to nframes frames of MYFLT in place, for a file that
+ * libsndfile converts to the format of the converter with full scale at
+ * 2^(bits - 1) - 1.  With noise shaping, the samples are also rounded.
+ */
+void cs_sampconv_dither(CS_SAMPCONV *, MYFLT *buf, int nframes);
+
+/**
+ * Copies nframes frames of interleaved MYFLT to nchnls separate float
+ * buffers, starting at sample offset of each, multiplying by scale.
+ */
+void cs_deinterleave(float *const *out, int offset, const MYFLT *in,
+                     int nchnls, int nframes, MYFLT scale);
+
+/**
+ * Copies nframes samples starting at offset in each of nchnls float
+ * buffers to interleaved MYFLT, multiplying by scale.
+ */
+void cs_interleave(MYFLT *out, const float *const *in, int offset,
+                   int nchnls, int nframes, MYFLT scale);
+
+#endif  /* CSOUND_SAMPCONV_H */
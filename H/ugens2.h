@@ -66,8 +66,9 @@ typedef struct  {
 
 typedef struct {
         OPDS    h;
-        MYFLT   *sr, *xamp, *xcps, *ifn, *iphs;
+        MYFLT   *sr, *xamp, *xcps, *ifn, *iphs, *ibl;
         int32   lphs;
+        int     bl;             /* read band-limited copies of the table */
         FUNC    *ftp;
         FUNC    FF;
 } OSC;
@@ -0,0 +1,92 @@
+/*
+    vecops.h:
+
+    Copyright (C) 2026 The Csound developers
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+                                                /*      VECOPS.H        */
+#ifndef CSOUND_VECOPS_H
+#define CSOUND_VECOPS_H
+
+/* Vector kernels for the a-rate operators of aops.c.  Each instruction
+   set (AVX2, SSE2, NEON, or plain C) has a table of them, and the best
+   one the CPU supports is chosen the first time VECOPS() is used.  The
+   kernels work on n samples from the start of their arguments, which may
+   be unaligned and may be the same array; the caller deals with the
+   ksmps_offset and ksmps_no_end edges.  Results are the same, sample for
+   sample, as the scalar C of the operators they replace.
+
+   Naming: vv takes two vectors, sv a scalar and a vector, and vs a
+   vector and a scalar, in the order of the operands.
+
+   The sample format kernels at the end are for sampconv.c.  */
+
+typedef struct {
+    const char  *name;
+    void (*add_vv)(MYFLT *r, const MYFLT *a, const MYFLT *b, uint32_t n);
+    void (*sub_vv)(MYFLT *r, const MYFLT *a, const MYFLT *b, uint32_t n);
+    void (*mul_vv)(MYFLT *r, const MYFLT *a, const MYFLT *b, uint32_t n);
+    void (*div_vv)(MYFLT *r, const MYFLT *a, const MYFLT *b, uint32_t n);
+    void (*add_sv)(MYFLT *r, MYFLT a, const MYFLT *b, uint32_t n);
+    void (*sub_sv)(MYFLT *r, MYFLT a, const MYFLT *b, uint32_t n);
+    void (*mul_sv)(MYFLT *r, MYFLT a, const MYFLT *b, uint32_t n);
+    void (*div_sv)(MYFLT *r, MYFLT a, const MYFLT *b, uint32_t n);
+    void (*add_vs)(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n);
+    void (*sub_vs)(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n);
+    void (*mul_vs)(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n);
+    void (*div_vs)(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n);
+    /* a / b, or def where b is zero */
+    void (*divz_vv)(MYFLT *r, const MYFLT *a, const MYFLT *b, MYFLT def,
+                    uint32_t n);
+    void (*divz_sv)(MYFLT *r, MYFLT a, const MYFLT *b, MYFLT def,
+                    uint32_t n);
+    /* int(), frac(), round(), floor() and ceil() */
+    void (*trunc)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void (*frac)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void (*round)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void (*floor)(MYFLT *r, const MYFLT *a, uint32_t n);
+    void (*ceil)(MYFLT *r, const MYFLT *a, uint32_t n);
+    /* r = a * scale + d, limited to lo..hi and rounded as lrint() does;
+       d is dither noise, or NULL for none */
+    void (*quant)(int32_t *r, const MYFLT *a, const MYFLT *d, MYFLT scale,
+                  MYFLT lo, MYFLT hi, uint32_t n);
+    /* r = a * scale, from int32 and from and to float */
+    void (*from_int)(MYFLT *r, const int32_t *a, MYFLT scale, uint32_t n);
+    void (*from_float)(MYFLT *r, const float *a, MYFLT scale, uint32_t n);
+    void (*to_float)(float *r, const MYFLT *a, MYFLT scale, uint32_t n);
+} CS_VECOPS;
+
+extern const CS_VECOPS *cs_vecops;
+
+/**
+ * Returns the kernels for the instruction set called name ("avx2",
+ * "sse2", "neon" or "c"), or for the best one available if name is NULL.
+ * Returns NULL if this build or CPU cannot run the one asked for.
+ */
+const CS_VECOPS *cs_vecops_find(const char *name);
+
+/**
+ * Sets cs_vecops to the best kernels available, and returns it.
+ */
+const CS_VECOPS *cs_vecops_init(void);
+
+#define VECOPS() \
+    (LIKELY(cs_vecops != NULL) ? cs_vecops : cs_vecops_init())
+
+#endif  /* CSOUND_VECOPS_H */
@@ -23,10 +23,30 @@
 
 #include <csoundCore.h>
 
+/* Single producer, single consumer ring.  wp is only written by the
+   producer and rp only by the consumer; each side publishes its index
+   after touching the data (release) and reads the other side's index
+   before touching the data (acquire).  One element is always left free
+   to tell a full buffer from an empty one. */
+
+#ifdef HAVE_ATOMIC_BUILTIN
+#define CB_ACQUIRE(x)   cb_acquire(&(x))
+#define CB_RELEASE(x,v) { __sync_synchronize(); (x) = (v); }
+static inline int cb_acquire(volatile int *x)
+{
+    int v = *x;
+    __sync_synchronize();
+    return v;
+}
+#else
+#define CB_ACQUIRE(x)   (x)
+#define CB_RELEASE(x,v) { (x) = (v); }
+#endif
+
 typedef struct _circular_buffer {
   char *buffer;
-  int  wp;
-  int rp;
+  volatile int  wp;
+  volatile int rp;
   int numelem;
   int elemsize; /* in number of bytes */
 } circular_buffer;
@@ -48,8 +68,7 @@ void *csoundCreateCircularBuffer(CSOUND *csound, int numelem, int elemsize){
     return (void *)p;
 }
 
-static int checkspace(circular_buffer *p, int writeCheck){
-    int wp = p->wp, rp = p->rp, numelem = p->numelem;
+static int checkspace(int wp, int rp, int numelem, int writeCheck){
     if(writeCheck){
       if (wp > rp) return rp - wp + numelem - 1;
       else if (wp < rp) return rp - wp - 1;
@@ -62,28 +81,33 @@ static int checkspace(circular_buffer *p, int writeCheck){
     }
 }
 
+/* copy items out starting at rp, in at most two blocks; returns new rp */
+static int copyout(circular_buffer *p, int rp, char *out, int items)
+{
+    int elemsize = p->elemsize;
+    int first = p->numelem - rp;
+    if (first > items) first = items;
+    memcpy(out, p->buffer + elemsize * rp, elemsize * first);
+    if (items > first)
+      memcpy(out + elemsize * first, p->buffer, elemsize * (items - first));
+    rp += items;
+    return rp >= p->numelem ? rp - p->numelem : rp;
+}
+
 int csoundReadCircularBuffer(CSOUND *csound, void *p, void *out, int items)
 {
     if (p == NULL) return 0;
     {
-      int remaining;
-      int itemsread, numelem = ((circular_buffer *)p)->numelem;
-      int elemsize = ((circular_buffer *)p)->elemsize;
-      int i=0, rp = ((circular_buffer *)p)->rp;
-      char *buffer = ((circular_buffer *)p)->buffer;
+      circular_buffer *cb = (circular_buffer *) p;
+      int remaining, itemsread, rp = cb->rp;
       IGN(csound);
-      if ((remaining = checkspace(p, 0)) == 0) {
+      if ((remaining = checkspace(CB_ACQUIRE(cb->wp), rp,
+                                  cb->numelem, 0)) == 0) {
         return 0;
       }
       itemsread = items > remaining ? remaining : items;
-      for (i=0; i < itemsread; i++){
-        memcpy((char *) out + (i * elemsize),
-               &(buffer[elemsize * rp++]),  elemsize);
-        if (rp == numelem) {
-          rp = 0;
-        }
-      }
-      ((circular_buffer *)p)->rp = rp;
+      rp = copyout(cb, rp, (char *) out, itemsread);
+      CB_RELEASE(cb->rp, rp);
       return itemsread;
     }
 }
@@ -92,23 +116,15 @@ int csoundPeekCircularBuffer(CSOUND *csound, void *p, void *out, int items)
 {
     if (p == NULL) return 0;
     {
-      int remaining;
-      int itemsread, numelem = ((circular_buffer *)p)->numelem;
-      int elemsize = ((circular_buffer *)p)->elemsize;
-      int i=0, rp = ((circular_buffer *)p)->rp;
-      char *buffer = ((circular_buffer *)p)->buffer;
+      circular_buffer *cb = (circular_buffer *) p;
+      int remaining, itemsread, rp = cb->rp;
       IGN(csound);
-      if ((remaining = checkspace(p, 0)) == 0) {
+      if ((remaining = checkspace(CB_ACQUIRE(cb->wp), rp,
+                                  cb->numelem, 0)) == 0) {
         return 0;
       }
       itemsread = items > remaining ? remaining : items;
-      for(i=0; i < itemsread; i++){
-        memcpy((char *) out + (i * elemsize),
-               &(buffer[elemsize * rp++]),  elemsize);
-        if (rp == numelem) {
-          rp = 0;
-        }
-      }
+      copyout(cb, rp, (char *) out, itemsread);
       return itemsread;
     }
 }
@@ -117,20 +133,10 @@ void csoundFlushCircularBuffer(CSOUND *csound, void *p)
 {
   if (p == NULL) return;
     {
-      int remaining;
-      int itemsread, numelem = ((circular_buffer *)p)->numelem;
-      int i=0, rp = ((circular_buffer *)p)->rp;
-      //MYFLT *buffer = ((circular_buffer *)p)->buffer;
+      circular_buffer *cb = (circular_buffer *) p;
       IGN(csound);
-      if ((remaining = checkspace(p, 0)) == 0) {
-        return;
-      }
-      itemsread = numelem > remaining ? remaining: numelem;
-      for (i=0; i < itemsread; i++){
-        rp++;
-        if(rp == numelem) rp = 0;
-      }
-      ((circular_buffer *)p)->rp = rp;
+      /* discard everything written so far */
+      CB_RELEASE(cb->rp, CB_ACQUIRE(cb->wp));
     }
 }
 
@@ -139,26 +145,83 @@ int csoundWriteCircularBuffer(CSOUND *csound, void *p, const void *in, int items
 {
     if (p == NULL) return 0;
     {
-      int remaining;
-      int itemswrite, numelem = ((circular_buffer *)p)->numelem;
-      int elemsize = ((circular_buffer *)p)->elemsize;
-      int i=0, wp = ((circular_buffer *)p)->wp;
-      char *buffer = ((circular_buffer *)p)->buffer;
+      circular_buffer *cb = (circular_buffer *) p;
+      int remaining, itemswrite, first, wp = cb->wp;
+      int numelem = cb->numelem, elemsize = cb->elemsize;
       IGN(csound);
-      if ((remaining = checkspace(p, 1)) == 0) {
+      if ((remaining = checkspace(wp, CB_ACQUIRE(cb->rp), numelem, 1)) == 0) {
         return 0;
       }
       itemswrite = items > remaining ? remaining : items;
-      for(i=0; i < itemswrite; i++){
-        memcpy(&(buffer[elemsize * wp++]),
-               ((char *) in) + (i * elemsize),  elemsize);
-        if(wp == numelem) wp = 0;
-      }
-      ((circular_buffer *)p)->wp = wp;
+      first = numelem - wp;
+      if (first > itemswrite) first = itemswrite;
+      memcpy(cb->buffer + elemsize * wp, in, elemsize * first);
+      if (itemswrite > first)
+        memcpy(cb->buffer, (const char *) in + elemsize * first,
+               elemsize * (itemswrite - first));
+      wp += itemswrite;
+      if (wp >= numelem) wp -= numelem;
+      CB_RELEASE(cb->wp, wp);
       return itemswrite;
     }
 }
 
+/* Zero-copy access: the reserve calls return a pointer into the buffer and
+   the number of contiguous elements (at most items) that may be written or
+   read there; the matching commit makes them visible to the other side. */
+
+int csoundReserveCircularBufferWrite(CSOUND *csound, void *p,
+                                     void **ptr, int items)
+{
+    circular_buffer *cb = (circular_buffer *) p;
+    int remaining, wp;
+    IGN(csound);
+    if (p == NULL) return 0;
+    wp = cb->wp;
+    remaining = checkspace(wp, CB_ACQUIRE(cb->rp), cb->numelem, 1);
+    if (remaining > cb->numelem - wp) remaining = cb->numelem - wp;
+    if (items > remaining) items = remaining;
+    *ptr = cb->buffer + cb->elemsize * wp;
+    return items;
+}
+
+void csoundCommitCircularBufferWrite(CSOUND *csound, void *p, int items)
+{
+    circular_buffer *cb = (circular_buffer *) p;
+    int wp;
+    IGN(csound);
+    if (p == NULL) return;
+    wp = cb->wp + items;
+    if (wp >= cb->numelem) wp -= cb->numelem;
+    CB_RELEASE(cb->wp, wp);
+}
+
+int csoundReserveCircularBufferRead(CSOUND *csound, void *p,
+                                    void **ptr, int items)
+{
+    circular_buffer *cb = (circular_buffer *) p;
+    int remaining, rp;
+    IGN(csound);
+    if (p == NULL) return 0;
+    rp = cb->rp;
+    remaining = checkspace(CB_ACQUIRE(cb->wp), rp, cb->numelem, 0);
+    if (remaining > cb->numelem - rp) remaining = cb->numelem - rp;
+    if (items > remaining) items = remaining;
+    *ptr = cb->buffer + cb->elemsize * rp;
+    return items;
+}
+
+void csoundCommitCircularBufferRead(CSOUND *csound, void *p, int items)
+{
+    circular_buffer *cb = (circular_buffer *) p;
+    int rp;
+    IGN(csound);
+    if (p == NULL) return;
+    rp = cb->rp + items;
+    if (rp >= cb->numelem) rp -= cb->numelem;
+    CB_RELEASE(cb->rp, rp);
+}
+
 void csoundDestroyCircularBuffer(CSOUND *csound, void *p){
     if(p == NULL) return;
     csound->Free(csound, ((circular_buffer *)p)->buffer);
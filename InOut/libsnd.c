@@ -23,6 +23,7 @@
 
 #include "csoundCore.h"                 /*             SNDLIB.C         */
 #include "soundio.h"
+#include "sampconv.h"
 #include <stdlib.h>
 #ifdef HAVE_SYS_TYPES_H
 # include <sys/types.h>
@@ -57,14 +58,50 @@ static inline void alloc_globals(CSOUND *csound)
    audtran to flush when this happens.
 */
 
-static void spoutsf(CSOUND *csound)
+/* Peak and out-of-range statistics for one block of interleaved output,
+   taken per channel over whole frames.  The results are the same as
+   testing each sample in turn: maxpos is the first frame at which a new
+   peak is reached. */
+
+static inline void spout_stats(CSOUND *csound, const MYFLT *sp, int nsmps,
+                               int chkrange)
 {
-    uint32_t   chn = 0;
-    int     n;
-    int spoutrem = csound->nspout;
-    MYFLT   *sp = csound->spout;
-    MYFLT   absamp = FL(0.0);
+    int     chans = (csound->multichan ? (int) csound->nchnls : 1);
+    int     frames = nsmps / chans, chn, i;
     uint32  nframes = csound->libsndStatics.nframes;
+    MYFLT   e0dbfs = csound->e0dbfs;
+
+    for (chn = 0; chn < chans; chn++) {
+      const MYFLT *p = sp + chn;
+      MYFLT   peak = FL(0.0), absamp;
+      int     over = 0;
+      for (i = 0; i < frames; i++) {        /* branch-free reductions */
+        absamp = FABS(p[i * chans]);
+        peak = (absamp > peak ? absamp : peak);
+        over += (absamp > e0dbfs);
+      }
+      if (peak > csound->maxamp[chn]) {     /*  maxamp this seg  */
+        for (i = 0; FABS(p[i * chans]) != peak; i++)
+          ;
+        csound->maxamp[chn] = peak;
+        csound->maxpos[chn] = nframes + (uint32) i;
+      }
+      if (chkrange && over) {               /* out of range?     */
+        csound->rngcnt[chn] += over;        /*  report it        */
+        csound->rngflg = 1;
+      }
+    }
+    csound->libsndStatics.nframes = nframes + (uint32) frames;
+}
+
+/* copy n samples of spout to the output buffer, flushing it when full */
+
+static inline void spout_write(CSOUND *csound, const MYFLT *sp, int spoutrem,
+                               MYFLT scl)
+{
+    int     n, i;
+    MYFLT   *op;
+
  nchk:
     /* if nspout remaining > buf rem, prepare to send in parts */
     if ((n = spoutrem) > (int) csound->libsndStatics.outbufrem) {
@@ -72,31 +109,16 @@ static void spoutsf(CSOUND *csound)
     }
     spoutrem -= n;
     csound->libsndStatics.outbufrem -= n;
-    do {
-      absamp = *sp++;
-      if (csound->libsndStatics.osfopen) {
-        *csound->libsndStatics.outbufp++ = (absamp * csound->dbfs_to_float);
-      }
-      if (absamp < FL(0.0)) {
-        absamp = -absamp;
-      }
-      if (absamp > csound->maxamp[chn]) {   /*  maxamp this seg  */
-        csound->maxamp[chn] = absamp;
-        csound->maxpos[chn] = nframes;
-      }
-      if (absamp > csound->e0dbfs) {        /* out of range?     */
-        csound->rngcnt[chn]++;              /*  report it        */
-        csound->rngflg = 1;
-      }
-      if (csound->multichan) {
-        if (++chn >= csound->nchnls) {
-            chn = 0;
-            nframes++;
-        }
-      } else {
-        nframes++;
-      }
-    } while (--n);
+    if (csound->libsndStatics.osfopen) {
+      op = csound->libsndStatics.outbufp;
+      if (scl == FL(1.0))
+        memcpy(op, sp, n * sizeof(MYFLT));
+      else
+        for (i = 0; i < n; i++)
+          op[i] = sp[i] * scl;
+      csound->libsndStatics.outbufp = op + n;
+    }
+    sp += n;
     if (!csound->libsndStatics.outbufrem) {
       if (csound->libsndStatics.osfopen) {
         csound->nrecs++;
@@ -109,50 +131,20 @@ static void spoutsf(CSOUND *csound)
           goto nchk;
       }
     }
-    csound->libsndStatics.nframes = nframes;
+}
+
+static void spoutsf(CSOUND *csound)
+{
+    spout_stats(csound, csound->spout, csound->nspout, 1);
+    spout_write(csound, csound->spout, csound->nspout, csound->dbfs_to_float);
 }
 
 /* special version of spoutsf for "raw" floating point files */
 
 static void spoutsf_noscale(CSOUND *csound)
 {
-    uint32_t chn = 0;
-    int      n, spoutrem = csound->nspout;
-    MYFLT    *sp = csound->spout;
-    MYFLT    absamp = FL(0.0);
-    uint32   nframes = csound->libsndStatics.nframes;
-
- nchk:
-    /* if nspout remaining > buf rem, prepare to send in parts */
-    if ((n = spoutrem) > (int) csound->libsndStatics.outbufrem)
-      n = (int)csound->libsndStatics.outbufrem;
-    spoutrem -= n;
-    csound->libsndStatics.outbufrem -= n;
-    do {
-      absamp = *sp++;
-      if (csound->libsndStatics.osfopen)
-        *csound->libsndStatics.outbufp++ = absamp;
-      if (absamp < FL(0.0))
-        absamp = -absamp;
-      if (absamp > csound->maxamp[chn]) {   /*  maxamp this seg  */
-        csound->maxamp[chn] = absamp;
-        csound->maxpos[chn] = nframes;
-      }
-      if (++chn >= csound->nchnls)
-        chn = 0, nframes++;
-    } while (--n);
-
-    if (!csound->libsndStatics.outbufrem) {
-      if (csound->libsndStatics.osfopen) {
-        csound->nrecs++;
-        csound->audtran(csound, csound->libsndStatics.outbuf,
-                        csound->libsndStatics.outbufsiz); /* Flush buffer */
-        csound->libsndStatics.outbufp = (MYFLT*) csound->libsndStatics.outbuf;
-      }
-      csound->libsndStatics.outbufrem = csound->oparms_.outbufsamps;
-      if (spoutrem) goto nchk;
-    }
-    csound->libsndStatics.nframes = nframes;
+    spout_stats(csound, csound->spout, csound->nspout, 0);
+    spout_write(csound, csound->spout, csound->nspout, FL(1.0));
 }
 
 /* diskfile write option for audtran's */
@@ -197,207 +189,33 @@ static void writesf(CSOUND *csound, const MYFLT *outbuf, int nbytes)
     }
 }
 
-static void writesf_dither_16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
-{
-    OPARMS  *O = csound->oparms;
-    int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
-
-    if (UNLIKELY(STA(outfile) == NULL))
-      return;
-
-    for (n=0; n<m; n++) {
-      int   tmp = ((STA(dither) * 15625) + 1) & 0xFFFF;
-      int   rnd = ((tmp * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      STA(dither) = rnd;
-      rnd = (rnd+tmp)>>1;           /* triangular distribution */
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7fff);
-      buf[n] += result;
-    }
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
-    }
-}
+/* dither, then as writesf(); the buffer is changed in place */
 
-static void writesf_dither_8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+static void writesf_dither(CSOUND *csound, const MYFLT *outbuf, int nbytes)
 {
-    OPARMS  *O = csound->oparms;
-    int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
-
-    if (UNLIKELY(STA(outfile) == NULL))
-      return;
-
-    for (n=0; n<m; n++) {
-      int   tmp = ((STA(dither) * 15625) + 1) & 0xFFFF;
-      int   rnd = ((tmp * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      STA(dither) = rnd;
-      rnd = (rnd+tmp)>>1;           /* triangular distribution */
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7f);
-      buf[n] += result;
-    }
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
-    }
+    if (LIKELY(STA(outfile) != NULL))
+      cs_sampconv_dither(STA(dither), (MYFLT*) outbuf,
+                         nbytes / ((int) sizeof(MYFLT) * csound->nchnls));
+    writesf(csound, outbuf, nbytes);
 }
 
-static void writesf_dither_u16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
-{
-    OPARMS  *O = csound->oparms;
-    int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
-
-    if (UNLIKELY(STA(outfile) == NULL))
-      return;
-
-    for (n=0; n<m; n++) {
-        int   rnd = ((STA(dither) * 15625) + 1) & 0xFFFF;
-        MYFLT result;
-        STA(dither) = rnd;
-        result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-        result /= ((MYFLT) 0x7fff);
-        buf[n] += result;
-    }
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
-    }
-}
+/* select writesf() or writesf_dither(), for integer formats */
 
-static void writesf_dither_u8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+static void set_audtran(CSOUND *csound)
 {
     OPARMS  *O = csound->oparms;
-    int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
 
-    if (UNLIKELY(STA(outfile) == NULL))
-      return;
-
-    for (n=0; n<m; n++) {
-      int   rnd = ((STA(dither) * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      STA(dither) = rnd;
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7f);
-      buf[n] += result;
+    csound->audtran = writesf;
+    if (STA(dither) != NULL) {          /* the output is being reopened */
+      cs_sampconv_destroy(csound, STA(dither));
+      STA(dither) = NULL;
     }
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
+    if (csound->dither_output &&
+        O->outformat != AE_FLOAT && O->outformat != AE_DOUBLE) {
+      STA(dither) = cs_sampconv_create(csound, O->outformat, csound->nchnls,
+                                       csound->dither_output);
+      if (STA(dither) != NULL && STA(dither)->dither != CS_DITHER_NONE)
+        csound->audtran = writesf_dither;
     }
 }
 
@@ -702,23 +520,7 @@ void sfopenout(CSOUND *csound)                  /* init for sound out       */
       }
       else if (strcmp(fName, "null") == 0) {
         STA(outfile) = NULL;
-        if (csound->dither_output && csound->oparms->outformat!=AE_FLOAT &&
-            csound->oparms->outformat!=AE_DOUBLE) {
-          if (csound->oparms->outformat==AE_SHORT)
-            if (csound->dither_output==1)
-              csound->audtran = writesf_dither_16;
-            else
-              csound->audtran = writesf_dither_u16;
-          else if (csound->oparms->outformat==AE_CHAR)
-            if (csound->dither_output==1)
-              csound->audtran = writesf_dither_8;
-            else
-              csound->audtran = writesf_dither_u8;
-          else
-            csound->audtran = writesf;
-        }
-        else
-          csound->audtran = writesf;
+        set_audtran(csound);
         goto outset;
       }
     }
@@ -798,17 +600,7 @@ void sfopenout(CSOUND *csound)                  /* init for sound out       */
       csound->spoutran = spoutsf;       /* accumulate output */
     else
       csound->spoutran = spoutsf_noscale;
-    if (csound->dither_output && csound->oparms->outformat!=AE_FLOAT &&
-        csound->oparms->outformat!=AE_DOUBLE) {
-      if (csound->oparms->outformat==AE_SHORT)
-        csound->audtran = writesf_dither_16;
-      else if (csound->oparms->outformat==AE_CHAR)
-        csound->audtran = writesf_dither_8;
-      else
-        csound->audtran = writesf;
-    }
-    else
-      csound->audtran = writesf;
+    set_audtran(csound);
     /* Write any tags. */
     if ((s = csound->SF_id_title) != NULL && *s != '\0')
       sf_set_string(STA(outfile), SF_STR_TITLE, s);
@@ -886,6 +678,10 @@ void sfcloseout(CSOUND *csound)
       csound->nrecs++;
       csound->audtran(csound, STA(outbuf), nb);
     }
+    if (STA(dither) != NULL) {
+      cs_sampconv_destroy(csound, STA(dither));
+      STA(dither) = NULL;
+    }
     if (STA(pipdevout) == 2 && (!STA(isfopen) || STA(pipdevin) != 2)) {
       /* close only if not open for input too */
       csound->rtclose_callback(csound);
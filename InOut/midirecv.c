@@ -75,6 +75,19 @@
       Returns pointer to a string constant storing an error massage
       for error code 'errcode'.
 
+    Timestamped input:
+    ------------------
+
+    int csoundPushMidiInput(CSOUND *csound, const unsigned char *msg,
+                            int nbytes, double age);
+
+      A driver that reads MIDI input in its own thread can queue each
+      complete message as it arrives, with 'age' the number of seconds
+      since it was received (zero if just now). Note on messages are
+      then started at the matching sample offset within the next
+      k-cycle, instead of at its start. Only one thread may push, and
+      MidiReadCallback should return zero for messages queued this way.
+
     Setting function pointers:
     --------------------------
 
@@ -128,6 +141,11 @@ void MidiOpen(CSOUND *csound)
     p->sexp = 0;
     /* Then open device... */
     if (O->Midiin) {
+      /* the queue must exist before the driver starts its thread */
+      p->tsQueue = csoundCreateCircularBuffer(csound, MIDITSQSIZE,
+                                              sizeof(MIDITSMSG));
+      p->tsPrev = p->tsNow = csoundGetRealTime(csound->csRtClock);
+      p->tsKcnt = -1L;
       if (p->MidiInOpenCallback == NULL)
         csound->Die(csound, Str(" *** no callback for opening MIDI input"));
       if (p->MidiReadCallback == NULL)
@@ -471,6 +489,40 @@ static void midNotesOff(CSOUND *csound)
     } while (++chan < MAXCHAN);
 }
 
+/* queue a complete message from a driver or host thread */
+
+PUBLIC int csoundPushMidiInput(CSOUND *csound, const unsigned char *msg,
+                               int nbytes, double age)
+{
+    MGLOBAL   *p = csound->midiGlobals;
+    MIDITSMSG m;
+
+    if (UNLIKELY(p->tsQueue == NULL || nbytes < 1 || nbytes > 3))
+      return CSOUND_ERROR;
+    m.time = csoundGetRealTime(csound->csRtClock) - age;
+    memcpy(m.msg, msg, (size_t) nbytes);
+    m.nbytes = (unsigned char) nbytes;
+    if (UNLIKELY(csoundWriteCircularBuffer(csound, p->tsQueue, &m, 1) != 1))
+      return CSOUND_MEMORY;
+    return OK;
+}
+
+/* sample offset in this k-cycle for a message that arrived at time t: */
+/* the interval since the previous k-cycle is mapped onto this one */
+
+static int midi_ts_offset(CSOUND *csound, MGLOBAL *p, double t)
+{
+    double  span = p->tsNow - p->tsPrev;
+    int     n;
+
+    if (span <= 0.0)
+      return 0;
+    n = (int) ((t - p->tsPrev) / span * (double) csound->ksmps);
+    if (n >= (int) csound->ksmps)
+      n = (int) csound->ksmps - 1;
+    return (n < 0 ? 0 : n);
+}
+
 /* sense a MIDI event, collect the data & dispatch */
 /* called from sensevents(), returns 2 if MIDI on/off */
 
@@ -482,10 +534,25 @@ int sensMidi(CSOUND *csound)
     int     n;
     int16   c, type;
 
+    if (p->tsQueue != NULL && p->tsKcnt != csound->kcounter) {
+      p->tsKcnt = csound->kcounter;
+      p->tsPrev = p->tsNow;
+      p->tsNow = csoundGetRealTime(csound->csRtClock);
+    }
  nxtchr:
     if (p->bufp >= p->endatp) {
+      MIDITSMSG m;
       p->bufp = &(p->mbuf[0]);
       p->endatp = p->bufp;
+      p->tsOffset = 0;
+      /* timestamped messages first, one at a time */
+      if (p->tsQueue != NULL && !csound->advanceCnt &&
+          csoundReadCircularBuffer(csound, p->tsQueue, &m, 1) == 1) {
+        memcpy(p->endatp, m.msg, (size_t) m.nbytes);
+        p->endatp += (int) m.nbytes;
+        p->tsOffset = midi_ts_offset(csound, p, m.time);
+        goto nxtchr;
+      }
       if (O->Midiin && !csound->advanceCnt) {   /* read MIDI device */
         n = p->MidiReadCallback(csound, p->midiInUserData, p->bufp, MBUFSIZ);
         if (n < 0)
@@ -602,6 +669,11 @@ void MidiClose(CSOUND *csound)
                        retval, csoundExternalMidiErrorString(csound, retval));
     }
     p->midiInUserData = NULL;
+    /* the driver has stopped pushing messages by now */
+    if (p->tsQueue != NULL) {
+      csoundDestroyCircularBuffer(csound, p->tsQueue);
+      p->tsQueue = NULL;
+    }
     if (p->MIDIoutDONE && p->MidiOutCloseCallback != NULL) {
       retval = p->MidiOutCloseCallback(csound, p->midiOutUserData);
       if (retval != 0)
@@ -41,6 +41,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/select.h>
+#include <poll.h>
 #include <termios.h>
 #include <errno.h>
 #include <stdio.h>
@@ -64,11 +65,7 @@ typedef struct devparams_ {
     int             nchns;          /* number of channels               */
     int             buffer_smps;    /* buffer length in samples         */
     int             period_smps;    /* period time in samples           */
-    /* playback sample conversion function */
-    void            (*playconv)(int, MYFLT *, void *, int *);
-    /* record sample conversion function */
-    void            (*rec_conv)(int, void *, MYFLT *);
-    int             seed;           /* random seed for dithering        */
+    CS_SAMPCONV     *conv;          /* sample format converter          */
 } DEVPARAMS;
 
 #ifdef BUF_SIZE
@@ -76,12 +73,26 @@ typedef struct devparams_ {
 #endif
 #define BUF_SIZE  4096
 
+/* MIDI input reader thread (see midi_reader_start()) */
+
+typedef struct alsaMidiReader_ {
+    CSOUND         *csound;
+    void           *thread;
+    volatile int   running;
+    struct pollfd  *pfds;
+    int            npfds;
+    int            (*read)(CSOUND *, void *, unsigned char *, int);
+    void           *userData;
+    unsigned char  status;          /* running status, or zero */
+} alsaMidiReader;
+
 typedef struct alsaMidiInputDevice_ {
     unsigned char  buf[BUF_SIZE];
     snd_rawmidi_t  *dev;
     int            bufpos, nbytes, datreq;
     unsigned char  prvStatus, dat1, dat2;
     struct alsaMidiInputDevice_ *next;
+    alsaMidiReader *reader;         /* first device in the list only */
 } alsaMidiInputDevice;
 
 
@@ -98,6 +109,7 @@ typedef struct alsaseqMidi_ {
     snd_seq_event_t       sev;
     snd_seq_client_info_t *cinfo;
     snd_seq_port_info_t   *pinfo;
+    alsaMidiReader        *reader;
 } alsaseqMidi;
 
 static const unsigned char dataBytes[16] = {
@@ -142,162 +154,17 @@ int set_scheduler_priority(CSOUND *csound, int priority)
 }
 
 
-/* sample conversion routines for playback */
-
-static void MYFLT_to_short(int nSmps, MYFLT *inBuf, int16_t *outBuf, int *seed)
-{
-    MYFLT tmp_f;
-    int   tmp_i;
-    int n;
-    for (n=0; n<nSmps; n++) {
-      int rnd = (((*seed) * 15625) + 1) & 0xFFFF;
-      *seed = (((rnd) * 15625) + 1) & 0xFFFF;
-      rnd += *seed;           /* triangular distribution */
-      tmp_f = (MYFLT) ((rnd>>1) - 0x8000) * (FL(1.0) / (MYFLT) 0x10000);
-      tmp_f += inBuf[n] * (MYFLT) 0x8000;
-#ifndef USE_DOUBLE
-      tmp_i = (int) lrintf(tmp_f);
-#else
-      tmp_i = (int) lrint(tmp_f);
-#endif
-      if (tmp_i < -0x8000) tmp_i = -0x8000;
-      if (tmp_i > 0x7FFF) tmp_i = 0x7FFF;
-      outBuf[n] = (int16_t) tmp_i;
-    }
-}
-
-static void MYFLT_to_short_u(int nSmps, MYFLT *inBuf, int16_t *outBuf, int *seed)
-{
-    MYFLT tmp_f;
-    int   tmp_i;
-    int n;
-    for (n=0; n<nSmps; n++) {
-      int rnd = (((*seed) * 15625) + 1) & 0xFFFF;
-      *seed = rnd;
-      tmp_f = (MYFLT) (rnd - 0x8000) * (FL(1.0) / (MYFLT) 0x10000);
-      tmp_f += inBuf[n] * (MYFLT) 0x8000;
-#ifndef USE_DOUBLE
-      tmp_i = (int) lrintf(tmp_f);
-#else
-      tmp_i = (int) lrint(tmp_f);
-#endif
-      if (tmp_i < -0x8000) tmp_i = -0x8000;
-      if (tmp_i > 0x7FFF) tmp_i = 0x7FFF;
-      outBuf[n] = (int16_t) tmp_i;
-    }
-}
-
-static void MYFLT_to_short_no_dither(int nSmps, MYFLT *inBuf,
-                                     int16_t *outBuf, int *seed)
-{
-    MYFLT tmp_f;
-    int   tmp_i;
-    int n;
-    for (n=0; n<nSmps; n++) {
-      tmp_f = inBuf[n] * (MYFLT) 0x8000;
-#ifndef USE_DOUBLE
-      tmp_i = (int) lrintf(tmp_f);
-#else
-      tmp_i = (int) lrint(tmp_f);
-#endif
-      if (tmp_i < -0x8000) tmp_i = -0x8000;
-      if (tmp_i > 0x7FFF) tmp_i = 0x7FFF;
-      outBuf[n] = (int16_t) tmp_i;
-    }
-}
-
-static void MYFLT_to_long(int nSmps, MYFLT *inBuf, int32_t *outBuf, int *seed)
-{
-    MYFLT   tmp_f;
-    int64_t tmp_i;
-    (void) seed;
-    int n;
-    for (n=0; n<nSmps; n++) {
-      tmp_f = inBuf[n] * (MYFLT) 0x80000000UL;
-#ifndef USE_DOUBLE
-      tmp_i = (int64_t) llrintf(tmp_f);
-#else
-      tmp_i = (int64_t) llrint(tmp_f);
-#endif
-      if (tmp_i < -((int64_t) 0x80000000UL))
-        tmp_i = -((int64_t) 0x80000000UL);
-      if (tmp_i > (int64_t) 0x7FFFFFFF) tmp_i = (int64_t) 0x7FFFFFFF;
-      outBuf[n] = (int32_t) tmp_i;
-    }
-}
-
-static void MYFLT_to_float(int nSmps, MYFLT *inBuf, float *outBuf, int *seed)
-{
-    (void) seed;
-    int n;
-    for (n=0; n<nSmps; n++)
-      outBuf[n] = (float) inBuf[n];
-}
-
-/* sample conversion routines for recording */
-
-static void short_to_MYFLT(int nSmps, int16_t *inBuf, MYFLT *outBuf)
-{
-    int n;
-    MYFLT adjust = FL(1.0) / (MYFLT) 0x8000;
-    for (n=0; n<nSmps; n++)
-      outBuf[n] = (MYFLT) inBuf[n] * adjust;
-}
-
-static void long_to_MYFLT(int nSmps, int32_t *inBuf, MYFLT *outBuf)
-{
-    int n;
-    MYFLT adjust = FL(1.0) / (MYFLT) 0x80000000UL;
-    for (n=0; n<nSmps; n++)
-      outBuf[n] = (MYFLT) inBuf[n] * adjust;
-}
-
-static void float_to_MYFLT(int nSmps, float *inBuf, MYFLT *outBuf)
-{
-    int n;
-    for (n=0; n<nSmps; n++)
-      outBuf[n] = (MYFLT) inBuf[n];
-}
-
 /* select sample format */
 
-static snd_pcm_format_t set_format(void (**convFunc)(void), int csound_format,
-                                   int play, int csound_dither)
+static snd_pcm_format_t set_format(int csound_format)
 {
     int16   endian_test = 0x1234;
 
-    (*convFunc) = NULL;
-    /* select conversion routine */
-    switch (csound_format) {
-    case AE_SHORT:
-      if (play) {
-        if (csound_dither==1)
-          *convFunc = (void (*)(void)) MYFLT_to_short;
-        else if (csound_dither==2)
-          *convFunc = (void (*)(void)) MYFLT_to_short_u;
-        else
-          *convFunc = (void (*)(void)) MYFLT_to_short_no_dither;
-      }
-      else
-        *convFunc = (void (*)(void)) short_to_MYFLT;
-      break;
-    case AE_LONG:
-      if (play)
-        *convFunc = (void (*)(void)) MYFLT_to_long;
-      else
-        *convFunc = (void (*)(void)) long_to_MYFLT;
-      break;
-    case AE_FLOAT:
-      if (play)
-        *convFunc = (void (*)(void)) MYFLT_to_float;
-      else
-        *convFunc = (void (*)(void)) float_to_MYFLT;
-      break;
-    }
     if (*((unsigned char*) (&endian_test)) == (unsigned char) 0x34) {
       /* little-endian */
       switch (csound_format) {
       case AE_SHORT:  return SND_PCM_FORMAT_S16_LE;
+      case AE_24INT:  return SND_PCM_FORMAT_S24_3LE;
       case AE_LONG:   return SND_PCM_FORMAT_S32_LE;
       case AE_FLOAT:  return SND_PCM_FORMAT_FLOAT_LE;
       }
@@ -306,6 +173,7 @@ static snd_pcm_format_t set_format(void (**convFunc)(void), int csound_format,
       /* big-endian */
       switch (csound_format) {
       case AE_SHORT:  return SND_PCM_FORMAT_S16_BE;
+      case AE_24INT:  return SND_PCM_FORMAT_S24_3BE;
       case AE_LONG:   return SND_PCM_FORMAT_S32_BE;
       case AE_FLOAT:  return SND_PCM_FORMAT_FLOAT_BE;
       }
@@ -361,17 +229,15 @@ static int set_device_params(CSOUND *csound, DEVPARAMS *dev, int play)
     /* sample format, */
     alsaFmt = SND_PCM_FORMAT_UNKNOWN;
     dev->sampleSize = (int) sizeof(MYFLT) * dev->nchns;
-    {
-      void  (*fp)(void) = NULL;
-      alsaFmt = set_format(&fp, dev->format, play, csound->GetDitherMode(csound));
-      if (play) dev->playconv = (void (*)(int, MYFLT*, void*, int*)) fp;
-      else      dev->rec_conv = (void (*)(int, void*, MYFLT*)) fp;
-    }
+    alsaFmt = set_format(dev->format);
     if (alsaFmt == SND_PCM_FORMAT_UNKNOWN) {
-      strncpy(msg, Str("Unknown sample format.\n *** Only 16-bit and 32-bit "
-                       "integers, and 32-bit floats are supported."), MSGLEN);
+      strncpy(msg, Str("Unknown sample format.\n *** Only 16-bit, 24-bit and "
+                       "32-bit integers, and 32-bit floats are supported."),
+              MSGLEN);
       goto err_return_msg;
     }
+    dev->conv = csound->CreateSampleConverter(csound, dev->format, dev->nchns,
+                            (play ? csound->GetDitherMode(csound) : 0));
     if (snd_pcm_hw_params_set_format(dev->handle, hw_params, alsaFmt) < 0) {
       strncpy(msg,
               Str("Unable to set requested sample format on soundcard"),MSGLEN);
@@ -461,7 +327,7 @@ static int set_device_params(CSOUND *csound, DEVPARAMS *dev, int play)
       goto err_return_msg;
     }
     /* allocate memory for sample conversion buffer */
-    n = (dev->format == AE_SHORT ? 2 : 4) * dev->nchns * alloc_smps;
+    n = csound->SampleConverterSize(dev->conv) * dev->nchns * alloc_smps;
     dev->buf = (void*) malloc((size_t) n);
     if (dev->buf == NULL) {
       strncpy(msg, Str("Memory allocation failure"),MSGLEN);
@@ -592,12 +458,11 @@ static int open_device(CSOUND *csound, const csRtAudioParams *parm, int play)
     dev->nchns = parm->nChannels;
     dev->buffer_smps = parm->bufSamp_HW;
     dev->period_smps = parm->bufSamp_SW;
-    dev->playconv = (void (*)(int, MYFLT*, void*, int*)) NULL;
-    dev->rec_conv = (void (*)(int, void*, MYFLT*)) NULL;
-    dev->seed = 1;
+    dev->conv = NULL;
     /* open device */
     retval = set_device_params(csound, dev, play);
     if (retval != 0) {
+      csound->DestroySampleConverter(csound, dev->conv);
       free(dev);
       *userDataPtr = NULL;
     }
@@ -668,7 +533,7 @@ static int rtrecord_(CSOUND *csound, MYFLT *inbuf, int nbytes)
       break;
     }
     /* convert samples to MYFLT */
-    dev->rec_conv(m * dev->nchns, dev->buf, inbuf);
+    csound->ConvertSamplesIn(dev->conv, inbuf, dev->buf, m);
     return (m * dev->sampleSize);
 }
 
@@ -686,7 +551,7 @@ static void rtplay_(CSOUND *csound, const MYFLT *outbuf, int nbytes)
     n = nbytes / dev->sampleSize;
 
     /* convert samples from MYFLT */
-    dev->playconv(n * dev->nchns, (MYFLT*) outbuf, dev->buf, &(dev->seed));
+    csound->ConvertSamplesOut(dev->conv, dev->buf, outbuf, n);
 
     while (n) {
       err = (int) snd_pcm_writei(dev->handle, dev->buf, (snd_pcm_uframes_t) n);
@@ -728,6 +593,7 @@ static void rtclose_(CSOUND *csound)
         snd_pcm_close(dev->handle);
       if (dev->buf != NULL)
         free(dev->buf);
+      csound->DestroySampleConverter(csound, dev->conv);
       free(dev);
     }
     dev = (DEVPARAMS*) (*(csound->GetRtPlayUserData(csound)));
@@ -737,10 +603,144 @@ static void rtclose_(CSOUND *csound)
         snd_pcm_close(dev->handle);
       if (dev->buf != NULL)
         free(dev->buf);
+      csound->DestroySampleConverter(csound, dev->conv);
       free(dev);
     }
 }
 
+/* The MIDI input drivers read in a thread of their own, which waits on */
+/* the poll descriptors of the device and queues each message with      */
+/* csoundPushMidiInput() as soon as it arrives.  Csound then starts     */
+/* notes at the sample where they were received, rather than at the     */
+/* start of the next k-cycle.  Channel messages sent with running       */
+/* status are queued with their status byte, so each is complete.      */
+
+static void midi_reader_push(alsaMidiReader *r,
+                             const unsigned char *buf, int n)
+{
+    CSOUND        *csound = r->csound;
+    unsigned char msg[3];
+    int           i = 0, len;
+
+    while (i < n) {
+      unsigned char c = buf[i];
+      if (c == (unsigned char) 0xF0) {          /* skip system exclusive */
+        r->status = 0;
+        while (i < n && buf[i] != (unsigned char) 0xF7)
+          i++;
+        i++;
+        continue;
+      }
+      if (c < (unsigned char) 0x80) {           /* data byte */
+        if (r->status == 0) {                   /* stray, skip it */
+          i++;
+          continue;
+        }
+        len = (int) dataBytes[(int) r->status >> 4];
+        if (i + len > n)
+          break;
+        msg[0] = r->status;
+        memcpy(&(msg[1]), &(buf[i]), (size_t) len);
+        csound->PushMidiInput(csound, &(msg[0]), len + 1, 0.0);
+        i += len;
+        continue;
+      }
+      if (c < (unsigned char) 0xF0)
+        r->status = c;
+      else if (c < (unsigned char) 0xF8)        /* system common */
+        r->status = 0;
+      if (c < (unsigned char) 0xF0)
+        len = 1 + (int) dataBytes[(int) c >> 4];
+      else if (c == (unsigned char) 0xF2)
+        len = 3;
+      else if (c == (unsigned char) 0xF1 || c == (unsigned char) 0xF3)
+        len = 2;
+      else
+        len = 1;
+      if (i + len > n)
+        break;
+      csound->PushMidiInput(csound, &(buf[i]), len, 0.0);
+      i += len;
+    }
+}
+
+static uintptr_t midi_reader_thread(void *userData)
+{
+    alsaMidiReader *r = (alsaMidiReader*) userData;
+    unsigned char  buf[BUF_SIZE];
+    int            i, n, got;
+
+    while (r->running) {
+      /* time out now and then to see if we should stop */
+      if (poll(r->pfds, (nfds_t) r->npfds, 50) <= 0)
+        continue;
+      got = 0;
+      while ((n = r->read(r->csound, r->userData, &(buf[0]), BUF_SIZE)) > 0) {
+        midi_reader_push(r, &(buf[0]), n);
+        got = 1;
+      }
+      if (got)
+        continue;
+      /* a device that has gone away stays ready with nothing to read */
+      for (i = 0; i < r->npfds; i++)
+        if (r->pfds[i].revents & (POLLERR | POLLHUP | POLLNVAL))
+          break;
+      if (i < r->npfds) {
+        r->csound->ErrorMsg(r->csound,
+                            Str("ALSA MIDI: input device failed, "
+                                "MIDI input stopped"));
+        break;
+      }
+    }
+    return (uintptr_t) 0;
+}
+
+static int midi_in_read(CSOUND *, void *, unsigned char *, int);
+static int alsaseq_in_read(CSOUND *, void *, unsigned char *, int);
+
+/* start a reader thread on 'npfds' poll descriptors, which it takes over */
+/* returns NULL if it cannot, and input is then polled every k-cycle     */
+
+static alsaMidiReader *midi_reader_start(CSOUND *csound,
+                                         struct pollfd *pfds, int npfds,
+                                         int (*read)(CSOUND *, void *,
+                                                     unsigned char *, int),
+                                         void *userData)
+{
+    alsaMidiReader *r;
+
+    if (pfds == NULL || npfds < 1 ||
+        (r = (alsaMidiReader*) calloc(1, sizeof(alsaMidiReader))) == NULL) {
+      free(pfds);
+      return NULL;
+    }
+    r->csound = csound;
+    r->pfds = pfds;
+    r->npfds = npfds;
+    r->read = read;
+    r->userData = userData;
+    r->running = 1;
+    r->thread = csound->CreateThread(midi_reader_thread, (void*) r);
+    if (r->thread == NULL) {
+      csound->Warning(csound, Str("ALSA MIDI: could not start input thread, "
+                                  "MIDI timing will be per k-cycle"));
+      free(r->pfds);
+      free(r);
+      return NULL;
+    }
+    return r;
+}
+
+static void midi_reader_stop(CSOUND *csound, alsaMidiReader *r)
+{
+    if (r == NULL)
+      return;
+    r->running = 0;
+    csound->JoinThread(r->thread);
+    free(r->pfds);
+    free(r);
+}
+
 static alsaMidiInputDevice* open_midi_device(CSOUND *csound, const char  *s)
 {
     int         err;
@@ -837,11 +837,36 @@ static int midi_in_open(CSOUND *csound, void **userData, const char *devName)
       *userData = NULL;
     }
     else {
+      struct pollfd *pfds;
+      int           npfds = 0;
+      for (newdev = dev; newdev != NULL; newdev = newdev->next)
+        npfds += snd_rawmidi_poll_descriptors_count(newdev->dev);
+      pfds = (struct pollfd*) calloc((size_t) npfds + 1, sizeof(struct pollfd));
+      if (pfds != NULL) {
+        npfds = 0;
+        for (newdev = dev; newdev != NULL; newdev = newdev->next)
+          npfds += snd_rawmidi_poll_descriptors(newdev->dev, &(pfds[npfds]),
+                     snd_rawmidi_poll_descriptors_count(newdev->dev));
+      }
+      dev->reader = midi_reader_start(csound, pfds, npfds, midi_in_read,
+                                      (void*) dev);
       *userData = (void*) dev;
     }
     return 0;
 }
 
+/* MidiReadCallback: nothing to do if the reader thread is running */
+
+static int midi_in_poll(CSOUND *csound,
+                        void *userData, unsigned char *buf, int nbytes)
+{
+    alsaMidiInputDevice *dev = (alsaMidiInputDevice*) userData;
+
+    if (dev != NULL && dev->reader != NULL)
+      return 0;
+    return midi_in_read(csound, userData, buf, nbytes);
+}
+
 static int midi_in_read(CSOUND *csound,
                         void *userData, unsigned char *buf, int nbytes)
 {
@@ -906,8 +931,9 @@ static int midi_in_close(CSOUND *csound, void *userData)
 {
     int ret = 0, retval = 0;
     alsaMidiInputDevice *olddev, *dev = NULL;
-    (void) csound;
     dev = (alsaMidiInputDevice*) userData;
+    if (dev != NULL)
+      midi_reader_stop(csound, dev->reader);
     while (dev != NULL) {
       if (dev->dev) {
         ret = snd_rawmidi_close(dev->dev);
@@ -1379,11 +1405,33 @@ static int alsaseq_in_open(CSOUND *csound, void **userData, const char *devName)
       return -1;
     }
     snd_midi_event_init(amidi->mev);
+    /* decode every message with its status byte */
+    snd_midi_event_no_status(amidi->mev, 1);
     alsaseq_connect(csound, amidi, SND_SEQ_PORT_CAP_READ, devName);
+    {
+      struct pollfd *pfds;
+      int           npfds = snd_seq_poll_descriptors_count(amidi->seq, POLLIN);
+      pfds = (struct pollfd*) calloc((size_t) npfds + 1, sizeof(struct pollfd));
+      if (pfds != NULL)
+        npfds = snd_seq_poll_descriptors(amidi->seq, pfds,
+                                         (unsigned int) npfds, POLLIN);
+      amidi->reader = midi_reader_start(csound, pfds, npfds, alsaseq_in_read,
+                                        (void*) amidi);
+    }
     *userData = (void*) amidi;
     return OK;
 }
 
+static int alsaseq_in_poll(CSOUND *csound,
+                           void *userData, unsigned char *buf, int nbytes)
+{
+    alsaseqMidi *amidi = (alsaseqMidi*) userData;
+
+    if (amidi->reader != NULL)
+      return 0;
+    return alsaseq_in_read(csound, userData, buf, nbytes);
+}
+
 static int alsaseq_in_read(CSOUND *csound,
                            void *userData, unsigned char *buf, int nbytes)
 {
@@ -1403,9 +1451,9 @@ static int alsaseq_in_read(CSOUND *csound,
 static int alsaseq_in_close(CSOUND *csound, void *userData)
 {
     alsaseqMidi *amidi = (alsaseqMidi*) userData;
-    IGN(csound);
 
     if (amidi != NULL) {
+      midi_reader_stop(csound, amidi->reader);
       snd_midi_event_free(amidi->mev);
       snd_seq_close(amidi->seq);
       free(amidi);
@@ -1816,7 +1864,7 @@ PUBLIC int csoundModuleInit(CSOUND *csound)
     if (strcmp(&(buf[0]), "alsaraw") == 0 || strcmp(&(buf[0]), "alsa") == 0) {
       csound->Message(csound, Str("rtmidi: ALSA Raw MIDI module enabled\n"));
       csound->SetExternalMidiInOpenCallback(csound, midi_in_open);
-      csound->SetExternalMidiReadCallback(csound, midi_in_read);
+      csound->SetExternalMidiReadCallback(csound, midi_in_poll);
       csound->SetExternalMidiInCloseCallback(csound, midi_in_close);
       csound->SetExternalMidiOutOpenCallback(csound, midi_out_open);
       csound->SetExternalMidiWriteCallback(csound, midi_out_write);
@@ -1828,7 +1876,7 @@ PUBLIC int csoundModuleInit(CSOUND *csound)
       if (oparms.msglevel & 0x400)
         csound->Message(csound, Str("rtmidi: ALSASEQ module enabled\n"));
       csound->SetExternalMidiInOpenCallback(csound, alsaseq_in_open);
-      csound->SetExternalMidiReadCallback(csound, alsaseq_in_read);
+      csound->SetExternalMidiReadCallback(csound, alsaseq_in_poll);
       csound->SetExternalMidiInCloseCallback(csound, alsaseq_in_close);
       csound->SetExternalMidiOutOpenCallback(csound, alsaseq_out_open);
       csound->SetExternalMidiWriteCallback(csound, alsaseq_out_write);
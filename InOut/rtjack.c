@@ -107,6 +107,20 @@ static inline void rtJack_DestroyLock(CSOUND *csound, void **p)
 static CS_NORETURN void rtJack_Error(CSOUND *, int errCode, const char *msg);
 
 static int processCallback(jack_nframes_t nframes, void *arg);
+static int performCallback(RtJackGlobals *p, jack_nframes_t nframes);
+static void rtJack_SpinRecv(CSOUND *csound);
+static void rtJack_SpoutTran(CSOUND *csound);
+
+/* in callback mode, wake up the Csound thread once the process */
+/* callback has stopped running the performance */
+
+static void rtJack_CallbackDone(RtJackGlobals *p)
+{
+    if (p->cbState == 1) {
+      p->cbState = 2;
+      rtJack_Unlock(p->csound, &(p->cbLock));
+    }
+}
 
 /* callback functions */
 
@@ -164,6 +178,8 @@ static void shutDownCallback(void *arg)
     RtJackGlobals *p = (RtJackGlobals*) arg;
 
     p->jackState = 2;
+    if (p->callbackMode)
+      rtJack_CallbackDone(p);
     if (p->bufs != NULL) {
       int   i;
       for (i = 0; i < p->nBuffers; i++) {
@@ -422,6 +438,20 @@ static void openJackStreams(RtJackGlobals *p)
     }
     if (UNLIKELY(p->bufSize < 8 || p->bufSize > 32768))
       rtJack_Error(csound, -1, Str("invalid period size (-b)"));
+    if (p->callbackMode) {
+      /* the process callback runs whole k-cycles, and needs no ring buffers */
+      if (UNLIKELY((int) jack_get_buffer_size(p->client)
+                   % (int) csound->GetKsmps(csound) != 0))
+        rtJack_Error(csound, -1, Str("JACK period size must be an integer "
+                                     "multiple of ksmps in callback mode"));
+      if (UNLIKELY(rtJack_CreateLock(csound, &(p->cbLock)) != 0))
+        rtJack_Error(csound, CSOUND_MEMORY, Str("memory allocation failure"));
+      rtJack_TryLock(csound, &(p->cbLock));
+      p->cbState = 0;
+      p->inCallback = 0;
+      rtJack_RegisterPorts(p);
+      goto setCallbacks;
+    }
     if (p->nBuffers < 2)
       p->nBuffers = 2;
     if (UNLIKELY((unsigned int) (p->nBuffers * p->bufSize) > (unsigned int) 65536))
@@ -461,6 +491,7 @@ static void openJackStreams(RtJackGlobals *p)
     if (p->outputEnabled)
       p->outPortBufs[0] = (jack_default_audio_sample_t*) NULL;
 
+ setCallbacks:
     /* register callback functions */
     if (UNLIKELY(jack_set_sample_rate_callback(p->client,
                                                sampleRateCallback, (void*) p)
@@ -637,8 +668,9 @@ static int recopen_(CSOUND *csound, const csRtAudioParams *parm)
       calloc((size_t) p->nChannels, sizeof(jack_default_audio_sample_t*));
     if (UNLIKELY(p->inPortBufs == NULL))
       rtJack_Error(p->csound, CSOUND_MEMORY, Str("memory allocation failure"));
-
-
+    /* in callback mode, spin is filled directly from the input ports */
+    if (p->callbackMode)
+      csound->SetAudioTransfer(csound, rtJack_SpinRecv, NULL);
 
     return 0;
 }
@@ -666,6 +698,9 @@ static int playopen_(CSOUND *csound, const csRtAudioParams *parm)
       calloc((size_t) p->nChannels, sizeof(jack_default_audio_sample_t*));
     if (UNLIKELY(p->outPortBufs == NULL))
       rtJack_Error(p->csound, CSOUND_MEMORY, Str("memory allocation failure"));
+    /* in callback mode, spout is written directly to the output ports */
+    if (p->callbackMode)
+      csound->SetAudioTransfer(csound, NULL, rtJack_SpoutTran);
     /* activate client to start playback */
     openJackStreams(p);
 
@@ -681,6 +716,8 @@ static int processCallback(jack_nframes_t nframes, void *arg)
     int           i, j, k, l;
 
     p = (RtJackGlobals*) arg;
+    if (p->callbackMode)
+      return performCallback(p, nframes);
     /* get pointers to port buffers */
     if (p->inputEnabled) {
       for (i = 0; i < p->nChannels; i++)
@@ -764,12 +801,132 @@ static CS_NOINLINE void rtJack_Restart(RtJackGlobals *p)
     openJackStreams(p);
 }
 
+/* Callback mode (-+jack_callback=1): instead of handing buffers to the */
+/* Csound thread through the ring, the process callback runs nframes / */
+/* ksmps k-cycles itself, and spin and spout are read from and written */
+/* to the JACK port buffers.  The thread that started the performance */
+/* hands it over in its first k-cycle, and sleeps until the end of the */
+/* score or a csoundStop(), so this is meant for csoundPerform() hosts: */
+/* one calling csoundPerformKsmps() does not get control back between */
+/* k-cycles.  The callback never waits for the API lock: while any     */
+/* other thread holds it (in csoundInputMessage(), csoundScoreEvent(),*/
+/* csoundTableCopyIn() or csoundCompileOrc(), for example), the period */
+/* is dropped, silenced and reported as an xrun. */
+
+static int rtJack_WaitCallback(CSOUND *csound, void *userData)
+{
+    RtJackGlobals *p = (RtJackGlobals*) userData;
+
+    p->cbState = 1;
+    rtJack_Lock(csound, &(p->cbLock));
+    switch (p->jackState) {
+    case 0:
+      break;
+    case 1:
+      csound->ErrorMsg(csound, " *** rtjack: %s",
+                       Str("JACK sample rate changed"));
+      return -1;
+    default:
+      csound->ErrorMsg(csound, " *** rtjack: %s",
+                       Str("no connection to JACK server"));
+      return -1;
+    }
+    /* end of score or stop: the host's call returns the same code */
+    if (p->cbResult > 0 && !(p->cbResult & CSOUND_EXITJMP_SUCCESS))
+      return p->cbResult;
+    /* exit without error */
+    if (p->cbResult == CSOUND_EXITJMP_SUCCESS)
+      return 0;
+    return -1;
+}
+
+static int performCallback(RtJackGlobals *p, jack_nframes_t nframes)
+{
+    CSOUND  *csound = p->csound;
+    int     i, n = 0;
+
+    if (p->inputEnabled) {
+      for (i = 0; i < p->nChannels; i++)
+        p->inPortBufs[i] = (jack_default_audio_sample_t*)
+          jack_port_get_buffer(p->inPorts[i], nframes);
+    }
+    if (p->outputEnabled) {
+      for (i = 0; i < p->nChannels; i++)
+        p->outPortBufs[i] = (jack_default_audio_sample_t*)
+          jack_port_get_buffer(p->outPorts[i], nframes);
+    }
+    p->cbInPos = p->cbOutPos = 0;
+    if (p->cbState == 1) {
+      if (p->jackState != 0)
+        rtJack_CallbackDone(p);
+      else {
+        /* this does not wait if another thread holds the API lock, */
+        /* and the period is then lost */
+        p->inCallback = 1;
+        n = csound->PerformKsmpsBatch(csound, (int) nframes
+                                      / (int) csound->GetKsmps(csound),
+                                      &(p->cbResult));
+        p->inCallback = 0;
+        if (p->cbResult != 0)
+          rtJack_CallbackDone(p);
+        else if (!n)
+          p->xrunFlag = 1;
+      }
+    }
+    /* silence the rest of the period */
+    if (p->outputEnabled) {
+      n = p->cbOutPos;
+      for (i = 0; i < p->nChannels; i++)
+        memset(&(p->outPortBufs[i][n]), 0,
+               sizeof(jack_default_audio_sample_t) * (size_t) (nframes - n));
+    }
+    return 0;
+}
+
+static void rtJack_SpinRecv(CSOUND *csound)
+{
+    RtJackGlobals *p;
+    MYFLT         *spin = csound->GetSpin(csound);
+    int           ksmps;
+
+    p = (RtJackGlobals*) *(csound->GetRtRecordUserData(csound));
+    if (UNLIKELY(p == NULL)) rtJack_Abort(csound, 0);
+    if (!p->inCallback) {
+      /* still in the Csound thread: start the stream if it is input */
+      /* only, and leave the rest to the process callback */
+      if (p->jackState < 0)
+        openJackStreams(p);
+      csound->HandOverPerformance(csound, rtJack_WaitCallback, (void*) p);
+    }
+    ksmps = (int) csound->GetKsmps(csound);
+    csound->Interleave(spin, (const float *const *) p->inPortBufs, p->cbInPos,
+                       p->nChannels, ksmps, csound->Get0dBFS(csound));
+    p->cbInPos += ksmps;
+}
+
+static void rtJack_SpoutTran(CSOUND *csound)
+{
+    RtJackGlobals *p;
+    MYFLT         *spout = csound->GetSpout(csound);
+    int           ksmps;
+
+    p = (RtJackGlobals*) *(csound->GetRtPlayUserData(csound));
+    if (UNLIKELY(p == NULL)) rtJack_Abort(csound, 0);
+    if (!p->inCallback)
+      csound->HandOverPerformance(csound, rtJack_WaitCallback, (void*) p);
+    ksmps = (int) csound->GetKsmps(csound);
+    csound->Deinterleave((float *const *) p->outPortBufs, p->cbOutPos, spout,
+                         p->nChannels, ksmps,
+                         FL(1.0) / csound->Get0dBFS(csound));
+    p->cbOutPos += ksmps;
+}
+
 /* get samples from ADC */
 
 static int rtrecord_(CSOUND *csound, MYFLT *inbuf_, int bytes_)
 {
     RtJackGlobals *p;
-    int           i, j, k, nframes, bufpos, bufcnt;
+    int           i, n, nframes, bufpos, bufcnt;
 
     p = (RtJackGlobals*) *(csound->GetRtPlayUserData(csound));
     if (UNLIKELY(p==NULL)) rtJack_Abort(csound, 0);
@@ -784,16 +941,20 @@ static int rtrecord_(CSOUND *csound, MYFLT *inbuf_, int bytes_)
     nframes = bytes_ / (p->nChannels * (int) sizeof(MYFLT));
     bufpos = p->csndBufPos;
     bufcnt = p->csndBufCnt;
-    for (i = j = 0; i < nframes; i++) {
+    for (i = 0; i < nframes; i += n) {
       if (bufpos == 0) {
         /* wait until there is enough data in ring buffer */
         /* **** COVERITY: claims this is a double lock **** */
         rtJack_Lock(csound, &(p->bufs[bufcnt]->csndLock));
       }
-      /* copy audio data */
-      for (k = 0; k < p->nChannels; k++)
-        inbuf_[j++] = (MYFLT) p->bufs[bufcnt]->inBufs[k][i];
-      if (++bufpos >= p->bufSize) {
+      /* copy audio data, up to the end of this buffer */
+      n = p->bufSize - bufpos;
+      if (n > nframes - i)
+        n = nframes - i;
+      csound->Interleave(&inbuf_[i * p->nChannels],
+                         (const float *const *) p->bufs[bufcnt]->inBufs,
+                         bufpos, p->nChannels, n, FL(1.0));
+      if ((bufpos += n) >= p->bufSize) {
         bufpos = 0;
         /* notify JACK callback that this buffer has been consumed */
         if (!p->outputEnabled)
@@ -823,7 +984,7 @@ static int rtrecord_(CSOUND *csound, MYFLT *inbuf_, int bytes_)
 static void rtplay_(CSOUND *csound, const MYFLT *outbuf_, int bytes_)
 {
     RtJackGlobals *p;
-    int           i, j, k, nframes;
+    int           i, n, nframes;
 
     p = (RtJackGlobals*) *(csound->GetRtPlayUserData(csound));
     if (p == NULL)
@@ -836,18 +997,21 @@ static void rtplay_(CSOUND *csound, const MYFLT *outbuf_, int bytes_)
       return;
     }
     nframes = bytes_ / (p->nChannels * (int) sizeof(MYFLT));
-    for (i = j = 0; i < nframes; i++) {
+    for (i = 0; i < nframes; i += n) {
       if (p->csndBufPos == 0) {
         /* wait until there is enough free space in ring buffer */
         if (!p->inputEnabled)
           /* **** COVERITY: claims this is a double lock **** */
           rtJack_Lock(csound, &(p->bufs[p->csndBufCnt]->csndLock));
       }
-      /* copy audio data */
-      for (k = 0; k < p->nChannels; k++)
-        p->bufs[p->csndBufCnt]->outBufs[k][i] =
-          (jack_default_audio_sample_t) outbuf_[j++];
-      if (++(p->csndBufPos) >= p->bufSize) {
+      /* copy audio data, up to the end of this buffer */
+      n = p->bufSize - p->csndBufPos;
+      if (n > nframes - i)
+        n = nframes - i;
+      csound->Deinterleave((float *const *) p->bufs[p->csndBufCnt]->outBufs,
+                           p->csndBufPos, &outbuf_[i * p->nChannels],
+                           p->nChannels, n, FL(1.0));
+      if ((p->csndBufPos += n) >= p->bufSize) {
         p->csndBufPos = 0;
         /* notify JACK callback that this buffer is now filled */
         rtJack_Unlock(csound, &(p->bufs[p->csndBufCnt]->jackLock));
@@ -928,6 +1092,8 @@ static CS_NOINLINE void rtclose_(CSOUND *csound)
         jack_client_close(p.client);
       }
     }
+    if (p.cbState >= 0)
+      rtJack_DestroyLock(csound, &(pp->cbLock));
     /* free copy of input and output device name */
     if (p.inDevName != NULL)
       free(p.inDevName);
@@ -1044,6 +1210,7 @@ PUBLIC int csoundModuleCreate(CSOUND *csound)
     p->outPorts = (jack_port_t**) NULL;
     p->outPortBufs = (jack_default_audio_sample_t**) NULL;
     p->bufs = (RtJackBuffer**) NULL;
+    p->cbState = -1;
     /* register options: */
     /*   client name */
     i = jack_client_name_size();
@@ -1078,6 +1245,15 @@ PUBLIC int csoundModuleCreate(CSOUND *csound)
                                         (void*) &(p->sleepTime),
                                         CSOUNDCFG_INTEGER, 0, &i, &j,
                                         Str("Deprecated"), NULL);
+    /* run the performance in the process callback */
+    csound->CreateConfigurationVariable(csound, "jack_callback",
+                                        (void*) &(p->callbackMode),
+                                        CSOUNDCFG_BOOLEAN, 0, NULL, NULL,
+                                        Str("Run the Csound performance in the "
+                                            "JACK process callback; a period "
+                                            "is dropped while another thread "
+                                            "holds the API lock "
+                                            "(default: off)"), NULL);
     /* done */
     p->listclient = NULL;
 
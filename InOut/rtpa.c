@@ -43,6 +43,7 @@ typedef struct devparams_ {
     PaStream    *handle;        /* stream handle                    */
     float       *buf;           /* sample conversion buffer         */
     int         nchns;          /* number of channels               */
+    CS_SAMPCONV *conv;          /* sample format converter          */
 } DEVPARAMS;
 
 typedef struct PA_BLOCKING_STREAM_ {
@@ -679,6 +680,7 @@ static int set_device_params(CSOUND *csound, DEVPARAMS *dev,
     dev->buf = (float*) p->Calloc(p, (size_t) (parm->bufSamp_SW
                                                * parm->nChannels
                                                * (int) sizeof(float)));
+    dev->conv = p->CreateSampleConverter(p, AE_FLOAT, dev->nchns, 0);
 
     return 0;
 }
@@ -740,7 +742,7 @@ static int playopen_blocking(CSOUND *csound, const csRtAudioParams *parm)
 static int rtrecord_blocking(CSOUND *csound, MYFLT *inbuf, int nbytes)
 {
     DEVPARAMS *dev;
-    int       i, n, err;
+    int       n, err;
 
     dev = (DEVPARAMS*) (*(csound->GetRtRecordUserData(csound)));
     /* calculate the number of samples to record */
@@ -749,8 +751,7 @@ static int rtrecord_blocking(CSOUND *csound, MYFLT *inbuf, int nbytes)
     if (err != (int) paNoError && (csound->GetMessageLevel(csound) & 4))
       csound->Warning(csound, Str("Buffer overrun in real-time audio input"));
     /* convert samples to MYFLT */
-    for (i = 0; i < (n * dev->nchns); i++)
-      inbuf[i] = (MYFLT) dev->buf[i];
+    csound->ConvertSamplesIn(dev->conv, inbuf, dev->buf, n);
 
     return nbytes;
 }
@@ -760,14 +761,13 @@ static int rtrecord_blocking(CSOUND *csound, MYFLT *inbuf, int nbytes)
 static void rtplay_blocking(CSOUND *csound, const MYFLT *outbuf, int nbytes)
 {
     DEVPARAMS *dev;
-    int       i, n, err;
+    int       n, err;
 
     dev = (DEVPARAMS*) (*(csound->GetRtPlayUserData(csound)));
     /* calculate the number of samples to play */
     n = nbytes / (dev->nchns * (int) sizeof(MYFLT));
     /* convert samples from MYFLT */
-    for (i = 0; i < (n * dev->nchns); i++)
-      dev->buf[i] = (float) outbuf[i];
+    csound->ConvertSamplesOut(dev->conv, dev->buf, outbuf, n);
     err = (int) Pa_WriteStream(dev->handle, dev->buf, (unsigned long) n);
     if (err != (int) paNoError && (csound->GetMessageLevel(csound) & 4))
       csound->Warning(csound, Str("Buffer underrun in real-time audio output"));
@@ -789,6 +789,7 @@ static void rtclose_blocking(CSOUND *csound)
       }
       if (dev->buf != NULL)
         csound->Free(csound, dev->buf);
+      csound->DestroySampleConverter(csound, dev->conv);
       csound->Free(csound, dev);
     }
     dev = (DEVPARAMS*) (*(csound->GetRtPlayUserData(csound)));
@@ -800,6 +801,7 @@ static void rtclose_blocking(CSOUND *csound)
       }
       if (dev->buf != NULL)
         csound->Free(csound, dev->buf);
+      csound->DestroySampleConverter(csound, dev->conv);
       csound->Free(csound, dev);
     }
 }
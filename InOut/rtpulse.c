@@ -22,6 +22,7 @@
 */
 
 #include <csdl.h>
+#include "soundio.h"
 #include <pulse/simple.h>
 #include <pulse/error.h>
 #include <string.h>
@@ -30,6 +31,7 @@ typedef struct _pulse_params {
   pa_simple *ps;
   pa_sample_spec spec;
   float *buf;
+  CS_SAMPCONV *conv;
 } pulse_params;
 
 typedef struct _pulse_globals {
@@ -98,11 +100,14 @@ static int pulse_playopen(CSOUND *csound, const csRtAudioParams *parm)
     int pulserror;
 
     pulse = (pulse_params *) malloc(sizeof(pulse_params));
-    pulse->buf = (float *) malloc(sizeof(float)* parm->bufSamp_SW);
     *(csound->GetRtPlayUserData(csound))  = (void *) pulse;
     pulse->spec.rate = csound->GetSr(csound);
     pulse->spec.channels = csound->GetNchnls(csound);
     pulse->spec.format = PA_SAMPLE_FLOAT32;
+    pulse->buf = (float *) malloc(sizeof(float) * parm->bufSamp_SW
+                                  * pulse->spec.channels);
+    pulse->conv = csound->CreateSampleConverter(csound, AE_FLOAT,
+                                                pulse->spec.channels, 0);
 
     /*
       attr.maxlength = parm->bufSamp_HW;
@@ -149,13 +154,14 @@ static int pulse_playopen(CSOUND *csound, const csRtAudioParams *parm)
 
 static void pulse_play(CSOUND *csound, const MYFLT *outbuf, int nbytes){
 
-  int i, bufsiz, pulserror;
+  int bufsiz, pulserror;
   float *buf;
   pulse_params *pulse = (pulse_params*) *(csound->GetRtPlayUserData(csound));
   //MYFLT norm = csound->e0dbfs;
   bufsiz = nbytes/sizeof(MYFLT);
   buf = pulse->buf;
-  for (i=0;i<bufsiz;i++) buf[i] = outbuf[i];
+  csound->ConvertSamplesOut(pulse->conv, buf, outbuf,
+                            bufsiz / (int) pulse->spec.channels);
   if (UNLIKELY(pa_simple_write(pulse->ps, buf,
                                bufsiz*sizeof(float), &pulserror) < 0))
     csound->ErrorMsg(csound,Str("Pulse audio module error: %s\n"),
@@ -173,6 +179,7 @@ static void pulse_close(CSOUND *csound)
       pa_simple_drain(pulse->ps, &error);
       pa_simple_free(pulse->ps);
       free(pulse->buf);
+      csound->DestroySampleConverter(csound, pulse->conv);
     }
 
     pulse = (pulse_params*) *(csound->GetRtRecordUserData(csound)) ;
@@ -180,6 +187,7 @@ static void pulse_close(CSOUND *csound)
     if (pulse != NULL){
       pa_simple_free(pulse->ps);
       free(pulse->buf);
+      csound->DestroySampleConverter(csound, pulse->conv);
     }
     csound->DestroyGlobalVariable(csound, "pulse_globals");
 }
@@ -193,11 +201,14 @@ static int pulse_recopen(CSOUND *csound, const csRtAudioParams *parm)
     int pulserror;
 
     pulse = (pulse_params *) malloc(sizeof(pulse_params));
-    pulse->buf = (float *) malloc(sizeof(float)* parm->bufSamp_SW);
     *(csound->GetRtRecordUserData(csound))  = (void *) pulse;
     pulse->spec.rate = csound->GetSr(csound);
     pulse->spec.channels = csound->GetNchnls(csound);
     pulse->spec.format = PA_SAMPLE_FLOAT32;
+    pulse->buf = (float *) malloc(sizeof(float) * parm->bufSamp_SW
+                                  * pulse->spec.channels);
+    pulse->conv = csound->CreateSampleConverter(csound, AE_FLOAT,
+                                                pulse->spec.channels, 0);
 
     /*
       attr.maxlength = parm->bufSamp_HW;
@@ -240,20 +251,22 @@ static int pulse_recopen(CSOUND *csound, const csRtAudioParams *parm)
 
 static int pulse_record(CSOUND *csound, MYFLT *inbuf, int nbytes)
 {
-    int i, bufsiz,pulserror;
+    int bufsiz,pulserror;
     float *buf;
     pulse_params *pulse = (pulse_params*) *(csound->GetRtRecordUserData(csound)) ;
     //MYFLT norm = csound->e0dbfs;
     bufsiz = nbytes/sizeof(MYFLT);
     buf = pulse->buf;
 
-    if (UNLIKELY(pa_simple_read(pulse->ps, buf, nbytes, &pulserror) < 0)) {
+    if (UNLIKELY(pa_simple_read(pulse->ps, buf, bufsiz*sizeof(float),
+                                &pulserror) < 0)) {
       csound->ErrorMsg(csound,Str("Pulse audio module error: %s\n"),
                        pa_strerror(pulserror));
       return -1;
     }
     else {
-      for (i=0;i<bufsiz;i++) inbuf[i] = buf[i];
+      csound->ConvertSamplesIn(pulse->conv, inbuf, buf,
+                               bufsiz / (int) pulse->spec.channels);
       return nbytes;
     }
 
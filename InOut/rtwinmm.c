@@ -40,12 +40,9 @@ typedef struct rtWinMMDevice_ {
     HWAVEOUT  outDev;
     int       cur_buf;
     int       nBuffers;
-    int       seed;             /* random seed for dithering */
+    int       nchns;
     int       enable_buf_timer;
-    /* playback sample conversion function */
-    void      (*playconv)(int, MYFLT*, void*, int*);
-    /* record sample conversion function */
-    void      (*rec_conv)(int, void*, MYFLT*);
+    CS_SAMPCONV *conv;          /* sample format converter */
     int64_t   prv_time;
     float     timeConv, bufTime;
     WAVEHDR   buffers[MAXBUFFERS];
@@ -155,104 +152,6 @@ static int set_format_params(CSOUND *csound, WAVEFORMATEX *wfx,
     return 0;
 }
 
-/* sample conversion routines for playback */
-
-static void MYFLT_to_short(int nSmps, MYFLT *inBuf, int16_t *outBuf, int *seed)
-{
-    MYFLT   tmp_f;
-    int     tmp_i;
-    int n;
-    for (n=0; n<nSmps; n++){
-      int rnd = (((*seed) * 15625) + 1) & 0xFFFF;
-      *seed = (((rnd) * 15625) + 1) & 0xFFFF;
-      rnd += *seed;           /* triangular distribution */
-      tmp_f = (MYFLT) ((rnd>>1) - 0x8000) * (FL(1.0) / (MYFLT) 0x10000);
-      tmp_f += inBuf[n] * (MYFLT) 0x8000;
-      tmp_i = (int) MYFLT2LRND(tmp_f);
-      if (tmp_i < -0x8000) tmp_i = -0x8000;
-      if (tmp_i > 0x7FFF) tmp_i = 0x7FFF;
-      outBuf[n] = (int16_t) tmp_i;
-    }
-}
-
-static void MYFLT_to_short_u(int nSmps, MYFLT *inBuf, int16_t *outBuf, int *seed)
-{
-    MYFLT   tmp_f;
-    int     tmp_i;
-    int n;
-    for (n=0; n<nSmps; n++) {
-      int rnd = (((*seed) * 15625) + 1) & 0xFFFF;
-      *seed = rnd;
-      tmp_f = (MYFLT) (rnd - 0x8000) * (FL(1.0) / (MYFLT) 0x10000);
-      tmp_f += inBuf[n] * (MYFLT) 0x8000;
-      tmp_i = (int) MYFLT2LRND(tmp_f);
-      if (tmp_i < -0x8000) tmp_i = -0x8000;
-      if (tmp_i > 0x7FFF) tmp_i = 0x7FFF;
-      outBuf[n] = (int16_t) tmp_i;
-    }
-}
-
-static void MYFLT_to_short_no_dither(int nSmps, MYFLT *inBuf,
-                                     int16_t *outBuf, int *seed)
-{
-    MYFLT   tmp_f;
-    int     tmp_i;
-    int n;
-    for (n=0; n<nSmps; n++){
-      tmp_f = inBuf[n] * (MYFLT) 0x8000;
-      tmp_i = (int) MYFLT2LRND(tmp_f);
-      if (tmp_i < -0x8000) tmp_i = -0x8000;
-      if (tmp_i > 0x7FFF) tmp_i = 0x7FFF;
-      outBuf[n] = (int16_t) tmp_i;
-    }
-}
-
-static void MYFLT_to_long(int nSmps, MYFLT *inBuf, int32_t *outBuf, int *seed)
-{
-    MYFLT   tmp_f;
-    int64_t tmp_i;
-    (void) seed;
-    int n;
-    for (n=0; n<nSmps; n++) {
-      tmp_f = inBuf[n] * (MYFLT) 0x80000000UL;
-      tmp_i = (int64_t) (tmp_f + (tmp_f < FL(0.0) ? FL(-0.5) : FL(0.5)));
-      if (tmp_i < -((int64_t) 0x80000000UL))
-        tmp_i = -((int64_t) 0x80000000UL);
-      if (tmp_i > (int64_t) 0x7FFFFFFF) tmp_i = (int64_t) 0x7FFFFFFF;
-      outBuf[n] = (int32_t) tmp_i;
-    }
-}
-
-static void MYFLT_to_float(int nSmps, MYFLT *inBuf, float *outBuf, int *seed)
-{
-    (void) seed;
-    int n;
-    for (n=0; n<nSmps; n++)
-      outBuf[n] = (float) inBuf[n];
-}
-
-/* sample conversion routines for recording */
-
-static void short_to_MYFLT(int nSmps, int16_t *inBuf, MYFLT *outBuf)
-{
-    while (nSmps--)
-      *(outBuf++) = (MYFLT) *(inBuf++) * (FL(1.0) / (MYFLT) 0x8000);
-}
-
-static void long_to_MYFLT(int nSmps, int32_t *inBuf, MYFLT *outBuf)
-{
-    int n;
-    for (n=0; n<nSmps; n++)
-      outBuf[n] = (MYFLT) inBuf[n] * (FL(1.0) / (MYFLT) 0x80000000UL);
-}
-
-static void float_to_MYFLT(int nSmps, float *inBuf, MYFLT *outBuf)
-{
-    int n;
-    for (n=0; n<nSmps; n++)
-      outBuf[n] = (MYFLT) inBuf[n];
-}
-
 static int open_device(CSOUND *csound,
                        const csRtAudioParams *parm, int is_playback)
 {
@@ -260,7 +159,7 @@ static int open_device(CSOUND *csound,
     rtWinMMDevice   *dev;
     WAVEFORMATEX    wfx;
     LARGE_INTEGER   pp;
-    int             i, ndev, devNum, conv_idx;
+    int             i, ndev, devNum;
     DWORD           openFlags = CALLBACK_NULL;
 
     if (UNLIKELY(parm->devName != NULL))
@@ -315,8 +214,7 @@ static int open_device(CSOUND *csound,
     if (UNLIKELY(dev == NULL))
       return err_msg(csound, Str("memory allocation failure"));
     memset(dev, 0, sizeof(rtWinMMDevice));
-    conv_idx = (parm->sampleFormat == AE_SHORT ?
-                0 : (parm->sampleFormat == AE_LONG ? 1 : 2));
+    dev->nchns = parm->nChannels;
     if (is_playback) {
       p->outDev = dev;
      *(csound->GetRtPlayUserData(csound)) = (void*) dev;
@@ -327,23 +225,9 @@ static int open_device(CSOUND *csound,
         dev->outDev = (HWAVEOUT) 0;
         return err_msg(csound, Str("failed to open device"));
       }
-      switch (conv_idx) {
-        case 0:
-          if (csound->GetDitherMode(csound)==1)
-            dev->playconv =
-                  (void (*)(int, MYFLT*, void*, int*)) MYFLT_to_short;
-          else if (csound->GetDitherMode(csound)==2)
-            dev->playconv =
-                  (void (*)(int, MYFLT*, void*, int*)) MYFLT_to_short_u;
-          else
-            dev->playconv =
-                  (void (*)(int, MYFLT*, void*, int*)) MYFLT_to_short_no_dither;
-          break;
-        case 1: dev->playconv =
-                  (void (*)(int, MYFLT*, void*, int*)) MYFLT_to_long;   break;
-        case 2: dev->playconv =
-                  (void (*)(int, MYFLT*, void*, int*)) MYFLT_to_float;  break;
-      }
+      dev->conv = csound->CreateSampleConverter(csound, parm->sampleFormat,
+                                                dev->nchns,
+                                                csound->GetDitherMode(csound));
     }
     else {
       p->inDev = dev;
@@ -356,14 +240,8 @@ static int open_device(CSOUND *csound,
         dev->inDev = (HWAVEIN) 0;
         return err_msg(csound, Str("failed to open device"));
       }
-      switch (conv_idx) {
-        case 0: dev->rec_conv =
-                  (void (*)(int, void*, MYFLT*)) short_to_MYFLT;  break;
-        case 1: dev->rec_conv =
-                  (void (*)(int, void*, MYFLT*)) long_to_MYFLT;   break;
-        case 2: dev->rec_conv =
-                  (void (*)(int, void*, MYFLT*)) float_to_MYFLT;  break;
-      }
+      dev->conv = csound->CreateSampleConverter(csound, parm->sampleFormat,
+                                                dev->nchns, 0);
     }
     if (UNLIKELY(allocate_buffers(csound, dev, parm, is_playback) != 0))
       return -1;
@@ -399,7 +277,8 @@ static int rtrecord_(CSOUND *csound, MYFLT *inBuf, int nbytes)
     WAVEHDR         *buf = &(dev->buffers[dev->cur_buf]);
     volatile DWORD  *dwFlags = &(buf->dwFlags);
 
-    dev->rec_conv(nbytes / (int) sizeof(MYFLT), (void*) buf->lpData, inBuf);
+    csound->ConvertSamplesIn(dev->conv, inBuf, (void*) buf->lpData,
+                             nbytes / ((int) sizeof(MYFLT) * dev->nchns));
     while (!(*dwFlags & WHDR_DONE))
       Sleep(1);
     waveInAddBuffer(dev->inDev, (LPWAVEHDR) buf, sizeof(WAVEHDR));
@@ -434,8 +313,8 @@ static void rtplay_(CSOUND *csound, const MYFLT *outBuf, int nbytes)
 
     while (!(*dwFlags & WHDR_DONE))
       Sleep(1);
-    dev->playconv(nbytes / (int) sizeof(MYFLT),
-                  (MYFLT*) outBuf, (void*) buf->lpData, &(dev->seed));
+    csound->ConvertSamplesOut(dev->conv, (void*) buf->lpData, outBuf,
+                              nbytes / ((int) sizeof(MYFLT) * dev->nchns));
     waveOutWrite(dev->outDev, (LPWAVEHDR) buf, sizeof(WAVEHDR));
     if (++(dev->cur_buf) >= dev->nBuffers)
       dev->cur_buf = 0;
@@ -486,6 +365,8 @@ static void rtclose_(CSOUND *csound)
         GlobalFree((HGLOBAL) inDev->buffers[i].lpData);
       }
       waveInClose(inDev->inDev);
+      if (inDev->conv != NULL)
+        csound->DestroySampleConverter(csound, inDev->conv);
       free(inDev);
     }
     if (outDev != NULL) {
@@ -501,6 +382,8 @@ static void rtclose_(CSOUND *csound)
         GlobalFree((HGLOBAL) outDev->buffers[i].lpData);
       }
       waveOutClose(outDev->outDev);
+      if (outDev->conv != NULL)
+        csound->DestroySampleConverter(csound, outDev->conv);
       free(outDev);
     }
 }
@@ -0,0 +1,340 @@
+/*
+    sampconv.c:
+
+    Copyright (C) 2026 The Csound developers
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+#include "csoundCore.h"                         /*      SAMPCONV.C      */
+#include "soundio.h"
+#include "vecops.h"
+#include "sampconv.h"
+#include <math.h>
+
+#ifdef USE_DOUBLE
+#  define SC_LRINT(x)   ((int32_t) lrint(x))
+#else
+#  define SC_LRINT(x)   ((int32_t) lrintf(x))
+#endif
+
+/* largest error fed back by noise shaping, in LSBs, so that clipping */
+/* does not make the filter run away                                  */
+#define SHAPE_MAXERR    FL(2.0)
+
+CS_SAMPCONV *cs_sampconv_create(CSOUND *csound, int format, int nchnls,
+                                int dither)
+{
+    CS_SAMPCONV *p;
+    int         bits, i;
+
+    switch (format) {
+    case AE_CHAR:
+    case AE_UNCH:   bits = 8;  break;
+    case AE_SHORT:  bits = 16; break;
+    case AE_24INT:  bits = 24; break;
+    case AE_LONG:   bits = 32; break;
+    case AE_FLOAT:  bits = 0;  break;
+    default:
+      return NULL;
+    }
+    if (UNLIKELY(nchnls < 1))
+      return NULL;
+    p = (CS_SAMPCONV*) csound->Calloc(csound, sizeof(CS_SAMPCONV));
+    p->format = format;
+    p->nchnls = nchnls;
+    p->dither = (bits != 0 && dither >= CS_DITHER_TRIANGULAR &&
+                 dither <= CS_DITHER_SHAPED ? dither : CS_DITHER_NONE);
+    if (bits != 0) {
+      p->scale = (MYFLT) ldexp(1.0, bits - 1);
+      p->lo = -(p->scale);
+      p->hi = p->scale - FL(1.0);
+#ifndef USE_DOUBLE
+      if (bits == 32)
+        p->hi = p->scale - FL(128.0);   /* largest float below 2^31 */
+#endif
+    }
+    else
+      p->scale = FL(1.0);
+    for (i = 0; i < SAMPCONV_LANES; i++)
+      p->rnd[i] = 0x9E3779B9U * (uint32_t) (i + 1);
+    if (p->dither == CS_DITHER_SHAPED)
+      p->err = (MYFLT*) csound->Calloc(csound,
+                                       sizeof(MYFLT) * 2 * (size_t) nchnls);
+    return p;
+}
+
+void cs_sampconv_destroy(CSOUND *csound, CS_SAMPCONV *p)
+{
+    if (p == NULL)
+      return;
+    if (p->err != NULL)
+      csound->Free(csound, p->err);
+    csound->Free(csound, p);
+}
+
+int cs_sampconv_size(CS_SAMPCONV *p)
+{
+    switch (p->format) {
+    case AE_CHAR:
+    case AE_UNCH:   return 1;
+    case AE_SHORT:  return 2;
+    case AE_24INT:  return 3;
+    }
+    return 4;
+}
+
+/* fill d with n (rounded up to SAMPCONV_LANES) samples of dither, in */
+/* LSBs; each lane has an xorshift32 generator, so that compilers can */
+/* vectorise the loop, and the triangular noise is the difference of  */
+/* the two halves of one output                                       */
+
+static void make_dither(CS_SAMPCONV *p, int n)
+{
+    uint32_t  *s = p->rnd;
+    MYFLT     *d = p->d;
+    int       i, k;
+
+    if (p->dither == CS_DITHER_UNIFORM) {
+      for (i = 0; i < n; i += SAMPCONV_LANES, d += SAMPCONV_LANES)
+        for (k = 0; k < SAMPCONV_LANES; k++) {
+          uint32_t x = s[k];
+          x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+          s[k] = x;
+          d[k] = (MYFLT) ((int32_t) (x & 0xFFFFU) - 0x8000)
+                 * (FL(1.0) / FL(65536.0));
+        }
+    }
+    else {
+      for (i = 0; i < n; i += SAMPCONV_LANES, d += SAMPCONV_LANES)
+        for (k = 0; k < SAMPCONV_LANES; k++) {
+          uint32_t x = s[k];
+          x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+          s[k] = x;
+          d[k] = (MYFLT) ((int32_t) (x >> 16) - (int32_t) (x & 0xFFFFU))
+                 * (FL(1.0) / FL(65536.0));
+        }
+    }
+}
+
+/* quantise n samples to q with triangular dither and second order */
+/* error feedback, E(z) (1 - z^-1)^2, which cannot be done a vector at */
+/* a time as each sample depends on the last two of its channel       */
+
+static void shape(CS_SAMPCONV *p, const MYFLT *in, int n, MYFLT scale)
+{
+    MYFLT   *e, w, y;
+    int     i, c = p->chn;
+
+    make_dither(p, n);
+    for (i = 0; i < n; i++) {
+      e = &(p->err[c + c]);
+      w = in[i] * scale - FL(2.0) * e[0] + e[1];
+      y = w + p->d[i];
+      y = (y < p->lo ? p->lo : (y > p->hi ? p->hi : y));
+      p->q[i] = SC_LRINT(y);
+      y = (MYFLT) p->q[i] - w;
+      e[1] = e[0];
+      e[0] = (y < -SHAPE_MAXERR ? -SHAPE_MAXERR :
+              (y > SHAPE_MAXERR ? SHAPE_MAXERR : y));
+      if (++c >= p->nchnls)
+        c = 0;
+    }
+    p->chn = c;
+}
+
+void cs_sampconv_out(CS_SAMPCONV *p, void *out, const MYFLT *in, int nframes)
+{
+    const CS_VECOPS *v = VECOPS();
+    const int32_t   *q = p->q;
+    int             n = nframes * p->nchnls, i, k, m;
+
+    if (p->format == AE_FLOAT) {
+      v->to_float((float*) out, in, FL(1.0), (uint32_t) n);
+      return;
+    }
+    for (i = 0; i < n; i += m) {
+      m = (n - i < SAMPCONV_BLOCK ? n - i : SAMPCONV_BLOCK);
+      if (p->dither == CS_DITHER_SHAPED)
+        shape(p, in + i, m, p->scale);
+      else if (p->dither != CS_DITHER_NONE) {
+        make_dither(p, m);
+        v->quant(p->q, in + i, p->d, p->scale, p->lo, p->hi, (uint32_t) m);
+      }
+      else
+        v->quant(p->q, in + i, NULL, p->scale, p->lo, p->hi, (uint32_t) m);
+      switch (p->format) {
+      case AE_CHAR:
+        {
+          int8_t  *o = (int8_t*) out + i;
+          for (k = 0; k < m; k++)
+            o[k] = (int8_t) q[k];
+        }
+        break;
+      case AE_UNCH:
+        {
+          uint8_t *o = (uint8_t*) out + i;
+          for (k = 0; k < m; k++)
+            o[k] = (uint8_t) (q[k] + 0x80);
+        }
+        break;
+      case AE_SHORT:
+        {
+          int16_t *o = (int16_t*) out + i;
+          for (k = 0; k < m; k++)
+            o[k] = (int16_t) q[k];
+        }
+        break;
+      case AE_24INT:
+        {
+          uint8_t *o = (uint8_t*) out + 3 * i;
+          for (k = 0; k < m; k++, o += 3) {
+#ifdef WORDS_BIGENDIAN
+            o[0] = (uint8_t) (q[k] >> 16);
+            o[1] = (uint8_t) (q[k] >> 8);
+            o[2] = (uint8_t) q[k];
+#else
+            o[0] = (uint8_t) q[k];
+            o[1] = (uint8_t) (q[k] >> 8);
+            o[2] = (uint8_t) (q[k] >> 16);
+#endif
+          }
+        }
+        break;
+      default:
+        memcpy((int32_t*) out + i, q, sizeof(int32_t) * (size_t) m);
+      }
+    }
+}
+
+void cs_sampconv_in(CS_SAMPCONV *p, MYFLT *out, const void *in, int nframes)
+{
+    const CS_VECOPS *v = VECOPS();
+    int32_t         *q = p->q;
+    MYFLT           scale = FL(1.0) / p->scale;
+    int             n = nframes * p->nchnls, i, k, m;
+
+    switch (p->format) {
+    case AE_FLOAT:
+      v->from_float(out, (const float*) in, FL(1.0), (uint32_t) n);
+      return;
+    case AE_LONG:
+      v->from_int(out, (const int32_t*) in, scale, (uint32_t) n);
+      return;
+    }
+    for (i = 0; i < n; i += m) {
+      m = (n - i < SAMPCONV_BLOCK ? n - i : SAMPCONV_BLOCK);
+      switch (p->format) {
+      case AE_CHAR:
+        {
+          const int8_t  *s = (const int8_t*) in + i;
+          for (k = 0; k < m; k++)
+            q[k] = (int32_t) s[k];
+        }
+        break;
+      case AE_UNCH:
+        {
+          const uint8_t *s = (const uint8_t*) in + i;
+          for (k = 0; k < m; k++)
+            q[k] = (int32_t) s[k] - 0x80;
+        }
+        break;
+      case AE_SHORT:
+        {
+          const int16_t *s = (const int16_t*) in + i;
+          for (k = 0; k < m; k++)
+            q[k] = (int32_t) s[k];
+        }
+        break;
+      default:
+        {
+          const uint8_t *s = (const uint8_t*) in + 3 * i;
+          for (k = 0; k < m; k++, s += 3) {
+#ifdef WORDS_BIGENDIAN
+            uint32_t x = ((uint32_t) s[0] << 24) | ((uint32_t) s[1] << 16)
+                         | ((uint32_t) s[2] << 8);
+#else
+            uint32_t x = ((uint32_t) s[2] << 24) | ((uint32_t) s[1] << 16)
+                         | ((uint32_t) s[0] << 8);
+#endif
+            q[k] = (int32_t) x >> 8;
+          }
+        }
+      }
+      v->from_int(out + i, q, scale, (uint32_t) m);
+    }
+}
+
+void cs_sampconv_dither(CS_SAMPCONV *p, MYFLT *buf, int nframes)
+{
+    MYFLT   scale, rscale;
+    int     n = nframes * p->nchnls, i, k, m;
+
+    if (p->dither == CS_DITHER_NONE)
+      return;
+    /* libsndfile scales by 0x7FFF, not 0x8000 */
+    scale = p->scale - FL(1.0);
+    rscale = FL(1.0) / scale;
+    for (i = 0; i < n; i += m) {
+      m = (n - i < SAMPCONV_BLOCK ? n - i : SAMPCONV_BLOCK);
+      if (p->dither == CS_DITHER_SHAPED) {
+        shape(p, buf + i, m, scale);
+        for (k = 0; k < m; k++)
+          buf[i + k] = (MYFLT) p->q[k] * rscale;
+      }
+      else {
+        make_dither(p, m);
+        for (k = 0; k < m; k++)
+          buf[i + k] += p->d[k] * rscale;
+      }
+    }
+}
+
+void cs_deinterleave(float *const *out, int offset, const MYFLT *in,
+                     int nchnls, int nframes, MYFLT scale)
+{
+    int i, j;
+
+    if (nchnls == 1) {
+      VECOPS()->to_float(out[0] + offset, in, scale, (uint32_t) nframes);
+      return;
+    }
+    for (j = 0; j < nchnls; j++) {
+      float       *o = out[j] + offset;
+      const MYFLT *s = in + j;
+      for (i = 0; i < nframes; i++, s += nchnls)
+        o[i] = (float) (*s * scale);
+    }
+}
+
+void cs_interleave(MYFLT *out, const float *const *in, int offset,
+                   int nchnls, int nframes, MYFLT scale)
+{
+    int i, j;
+
+    if (nchnls == 1) {
+      VECOPS()->from_float(out, in[0] + offset, scale, (uint32_t) nframes);
+      return;
+    }
+    for (j = 0; j < nchnls; j++) {
+      const float *s = in[j] + offset;
+      MYFLT       *o = out + j;
+      for (i = 0; i < nframes; i++, o += nchnls)
+        *o = (MYFLT) s[i] * scale;
+    }
+}
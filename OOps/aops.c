@@ -22,6 +22,7 @@
 
 #include "csoundCore.h" /*                                      AOPS.C  */
 #include "aops.h"
+#include "vecops.h"
 #include <math.h>
 #include <time.h>
 
@@ -273,185 +274,134 @@ int modkk(CSOUND *csound, AOP *p)
     return OK;
 }
 
-#define KA(OPNAME,OP)                           \
-  int OPNAME(CSOUND *csound, AOP *p) {          \
-    uint32_t n, nsmps = CS_KSMPS;                    \
-    if (LIKELY(nsmps!=1)) {                     \
-      MYFLT   *r, a, *b;                          \
-      uint32_t offset = p->h.insdshead->ksmps_offset;  \
-      uint32_t early  = p->h.insdshead->ksmps_no_end;  \
-      r = p->r;                                        \
-      a = *p->a;                                       \
-      b = p->b;                                        \
-      if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT)); \
-      if (UNLIKELY(early)) {                           \
-        nsmps -= early;                                \
-        memset(&r[nsmps], '\0', early*sizeof(MYFLT));  \
-      }                                                \
-      for (n=offset; n<nsmps; n++)                     \
-        r[n] = a OP b[n];                              \
-      return OK;                                       \
-    }                                                  \
-    else {                                             \
-        *p->r = *p->a OP *p->b;                        \
-      return OK;                                       \
-    }                                                  \
+/* Clear the parts of r outside the sample-accurate window of the
+   current instance, and return the number of samples up to its end;
+   *offset is set to where the window starts.  */
+
+static inline uint32_t aops_edges(INSDS *ip, MYFLT *r, uint32_t *offset)
+{
+    uint32_t nsmps = ip->ksmps;
+    uint32_t early = ip->ksmps_no_end;
+    *offset = ip->ksmps_offset;
+    if (UNLIKELY(*offset)) memset(r, '\0', *offset*sizeof(MYFLT));
+    if (UNLIKELY(early)) {
+      nsmps -= early;
+      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
+    }
+    return nsmps;
+}
+
+#define KA(OPNAME,KERN,OP)                                      \
+  int OPNAME(CSOUND *csound, AOP *p) {                          \
+    if (LIKELY(CS_KSMPS != 1)) {                                \
+      uint32_t offset,                                          \
+        nsmps = aops_edges(p->h.insdshead, p->r, &offset);      \
+      if (LIKELY(nsmps > offset))                               \
+        VECOPS()->KERN(p->r + offset, *p->a, p->b + offset,     \
+                       nsmps - offset);                         \
+      return OK;                                                \
+    }                                                           \
+    else {                                                      \
+      *p->r = *p->a OP *p->b;                                   \
+      return OK;                                                \
+    }                                                           \
   }
 
-KA(addka,+)
-KA(subka,-)
-KA(mulka,*)
-KA(divka,/)
+KA(addka,add_sv,+)
+KA(subka,sub_sv,-)
+KA(mulka,mul_sv,*)
+KA(divka,div_sv,/)
 
 /* ********COULD BE IMPROVED******** */
 int modka(CSOUND *csound, AOP *p)
 {
-    MYFLT   *r, a, *b;
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
+    MYFLT   *r = p->r, a = *p->a, *b = p->b;
+    uint32_t n, offset,
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);
 
-    r = p->r;
-    a = *p->a;
-    b = p->b;
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
-    }
     for (n=offset; n<nsmps; n++)
       r[n] = MOD(a, b[n]);
     return OK;
 }
 
-#define AK(OPNAME,OP)                           \
-  int OPNAME(CSOUND *csound, AOP *p) {          \
-    uint32_t n, nsmps = CS_KSMPS;               \
-    if (LIKELY(nsmps != 1)) {                   \
-      MYFLT   *r, *a, b;                        \
-      uint32_t offset = p->h.insdshead->ksmps_offset;  \
-      uint32_t early  = p->h.insdshead->ksmps_no_end;  \
-      r = p->r;                                 \
-      a = p->a;                                 \
-      b = *p->b;                                \
-      if (UNLIKELY(offset))                     \
-        memset(r, '\0', offset*sizeof(MYFLT));  \
-      if (UNLIKELY(early)) {                    \
-        nsmps -= early;                         \
-        memset(&r[nsmps], '\0', early*sizeof(MYFLT)); \
-      }                                         \
-      for (n=offset; n<nsmps; n++)              \
-        r[n] = a[n] OP b;                       \
-      return OK;                                \
-    }                                           \
-    else {                                      \
-      p->r[0] = p->a[0] OP *p->b;               \
-      return OK;                                \
-    }                                           \
-}
-
-AK(addak,+)
-AK(subak,-)
-AK(mulak,*)
-//AK(divak,/)
+#define AK(OPNAME,KERN,OP)                                      \
+  int OPNAME(CSOUND *csound, AOP *p) {                          \
+    if (LIKELY(CS_KSMPS != 1)) {                                \
+      uint32_t offset,                                          \
+        nsmps = aops_edges(p->h.insdshead, p->r, &offset);      \
+      if (LIKELY(nsmps > offset))                               \
+        VECOPS()->KERN(p->r + offset, p->a + offset, *p->b,     \
+                       nsmps - offset);                         \
+      return OK;                                                \
+    }                                                           \
+    else {                                                      \
+      p->r[0] = p->a[0] OP *p->b;                               \
+      return OK;                                                \
+    }                                                           \
+  }
+
+AK(addak,add_vs,+)
+AK(subak,sub_vs,-)
+AK(mulak,mul_vs,*)
+//AK(divak,div_vs,/)
 int divak(CSOUND *csound, AOP *p) {
-    uint32_t n, nsmps = CS_KSMPS;  
     MYFLT b = *p->b;
-    if (LIKELY(nsmps != 1)) {      
-      MYFLT   *r, *a;           
-      uint32_t offset = p->h.insdshead->ksmps_offset;
-      uint32_t early  = p->h.insdshead->ksmps_no_end;
-      r = p->r;                    
-      a = p->a;                    
-      b = *p->b;
-      if (UNLIKELY(b==FL(0.0)))
-        csound->Warning(csound, Str("Division by zero"));
-      if (UNLIKELY(offset))        
-        memset(r, '\0', offset*sizeof(MYFLT));
-      if (UNLIKELY(early)) {       
-        nsmps -= early;            
-        memset(&r[nsmps], '\0', early*sizeof(MYFLT)); \
-      }                            
-      for (n=offset; n<nsmps; n++) 
-        r[n] = a[n] / b;          
-      return OK;                   
-    }                              
-    else {                         
-      if (UNLIKELY(b==FL(0.0)))
-        csound->Warning(csound, Str("Division by zero"));
-      p->r[0] = p->a[0] / b;  
-      return OK;                   
-    }                              
+    if (UNLIKELY(b==FL(0.0)))
+      csound->Warning(csound, Str("Division by zero"));
+    if (LIKELY(CS_KSMPS != 1)) {
+      uint32_t offset,
+        nsmps = aops_edges(p->h.insdshead, p->r, &offset);
+      if (LIKELY(nsmps > offset))
+        VECOPS()->div_vs(p->r + offset, p->a + offset, b, nsmps - offset);
+      return OK;
+    }
+    else {
+      p->r[0] = p->a[0] / b;
+      return OK;
+    }
 }
 
 
 /* ********COULD BE IMPROVED******** */
 int modak(CSOUND *csound, AOP *p)
 {
-    MYFLT   *r, *a, b;
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
+    MYFLT   *r = p->r, *a = p->a, b = *p->b;
+    uint32_t n, offset,
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);
 
-    r = p->r;
-    a = p->a;
-    b = *p->b;
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
-    }
     for (n=offset; n<nsmps; n++)
       r[n] = MOD(a[n], b);
     return OK;
 }
 
-#define AA(OPNAME,OP)                           \
-  int OPNAME(CSOUND *csound, AOP *p) {          \
-  MYFLT   *r, *a, *b;                           \
-  uint32_t n, nsmps = CS_KSMPS;                 \
-  if (LIKELY(nsmps!=1)) {                       \
-    uint32_t offset = p->h.insdshead->ksmps_offset;       \
-    uint32_t early  = p->h.insdshead->ksmps_no_end;  \
-    r = p->r;                                   \
-    a = p->a;                                   \
-    b = p->b;                                   \
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT)); \
-    if (UNLIKELY(early)) {                      \
-      nsmps -= early;                           \
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT)); \
-    }                                           \
-    for (n=offset; n<nsmps; n++)                \
-      r[n] = a[n] OP b[n];                      \
-    return OK;                                  \
-  }                                             \
-    else {                                      \
-      *p->r = *p->a OP *p->b;                    \
-      return OK;                                \
-    }                                           \
+#define AA(OPNAME,KERN,OP)                                      \
+  int OPNAME(CSOUND *csound, AOP *p) {                          \
+    if (LIKELY(CS_KSMPS != 1)) {                                \
+      uint32_t offset,                                          \
+        nsmps = aops_edges(p->h.insdshead, p->r, &offset);      \
+      if (LIKELY(nsmps > offset))                               \
+        VECOPS()->KERN(p->r + offset, p->a + offset,            \
+                       p->b + offset, nsmps - offset);          \
+      return OK;                                                \
+    }                                                           \
+    else {                                                      \
+      *p->r = *p->a OP *p->b;                                   \
+      return OK;                                                \
+    }                                                           \
   }
 
-AA(addaa,+)
-AA(subaa,-)
-AA(mulaa,*)
-AA(divaa,/)
+AA(addaa,add_vv,+)
+AA(subaa,sub_vv,-)
+AA(mulaa,mul_vv,*)
+AA(divaa,div_vv,/)
 
 /* ********COULD BE IMPROVED******** */
 int modaa(CSOUND *csound, AOP *p)
 {
-    MYFLT   *r, *a, *b;
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
+    MYFLT   *r = p->r, *a = p->a, *b = p->b;
+    uint32_t n, offset,
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);
 
-    r = p->r;
-    a = p->a;
-    b = p->b;
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
-    }
     for (n=offset; n<nsmps; n++)
       r[n] = MOD(a[n], b[n]);
     return OK;
@@ -467,73 +417,134 @@ int divzkk(CSOUND *csound, DIVZ *p)
 
 int divzka(CSOUND *csound, DIVZ *p)
 {
-    uint32_t n;
-    MYFLT    *r, a, *b, def;
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t nsmps = CS_KSMPS;
+    uint32_t offset,
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);
 
-    r = p->r;
-    a = *p->a;
-    b = p->b;
-    def = *p->def;
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
-    }
-    for (n=offset; n<nsmps; n++)
-      r[n] = (b[n]==FL(0.0) ? def : a / b[n]);
+    if (LIKELY(nsmps > offset))
+      VECOPS()->divz_sv(p->r + offset, *p->a, p->b + offset, *p->def,
+                        nsmps - offset);
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 int divzak(CSOUND *csound, DIVZ *p)
 {
-    uint32_t n;
-    MYFLT    *r, *a, b, def;
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t nsmps = CS_KSMPS;
+    uint32_t n, offset,
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);
+    MYFLT    *r = p->r, b = *p->b;
 
-    r = p->r;
-    a = p->a;
-    b = *p->b;
-    def = *p->def;
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
-    }
     if (UNLIKELY(b==FL(0.0))) {
-      for (n=offset; n<nsmps; n++) r[n] = def;
-    }
-    else {
-      for (n=offset; n<nsmps; n++) r[n] = a[n] / b;
+      for (n=offset; n<nsmps; n++) r[n] = *p->def;
     }
+    else if (LIKELY(nsmps > offset))
+      VECOPS()->div_vs(r + offset, p->a + offset, b, nsmps - offset);
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 int divzaa(CSOUND *csound, DIVZ *p)
 {
-    uint32_t n;
-    MYFLT    *r, *a, *b, def;
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t nsmps = CS_KSMPS;
+    uint32_t offset,
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);
 
-    r = p->r;
-    a = p->a;
-    b = p->b;
-    def = *p->def;
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
+    if (LIKELY(nsmps > offset))
+      VECOPS()->divz_vv(p->r + offset, p->a + offset, p->b + offset,
+                        *p->def, nsmps - offset);
+    return OK;
+}
+
+int expr_init(CSOUND *csound, EXPR *p)
+{
+    const char *c;
+    int      nargs = p->INOCOUNT - 1, sp = 0;
+
+    for (c = p->prog->data; *c != '\0'; c++) {
+      if (*c >= 'A' && *c <= 'Z') {
+        if (UNLIKELY(*c - 'A' >= nargs || ++sp > EXPR_DEPTH))
+          break;
+      }
+      else if (UNLIKELY(strchr("+-*/", *c) == NULL || --sp < 1))
+        break;
+    }
+    if (UNLIKELY(*c != '\0' || sp != 1 || c - p->prog->data > EXPR_MAXCODE))
+      return csound->InitError(csound, Str("invalid expression program %s"),
+                               p->prog->data);
+    p->code = p->prog->data;
+    p->amask = (uint32_t) (csound->GetInputArgAMask(p) >> 1);
+    return OK;
+}
+
+int expr_perf(CSOUND *csound, EXPR *p)
+{
+    const CS_VECOPS *v = VECOPS();
+    MYFLT    reg[EXPR_DEPTH][EXPR_BLOCK];
+    MYFLT    *vec[EXPR_DEPTH], sca[EXPR_DEPTH];
+    uint32_t n, m, offset,
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);
+    const char *c;
+    int      i, sp;
+
+    for (n = offset; n < nsmps; n += m) {
+      m = (nsmps - n < EXPR_BLOCK ? nsmps - n : EXPR_BLOCK);
+      for (c = p->code, sp = 0; *c != '\0'; c++) {
+        MYFLT *x, *y, *d;
+        if (*c >= 'A') {                        /* push an operand */
+          i = *c - 'A';
+          if (p->amask & (1U << i))
+            vec[sp] = p->args[i] + n;
+          else {
+            vec[sp] = NULL;
+            sca[sp] = *p->args[i];
+          }
+          sp++;
+          continue;
+        }
+        i = (--sp) - 1;                         /* x op y -> x */
+        x = vec[i]; y = vec[sp];
+        d = (c[1] == '\0' ? p->r + n : reg[i]);
+        if (x != NULL && y != NULL) {
+          switch (*c) {
+          case '+': v->add_vv(d, x, y, m); break;
+          case '-': v->sub_vv(d, x, y, m); break;
+          case '*': v->mul_vv(d, x, y, m); break;
+          default:  v->div_vv(d, x, y, m); break;
+          }
+        }
+        else if (y != NULL) {
+          switch (*c) {
+          case '+': v->add_sv(d, sca[i], y, m); break;
+          case '-': v->sub_sv(d, sca[i], y, m); break;
+          case '*': v->mul_sv(d, sca[i], y, m); break;
+          default:  v->div_sv(d, sca[i], y, m); break;
+          }
+        }
+        else if (x != NULL) {
+          switch (*c) {
+          case '+': v->add_vs(d, x, sca[sp], m); break;
+          case '-': v->sub_vs(d, x, sca[sp], m); break;
+          case '*': v->mul_vs(d, x, sca[sp], m); break;
+          default:
+            if (UNLIKELY(sca[sp] == FL(0.0) && n == offset))
+              csound->Warning(csound, Str("Division by zero"));
+            v->div_vs(d, x, sca[sp], m);
+            break;
+          }
+        }
+        else {                                  /* both scalars */
+          switch (*c) {
+          case '+': sca[i] = sca[i] + sca[sp]; break;
+          case '-': sca[i] = sca[i] - sca[sp]; break;
+          case '*': sca[i] = sca[i] * sca[sp]; break;
+          default:  sca[i] = sca[i] / sca[sp]; break;
+          }
+          continue;
+        }
+        vec[i] = d;
+      }
+      if (UNLIKELY(vec[0] == NULL))             /* a scalar result */
+        for (i = 0; i < (int) m; i++)
+          p->r[n + i] = sca[0];
+      else if (vec[0] != p->r + n)              /* a lone operand */
+        memmove(p->r + n, vec[0], m * sizeof(MYFLT));
     }
-    for (n=offset; n<nsmps; n++)
-      r[n] = (b[n]==FL(0.0) ? def : a[n] / b[n]);
     return OK;
 }
 
@@ -575,23 +586,13 @@ int int1(CSOUND *csound, EVAL *p)               /* returns signed whole no. */
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 int int1a(CSOUND *csound, EVAL *p)              /* returns signed whole no. */
 {
-    MYFLT        intpart, *a=p->a, *r=p->r;
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
+    uint32_t offset,
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);
 
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
-    }
-    for (n = offset; n < nsmps; n++) {
-      MODF(a[n], &intpart);
-      r[n] = intpart;
-    }
+    if (LIKELY(nsmps > offset))
+      VECOPS()->trunc(p->r + offset, p->a + offset, nsmps - offset);
     return OK;
 }
 
@@ -604,23 +605,13 @@ int frac1(CSOUND *csound, EVAL *p)              /* returns positive frac part */
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 int frac1a(CSOUND *csound, EVAL *p)             /* returns positive frac part */
 {
-    MYFLT intpart, fracpart, *r = p->r, *a = p->a;
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
+    uint32_t offset,
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);
 
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
-    }
-    for (n = offset; n < nsmps; n++) {
-      fracpart = MODF(a[n], &intpart);
-      r[n] = fracpart;
-    }
+    if (LIKELY(nsmps > offset))
+      VECOPS()->frac(p->r + offset, p->a + offset, nsmps - offset);
     return OK;
 }
 
@@ -641,21 +632,13 @@ int int1_round(CSOUND *csound, EVAL *p)         /* round to nearest integer */
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 int int1a_round(CSOUND *csound, EVAL *p)        /* round to nearest integer */
 {
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
-    MYFLT *r=p->r, *a=p->a;
+    uint32_t offset,
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);
 
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
-    }
-    for (n = offset; n < nsmps; n++)
-      r[n] = (MYFLT)MYFLT2LRND(a[n]);
+    if (LIKELY(nsmps > offset))
+      VECOPS()->round(p->r + offset, p->a + offset, nsmps - offset);
     return OK;
 }
 
@@ -666,21 +649,13 @@ int int1_floor(CSOUND *csound, EVAL *p)         /* round down */
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 int int1a_floor(CSOUND *csound, EVAL *p)        /* round down */
 {
-    MYFLT    *a=p->a, *r=p->r;
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
+    uint32_t offset,
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);
 
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
-    }
-    for (n = offset; n < nsmps; n++)
-      r[n] = (MYFLT)(MYFLOOR(a[n]));
+    if (LIKELY(nsmps > offset))
+      VECOPS()->floor(p->r + offset, p->a + offset, nsmps - offset);
     return OK;
 }
 
@@ -691,21 +666,13 @@ int int1_ceil(CSOUND *csound, EVAL *p)          /* round up */
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 int int1a_ceil(CSOUND *csound, EVAL *p)         /* round up */
 {
-    MYFLT    *a=p->a, *r=p->r;
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
+    uint32_t offset,
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);
 
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
-    }
-    for (n = offset; n < nsmps; n++)
-      r[n] = (MYFLT)(MYCEIL(a[n]));
+    if (LIKELY(nsmps > offset))
+      VECOPS()->ceil(p->r + offset, p->a + offset, nsmps - offset);
     return OK;
 }
 
@@ -752,19 +719,10 @@ int atan21(CSOUND *csound, AOP *p)
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 #define LIBA(OPNAME,LIBNAME) int OPNAME(CSOUND *csound, EVAL *p) {      \
-    uint32_t offset = p->h.insdshead->ksmps_offset;                     \
-    uint32_t early  = p->h.insdshead->ksmps_no_end;                     \
-    uint32_t n, nsmps =CS_KSMPS;                                        \
-    MYFLT   *r, *a;                                                     \
-    r = p->r;                                                           \
-    a = p->a;                                                           \
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));        \
-    if (UNLIKELY(early)) {                                              \
-      nsmps -= early;                                                   \
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));                     \
-    }                                                                   \
+    uint32_t n, offset,                                                 \
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);                \
+    MYFLT   *r = p->r, *a = p->a;                                       \
     for (n = offset; n < nsmps; n++)                                    \
       r[n] = LIBNAME(a[n]);                                             \
     return OK;                                                          \
@@ -788,19 +746,10 @@ LIBA(log2a,LOG2)
 /* ********COULD BE IMPROVED******** */
 int atan2aa(CSOUND *csound, AOP *p)
 {
-    MYFLT   *r, *a, *b;
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
+    MYFLT   *r = p->r, *a = p->a, *b = p->b;
+    uint32_t n, offset,
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);
 
-    r = p->r;
-    a = p->a;
-    b = p->b;
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
-    }
     for (n = offset; n < nsmps; n++)
       r[n] = ATAN2(a[n], b[n]);
     return OK;
@@ -822,16 +771,10 @@ int ampdb(CSOUND *csound, EVAL *p)
 
 int aampdb(CSOUND *csound, EVAL *p)
 {
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
     MYFLT   *r = p->r, *a = p->a;
+    uint32_t n, offset,
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);
 
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
-    }
     for (n = offset; n < nsmps; n++)
       r[n] = EXP(a[n] * LOG10D20);
     return OK;
@@ -852,20 +795,12 @@ int ampdbfs(CSOUND *csound, EVAL *p)
 /* ********COULD BE IMPROVED******** */
 int aampdbfs(CSOUND *csound, EVAL *p)
 {
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
-    MYFLT   *r, *a;
+    MYFLT   *r = p->r, *a = p->a, e0dbfs = csound->e0dbfs;
+    uint32_t n, offset,
+      nsmps = aops_edges(p->h.insdshead, p->r, &offset);
 
-    r = p->r;
-    a = p->a;
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
-    }
     for (n = offset; n < nsmps; n++)
-      r[n] = csound->e0dbfs * EXP(a[n] * LOG10D20);
+      r[n] = e0dbfs * EXP(a[n] * LOG10D20);
     return OK;
 }
 
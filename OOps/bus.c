@@ -72,47 +72,229 @@
 
 
 
+static CHNENTRY *get_channel(CSOUND *, const char *, int, int *);
+static inline int *channel_lock(CHNENTRY *);
+
+/* Control channel values are a single MYFLT and are read and written
+   with plain atomic loads and stores, so neither side ever waits. */
+
+static inline MYFLT chn_load_k(MYFLT *fp)
+{
+    union {
+      MYFLT d;
+      MYFLT_INT_TYPE i;
+    } x;
+#if defined(__ATOMIC_ACQUIRE)
+    x.i = __atomic_load_n((MYFLT_INT_TYPE *) fp, __ATOMIC_ACQUIRE);
+#elif defined(HAVE_ATOMIC_BUILTIN)
+    x.i = __sync_fetch_and_add((MYFLT_INT_TYPE *) fp, 0);
+#else
+    x.d = *fp;
+#endif
+    return x.d;
+}
+
+static inline void chn_store_k(MYFLT *fp, MYFLT val)
+{
+    union {
+      MYFLT d;
+      MYFLT_INT_TYPE i;
+    } x;
+    x.d = val;
+#if defined(__ATOMIC_RELEASE)
+    __atomic_store_n((MYFLT_INT_TYPE *) fp, x.i, __ATOMIC_RELEASE);
+#elif defined(HAVE_ATOMIC_BUILTIN)
+    __sync_lock_test_and_set((MYFLT_INT_TYPE *) fp, x.i);
+#else
+    *fp = x.d;
+#endif
+}
+
+/* Opcodes read and write audio channels under the channel lock, as do
+   hosts using csoundGetChannelPtr() with csoundGetChannelLock().
+   Writers also make the sequence count odd while they touch the data,
+   so that csoundGetAudioChannelByHandle() can copy it without the lock,
+   trying again if a write overlapped the copy.
+
+   csoundSetAudioChannelByHandle() and csoundMixAudioChannelByHandle()
+   never take the channel lock, as a host thread preempted while holding
+   it would stall the performance.  They write to a separate buffer,
+   hostdata, under hostlock, and set chn_host_pending.  Once per k-cycle,
+   before any instrument runs, chn_merge_host() copies (or mixes) that
+   into the data of every channel, including those exported from global
+   variables with chnexport.  If the host is writing a channel just then,
+   that channel is left for the next k-cycle.
+
+   Without atomic builtins everything falls back to the channel lock. */
+
+#define CHN_HOST_NONE   0
+#define CHN_HOST_SET    1       /* hostdata replaces the data */
+#define CHN_HOST_MIX    2       /* hostdata is added to the data */
+
+#ifdef HAVE_ATOMIC_BUILTIN
+static inline void chn_host_lock(CHNENTRY *chn)
+{
+    while (__sync_lock_test_and_set(&chn->hostlock, 1))
+      ;
+}
+
+static inline void chn_host_unlock(CHNENTRY *chn)
+{
+    __sync_lock_release(&chn->hostlock);
+}
+
+/* with the channel lock held: take the host's samples, if there are
+   any; returns zero if the host is writing them now */
+static inline int chn_take_host(CHNENTRY *chn)
+{
+    int     i;
+
+    if (chn->hoststate == CHN_HOST_NONE)
+      return 1;
+    if (__sync_lock_test_and_set(&chn->hostlock, 1))
+      return 0;
+    if (chn->hoststate == CHN_HOST_SET)
+      memcpy(chn->data, chn->hostdata, chn->nhost * sizeof(MYFLT));
+    else if (chn->hoststate == CHN_HOST_MIX)
+      for (i = 0; i < chn->nhost; i++)
+        chn->data[i] += chn->hostdata[i];
+    chn->hoststate = CHN_HOST_NONE;
+    __sync_lock_release(&chn->hostlock);
+    return 1;
+}
+#endif
+
+static inline void chn_write_begin(CHNENTRY *chn)
+{
+    csoundSpinLock(channel_lock(chn));
+#ifdef HAVE_ATOMIC_BUILTIN
+    chn->seq++;
+    __sync_synchronize();
+#endif
+}
+
+static inline void chn_write_end(CHNENTRY *chn)
+{
+#ifdef HAVE_ATOMIC_BUILTIN
+    __sync_synchronize();
+    chn->seq++;
+#endif
+    csoundSpinUnLock(channel_lock(chn));
+}
+
+#ifdef HAVE_ATOMIC_BUILTIN
+/* for csoundGetAudioChannelByHandle(): host writes go to hostdata, so
+   this only waits for performance threads */
+static inline unsigned int chn_read_seq(CHNENTRY *chn)
+{
+    unsigned int seq;
+    while ((seq = chn->seq) & 1U)
+      ;
+    __sync_synchronize();
+    return seq;
+}
+#endif
+
+static inline unsigned int chn_read_begin(CHNENTRY *chn)
+{
+    csoundSpinLock(channel_lock(chn));
+    return 0U;
+}
+
+static inline int chn_read_retry(CHNENTRY *chn, unsigned int seq)
+{
+    IGN(seq);
+    csoundSpinUnLock(channel_lock(chn));
+    return 0;
+}
+
+/* called by the performance thread at the start of each k-cycle */
+
+void chn_merge_host(CSOUND *csound)
+{
+#ifdef HAVE_ATOMIC_BUILTIN
+    CS_HASH_TABLE *db;
+    CHNENTRY      *chn;
+    unsigned int  i;
+
+    if (!__sync_lock_test_and_set(&csound->chn_host_pending, 0))
+      return;
+    csoundSpinLock(&csound->chn_db_lock);
+    db = csound->chn_db;
+    for (i = 0; db != NULL && i < db->size; i++) {
+      if (db->items[i].key == NULL)
+        continue;
+      chn = (CHNENTRY*) db->items[i].value;
+      if (LIKELY(chn->hoststate == CHN_HOST_NONE))
+        continue;
+      chn_write_begin(chn);
+      if (!chn_take_host(chn))
+        csound->chn_host_pending = 1;   /* try again next k-cycle */
+      chn_write_end(chn);
+    }
+    csoundSpinUnLock(&csound->chn_db_lock);
+#else
+    IGN(csound);
+#endif
+}
+
+/* channel for bus number n; the handle is cached in the opcode and only
+   looked up again when n changes */
+
+static inline CHNENTRY *numbered_channel(CSOUND *csound, CHNENTRY **chn,
+                                         int *chn_n, int n, int type, int *err)
+{
+    if (UNLIKELY(*chn == NULL || *chn_n != n)) {
+      char chan_name[16];
+      snprintf(chan_name, 16, "%i", n);
+      *chn = get_channel(csound, chan_name, type, err);
+      *chn_n = n;
+    }
+    return *chn;
+}
+
+int chnval_opcode_init(CSOUND *csound, CHNVAL *p)
+{
+    IGN(csound);
+    p->chn = NULL;
+    return OK;
+}
+
 int chani_opcode_perf_k(CSOUND *csound, CHNVAL *p)
 {
     int     n = (int)MYFLT2LRND(*(p->a));
-    char chan_name[16];
-    int   err;
-    MYFLT *val;
+    int   err = CSOUND_ERROR;
+    CHNENTRY *chn;
 
     if (UNLIKELY(n < 0))
       return csound->PerfError(csound, p->h.insdshead,Str("chani: invalid index"));
 
-    snprintf(chan_name, 16, "%i", n);
-    err = csoundGetChannelPtr(csound, &val, chan_name,
-                              CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
-
-    if (UNLIKELY(err))
+    chn = numbered_channel(csound, &p->chn, &p->n, n,
+                           CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL, &err);
+    if (UNLIKELY(chn == NULL))
       return csound->PerfError(csound, p->h.insdshead,
                                Str("chani error %d:"
                                    "channel not found or not right type"), err);
-    *(p->r) = *val;
+    *(p->r) = chn_load_k(chn->data);
     return OK;
 }
 
 int chano_opcode_perf_k(CSOUND *csound, CHNVAL *p)
 {
     int     n = (int)MYFLT2LRND(*(p->a));
-    char chan_name[16];
-    int   err;
-    MYFLT *val;
+    int   err = CSOUND_ERROR;
+    CHNENTRY *chn;
 
     if (UNLIKELY(n < 0))
       return csound->PerfError(csound,p->h.insdshead,Str("chani: invalid index"));
 
-    snprintf(chan_name, 16, "%i", n);
-    err = csoundGetChannelPtr(csound, &val, chan_name,
-                              CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
-
-    if (UNLIKELY(err))
+    chn = numbered_channel(csound, &p->chn, &p->n, n,
+                           CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL, &err);
+    if (UNLIKELY(chn == NULL))
       return csound->PerfError(csound, p->h.insdshead,
                                Str("chano error %d:"
                                    "channel not found or not right type"), err);
-    *val = *(p->r);
+    chn_store_k(chn->data, *(p->r));
     return OK;
 }
 
@@ -122,23 +304,27 @@ int chani_opcode_perf_a(CSOUND *csound, CHNVAL *p)
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
 
-    char chan_name[16];
-    int   err;
+    int   err = CSOUND_ERROR;
+    CHNENTRY *chn;
     MYFLT *val;
+    unsigned int seq;
 
     if (UNLIKELY(n < 0))
       return csound->PerfError(csound, p->h.insdshead,Str("chani: invalid index"));
 
-    snprintf(chan_name, 16, "%i", n);
-    err = csoundGetChannelPtr(csound, &val, chan_name,
-                              CSOUND_AUDIO_CHANNEL | CSOUND_INPUT_CHANNEL);
-    if (UNLIKELY(err))
+    chn = numbered_channel(csound, &p->chn, &p->n, n,
+                           CSOUND_AUDIO_CHANNEL | CSOUND_INPUT_CHANNEL, &err);
+    if (UNLIKELY(chn == NULL))
       return csound->PerfError(csound, p->h.insdshead,
                                Str("chani error %d:"
                                    "channel not found or not right type"), err);
+    val = chn->data;
     if (UNLIKELY(offset)) memset(p->r, '\0', offset * sizeof(MYFLT));
-    memcpy(&p->r[offset], &val[offset],
-           sizeof(MYFLT) * (CS_KSMPS-offset-early));
+    do {
+      seq = chn_read_begin(chn);
+      memcpy(&p->r[offset], &val[offset],
+             sizeof(MYFLT) * (CS_KSMPS-offset-early));
+    } while (UNLIKELY(chn_read_retry(chn, seq)));
     if (UNLIKELY(early))
       memset(&p->r[CS_KSMPS-early], '\0', early * sizeof(MYFLT));
     return OK;
@@ -150,44 +336,43 @@ int chano_opcode_perf_a(CSOUND *csound, CHNVAL *p)
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
 
-    char chan_name[16];
-    int   err;
+    int   err = CSOUND_ERROR;
+    CHNENTRY *chn;
     MYFLT *val;
 
     if (UNLIKELY(n < 0))
       return csound->PerfError(csound, p->h.insdshead,Str("chani: invalid index"));
 
-    snprintf(chan_name, 16, "%i", n);
-    err = csoundGetChannelPtr(csound, &val, chan_name,
-                              CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL);
-    if (UNLIKELY(err))
+    chn = numbered_channel(csound, &p->chn, &p->n, n,
+                           CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL, &err);
+    if (UNLIKELY(chn == NULL))
       return csound->PerfError(csound, p->h.insdshead,
                                Str("chano error %d:"
                                    "channel not found or not right type"), err);
-
-    if (UNLIKELY(offset)) memset(&val, '\0', offset * sizeof(MYFLT));
+    val = chn->data;
+    chn_write_begin(chn);
+    if (UNLIKELY(offset)) memset(val, '\0', offset * sizeof(MYFLT));
     memcpy(&val[offset], &p->r[offset],
            sizeof(MYFLT) * (CS_KSMPS-offset-early));
 
     if (UNLIKELY(early))
       memset(&val[CS_KSMPS-early], '\0', early * sizeof(MYFLT));
+    chn_write_end(chn);
     return OK;
 }
 
 int pvsin_init(CSOUND *csound, FCHAN *p)
 {
-    int N;
-    MYFLT *pp;
+    int N, err;
     PVSDATEXT *f;
     int     n = (int)MYFLT2LRND(*(p->a));
-    char name[16];
-    snprintf(name, 16, "%i", n);
-    if (csoundGetChannelPtr(csound, &pp, name,
-                           CSOUND_PVS_CHANNEL | CSOUND_INPUT_CHANNEL)
-            == CSOUND_SUCCESS){
-        int    *lock =
-                csoundGetChannelLock(csound, name);
-        f = (PVSDATEXT *) pp;
+
+    p->chn = NULL;
+    if (numbered_channel(csound, &p->chn, &p->n, n,
+                         CSOUND_PVS_CHANNEL | CSOUND_INPUT_CHANNEL, &err)
+            != NULL){
+        int    *lock = channel_lock(p->chn);
+        f = (PVSDATEXT *) p->chn->data;
         csoundSpinLock(lock);
         memcpy(&(p->init), f, sizeof(PVSDAT)-sizeof(AUXCH));
         csoundSpinUnLock(lock);
@@ -210,25 +395,23 @@ int pvsin_perf(CSOUND *csound, FCHAN *p)
 {
     PVSDAT *fout = p->r;
     int     n = (int)MYFLT2LRND(*(p->a));
-    char chan_name[16];
-    int   err, size, *lock;
+    int   err = CSOUND_ERROR, size, *lock;
     PVSDATEXT *fin;
-    MYFLT      *pp;
+    CHNENTRY  *chn;
 
     if (UNLIKELY(n < 0))
       return csound->PerfError(csound, p->h.insdshead,Str("pvsin: invalid index"));
 
-    snprintf(chan_name, 16, "%i", n);
-    err = csoundGetChannelPtr(csound, &pp, chan_name,
-                              CSOUND_PVS_CHANNEL | CSOUND_INPUT_CHANNEL);
-    fin = (PVSDATEXT *) pp;
-    if (UNLIKELY(err))
+    chn = numbered_channel(csound, &p->chn, &p->n, n,
+                           CSOUND_PVS_CHANNEL | CSOUND_INPUT_CHANNEL, &err);
+    if (UNLIKELY(chn == NULL))
       return csound->PerfError(csound, p->h.insdshead,
                                Str("pvsin error %d:"
                                    "channel not found or not right type"), err);
+    fin = (PVSDATEXT *) chn->data;
 
     size = fin->N < fout->N ? fin->N : fout->N;
-    lock = csoundGetChannelLock(csound, chan_name);
+    lock = channel_lock(chn);
     csoundSpinLock(lock);
     memcpy(fout, fin, sizeof(PVSDAT)-sizeof(AUXCH));
     //printf("fout=%p fout->frame.auxp=%p fin=%p fin->frame=%p\n",
@@ -243,18 +426,15 @@ int pvsin_perf(CSOUND *csound, FCHAN *p)
 int pvsout_init(CSOUND *csound, FCHAN *p)
 {
     PVSDAT *fin = p->r;
-    MYFLT *pp;
     PVSDATEXT *f;
-    int     n = (int)MYFLT2LRND(*(p->a));
-    char name[16];
-
-    snprintf(name, 16, "%i", n);
-    if (csoundGetChannelPtr(csound, &pp, name,
-                           CSOUND_PVS_CHANNEL | CSOUND_OUTPUT_CHANNEL)
-            == CSOUND_SUCCESS){
-        int    *lock =
-                csoundGetChannelLock(csound, name);
-        f = (PVSDATEXT *) pp;
+    int     n = (int)MYFLT2LRND(*(p->a)), err;
+
+    p->chn = NULL;
+    if (numbered_channel(csound, &p->chn, &p->n, n,
+                         CSOUND_PVS_CHANNEL | CSOUND_OUTPUT_CHANNEL, &err)
+            != NULL){
+        int    *lock = channel_lock(p->chn);
+        f = (PVSDATEXT *) p->chn->data;
         csoundSpinLock(lock);
         if(f->frame == NULL) {
           f->frame = csound->Calloc(csound, sizeof(float)*(fin->N+2));
@@ -273,24 +453,22 @@ int pvsout_perf(CSOUND *csound, FCHAN *p)
 
     PVSDAT *fin = p->r;
     int     n = (int)MYFLT2LRND(*(p->a));
-    char chan_name[16];
-    int   err, size, *lock;
+    int   err = CSOUND_ERROR, size, *lock;
     PVSDATEXT *fout;
-    MYFLT *pp;
+    CHNENTRY  *chn;
 
     if (UNLIKELY(n < 0))
       return csound->PerfError(csound, p->h.insdshead,Str("pvsout: invalid index"));
 
-    snprintf(chan_name, 16, "%i", n);
-    err = csoundGetChannelPtr(csound, &pp, chan_name,
-                              CSOUND_PVS_CHANNEL | CSOUND_OUTPUT_CHANNEL);
-    fout = (PVSDATEXT *) pp;
-    if (UNLIKELY(err))
+    chn = numbered_channel(csound, &p->chn, &p->n, n,
+                           CSOUND_PVS_CHANNEL | CSOUND_OUTPUT_CHANNEL, &err);
+    if (UNLIKELY(chn == NULL))
       return csound->PerfError(csound, p->h.insdshead,
                                Str("pvsout error %d:"
                                    "channel not found or not right type"), err);
+    fout = (PVSDATEXT *) chn->data;
 
-    lock = csoundGetChannelLock(csound, chan_name);
+    lock = channel_lock(chn);
     csoundSpinLock(lock);
     size = fin->N < fout->N ? fin->N : fout->N;
     memcpy(fout, fin, sizeof(PVSDAT)-sizeof(AUXCH));
@@ -320,6 +498,8 @@ static int delete_channel_db(CSOUND *csound, void *p)
           if ((entry->type & CSOUND_CHANNEL_TYPE_MASK) != CSOUND_CONTROL_CHANNEL) {
             csound->Free(csound, entry->hints.attributes);
           }
+          if (entry->hostdata != NULL)
+            csound->Free(csound, entry->hostdata);
           csound->Free(csound, entry->data);
           entry->datasize = 0;
           values = values->next;
@@ -332,18 +512,35 @@ static int delete_channel_db(CSOUND *csound, void *p)
     return 0;
 }
 
-static inline CHNENTRY *find_channel(CSOUND *csound, const char *name)
+/* chn_db is looked up by the performance and init threads and by host
+   threads, any of which may add a channel, and an insert can move the
+   items of the table; so lookups and inserts hold chn_db_lock.  Channel
+   handles and the data of a channel are used without it. */
+
+static inline CHNENTRY *find_channel_hashed(CSOUND *csound, const char *name,
+                                            unsigned int hash)
 {
+    CHNENTRY  *pp = NULL;
+
     if (csound->chn_db != NULL && name[0]) {
-        return (CHNENTRY*) cs_hash_table_get(csound, csound->chn_db, (char*) name);
+        csoundSpinLock(&csound->chn_db_lock);
+        pp = (CHNENTRY*) cs_hash_table_get_hashed(csound, csound->chn_db,
+                                                  name, hash);
+        csoundSpinUnLock(&csound->chn_db_lock);
     }
-    return NULL;
+    return pp;
+}
+
+static inline CHNENTRY *find_channel(CSOUND *csound, const char *name)
+{
+    return find_channel_hashed(csound, name, cs_hash_table_hash(name));
 }
 
 void set_channel_data_ptr(CSOUND *csound, const char *name, void *ptr, int newSize)
 {
-    find_channel(csound, name)->data = (MYFLT *) ptr;
-    find_channel(csound, name)->datasize = newSize;
+    CHNENTRY *pp = find_channel(csound, name);
+    pp->data = (MYFLT *) ptr;
+    pp->datasize = newSize;
 }
 
 #define INIT_STRING_CHANNEL_DATASIZE 256
@@ -376,6 +573,10 @@ static CS_NOINLINE CHNENTRY *alloc_channel(CSOUND *csound,
         ((STRINGDAT*) pp->data)->size = 128;
         ((STRINGDAT*) pp->data)->data = csound->Calloc(csound, 128 * sizeof(char));
     }
+    if ((type & CSOUND_CHANNEL_TYPE_MASK) == CSOUND_AUDIO_CHANNEL) {
+        pp->hostdata = (MYFLT *) csound->Calloc(csound, dsize);
+        pp->nhost = csound->ksmps;
+    }
 
 #ifndef MACOSX
 #if defined(HAVE_PTHREAD_SPIN_LOCK)
@@ -388,59 +589,261 @@ static CS_NOINLINE CHNENTRY *alloc_channel(CSOUND *csound,
     return (CHNENTRY*) pp;
 }
 
+static void free_channel(CSOUND *csound, CHNENTRY *pp)
+{
+    if ((pp->type & CSOUND_CHANNEL_TYPE_MASK) == CSOUND_STRING_CHANNEL)
+      csound->Free(csound, ((STRINGDAT*) pp->data)->data);
+    if (pp->hostdata != NULL)
+      csound->Free(csound, pp->hostdata);
+    csound->Free(csound, pp->data);
+    csound->Free(csound, pp);
+}
+
 static CS_NOINLINE int create_new_channel(CSOUND *csound, const char *name,
                                           int type)
 {
     CHNENTRY      *pp;
+    CS_HASH_TABLE *db = NULL, *spare = NULL;
+    CS_HASH_TABLE_ITEM *items = NULL, *old = NULL;
+    unsigned int  size = 0;
+    char          *key;
     /* check for valid parameters and calculate hash value */
     if (UNLIKELY(!(type & 48)))
       return CSOUND_ERROR;
 
-    /* create new empty database if not allocated */
-    if (csound->chn_db == NULL) {
-      csound->chn_db = cs_hash_table_create(csound);
-      if (UNLIKELY(csound->RegisterResetCallback(csound, NULL,
-                                                 delete_channel_db) != 0))
-          return CSOUND_MEMORY;
-      if (UNLIKELY(csound->chn_db == NULL))
-        return CSOUND_MEMORY;
-    }
-    /* allocate new entry */
+    /* allocate new entry, and its key, before taking the spinlock:
+       other threads may be spinning on it meanwhile */
     pp = alloc_channel(csound, name, type);
     if (UNLIKELY(pp == NULL))
       return CSOUND_MEMORY;
     pp->hints.behav = 0;
     pp->type = type;
     strcpy(&(pp->name[0]), name);
-
-    cs_hash_table_put(csound, csound->chn_db, (char*)name, pp);
+    key = (char*) csound->Malloc(csound, strlen(name) + 1);
+    strcpy(key, name);
+
+    for (;;) {
+      csoundSpinLock(&csound->chn_db_lock);
+      if (csound->chn_db == NULL && spare != NULL) {
+        csound->chn_db = spare;
+        spare = NULL;
+      }
+      db = csound->chn_db;
+      if (db != NULL && cs_hash_table_get(csound, db, (char*) name) != NULL) {
+        /* another thread has made the channel since it was looked for */
+        csoundSpinUnLock(&csound->chn_db_lock);
+        csound->Free(csound, key);
+        free_channel(csound, pp);
+        break;
+      }
+      if (db != NULL && !cs_hash_table_full(db)) {
+        cs_hash_table_put_no_key_copy(csound, db, key, pp);
+        csoundSpinUnLock(&csound->chn_db_lock);
+        break;
+      }
+      if (db != NULL && items != NULL && size == db->size) {
+        old = cs_hash_table_grow_into(db, items);
+        items = NULL;
+        cs_hash_table_put_no_key_copy(csound, db, key, pp);
+        csoundSpinUnLock(&csound->chn_db_lock);
+        break;
+      }
+      if (db != NULL)
+        size = db->size;
+      csoundSpinUnLock(&csound->chn_db_lock);
+      /* create new empty database if not allocated, or grow it */
+      if (db == NULL) {
+        spare = cs_hash_table_create(csound);
+        if (UNLIKELY(spare == NULL ||
+                     csound->RegisterResetCallback(csound, NULL,
+                                                   delete_channel_db) != 0)) {
+          if (spare != NULL)
+            cs_hash_table_free(csound, spare);
+          csound->Free(csound, key);
+          free_channel(csound, pp);
+          return CSOUND_MEMORY;
+        }
+      }
+      else {
+        if (items != NULL)
+          csound->Free(csound, items);
+        items = (CS_HASH_TABLE_ITEM*)
+          csound->Calloc(csound, 2 * size * sizeof(CS_HASH_TABLE_ITEM));
+      }
+    }
+    if (old != NULL)
+      csound->Free(csound, old);
+    if (items != NULL)
+      csound->Free(csound, items);
+    if (spare != NULL)
+      cs_hash_table_free(csound, spare);
 
     return CSOUND_SUCCESS;
 }
 
 
-PUBLIC int csoundGetChannelPtr(CSOUND *csound,
-                               MYFLT **p, const char *name, int type)
+/* find channel 'name', creating it if needed; on failure *err is the
+   error code csoundGetChannelPtr() returns */
+
+static CHNENTRY *get_channel(CSOUND *csound, const char *name, int type,
+                             int *err)
 {
     CHNENTRY  *pp;
+    unsigned int hash;
 
-    *p = (MYFLT*) NULL;
+    *err = CSOUND_ERROR;
     if (UNLIKELY(name == NULL))
-      return CSOUND_ERROR;
-    pp = find_channel(csound, name);
+      return NULL;
+    hash = cs_hash_table_hash(name);
+    pp = find_channel_hashed(csound, name, hash);
     if (!pp) {
         if (create_new_channel(csound, name, type) == CSOUND_SUCCESS) {
-            pp = find_channel(csound, name);
+            pp = find_channel_hashed(csound, name, hash);
         }
     }
     if (pp != NULL) {
-      if ((pp->type ^ type) & CSOUND_CHANNEL_TYPE_MASK)
-        return pp->type;
+      if ((pp->type ^ type) & CSOUND_CHANNEL_TYPE_MASK) {
+        *err = pp->type;
+        return NULL;
+      }
       pp->type |= (type & (CSOUND_INPUT_CHANNEL | CSOUND_OUTPUT_CHANNEL));
+      *err = CSOUND_SUCCESS;
+    }
+    return pp;
+}
+
+static inline int *channel_lock(CHNENTRY *pp)
+{
+#ifndef MACOSX
+#if defined(HAVE_PTHREAD_SPIN_LOCK)
+    return (int*)pp->lock;
+#else
+    return &(pp->lock);
+#endif
+#else
+    return &(pp->lock);
+#endif
+}
+
+PUBLIC int csoundGetChannelPtr(CSOUND *csound,
+                               MYFLT **p, const char *name, int type)
+{
+    CHNENTRY  *pp;
+    int       err;
+
+    *p = (MYFLT*) NULL;
+    pp = get_channel(csound, name, type, &err);
+    if (pp != NULL)
       *p = pp->data;
-      return CSOUND_SUCCESS;
+    return err;
+}
+
+PUBLIC CSOUND_CHANNEL *csoundGetChannelHandle(CSOUND *csound,
+                                              const char *name, int type)
+{
+    int       err;
+    return get_channel(csound, name, type, &err);
+}
+
+#define IS_CHANNEL_TYPE(pp, t) \
+    ((pp) != NULL && ((pp)->type & CSOUND_CHANNEL_TYPE_MASK) == (t))
+
+PUBLIC MYFLT csoundGetControlChannelByHandle(CSOUND *csound,
+                                             CSOUND_CHANNEL *h)
+{
+    IGN(csound);
+    if (UNLIKELY(!IS_CHANNEL_TYPE(h, CSOUND_CONTROL_CHANNEL)))
+      return FL(0.0);
+    return chn_load_k(h->data);
+}
+
+PUBLIC void csoundSetControlChannelByHandle(CSOUND *csound,
+                                            CSOUND_CHANNEL *h, MYFLT val)
+{
+    IGN(csound);
+    if (UNLIKELY(!IS_CHANNEL_TYPE(h, CSOUND_CONTROL_CHANNEL)))
+      return;
+    chn_store_k(h->data, val);
+}
+
+/* the host side of audio channels: see chn_merge_host() */
+
+PUBLIC void csoundGetAudioChannelByHandle(CSOUND *csound,
+                                          CSOUND_CHANNEL *h, MYFLT *samples)
+{
+    uint32_t n, nsmps = csound->ksmps;
+    if (UNLIKELY(!IS_CHANNEL_TYPE(h, CSOUND_AUDIO_CHANNEL)))
+      return;
+#ifdef HAVE_ATOMIC_BUILTIN
+    {
+      unsigned int seq;
+      chn_host_lock(h);
+      if (h->hoststate == CHN_HOST_SET)
+        memcpy(samples, h->hostdata, nsmps * sizeof(MYFLT));
+      else {
+        do {
+          seq = chn_read_seq(h);
+          memcpy(samples, h->data, nsmps * sizeof(MYFLT));
+          __sync_synchronize();
+        } while (UNLIKELY(h->seq != seq));
+        if (h->hoststate == CHN_HOST_MIX)
+          for (n = 0; n < nsmps; n++)
+            samples[n] += h->hostdata[n];
+      }
+      chn_host_unlock(h);
     }
-    return CSOUND_ERROR;
+#else
+    IGN(n);
+    csoundSpinLock(channel_lock(h));
+    memcpy(samples, h->data, nsmps * sizeof(MYFLT));
+    csoundSpinUnLock(channel_lock(h));
+#endif
+}
+
+PUBLIC void csoundSetAudioChannelByHandle(CSOUND *csound,
+                                          CSOUND_CHANNEL *h, MYFLT *samples)
+{
+    if (UNLIKELY(!IS_CHANNEL_TYPE(h, CSOUND_AUDIO_CHANNEL)))
+      return;
+#ifdef HAVE_ATOMIC_BUILTIN
+    chn_host_lock(h);
+    memcpy(h->hostdata, samples, csound->ksmps * sizeof(MYFLT));
+    h->hoststate = CHN_HOST_SET;
+    chn_host_unlock(h);
+    csound->chn_host_pending = 1;
+#else
+    chn_write_begin(h);
+    memcpy(h->data, samples, csound->ksmps * sizeof(MYFLT));
+    chn_write_end(h);
+#endif
+}
+
+PUBLIC void csoundMixAudioChannelByHandle(CSOUND *csound,
+                                          CSOUND_CHANNEL *h, MYFLT *samples)
+{
+    uint32_t n, nsmps = csound->ksmps;
+    MYFLT *data;
+    if (UNLIKELY(!IS_CHANNEL_TYPE(h, CSOUND_AUDIO_CHANNEL)))
+      return;
+#ifdef HAVE_ATOMIC_BUILTIN
+    chn_host_lock(h);
+    data = h->hostdata;
+    if (h->hoststate == CHN_HOST_NONE) {
+      memcpy(data, samples, nsmps * sizeof(MYFLT));
+      h->hoststate = CHN_HOST_MIX;
+    }
+    else
+      for (n = 0; n < nsmps; n++)
+        data[n] += samples[n];
+    chn_host_unlock(h);
+    csound->chn_host_pending = 1;
+#else
+    data = h->data;
+    chn_write_begin(h);
+    for (n = 0; n < nsmps; n++)
+      data[n] += samples[n];
+    chn_write_end(h);
+#endif
 }
 
 PUBLIC int csoundGetChannelDatasize(CSOUND *csound, const char *name){
@@ -467,17 +870,8 @@ PUBLIC int *csoundGetChannelLock(CSOUND *csound,
     if (UNLIKELY(name == NULL))
       return NULL;
     pp = find_channel(csound, name);
-    if (pp) {
-#ifndef MACOSX
-#if defined(HAVE_PTHREAD_SPIN_LOCK)
-      return (int*)pp->lock;
-#else
-      return &(pp->lock);
-#endif
-#else
-      return &(pp->lock);
-#endif
-    }
+    if (pp)
+      return channel_lock(pp);
     else return NULL;
 }
 
@@ -497,7 +891,9 @@ PUBLIC int csoundListChannels(CSOUND *csound, controlChannelInfo_t **lst)
     if (csound->chn_db == NULL)
       return 0;
 
+    csoundSpinLock(&csound->chn_db_lock);
     channels = cs_hash_table_values(csound, csound->chn_db);
+    csoundSpinUnLock(&csound->chn_db_lock);
     n = cs_cons_length(channels);
 
     if (!n)
@@ -638,16 +1034,8 @@ static CS_NOINLINE int print_chn_err(void *p, int err)
 /* receive control value from bus at performance time */
 static int chnget_opcode_perf_k(CSOUND *csound, CHNGET *p)
 {
-#ifdef HAVE_ATOMIC_BUILTIN
-    volatile union {
-    MYFLT d;
-    MYFLT_INT_TYPE i;
-    } x;
-    x.i = __sync_fetch_and_add((MYFLT_INT_TYPE *) p->fp, 0);
-    *(p->arg) = x.d;
-#else
-    *(p->arg) = *(p->fp);
-#endif
+    IGN(csound);
+    *(p->arg) = chn_load_k(p->fp);
     return OK;
 }
 
@@ -657,24 +1045,27 @@ static int chnget_opcode_perf_a(CSOUND *csound, CHNGET *p)
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
+    unsigned int seq;
 
     if(CS_KSMPS == (unsigned int) csound->ksmps) {
-    csoundSpinLock(p->lock);
     if (UNLIKELY(offset)) memset(p->arg, '\0', offset);
-    memcpy(&p->arg[offset], p->fp, sizeof(MYFLT)*(CS_KSMPS-offset-early));
+    do {
+      seq = chn_read_begin(p->chn);
+      memcpy(&p->arg[offset], p->fp, sizeof(MYFLT)*(CS_KSMPS-offset-early));
+    } while (UNLIKELY(chn_read_retry(p->chn, seq)));
     if (UNLIKELY(early))
       memset(&p->arg[CS_KSMPS-early], '\0', sizeof(MYFLT)*early);
-    csoundSpinUnLock(p->lock);
     } else {
-    csoundSpinLock(p->lock);
     if (UNLIKELY(offset)) memset(p->arg, '\0', offset);
-    memcpy(&p->arg[offset], &(p->fp[offset+p->pos]),
-           sizeof(MYFLT)*(CS_KSMPS-offset-early));
+    do {
+      seq = chn_read_begin(p->chn);
+      memcpy(&p->arg[offset], &(p->fp[offset+p->pos]),
+             sizeof(MYFLT)*(CS_KSMPS-offset-early));
+    } while (UNLIKELY(chn_read_retry(p->chn, seq)));
     if (UNLIKELY(early))
       memset(&p->arg[CS_KSMPS-early], '\0', sizeof(MYFLT)*early);
     p->pos+=CS_KSMPS;
     p->pos %= (csound->ksmps-offset);
-    csoundSpinUnLock(p->lock);
     }
 
     return OK;
@@ -690,18 +1081,7 @@ int chnget_opcode_init_i(CSOUND *csound, CHNGET *p)
                               CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
     if (UNLIKELY(err))
       return print_chn_err(p, err);
-#ifdef HAVE_ATOMIC_BUILTIN
-    {
-    union {
-    MYFLT d;
-    MYFLT_INT_TYPE i;
-    } x;
-    x.i = __sync_fetch_and_add((MYFLT_INT_TYPE *) p->fp, 0);
-    *(p->arg) =  x.d;
-    }
-#else
-    *(p->arg) = *(p->fp);
-#endif
+    *(p->arg) = chn_load_k(p->fp);
     return OK;
 }
 
@@ -727,11 +1107,11 @@ int chnget_opcode_init_a(CSOUND *csound, CHNGET *p)
 {
     int   err;
     p->pos = 0;
-    err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
-                              CSOUND_AUDIO_CHANNEL | CSOUND_INPUT_CHANNEL);
-    p->lock = csoundGetChannelLock(csound, (char*) p->iname->data);
-
+    p->chn = get_channel(csound, (char*) p->iname->data,
+                         CSOUND_AUDIO_CHANNEL | CSOUND_INPUT_CHANNEL, &err);
     if (LIKELY(!err)) {
+      p->fp = p->chn->data;
+      p->lock = channel_lock(p->chn);
       p->h.opadr = (SUBR) chnget_opcode_perf_a;
       return OK;
     }
@@ -797,18 +1177,8 @@ int chnget_opcode_perf_S(CSOUND *csound, CHNGET *p)
 
 static int chnset_opcode_perf_k(CSOUND *csound, CHNGET *p)
 {
-#ifdef HAVE_ATOMIC_BUILTIN
-    union {
-      MYFLT d;
-      MYFLT_INT_TYPE i;
-    } x;
-    x.d = *(p->arg);
-    __sync_lock_test_and_set((MYFLT_INT_TYPE *)(p->fp),x.i);
-#else
-    csoundSpinLock(p->lock);
-    *(p->fp) = *(p->arg);
-    csoundSpinUnLock(p->lock);
-#endif
+    IGN(csound);
+    chn_store_k(p->fp, *(p->arg));
     return OK;
 }
 
@@ -819,17 +1189,15 @@ static int chnset_opcode_perf_a(CSOUND *csound, CHNGET *p)
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     if(CS_KSMPS == (unsigned int) csound->ksmps){
-      /* Need lock for the channel */
-      csoundSpinLock(p->lock);
+      chn_write_begin(p->chn);
       if (UNLIKELY(offset)) memset(p->fp, '\0', sizeof(MYFLT)*offset);
       memcpy(&p->fp[offset], &p->arg[offset],
              sizeof(MYFLT)*(CS_KSMPS-offset-early));
       if (UNLIKELY(early))
         memset(&p->fp[early], '\0', sizeof(MYFLT)*(CS_KSMPS-early));
-      csoundSpinUnLock(p->lock);
+      chn_write_end(p->chn);
     } else {
-      /* Need lock for the channel */
-      csoundSpinLock(p->lock);
+      chn_write_begin(p->chn);
       if (UNLIKELY(offset)) memset(p->fp, '\0', sizeof(MYFLT)*offset);
       memcpy(&p->fp[offset+p->pos], &p->arg[offset],
              sizeof(MYFLT)*(CS_KSMPS-offset-early));
@@ -837,7 +1205,7 @@ static int chnset_opcode_perf_a(CSOUND *csound, CHNGET *p)
         memset(&p->fp[early], '\0', sizeof(MYFLT)*(CS_KSMPS-early));
       p->pos += CS_KSMPS;
       p->pos %= (csound->ksmps-offset);
-      csoundSpinUnLock(p->lock);
+      chn_write_end(p->chn);
     }
     return OK;
 }
@@ -851,12 +1219,11 @@ static int chnmix_opcode_perf(CSOUND *csound, CHNGET *p)
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     if (UNLIKELY(early)) nsmps -= early;
-    /* Need lock for the channel */
-    csoundSpinLock(p->lock);
+    chn_write_begin(p->chn);
     for (n=offset; n<nsmps; n++) {
       p->fp[n] += p->arg[n];
     }
-    csoundSpinUnLock(p->lock);
+    chn_write_end(p->chn);
     return OK;
 }
 
@@ -864,10 +1231,9 @@ static int chnmix_opcode_perf(CSOUND *csound, CHNGET *p)
 
 static int chnclear_opcode_perf(CSOUND *csound, CHNCLEAR *p)
 {
-    /* Need lock for the channel */
-    csoundSpinLock(p->lock);
+    chn_write_begin(p->chn);
     memset(p->fp, 0, CS_KSMPS*sizeof(MYFLT)); /* Should this leave start? */
-    csoundSpinUnLock(p->lock);
+    chn_write_end(p->chn);
     return OK;
 }
 
@@ -881,25 +1247,7 @@ int chnset_opcode_init_i(CSOUND *csound, CHNGET *p)
                               CSOUND_CONTROL_CHANNEL | CSOUND_OUTPUT_CHANNEL);
     if (UNLIKELY(err))
       return print_chn_err(p, err);
-
-
-#ifdef HAVE_ATOMIC_BUILTIN
-    union {
-      MYFLT d;
-      MYFLT_INT_TYPE i;
-    } x;
-    x.d = *(p->arg);
-    __sync_lock_test_and_set((MYFLT_INT_TYPE *)(p->fp),x.i);
-#else
-    {
-      int *lock;       /* Need lock for the channel */
-      p->lock = lock =
-        csoundGetChannelLock(csound, (char*) p->iname->data);
-      csoundSpinLock(lock);
-      *(p->fp) = *(p->arg);
-      csoundSpinUnLock(lock);
-    }
-#endif
+    chn_store_k(p->fp, *(p->arg));
     return OK;
 }
 
@@ -925,10 +1273,11 @@ int chnset_opcode_init_a(CSOUND *csound, CHNGET *p)
 {
     int   err;
     p->pos = 0;
-    err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
-                              CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL);
+    p->chn = get_channel(csound, (char*) p->iname->data,
+                         CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL, &err);
     if (!err) {
-      p->lock = csoundGetChannelLock(csound, (char*) p->iname->data);
+      p->fp = p->chn->data;
+      p->lock = channel_lock(p->chn);
       p->h.opadr = (SUBR) chnset_opcode_perf_a;
       return OK;
     }
@@ -941,10 +1290,11 @@ int chnmix_opcode_init(CSOUND *csound, CHNGET *p)
 {
     int   err;
 
-    err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
-                              CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL);
+    p->chn = get_channel(csound, (char*) p->iname->data,
+                         CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL, &err);
     if (LIKELY(!err)) {
-      p->lock = csoundGetChannelLock(csound, (char*) p->iname->data);
+      p->fp = p->chn->data;
+      p->lock = channel_lock(p->chn);
       p->h.opadr = (SUBR) chnmix_opcode_perf;
       return OK;
     }
@@ -958,10 +1308,11 @@ int chnclear_opcode_init(CSOUND *csound, CHNCLEAR *p)
     int   err;
 
     /* NOTE: p->imode is a pointer to the channel data here */
-    err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
-                              CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL);
+    p->chn = get_channel(csound, (char*) p->iname->data,
+                         CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL, &err);
     if (LIKELY(!err)) {
-      p->lock = csoundGetChannelLock(csound, (char*) p->iname->data);
+      p->fp = p->chn->data;
+      p->lock = channel_lock(p->chn);
       p->h.opadr = (SUBR) chnclear_opcode_perf;
       return OK;
     }
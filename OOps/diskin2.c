@@ -26,12 +26,195 @@
 #include "diskin2.h"
 #include <math.h>
 
+/* Asynchronous reading: one I/O thread serves every diskin2 instance
+   opened in asynchronous mode.  It keeps each instance's ring topped up
+   with whole ksmps blocks and sleeps on a condition variable once they
+   are all full; the performance side wakes it after taking a block.
+   The list lock is never held while reading a file, so that notes can
+   start and end while the thread waits for the disk; an instance being
+   read is marked busy, and only its own removal waits for the read. */
+
 typedef struct DISKIN_INST_ {
   CSOUND *csound;
-  DISKIN2 *diskin;
+  void   *diskin;
+  int   (*read)(CSOUND *, void *);  /* 1 if a block was queued, else 0 */
+  int    removed;                   /* unlinked while being read */
   struct DISKIN_INST_ *nxt;
 } DISKIN_INST;
 
+typedef struct {
+  pthread_t       thread;
+  pthread_mutex_t lock;         /* protects all of the fields below, */
+  pthread_cond_t  cond;         /* except waiting and pending        */
+  pthread_cond_t  done;         /* signals the end of a read */
+  int             running;
+  volatile int    waiting;      /* the thread sleeps, or is about to */
+  volatile int    pending;      /* a block was taken or an instance added */
+  DISKIN_INST     *busy;        /* instance being read */
+  DISKIN_INST     *top;
+} DISKIN_IO;
+
+static void *diskin_io_thread(void *arg)
+{
+    DISKIN_IO   *io = (DISKIN_IO *) arg;
+    DISKIN_INST *current;
+    int         more;
+
+    pthread_mutex_lock(&io->lock);
+    while (io->running) {
+      more = 0;
+      io->pending = 0;
+#ifdef HAVE_ATOMIC_BUILTIN
+      __sync_synchronize();
+#endif
+      current = io->top;
+      while (current != NULL) {
+        io->busy = current;
+        pthread_mutex_unlock(&io->lock);
+        more |= current->read(current->csound, current->diskin);
+        pthread_mutex_lock(&io->lock);
+        io->busy = NULL;
+        if (current->removed) {
+          /* the list has changed: let the remover go, and start again */
+          pthread_cond_broadcast(&io->done);
+          more = 1;
+          break;
+        }
+        current = current->nxt;
+      }
+      if (!more && io->running) {
+        /* announce the sleep before the last look at pending: either
+           this sees a block taken, or the consumer sees waiting set */
+        io->waiting = 1;
+#ifdef HAVE_ATOMIC_BUILTIN
+        __sync_synchronize();
+#endif
+        if (!io->pending)
+          pthread_cond_wait(&io->cond, &io->lock);
+        io->waiting = 0;
+      }
+    }
+    pthread_mutex_unlock(&io->lock);
+    return NULL;
+}
+
+/* link an instance into the I/O list, starting the thread if needed */
+static DISKIN_IO *diskin_io_add(CSOUND *csound, void *p,
+                                int (*read)(CSOUND *, void *))
+{
+    DISKIN_IO   *io;
+    DISKIN_INST *inst;
+
+    if ((io = (DISKIN_IO *)
+         csound->QueryGlobalVariable(csound, "DISKIN_IO")) == NULL) {
+      if (csound->CreateGlobalVariable(csound, "DISKIN_IO",
+                                       sizeof(DISKIN_IO)) != 0)
+        return NULL;
+      io = (DISKIN_IO *) csound->QueryGlobalVariable(csound, "DISKIN_IO");
+      pthread_mutex_init(&io->lock, NULL);
+      pthread_cond_init(&io->cond, NULL);
+      pthread_cond_init(&io->done, NULL);
+      io->running = 1;
+      if (pthread_create(&io->thread, NULL, diskin_io_thread, io) != 0) {
+        pthread_cond_destroy(&io->done);
+        pthread_cond_destroy(&io->cond);
+        pthread_mutex_destroy(&io->lock);
+        csound->DestroyGlobalVariable(csound, "DISKIN_IO");
+        return NULL;
+      }
+    }
+    inst = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
+    inst->csound = csound;
+    inst->diskin = p;
+    inst->read = read;
+    pthread_mutex_lock(&io->lock);
+    inst->nxt = io->top;
+    io->top = inst;
+    io->pending = 1;
+    pthread_cond_signal(&io->cond);
+    pthread_mutex_unlock(&io->lock);
+    return io;
+}
+
+/* unlink an instance; the last one out stops the thread */
+static int diskin_io_remove(CSOUND *csound, void *p)
+{
+    DISKIN_IO   *io;
+    DISKIN_INST **prv, *current = NULL;
+
+    if ((io = (DISKIN_IO *)
+         csound->QueryGlobalVariable(csound, "DISKIN_IO")) == NULL)
+      return NOTOK;
+    pthread_mutex_lock(&io->lock);
+    for (prv = &io->top; *prv != NULL; prv = &(*prv)->nxt) {
+      if ((*prv)->diskin == p) {
+        current = *prv;
+        *prv = current->nxt;
+        break;
+      }
+    }
+    if (current != NULL) {
+      /* the instance may be in the middle of a read */
+      current->removed = 1;
+      while (io->busy == current)
+        pthread_cond_wait(&io->done, &io->lock);
+    }
+    if (io->top == NULL) {
+      io->running = 0;
+      pthread_cond_signal(&io->cond);
+    }
+    pthread_mutex_unlock(&io->lock);
+    if (!io->running) {
+      pthread_join(io->thread, NULL);
+      pthread_cond_destroy(&io->done);
+      pthread_cond_destroy(&io->cond);
+      pthread_mutex_destroy(&io->lock);
+      csound->DestroyGlobalVariable(csound, "DISKIN_IO");
+    }
+    if (current != NULL)
+      csound->Free(csound, current);
+    return OK;
+}
+
+/* called by the consumer after each block, on the audio thread, so it
+   never blocks: the flag makes the thread look again if it is mid-pass,
+   and the lock is only tried when the thread sleeps.  If the thread
+   holds the lock on its way to sleep, the signal is retried on the next
+   block, as waiting stays set. */
+static inline void diskin_io_wake(DISKIN_IO *io)
+{
+    io->pending = 1;
+#ifdef HAVE_ATOMIC_BUILTIN
+    __sync_synchronize();
+#endif
+    if (io->waiting && pthread_mutex_trylock(&io->lock) == 0) {
+      pthread_cond_signal(&io->cond);
+      pthread_mutex_unlock(&io->lock);
+    }
+}
+
+/* count an underrun, reporting it at once but at most once a second */
+static void diskin_io_underrun(CSOUND *csound, uint32_t *underruns,
+                               uint32_t *told, long *kcnt)
+{
+    (*underruns)++;
+    if (*told == 0 || csound->kcounter - *kcnt >= (long) csound->ekr) {
+      csound->Warning(csound, Str("diskin2: %u buffer underrun(s) "
+                                  "in asynchronous read"),
+                      *underruns - *told);
+      *told = *underruns;
+      *kcnt = csound->kcounter;
+    }
+}
+
+/* ring size in frames: the read-ahead time, but no less than two
+   file buffers */
+static inline int diskin_ring_frames(CSOUND *csound, int bufSize)
+{
+    int n = (int) (DISKIN2_READAHEAD * csound->esr + FL(0.5));
+    return (n > 2 * bufSize ? n : 2 * bufSize);
+}
+
 
 static CS_NOINLINE void diskin2_read_buffer(CSOUND *csound,
                                             DISKIN2 *p, int bufReadPos)
@@ -257,6 +440,7 @@ int diskin_init_S(CSOUND *csound, DISKIN2 *p){
 }
 
 int diskin2_async_deinit(CSOUND *csound, void *p);
+int diskin_file_read(CSOUND *csound, DISKIN2 *p);
 
 static int diskin2_init_(CSOUND *csound, DISKIN2 *p, int stringname)
 {
@@ -378,10 +562,9 @@ static int diskin2_init_(CSOUND *csound, DISKIN2 *p, int stringname)
     // create circular buffer, on fail set mode to synchronous
     if(csound->realtime_audio_flag==1 && p->fforceSync==0 &&
        (p->cb = csound->CreateCircularBuffer(csound,
-                                             p->bufSize*p->nChannels*2,
+                                             diskin_ring_frames(csound,
+                                                p->bufSize)*p->nChannels,
                                              sizeof(MYFLT))) != NULL){
-      DISKIN_INST **top, *current;
-      int *start;
       // allocate buffer
       n = CS_KSMPS*sizeof(MYFLT)*p->nChannels;
       if (n != (int)p->auxData2.size)
@@ -390,36 +573,9 @@ static int diskin2_init_(CSOUND *csound, DISKIN2 *p, int stringname)
       memset(p->aOut_buf, 0, n);
       p->aOut_bufsize = CS_KSMPS;
 
-      if ((top=(DISKIN_INST **)csound->QueryGlobalVariable(csound,
-                                                       "DISKIN_INST")) == NULL){
-        csound->CreateGlobalVariable(csound, "DISKIN_INST", sizeof(DISKIN_INST *));
-        top = (DISKIN_INST **) csound->QueryGlobalVariable(csound, "DISKIN_INST");
-        *top = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        csound->CreateGlobalVariable(csound, "DISKIN_PTHREAD", sizeof(pthread_t));
-        csound->CreateGlobalVariable(csound, "DISKIN_THREAD_START", sizeof(int));
-        current = *top;
-      }
-      else {
-        current = *top;
-        while(current->nxt != NULL) { /* find next empty slot in chain */
-          current = current->nxt;
-        }
-        current->nxt = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        current = current->nxt;
-      }
-      current->csound = csound;
-      current->diskin = p;
-      current->nxt = NULL;
-
-      if( *(start = csound->QueryGlobalVariable(csound,
-                                                "DISKIN_THREAD_START")) == 0) {
-        void *diskin_io_thread(void *p);
-        *start = 1;
-        pthread_create((pthread_t *)csound->QueryGlobalVariable(csound,
-                                                                "DISKIN_PTHREAD"),
-                       NULL, diskin_io_thread, *top);
-      }
-      csound->RegisterDeinitCallback(csound, p, diskin2_async_deinit);
+      p->aOut_pending = 0;
+      p->underruns = 0;
+      p->underruns_told = 0;
       p->async = 1;
 
       /* print file information */
@@ -449,40 +605,35 @@ static int diskin2_init_(CSOUND *csound, DISKIN2 *p, int stringname)
 
     /* done initialisation */
     p->initDone = 1;
+    if (p->async) {
+      /* queue the first block now so that playback does not start
+         with an underrun, then hand the file to the I/O thread */
+      diskin_file_read(csound, p);
+      if (UNLIKELY((p->io = diskin_io_add(csound, p,
+                                          (int (*)(CSOUND *, void *))
+                                          diskin_file_read)) == NULL)) {
+        csound->DestroyCircularBuffer(csound, p->cb);
+        p->cb = NULL;
+        return csound->InitError(csound,
+                                 Str("diskin2: could not start I/O thread"));
+      }
+      csound->RegisterDeinitCallback(csound, p, diskin2_async_deinit);
+    }
     return OK;
 }
 
-int diskin2_async_deinit(CSOUND *csound,  void *p){
-
-  DISKIN_INST **top, *current, *prv;
-
-  if ((top = (DISKIN_INST **)
-       csound->QueryGlobalVariable(csound, "DISKIN_INST")) == NULL) return NOTOK;
-   current = *top;
-   prv = NULL;
-   while(current->diskin != (DISKIN2 *)p) {
-        prv = current;
-        current = current->nxt;
-   }
-   if(prv == NULL) *top = current->nxt;
-   else prv->nxt = current->nxt;
-
-   if(*top == NULL) {
-     int *start; pthread_t *pt;
-
-     start = (int *) csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-     *start = 0;
-     pt = (pthread_t *) csound->QueryGlobalVariable(csound,"DISKIN_PTHREAD");
-     //csound->Message(csound, "dealloc %p %d\n", start, *start);
-     pthread_join(*pt, NULL);
-     csound->DestroyGlobalVariable(csound, "DISKIN_PTHREAD");
-     csound->DestroyGlobalVariable(csound, "DISKIN_THREAD_START");
-     csound->DestroyGlobalVariable(csound, "DISKIN_INST");
-   }
-   csound->Free(csound, current);
-   csound->DestroyCircularBuffer(csound, ((DISKIN2 *)p)->cb);
-
-   return OK;
+int diskin2_async_deinit(CSOUND *csound,  void *p)
+{
+    DISKIN2 *pp = (DISKIN2 *) p;
+
+    if (diskin_io_remove(csound, p) != OK) return NOTOK;
+    csound->DestroyCircularBuffer(csound, pp->cb);
+    pp->cb = NULL;
+    if (UNLIKELY(pp->underruns != pp->underruns_told))
+      csound->Warning(csound, Str("diskin2: %u buffer underrun(s) "
+                                  "in asynchronous read"),
+                      pp->underruns - pp->underruns_told);
+    return OK;
 }
 
 static inline void diskin2_file_pos_inc(DISKIN2 *p, int32 *ndx)
@@ -691,7 +842,7 @@ int diskin2_perf_synchronous(CSOUND *csound, DISKIN2 *p)
 int diskin_file_read(CSOUND *csound, DISKIN2 *p)
 {
      /* nsmps is bufsize in frames */
-    int nsmps = p->aOut_bufsize - p->h.insdshead->ksmps_offset;
+    int nsmps = (int) p->aOut_bufsize;
     int i, nn;
     int chn, chans = p->nChannels;
     double  d, frac_d, x, c, v, pidwarp_d;
@@ -700,11 +851,18 @@ int diskin_file_read(CSOUND *csound, DISKIN2 *p)
     int     wsized2, warp;
     MYFLT  *aOut = (MYFLT *)p->aOut_buf; /* needs to be allocated */
 
-    if (UNLIKELY(p->fdch.fd == NULL) ) goto file_error;
-    if (!p->initDone && !p->iSkipInit) {
-      return csound->PerfError(csound, p->h.insdshead,
-                               Str("diskin2: not initialised"));
+    /* finish queueing the previous block first */
+    if (p->aOut_pending) {
+      int n = nsmps*chans;
+      p->aOut_pending -=
+        csound->WriteCircularBuffer(csound, p->cb, &aOut[n - p->aOut_pending],
+                                    p->aOut_pending);
+      if (p->aOut_pending)
+        return 0;
     }
+    if (UNLIKELY(p->fdch.fd == NULL) ) goto file_error;
+    if (!p->initDone)
+      return 0;
     if (*(p->kTranspose) != p->prv_kTranspose) {
       double  f;
       p->prv_kTranspose = *(p->kTranspose);
@@ -862,20 +1020,13 @@ int diskin_file_read(CSOUND *csound, DISKIN2 *p)
           diskin2_file_pos_inc(p, &ndx);
         }
     }
-    {
-    /* write to circular buffer */
-    int lc, mc=0, nc=nsmps*p->nChannels;
-    int *start = csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-    do{
-      lc = csound->WriteCircularBuffer(csound, p->cb, &aOut[mc], nc);
-      nc -= lc;
-      mc += lc;
-    } while(nc && *start);
-    }
-    return OK;
+    /* queue the block; whatever does not fit is sent on the next call */
+    p->aOut_pending = nsmps*chans -
+      csound->WriteCircularBuffer(csound, p->cb, aOut, nsmps*chans);
+    return 1;
  file_error:
     csound->ErrorMsg(csound, Str("diskin2: file descriptor closed or invalid\n"));
-   return NOTOK;
+    return 0;
 }
 
 
@@ -884,8 +1035,8 @@ int diskin2_perf_asynchronous(CSOUND *csound, DISKIN2 *p)
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t nn, nsmps = CS_KSMPS;
-    MYFLT samp;
-    int chn;
+    MYFLT *samp, scl = csound->e0dbfs;
+    int chn, i, n, need;
     void *cb = p->cb;
     int chans = p->nChannels;
 
@@ -901,38 +1052,32 @@ int diskin2_perf_asynchronous(CSOUND *csound, DISKIN2 *p)
       return csound->PerfError(csound, p->h.insdshead,
                                Str("diskin2: not initialised"));
     }
-    for (nn = offset; nn < nsmps; nn++){
-
-    for (chn = 0; chn < chans; chn++) {
-      //int i =0;
-      //do {
-      // i =
-       csound->ReadCircularBuffer(csound, cb, &samp, 1);
-        //} while(i==0);
-        p->aOut[chn][nn] = csound->e0dbfs*samp;
-      }
-    }
+    /* take the block straight out of the ring, in at most two pieces;
+       only whole frames are consumed so the read side stays aligned */
+    nn = offset;
+    while (nn < nsmps) {
+      need = (int) (nsmps - nn) * chans;
+      n = csound->ReserveCircularBufferRead(csound, cb, (void **) &samp, need);
+      n -= n % chans;
+      if (n == 0) break;
+      for (i = 0; i < n; i += chans, nn++)
+        for (chn = 0; chn < chans; chn++)
+          p->aOut[chn][nn] = scl*samp[i+chn];
+      csound->CommitCircularBufferRead(csound, cb, n);
+    }
+    if (UNLIKELY(nn < nsmps)) {
+      /* the I/O thread fell behind */
+      diskin_io_underrun(csound, &p->underruns,
+                         &p->underruns_told, &p->underrun_kcnt);
+      for (chn = 0; chn < chans; chn++)
+        for (i = nn; i < (int) nsmps; i++)
+          p->aOut[chn][i] = FL(0.0);
+    }
+    diskin_io_wake((DISKIN_IO *) p->io);
     return OK;
 }
 
 
-void *diskin_io_thread(void *p){
-  DISKIN_INST *current = (DISKIN_INST *) p;
-  int wakeup = 1000*current->csound->ksmps/current->csound->esr;
-  int *start =
-    current->csound->QueryGlobalVariable(current->csound,"DISKIN_THREAD_START");
-  while(*start){
-    current = (DISKIN_INST *) p;
-    csoundSleep(wakeup > 0 ? wakeup : 1);
-    while(current != NULL){
-      diskin_file_read(current->csound, current->diskin);
-      current = current->nxt;
-  }
-  }
-  return NULL;
-}
-
-
 int diskin2_perf(CSOUND *csound, DISKIN2 *p) {
   if(!p->async) return diskin2_perf_synchronous(csound, p);
   else return diskin2_perf_asynchronous(csound, p);
@@ -1475,46 +1620,25 @@ static inline void diskin2_get_sample_array(CSOUND *csound,
    }
 }
 
-int diskin2_async_deinit_array(CSOUND *csound,  void *p){
-
-  DISKIN_INST **top, *current, *prv;
-
-  if ((top = (DISKIN_INST **)
-       csound->QueryGlobalVariable(csound, "DISKIN_INST_ARRAY")) == NULL)
-    return NOTOK;
-   current = *top;
-   prv = NULL;
-   while(current->diskin != (DISKIN2 *)p) {
-        prv = current;
-        current = current->nxt;
-   }
-   if(prv == NULL) *top = current->nxt;
-   else prv->nxt = current->nxt;
-
-   if(*top == NULL) {
-     int *start; pthread_t *pt;
-
-     start = (int *) csound->QueryGlobalVariable(csound,
-                                                 "DISKIN_THREAD_START_ARRAY");
-     *start = 0;
-     pt = (pthread_t *) csound->QueryGlobalVariable(csound,"DISKIN_PTHREAD_ARRAY");
-     //csound->Message(csound, "dealloc %p %d\n", start, *start);
-     pthread_join(*pt, NULL);
-     csound->DestroyGlobalVariable(csound, "DISKIN_PTHREAD_ARRAY");
-     csound->DestroyGlobalVariable(csound, "DISKIN_THREAD_START_ARRAY");
-     csound->DestroyGlobalVariable(csound, "DISKIN_INST_ARRAY");
-   }
-   csound->Free(csound, current);
-   csound->DestroyCircularBuffer(csound, ((DISKIN2_ARRAY *)p)->cb);
-
-   return OK;
+int diskin2_async_deinit_array(CSOUND *csound,  void *p)
+{
+    DISKIN2_ARRAY *pp = (DISKIN2_ARRAY *) p;
+
+    if (diskin_io_remove(csound, p) != OK) return NOTOK;
+    csound->DestroyCircularBuffer(csound, pp->cb);
+    pp->cb = NULL;
+    if (UNLIKELY(pp->underruns != pp->underruns_told))
+      csound->Warning(csound, Str("diskin2: %u buffer underrun(s) "
+                                  "in asynchronous read"),
+                      pp->underruns - pp->underruns_told);
+    return OK;
 }
 
 
 int diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p)
 {
      /* nsmps is bufsize in frames */
-    int nsmps = p->aOut_bufsize - p->h.insdshead->ksmps_offset;
+    int nsmps = (int) p->aOut_bufsize;
     int i, nn;
     int chn, chans = p->nChannels;
     double  d, frac_d, x, c, v, pidwarp_d;
@@ -1523,11 +1647,18 @@ int diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p)
     int     wsized2, warp;
     MYFLT  *aOut = (MYFLT *)p->aOut_buf; /* needs to be allocated */
 
-    if (UNLIKELY(p->fdch.fd == NULL) ) goto file_error;
-    if (!p->initDone && !p->iSkipInit) {
-      return csound->PerfError(csound, p->h.insdshead,
-                               Str("diskin2: not initialised"));
+    /* finish queueing the previous block first */
+    if (p->aOut_pending) {
+      int n = nsmps*chans;
+      p->aOut_pending -=
+        csound->WriteCircularBuffer(csound, p->cb, &aOut[n - p->aOut_pending],
+                                    p->aOut_pending);
+      if (p->aOut_pending)
+        return 0;
     }
+    if (UNLIKELY(p->fdch.fd == NULL) ) goto file_error;
+    if (!p->initDone)
+      return 0;
     if (*(p->kTranspose) != p->prv_kTranspose) {
       double  f;
       p->prv_kTranspose = *(p->kTranspose);
@@ -1685,40 +1816,15 @@ int diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p)
           diskin2_file_pos_inc_array(p, &ndx);
         }
     }
-    {
-    /* write to circular buffer */
-    int lc, mc=0, nc=nsmps*p->nChannels;
-    int *start = csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-    do{
-      lc = csound->WriteCircularBuffer(csound, p->cb, &aOut[mc], nc);
-      nc -= lc;
-      mc += lc;
-    } while(nc && *start);
-    }
-    return OK;
+    /* queue the block; whatever does not fit is sent on the next call */
+    p->aOut_pending = nsmps*chans -
+      csound->WriteCircularBuffer(csound, p->cb, aOut, nsmps*chans);
+    return 1;
  file_error:
     csound->ErrorMsg(csound, Str("diskin2: file descriptor closed or invalid\n"));
-   return NOTOK;
+    return 0;
 }
 
-void *diskin_io_thread_array(void *p){
-  DISKIN_INST *current = (DISKIN_INST *) p;
-  int wakeup = 1000*current->csound->ksmps/current->csound->esr;
-  int *start =
-    current->csound->QueryGlobalVariable(current->csound,
-                                         "DISKIN_THREAD_START_ARRAY");
-  while(*start){
-    current = (DISKIN_INST *) p;
-    csoundSleep(wakeup > 0 ? wakeup : 1);
-    while(current != NULL){
-      diskin_file_read_array(current->csound, (DISKIN2_ARRAY *)current->diskin);
-      current = current->nxt;
-  }
-  }
-  return NULL;
-}
-
-
 static int diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p, int stringname)
 {
     double  pos;
@@ -1849,10 +1955,9 @@ static int diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p, int stringname)
     // create circular buffer, on fail set mode to synchronous
     if(csound->realtime_audio_flag==1 && p->fforceSync==0 &&
        (p->cb = csound->CreateCircularBuffer(csound,
-                                             p->bufSize*p->nChannels*2,
+                                             diskin_ring_frames(csound,
+                                                p->bufSize)*p->nChannels,
                                              sizeof(MYFLT))) != NULL){
-      DISKIN_INST **top, *current;
-      int *start;
       // allocate buffer
       n = CS_KSMPS*sizeof(MYFLT)*p->nChannels;
       if (n != (int)p->auxData2.size)
@@ -1861,43 +1966,9 @@ static int diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p, int stringname)
       memset(p->aOut_buf, 0, n);
       p->aOut_bufsize = CS_KSMPS;
 
-      if ((top=(DISKIN_INST **)
-           csound->QueryGlobalVariable(csound,
-                                       "DISKIN_INST_ARRAY")) == NULL){
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_INST_ARRAY", sizeof(DISKIN_INST *));
-        top = (DISKIN_INST **) csound->QueryGlobalVariable(csound,
-                                                           "DISKIN_INST_ARRAY");
-        *top = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_PTHREAD_ARRAY", sizeof(pthread_t));
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_THREAD_START_ARRAY", sizeof(int));
-        current = *top;
-      }
-      else {
-        current = *top;
-        while(current->nxt != NULL) { /* find next empty slot in chain */
-          current = current->nxt;
-        }
-        current->nxt = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        current = current->nxt;
-      }
-      current->csound = csound;
-      current->diskin =  (DISKIN2 *) p;
-      current->nxt = NULL;
-
-      if (*(start =
-            csound->QueryGlobalVariable(csound,
-                                        "DISKIN_THREAD_START_ARRAY")) == 0) {
-        void *diskin_io_thread(void *p);
-        *start = 1;
-        pthread_create((pthread_t *)csound->QueryGlobalVariable(csound,
-                                                       "DISKIN_PTHREAD_ARRAY"),
-                       NULL, diskin_io_thread_array, *top);
-      }
-      csound->RegisterDeinitCallback(csound, (DISKIN2 *) p,
-                                     diskin2_async_deinit_array);
+      p->aOut_pending = 0;
+      p->underruns = 0;
+      p->underruns_told = 0;
       p->async = 1;
 
       /* print file information */
@@ -1927,6 +1998,21 @@ static int diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p, int stringname)
 
     /* done initialisation */
     p->initDone = 1;
+    if (p->async) {
+      /* queue the first block now so that playback does not start
+         with an underrun, then hand the file to the I/O thread */
+      diskin_file_read_array(csound, p);
+      if (UNLIKELY((p->io = diskin_io_add(csound, p,
+                                          (int (*)(CSOUND *, void *))
+                                          diskin_file_read_array)) == NULL)) {
+        csound->DestroyCircularBuffer(csound, p->cb);
+        p->cb = NULL;
+        return csound->InitError(csound,
+                                 Str("diskin2: could not start I/O thread"));
+      }
+      csound->RegisterDeinitCallback(csound, (DISKIN2 *) p,
+                                     diskin2_async_deinit_array);
+    }
     return OK;
 }
 
@@ -2125,8 +2211,8 @@ int diskin2_perf_asynchronous_array(CSOUND *csound, DISKIN2_ARRAY *p)
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t nn, nsmps = CS_KSMPS, ksmps = CS_KSMPS;
-    MYFLT samp;
-    int chn;
+    MYFLT *samp, scl = csound->e0dbfs;
+    int chn, i, n, need;
     void *cb = p->cb;
     int chans = p->nChannels;
     MYFLT *aOut = (MYFLT *) p->aOut->data;
@@ -2143,17 +2229,28 @@ int diskin2_perf_asynchronous_array(CSOUND *csound, DISKIN2_ARRAY *p)
       return csound->PerfError(csound, p->h.insdshead,
                                Str("diskin2: not initialised"));
     }
-    for (nn = offset; nn < nsmps; nn++){
-
-    for (chn = 0; chn < chans; chn++) {
-      //int i =0;
-      //do {
-      // i =
-       csound->ReadCircularBuffer(csound, cb, &samp, 1);
-        //} while(i==0);
-        aOut[chn*ksmps+nn] = csound->e0dbfs*samp;
-      }
-    }
+    /* take the block straight out of the ring, in at most two pieces;
+       only whole frames are consumed so the read side stays aligned */
+    nn = offset;
+    while (nn < nsmps) {
+      need = (int) (nsmps - nn) * chans;
+      n = csound->ReserveCircularBufferRead(csound, cb, (void **) &samp, need);
+      n -= n % chans;
+      if (n == 0) break;
+      for (i = 0; i < n; i += chans, nn++)
+        for (chn = 0; chn < chans; chn++)
+          aOut[chn*ksmps+nn] = scl*samp[i+chn];
+      csound->CommitCircularBufferRead(csound, cb, n);
+    }
+    if (UNLIKELY(nn < nsmps)) {
+      /* the I/O thread fell behind */
+      diskin_io_underrun(csound, &p->underruns,
+                         &p->underruns_told, &p->underrun_kcnt);
+      for (chn = 0; chn < chans; chn++)
+        for (i = nn; i < (int) nsmps; i++)
+          aOut[chn*ksmps+i] = FL(0.0);
+    }
+    diskin_io_wake((DISKIN_IO *) p->io);
     return OK;
 }
 
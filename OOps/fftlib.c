@@ -3149,6 +3149,9 @@ static void fftInit(CSOUND *csound, int M)
       }
     }
 
+#ifdef HAVE_ATOMIC_BUILTIN
+    __sync_synchronize();       /* tables before the flag */
+#endif
     csound->FFT_max_size |= (1 << M);
 }
 
@@ -3195,8 +3198,13 @@ static inline int ConvertFFTSize(CSOUND *csound, int N)
 static inline void getTablePointers(CSOUND *p, MYFLT **ct, int16 **bt,
                                                 int cn, int bn)
 {
-    if (!(p->FFT_max_size & (1 << cn)))
-      fftInit(p, cn);
+    /* tables are made on first use, by any thread */
+    if (UNLIKELY(!(p->FFT_max_size & (1 << cn)))) {
+      csoundSpinLock(&p->FFT_lock);
+      if (!(p->FFT_max_size & (1 << cn)))
+        fftInit(p, cn);
+      csoundSpinUnLock(&p->FFT_lock);
+    }
     *ct = ((MYFLT**) p->FFT_table_1)[cn];
     *bt = ((int16**) p->FFT_table_2)[bn];
 }
@@ -3344,3 +3352,219 @@ void csoundRealFFTMult(CSOUND *csound, MYFLT *outbuf,
     }
 }
 
+
+/* ----------------------------- FFT plans ----------------------------- */
+
+/* A plan holds everything a transform of one size and type needs, so
+   that executing it does no lookups, allocation or table setup.  Plans
+   are never modified once created, and are shared: csoundCreateFFTPlan()
+   returns the existing plan if one of the same size and type was made
+   before.  They are freed along with the rest of the instance memory. */
+
+struct CS_FFT_PLAN_ {
+    CS_FFT_PLAN *nxt;
+    int     N;                  /* transform length                     */
+    int     flags;              /* CS_FFT_INVERSE, CS_FFT_COMPLEX       */
+    int     M;                  /* log2(N), or -1 if not a power of two */
+    MYFLT   *Utbl;              /* power of two: cosine table           */
+    int16   *BRLow;             /* power of two: bit reversal table     */
+    MYFLT   *twiddle;           /* real, other sizes: exp(-2 pi i k/N)  */
+};
+
+extern void csoundMixedRadixComplexFFT(CSOUND *, MYFLT *, int, int);
+
+static int fft_log2(int N)
+{
+    int M = 0;
+    if (N < 1 || (N & (N - 1)))
+      return -1;
+    while ((1 << M) < N)
+      M++;
+    return M;
+}
+
+/* Real transforms of a size that is not a power of two are done as a
+   complex transform of half the size on the even/odd sample pairs, with
+   the two spectra separated here.  The layout is the same as that of
+   csoundRealFFT(): buf[1] holds the Nyquist component. */
+
+static void real_split(MYFLT *buf, int N, const MYFLT *w)
+{
+    MYFLT   ar, ai, br, bi, er, ei, dr, di, or_, oi;
+    int     k, h = N >> 1;
+
+    ar = buf[0];
+    ai = buf[1];
+    buf[0] = ar + ai;
+    buf[1] = ar - ai;
+    for (k = 1; k <= (h >> 1); k++) {
+      ar = buf[2 * k];
+      ai = buf[2 * k + 1];
+      br = buf[2 * (h - k)];            /* conj(Z[h - k]) */
+      bi = -buf[2 * (h - k) + 1];
+      er = FL(0.5) * (ar + br);
+      ei = FL(0.5) * (ai + bi);
+      dr = FL(0.5) * (ar - br);
+      di = FL(0.5) * (ai - bi);
+      /* O = -i * W^k * D */
+      or_ = w[2 * k] * di + w[2 * k + 1] * dr;
+      oi = w[2 * k + 1] * di - w[2 * k] * dr;
+      buf[2 * k] = er + or_;
+      buf[2 * k + 1] = ei + oi;
+      buf[2 * (h - k)] = er - or_;
+      buf[2 * (h - k) + 1] = oi - ei;
+    }
+}
+
+static void real_merge(MYFLT *buf, int N, const MYFLT *w)
+{
+    MYFLT   ar, ai, br, bi, er, ei, or_, oi, dr, di;
+    int     k, h = N >> 1;
+
+    ar = buf[0];
+    ai = buf[1];
+    buf[0] = FL(0.5) * (ar + ai);
+    buf[1] = FL(0.5) * (ar - ai);
+    for (k = 1; k <= (h >> 1); k++) {
+      ar = buf[2 * k];
+      ai = buf[2 * k + 1];
+      br = buf[2 * (h - k)];            /* conj(X[h - k]) */
+      bi = -buf[2 * (h - k) + 1];
+      er = FL(0.5) * (ar + br);
+      ei = FL(0.5) * (ai + bi);
+      or_ = FL(0.5) * (ar - br);
+      oi = FL(0.5) * (ai - bi);
+      /* D = i * conj(W^k) * O */
+      dr = w[2 * k + 1] * or_ - w[2 * k] * oi;
+      di = w[2 * k] * or_ + w[2 * k + 1] * oi;
+      buf[2 * k] = er + dr;
+      buf[2 * k + 1] = ei + di;
+      buf[2 * (h - k)] = er - dr;
+      buf[2 * (h - k) + 1] = di - ei;
+    }
+}
+
+/**
+ * Returns a plan for transforms of FFTsize points, or NULL if the size
+ * is not supported.  flags is a combination of CS_FFT_INVERSE and
+ * CS_FFT_COMPLEX.  Complex transforms can be of any size, real ones of
+ * any even size; powers of two are fastest.  Data layouts and scaling
+ * are the same as for csoundRealFFT() etc.
+ * Plans may be created by any thread (init passes and score f-statements
+ * run in different ones), and executing one is thread safe.
+ */
+
+static CS_FFT_PLAN *find_fft_plan(CSOUND *csound, int FFTsize, int flags)
+{
+    CS_FFT_PLAN *plan;
+
+    for (plan = csound->FFT_plans; plan != NULL; plan = plan->nxt)
+      if (plan->N == FFTsize && plan->flags == flags)
+        return plan;
+    return NULL;
+}
+
+CS_FFT_PLAN *csoundCreateFFTPlan(CSOUND *csound, int FFTsize, int flags)
+{
+    CS_FFT_PLAN *plan, *other;
+    int     k, h;
+
+    flags &= (CS_FFT_INVERSE | CS_FFT_COMPLEX);
+    csoundSpinLock(&csound->FFT_lock);
+    plan = find_fft_plan(csound, FFTsize, flags);
+    csoundSpinUnLock(&csound->FFT_lock);
+    if (plan != NULL)
+      return plan;
+    if (UNLIKELY(FFTsize < 2 ||
+                 (!(flags & CS_FFT_COMPLEX) && (FFTsize & 1)))) {
+      csound->Warning(csound, Str("csoundCreateFFTPlan(): "
+                                  "invalid FFT size: %d"), FFTsize);
+      return NULL;
+    }
+    plan = (CS_FFT_PLAN*) csound->Calloc(csound, sizeof(CS_FFT_PLAN));
+    plan->N = FFTsize;
+    plan->flags = flags;
+    plan->M = fft_log2(FFTsize);
+    if (plan->M >= 0) {
+      getTablePointers(csound, &(plan->Utbl), &(plan->BRLow), plan->M,
+                       (flags & CS_FFT_COMPLEX) ?
+                       plan->M / 2 : (plan->M - 1) / 2);
+    }
+    else if (!(flags & CS_FFT_COMPLEX)) {
+      h = FFTsize >> 1;
+      plan->twiddle = (MYFLT*) csound->Malloc(csound,
+                                              sizeof(MYFLT) * (h + 2));
+      for (k = 0; k <= (h >> 1); k++) {
+        plan->twiddle[2 * k] = (MYFLT) cos(2.0 * MYPI * k / FFTsize);
+        plan->twiddle[2 * k + 1] = (MYFLT) -sin(2.0 * MYPI * k / FFTsize);
+      }
+    }
+    /* the plan is made without the lock, so another thread may have
+       added the same one meanwhile */
+    csoundSpinLock(&csound->FFT_lock);
+    other = find_fft_plan(csound, FFTsize, flags);
+    if (other == NULL) {
+      plan->nxt = csound->FFT_plans;
+      csound->FFT_plans = plan;
+    }
+    csoundSpinUnLock(&csound->FFT_lock);
+    if (other != NULL) {
+      if (plan->twiddle != NULL)
+        csound->Free(csound, plan->twiddle);
+      csound->Free(csound, plan);
+      return other;
+    }
+    return plan;
+}
+
+/**
+ * Compute an in-place transform with a plan from csoundCreateFFTPlan().
+ */
+
+void csoundExecuteFFTPlan(CSOUND *csound, CS_FFT_PLAN *plan, MYFLT *buf)
+{
+    switch (plan->flags) {
+    case 0:
+      if (plan->M >= 0)
+        rffts1(buf, plan->M, plan->Utbl, plan->BRLow);
+      else {
+        csoundMixedRadixComplexFFT(csound, buf, plan->N >> 1, 0);
+        real_split(buf, plan->N, plan->twiddle);
+      }
+      break;
+    case CS_FFT_INVERSE:
+      if (plan->M >= 0)
+        riffts1(buf, plan->M, plan->Utbl, plan->BRLow);
+      else {
+        real_merge(buf, plan->N, plan->twiddle);
+        csoundMixedRadixComplexFFT(csound, buf, plan->N >> 1, 1);
+      }
+      break;
+    case CS_FFT_COMPLEX:
+      if (plan->M >= 0)
+        ffts1(buf, plan->M, plan->Utbl, plan->BRLow);
+      else
+        csoundMixedRadixComplexFFT(csound, buf, plan->N, 0);
+      break;
+    case (CS_FFT_COMPLEX | CS_FFT_INVERSE):
+      if (plan->M >= 0)
+        iffts1(buf, plan->M, plan->Utbl, plan->BRLow);
+      else
+        csoundMixedRadixComplexFFT(csound, buf, plan->N, 1);
+      break;
+    }
+}
+
+/**
+ * Compute 'howmany' in-place transforms with the same plan, the first
+ * one at buf and each following one 'dist' MYFLT values after the last.
+ */
+
+void csoundExecuteFFTPlanBatch(CSOUND *csound, CS_FFT_PLAN *plan, MYFLT *buf,
+                               int howmany, int dist)
+{
+    while (howmany-- > 0) {
+      csoundExecuteFFTPlan(csound, plan, buf);
+      buf += dist;
+    }
+}
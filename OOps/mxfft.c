@@ -125,6 +125,11 @@ static void fft_(CSOUND *csound, MYFLT *a, MYFLT *b,
 
     /* work space pointers */
     void        *buf;
+    size_t      bufsize;
+    union {                     /* enough for factors up to 61 */
+      MYFLT     f[256];
+      int       i[1];
+    } wsp;
     MYFLT       *at, *ck, *bt, *sk;
     int         *np;
 
@@ -184,7 +189,14 @@ static void fft_(CSOUND *csound, MYFLT *a, MYFLT *b,
       maxf = nfac[kt];
 
     /* allocate workspace - assume no errors! */
-    buf = calloc(sizeof(MYFLT) * 4 * maxf + sizeof(int) * maxp, (size_t) 1);
+    /* (small transforms use the stack, to keep malloc out of perf time) */
+    bufsize = sizeof(MYFLT) * 4 * maxf + sizeof(int) * maxp;
+    if (bufsize <= sizeof(wsp)) {
+      memset(&wsp, 0, bufsize);
+      buf = (void*) &wsp;
+    }
+    else
+      buf = calloc(bufsize, (size_t) 1);
     at = (MYFLT*) buf;
     ck = (MYFLT*) at + (int) maxf;
     bt = (MYFLT*) ck + (int) maxf;
@@ -198,7 +210,8 @@ static void fft_(CSOUND *csound, MYFLT *a, MYFLT *b,
     fftmx(a, b, ntot, nf, nspn, isn, m, &kt, at, ck, bt, sk, np, nfac);
 
     /* release working storage before returning - assume no problems */
-    free(buf);
+    if (buf != (void*) &wsp)
+      free(buf);
 }
 
 /*
@@ -977,6 +990,15 @@ void csoundInverseComplexFFTnp2(CSOUND *csound, MYFLT *buf, int FFTsize)
     fft_(csound, buf, buf, 1, FFTsize, 1, 2);
 }
 
+/* In-place mixed radix complex FFT of FFTsize interleaved values, for
+   the FFT plans in fftlib.c.  Sign as csoundComplexFFT(), not scaled. */
+
+void csoundMixedRadixComplexFFT(CSOUND *csound, MYFLT *buf, int FFTsize,
+                                int inverse)
+{
+    fft_(csound, buf, &(buf[1]), 1, FFTsize, 1, (inverse ? 2 : -2));
+}
+
 void csoundComplexFFTnp2(CSOUND *csound, MYFLT *buf, int FFTsize)
 {
       if (UNLIKELY(FFTsize < 2 || (FFTsize & 1))) {
@@ -94,11 +94,51 @@ static CS_NOINLINE int PVS_CreateWindow(CSOUND *csound, MYFLT *buf,
 }
 
 
+/* The sliding DFT updates every bin on every input sample.  The bins
+   are processed in tiles of SDFT_LANES, each tile running through a
+   chunk of up to SDFT_CHUNK samples with its state held in locals, so
+   the inner loops are independent across bins and can be vectorised.
+   The rotated spectra are kept as rows of real and imaginary parts with
+   two guard bins at each end, used by the window kernel. */
+
+#define SDFT_LANES  8
+#define SDFT_CHUNK  16
+#define SDFT_ROWLEN(NBP)    ((NBP) + 4)
+
+/* Single precision atan2 and cos for the fast mode, accurate to about
+   4e-7.  They are written without branches or calls, and without
+   conditional arithmetic, so that loops using them can be vectorised. */
+
+static inline float sdft_atan2f(float y, float x)
+{
+    float ax = fabsf(x), ay = fabsf(y);
+    float mx = (ax > ay ? ax : ay), mn = (ax > ay ? ay : ax);
+    float a = mn / (mx + 1.0e-37f);                   /* 0 to 1 */
+    float b = (a - 1.0f) / (a + 1.0f);                /* tan(atan(a) - pi/4) */
+    float big = (a > 0.41421356f ? 1.0f : 0.0f);
+    float t = a + big*(b - a), s = t*t, r;
+    r = t*(1.0f + s*(-1.0f/3 + s*(1.0f/5 + s*(-1.0f/7 + s*(1.0f/9
+          + s*(-1.0f/11 + s*(1.0f/13)))))));
+    r += big * (float) (PI/4);
+    r = (ay > ax ? (float) (PI/2) : 0.0f) + (ay > ax ? -r : r);
+    r = (x < 0.0f ? (float) PI : 0.0f) + (x < 0.0f ? -r : r);
+    return (y < 0.0f ? -r : r);
+}
+
+static inline float sdft_cosf(float x)      /* x in [-pi, pi] */
+{
+    float ax = fabsf(x);
+    float sgn = (ax > (float) (PI/2) ? -1.0f : 1.0f);
+    float t = (ax > (float) (PI/2) ? (float) PI : 0.0f) + sgn*ax, s = t*t;
+    return sgn*(1.0f + s*(-1.0f/2 + s*(1.0f/24 + s*(-1.0f/720
+              + s*(1.0f/40320 + s*(-1.0f/3628800 + s*(1.0f/479001600)))))));
+}
+
 int pvssanalset(CSOUND *csound, PVSANAL *p)
 {
     /* opcode params */
     int N = (int) (FL(0.5)+*(p->winsize));
-    int NB;
+    int NB, NBP;
     int i;
     int wintype = (int) (FL(0.5)+*p->wintype);
 
@@ -106,6 +146,7 @@ int pvssanalset(CSOUND *csound, PVSANAL *p)
 
     N = N + N%2;               /* Make N even */
     NB = N/2+1;                 /* Number of bins */
+    NBP = (NB + SDFT_LANES - 1) & ~(SDFT_LANES - 1);
 
     /* Need space for NB complex numbers for each of ksmps */
     if (p->fsig->frame.auxp==NULL ||
@@ -118,27 +159,95 @@ int pvssanalset(CSOUND *csound, PVSANAL *p)
       csound->AuxAlloc(csound, N*sizeof(MYFLT),&p->input);
     else memset(p->input.auxp, 0, N*sizeof(MYFLT));
     csound->AuxAlloc(csound, NB * sizeof(double), &p->oldInPhase);
-   if (p->analwinbuf.auxp==NULL ||
-        NB*sizeof(CMPLX) > (unsigned int)p->analwinbuf.size)
-      csound->AuxAlloc(csound, NB*sizeof(CMPLX),&p->analwinbuf);
-    else memset(p->analwinbuf.auxp, 0, NB*sizeof(CMPLX));
+    /* Rotated spectra for a chunk of samples, and the input changes */
+    csound->AuxAlloc(csound, (2*SDFT_CHUNK*SDFT_ROWLEN(NBP) + SDFT_CHUNK)
+                             * sizeof(MYFLT), &p->analwinbuf);
     p->inptr = 0;                 /* Pointer in circular buffer */
     p->fsig->NB = p->Ii = NB;
     p->fsig->wintype = wintype;
     p->fsig->format = PVS_AMP_FREQ;      /* only this, for now */
     p->fsig->N = p->nI  = N;
     p->fsig->sliding = 1;
-    /* Need space for NB sines, cosines and a scatch phase area */
-    if (p->trig.auxp==NULL ||
-        (2*NB)*sizeof(double) > (unsigned int)p->trig.size)
-      csound->AuxAlloc(csound,(2*NB)*sizeof(double),&p->trig);
-    {
+    p->NBP = NBP;
+    p->resync = 0;
+    /* In single precision the state drifts as rounding errors in the
+       rotations build up, so it is rebuilt every N samples by an FFT of
+       the input buffer, which holds exactly the samples it sums. */
+    p->sfast = (*p->fast != FL(0.0));
+    if (p->sfast) {
+      p->setup = csound->CreateFFTPlan(csound, N, 0);
+      if (UNLIKELY(p->setup == NULL))
+        p->sfast = 0;
+    }
+    /* The windows are sums of cosines, applied as a convolution of the
+       spectrum with a0 at the bin, a1 at +/-1 and a2 at +/-2 bins */
+    /* Rectang :Fw_t =     F_t                          */
+    /* Hamming :Fw_t = 0.54F_t - 0.23[ F_{t-1}+F_{t+1}] */
+    /* Hamming :Fw_t = 0.5 F_t - 0.25[ F_{t-1}+F_{t+1}] */
+    /* Blackman:Fw_t = 0.42F_t - 0.25[ F_{t-1}+F_{t+1}]+0.04[F_{t-2}+F_{t+2}] */
+    /* Blackman_exact:Fw_t = 0.42659071367153912296F_t
+       - 0.24828030954428202923 [F_{t-1}+F_{t+1}]
+       + 0.038424333619948409286 [F_{t-2}+F_{t+2}]      */
+    /* Nuttall_C3:Fw_t = 0.375  F_t - 0.25[ F_{t-1}+F_{t+1}] +
+                                    0.0625 [F_{t-2}+F_{t+2}] */
+    /* BHarris_3:Fw_t = 0.44959 F_t - 0.24682[ F_{t-1}+F_{t+1}] +
+                                    0.02838 [F_{t-2}+F_{t+2}] */
+    /* BHarris_min:Fw_t = 0.42323 F_t - 0.2486703 [ F_{t-1}+F_{t+1}] +
+                                    0.0391396 [F_{t-2}+F_{t+2}] */
+    p->wcoef[0] = FL(1.0); p->wcoef[1] = p->wcoef[2] = FL(0.0);
+    switch (wintype) {
+    case PVS_WIN_HAMMING:
+      p->wcoef[0] = FL(0.54); p->wcoef[1] = -FL(0.23);
+      break;
+    case PVS_WIN_HANN:
+      p->wcoef[0] = FL(0.5); p->wcoef[1] = -FL(0.25);
+      break;
+    default:
+      csound->Warning(csound,
+                      Str("Unknown window type; replaced by rectangular\n"));
+    case PVS_WIN_RECT:
+      break;
+    case PVS_WIN_BLACKMAN:
+      p->wcoef[0] = FL(0.42); p->wcoef[1] = -FL(0.25);
+      p->wcoef[2] = FL(0.04);
+      break;
+    case PVS_WIN_BLACKMAN_EXACT:
+      p->wcoef[0] = FL(0.42659071367153912296);
+      p->wcoef[1] = -FL(0.49656061908856405847)*FL(0.5);
+      p->wcoef[2] = FL(0.076848667239896818573)*FL(0.5);
+      break;
+    case PVS_WIN_NUTTALLC3:
+      p->wcoef[0] = FL(0.375); p->wcoef[1] = -FL(0.25);
+      p->wcoef[2] = FL(0.0625);
+      break;
+    case PVS_WIN_BHARRIS_3:
+      p->wcoef[0] = FL(0.44959); p->wcoef[1] = -FL(0.49364)*FL(0.5);
+      p->wcoef[2] = FL(0.05677)*FL(0.5);
+      break;
+    case PVS_WIN_BHARRIS_MIN:
+      p->wcoef[0] = FL(0.42323); p->wcoef[1] = -FL(0.4973406)*FL(0.5);
+      p->wcoef[2] = FL(0.0782793)*FL(0.5);
+      break;
+    }
+    /* Need space for NBP sines and cosines, and the state of each bin;
+       bins past NB rotate by zero and so stay empty */
+    if (p->sfast) {
+      float *c, *s;
+      csound->AuxAlloc(csound, 4*NBP*sizeof(float), &p->trig);
+      c = (float *)(p->trig.auxp);
+      s = c+NBP;
+      for (i=0; i<NB; i++) {
+        c[i] = (float) cos(TWOPI*i/(double)N);
+        s[i] = (float) sin(TWOPI*i/(double)N);
+      }
+    }
+    else {
       double dc = cos(TWOPI/(double)N);
       double ds = sin(TWOPI/(double)N);
-      double *c = (double *)(p->trig.auxp);
-      double *s = c+NB;
-      p->cosine = c;
-      p->sine = s;
+      double *c, *s;
+      csound->AuxAlloc(csound, 4*NBP*sizeof(double), &p->trig);
+      c = (double *)(p->trig.auxp);
+      s = c+NBP;
       c[0] = 1.0; s[0] = 0.0; // assignment to s unnecessary as auxalloc zeros
         /*
           direct computation of c and s may be better for large n
@@ -187,6 +296,8 @@ int pvsanalset(CSOUND *csound, PVSANAL *p)
     if (UNLIKELY(overlap > N / 2))
       return csound->InitError(csound,
                                Str("pvsanal: overlap too big for fft size\n"));
+    if (UNLIKELY((p->setup = csound->CreateFFTPlan(csound, N, 0)) == NULL))
+      return csound->InitError(csound, Str("pvsanal: invalid fft size\n"));
 #ifdef OLPC
     if (UNLIKELY(overlap < CS_KSMPS))
       return csound->InitError(csound,
@@ -326,13 +437,9 @@ static void generate_frame(CSOUND *csound, PVSANAL *p)
       /* *(anal + k) += *(analWindow + i) * *(input + j); */
       anal[k] += analWindow[i] * input[j];
     }
-    if (!(N & (N - 1))) {
-      csound->RealFFT(csound, anal, N);
-      anal[N] = anal[1];
-      anal[1] = anal[N + 1] = FL(0.0);
-    }
-    else
-      csound->RealFFTnp2(csound, anal, N);
+    csound->ExecuteFFTPlan(csound, p->setup, anal);
+    anal[N] = anal[1];
+    anal[1] = anal[N + 1] = FL(0.0);
     /* conversion: The real and imaginary values in anal are converted to
        magnitude and angle-difference-per-second (assuming an
        intermediate sampling rate of rIn) and are returned in
@@ -434,33 +541,166 @@ static void anal_tick(CSOUND *csound, PVSANAL *p,MYFLT samp)
 
 }
 
-static inline double mod2Pi(double x)
+/* Rotate a tile of bins through n samples: each bin adds the change in
+   the input and advances by its own frequency.  The spectra go to rows
+   xr[i*2*rowlen + j] (real) and xr[(i*2+1)*rowlen + j] (imaginary). */
+
+static void sdft_rotate(double *re, double *im,
+                        const double *c, const double *s,
+                        const MYFLT *dx, MYFLT *xr, int NBP, int rowlen, int n)
 {
-    x = fmod(x,TWOPI);
-    if (x <= -PI) {
-        return x + TWOPI;
+    int i, j, l;
+
+    for (j = 0; j < NBP; j += SDFT_LANES) {
+      double r[SDFT_LANES], m[SDFT_LANES];
+      for (l = 0; l < SDFT_LANES; l++) {
+        r[l] = re[j+l]; m[l] = im[j+l];
+      }
+      for (i = 0; i < n; i++) {
+        MYFLT *yr = xr + 2*i*rowlen + j, *yi = yr + rowlen;
+        for (l = 0; l < SDFT_LANES; l++) {
+          double a = r[l] + dx[i], b = m[l];
+          r[l] = c[j+l]*a - s[j+l]*b;
+          m[l] = c[j+l]*b + s[j+l]*a;
+          yr[l] = (MYFLT) r[l];
+          yi[l] = (MYFLT) m[l];
+        }
+      }
+      for (l = 0; l < SDFT_LANES; l++) {
+        re[j+l] = r[l]; im[j+l] = m[l];
+      }
     }
-    else if (x > PI) {
-        return x - TWOPI;
+}
+
+static void sdft_rotatef(float *re, float *im,
+                         const float *c, const float *s,
+                         const MYFLT *dx, MYFLT *xr, int NBP, int rowlen, int n)
+{
+    int i, j, l;
+
+    for (j = 0; j < NBP; j += SDFT_LANES) {
+      float r[SDFT_LANES], m[SDFT_LANES];
+      for (l = 0; l < SDFT_LANES; l++) {
+        r[l] = re[j+l]; m[l] = im[j+l];
+      }
+      for (i = 0; i < n; i++) {
+        MYFLT *yr = xr + 2*i*rowlen + j, *yi = yr + rowlen;
+        for (l = 0; l < SDFT_LANES; l++) {
+          float a = r[l] + (float) dx[i], b = m[l];
+          r[l] = c[j+l]*a - s[j+l]*b;
+          m[l] = c[j+l]*b + s[j+l]*a;
+          yr[l] = (MYFLT) r[l];
+          yi[l] = (MYFLT) m[l];
+        }
+      }
+      for (l = 0; l < SDFT_LANES; l++) {
+        re[j+l] = r[l]; im[j+l] = m[l];
+      }
     }
-    else
-      return x;
+}
+
+/* Rebuild the single precision state.  After each sample it is the DFT
+   of the last N samples in time order, which start at data[loc]. */
+
+static void sdft_resync(CSOUND *csound, PVSANAL *p, int loc)
+{
+    int N = p->nI, NB = p->Ii, NBP = p->NBP, j;
+    MYFLT *data = (MYFLT*) p->input.auxp;
+    MYFLT *buf = (MYFLT*) p->analwinbuf.auxp;
+    float *re = (float*) p->trig.auxp + 2*NBP, *im = re + NBP;
+
+    for (j = 0; j < N; j++) {
+      buf[j] = data[loc];
+      if (++loc == N) loc = 0;
+    }
+    csound->ExecuteFFTPlan(csound, p->setup, buf);
+    re[0] = (float) buf[0]; im[0] = 0.0f;
+    re[NB-1] = (float) buf[1]; im[NB-1] = 0.0f;
+    for (j = 1; j < NB-1; j++) {
+      re[j] = (float) buf[2*j];
+      im[j] = (float) buf[2*j+1];
+    }
+    p->resync = 0;
+}
+
+/* Apply the window to one rotated spectrum, writing it to ff.  The
+   spectrum of a real signal is conjugate symmetric, which gives the
+   neighbours of the DC and Nyquist bins. */
+
+static void sdft_window(const MYFLT *w, MYFLT *xr, MYFLT *xi, CMPLX *ff,
+                        int NB)
+{
+    MYFLT w0 = w[0], w1 = w[1], w2 = w[2];
+    int j;
+
+    xr[-1] = xr[1];      xi[-1] = -xi[1];
+    xr[-2] = xr[2];      xi[-2] = -xi[2];
+    xr[NB] = xr[NB-2];   xi[NB] = -xi[NB-2];
+    xr[NB+1] = xr[NB-3]; xi[NB+1] = -xi[NB-3];
+    for (j = 0; j < NB; j++) {
+      ff[j].re = w0*xr[j] + w1*(xr[j-1] + xr[j+1]) + w2*(xr[j-2] + xr[j+2]);
+      ff[j].im = w0*xi[j] + w1*(xi[j-1] + xi[j+1]) + w2*(xi[j-2] + xi[j+2]);
+    }
+}
+
+/* Convert a windowed spectrum to AMP_FREQ.  The phase difference from
+   the last sample, less the advance expected of the bin, lies in
+   [-3pi, 2pi] and is wrapped to (-pi, pi]. */
+
+static void sdft_polar(CSOUND *csound, CMPLX *ff, double *h, int NB, int N)
+{
+    double binAdv = TWOPI / N, binFreq = csound->esr / N;
+    double scale = csound->esr / TWOPI;
+    int j;
+
+    for (j = 0; j < NB; j++) {
+      double re = ff[j].re, im = ff[j].im;
+      double phase = atan2(im, re);
+      double angleDif = phase - h[j] - j*binAdv;
+      h[j] = phase;
+      if (angleDif <= -PI) angleDif += TWOPI;
+      if (angleDif <= -PI) angleDif += TWOPI;
+      if (angleDif > PI) angleDif -= TWOPI;
+      ff[j].re = (MYFLT) sqrt(re*re + im*im);
+      ff[j].im = (MYFLT) (j*binFreq + angleDif*scale);
+    }
+}
+
+static void sdft_polarf(CSOUND *csound, CMPLX *ff, float *h, int NB, int N)
+{
+    float binAdv = (float) (TWOPI / N), binFreq = (float) (csound->esr / N);
+    float scale = (float) (csound->esr / TWOPI);
+    int j;
+
+    for (j = 0; j < NB; j++) {
+      float re = (float) ff[j].re, im = (float) ff[j].im;
+      float phase = sdft_atan2f(im, re);
+      float angleDif = phase - h[j] - j*binAdv;
+      h[j] = phase;
+      angleDif += (angleDif <= -(float) PI ? (float) TWOPI : 0.0f);
+      angleDif += (angleDif <= -(float) PI ? (float) TWOPI : 0.0f);
+      angleDif += (angleDif > (float) PI ? -(float) TWOPI : 0.0f);
+      ff[j].re = (MYFLT) (re*re + im*im);
+      ff[j].im = (MYFLT) (j*binFreq + angleDif*scale);
+    }
+    /* kept apart so that the loop above has no calls to libm */
+    for (j = 0; j < NB; j++)
+      ff[j].re = SQRT(ff[j].re);
 }
 
 int pvssanal(CSOUND *csound, PVSANAL *p)
 {
     MYFLT *ain;
-    int NB = p->Ii, loc;
+    int NB = p->Ii, NBP = p->NBP, loc;
     int N = p->fsig->N;
+    int rowlen = SDFT_ROWLEN(NBP);
     MYFLT *data = (MYFLT*)(p->input.auxp);
-    CMPLX *fw = (CMPLX*)(p->analwinbuf.auxp);
-    double *c = p->cosine;
-    double *s = p->sine;
-    double *h = (double*)p->oldInPhase.auxp;
+    MYFLT *xr = (MYFLT*)(p->analwinbuf.auxp);
+    MYFLT *dx = xr + 2*SDFT_CHUNK*rowlen;
+    CMPLX *frame = (CMPLX*)(p->fsig->frame.auxp);
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t i, nsmps = CS_KSMPS;
-    int wintype = p->fsig->wintype;
+    uint32_t i, k, n, nsmps = CS_KSMPS;
     if (UNLIKELY(data==NULL)) {
       return csound->PerfError(csound,p->h.insdshead,
                                Str("pvsanal: Not Initialised.\n"));
@@ -468,200 +708,40 @@ int pvssanal(CSOUND *csound, PVSANAL *p)
     ain = p->ain;               /* The input samples */
     loc = p->inptr;             /* Circular buffer */
     nsmps -= early;
-    for (i=offset; i < nsmps; i++) {
-      MYFLT re, im, dx;
-      CMPLX* ff;
-      int j;
-
-/*       printf("%d: in = %f\n", i, *ain); */
-      dx = *ain - data[loc];    /* Change in sample */
-      data[loc] = *ain++;       /* Remember input sample */
-      /* get the frame for this sample */
-      ff = (CMPLX*)(p->fsig->frame.auxp) + i*NB;
-      /* fw is the current frame at this sample */
-      for (j = 0; j < NB; j++) {
-        double ci = c[j], si = s[j];
-        re = fw[j].re + dx;
-        im = fw[j].im;
-        fw[j].re = ci*re - si*im;
-        fw[j].im = ci*im + si*re;
+    for (i=offset; i < nsmps; i += n) {
+      n = nsmps - i;
+      if (n > SDFT_CHUNK) n = SDFT_CHUNK;
+      for (k = 0; k < n; k++) {
+        dx[k] = ain[i+k] - data[loc];   /* Change in sample */
+        data[loc] = ain[i+k];           /* Remember input sample */
+        loc++; if (UNLIKELY(loc==N)) loc = 0; /* Circular buffer */
       }
-      loc++; if (UNLIKELY(loc==p->nI)) loc = 0; /* Circular buffer */
-      /* apply window and transfer to ff buffer*/
-      /* Rectang :Fw_t =     F_t                          */
-      /* Hamming :Fw_t = 0.54F_t - 0.23[ F_{t-1}+F_{t+1}] */
-      /* Hamming :Fw_t = 0.5 F_t - 0.25[ F_{t-1}+F_{t+1}] */
-      /* Blackman:Fw_t = 0.42F_t - 0.25[ F_{t-1}+F_{t+1}]+0.04[F_{t-2}+F_{t+2}] */
-      /* Blackman_exact:Fw_t = 0.42659071367153912296F_t
-         - 0.24828030954428202923 [F_{t-1}+F_{t+1}]
-         + 0.038424333619948409286 [F_{t-2}+F_{t+2}]      */
-      /* Nuttall_C3:Fw_t = 0.375  F_t - 0.25[ F_{t-1}+F_{t+1}] +
-                                      0.0625 [F_{t-2}+F_{t+2}] */
-      /* BHarris_3:Fw_t = 0.44959 F_t - 0.24682[ F_{t-1}+F_{t+1}] +
-                                      0.02838 [F_{t-2}+F_{t+2}] */
-      /* BHarris_min:Fw_t = 0.42323 F_t - 0.2486703 [ F_{t-1}+F_{t+1}] +
-                                      0.0391396 [F_{t-2}+F_{t+2}] */
-      switch (wintype) {
-      case PVS_WIN_HAMMING:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.54)*fw[j].re;
-          ff[j].im = FL(0.54)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.23)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.23)*(fw[j+1].im + fw[j-1].im);
-        }
-        ff[0].re -= FL(0.46)*fw[1].re;
-        ff[NB-1].re -= FL(0.46)*fw[NB-2].re;
-        break;
-      case PVS_WIN_HANN:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.5)*fw[j].re;
-          ff[j].im = FL(0.5)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.25)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.25)*(fw[j+1].im + fw[j-1].im);
-        }
-        ff[0].re -= FL(0.5)*fw[1].re;
-        ff[NB-1].re -= FL(0.5)*fw[NB-2].re;
-        break;
-      default:
-        csound->Warning(csound,
-                        Str("Unknown window type; replaced by rectangular\n"));
-      case PVS_WIN_RECT:
-        memcpy(ff, fw, NB*sizeof(CMPLX));
-        /* for (j=0; j<NB; j++) { */
-        /*   ff[j].re = fw[j].re; */
-        /*   ff[j].im = fw[j].im; */
-        /* } */
-        break;
-      case PVS_WIN_BLACKMAN:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.42)*fw[j].re;
-          ff[j].im = FL(0.42)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.25)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.25)*(fw[j+1].im + fw[j-1].im);
-        }
-        for (j=2; j<NB-2; j++) {
-          ff[j].re += FL(0.04)*(fw[j+2].re + fw[j-2].re);
-          ff[j].im += FL(0.04)*(fw[j+2].im + fw[j-2].im);
-        }
-        ff[0].re    += -FL(0.5)*fw[1].re + FL(0.08)*fw[2].re;
-        ff[NB-1].re += -FL(0.5)*fw[NB-2].re + FL(0.08)*fw[NB-3].re;
-        ff[1].re    += -FL(0.5)*fw[2].re + FL(0.08)*fw[3].re;
-        ff[NB-2].re += -FL(0.5)*fw[NB-3].re + FL(0.08)*fw[NB-4].re;
-        break;
-    case PVS_WIN_BLACKMAN_EXACT:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.42659071367153912296)*fw[j].re;
-          ff[j].im = FL(0.42659071367153912296)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.49656061908856405847)*FL(0.5)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.49656061908856405847)*FL(0.5)*(fw[j+1].im + fw[j-1].im);
-        }
-        for (j=2; j<NB-2; j++) {
-          ff[j].re += FL(0.076848667239896818573)*FL(0.5)*(fw[j+2].re + fw[j-2].re);
-          ff[j].im += FL(0.076848667239896818573)*FL(0.5)*(fw[j+2].im + fw[j-2].im);
-        }
-        ff[0].re    += -FL(0.49656061908856405847) * fw[1].re
-                      + FL(0.076848667239896818573) * fw[2].re;
-        ff[NB-1].re += -FL(0.49656061908856405847) * fw[NB-2].re
-                      + FL(0.076848667239896818573) * fw[NB-3].re;
-        ff[1].re    += -FL(0.49656061908856405847) * fw[2].re
-                      + FL(0.076848667239896818573) * fw[3].re;
-        ff[NB-2].re += -FL(0.49656061908856405847) * fw[NB-3].re
-                      + FL(0.076848667239896818573) * fw[NB-4].re;
-        break;
-      case PVS_WIN_NUTTALLC3:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.375)*fw[j].re;
-          ff[j].im = FL(0.375)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.5)*FL(0.5)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.5)*FL(0.5)*(fw[j+1].im + fw[j-1].im);
-        }
-        for (j=2; j<NB-2; j++) {
-          ff[j].re += FL(0.125)*FL(0.5)*(fw[j+2].re + fw[j-2].re);
-          ff[j].im += FL(0.125)*FL(0.5)*(fw[j+2].im + fw[j-2].im);
-        }
-        ff[0].re    += -FL(0.5) * fw[1].re    + FL(0.125) * fw[2].re;
-        ff[NB-1].re += -FL(0.5) * fw[NB-2].re + FL(0.125) * fw[NB-3].re;
-        ff[1].re    += -FL(0.5) * fw[2].re    + FL(0.125) * fw[3].re;
-        ff[NB-2].re += -FL(0.5) * fw[NB-3].re + FL(0.125) * fw[NB-4].re;
-        ff[1].re = 0.5 * (fw[2].re + fw[0].re); /* HACK???? */
-        ff[1].im = 0.5 * (fw[2].im + fw[0].im);
-        break;
-      case PVS_WIN_BHARRIS_3:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.44959)*fw[j].re;
-          ff[j].im = FL(0.44959)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.49364)*FL(0.5)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.49364)*FL(0.5)*(fw[j+1].im + fw[j-1].im);
-        }
-        for (j=2; j<NB-2; j++) {
-          ff[j].re += FL(0.05677)*FL(0.5)*(fw[j+2].re + fw[j-2].re);
-          ff[j].im += FL(0.05677)*FL(0.5)*(fw[j+2].im + fw[j-2].im);
-        }
-        ff[0].re    += -FL(0.49364) * fw[1].re    + FL(0.05677) * fw[2].re;
-        ff[NB-1].re += -FL(0.49364) * fw[NB-2].re + FL(0.05677) * fw[NB-3].re;
-        ff[1].re    += -FL(0.49364) * fw[2].re    + FL(0.05677) * fw[3].re;
-        ff[NB-2].re += -FL(0.49364) * fw[NB-3].re + FL(0.05677) * fw[NB-4].re;
-        ff[1].re = 0.5 * (fw[2].re + fw[0].re); /* HACK???? */
-        ff[1].im = 0.5 * (fw[2].im + fw[0].im);
-        break;
-      case PVS_WIN_BHARRIS_MIN:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.42323)*fw[j].re;
-          ff[j].im = FL(0.42323)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.4973406)*FL(0.5)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.4973406)*FL(0.5)*(fw[j+1].im + fw[j-1].im);
-        }
-        for (j=2; j<NB-2; j++) {
-          ff[j].re += FL(0.0782793)*FL(0.5)*(fw[j+2].re + fw[j-2].re);
-          ff[j].im += FL(0.0782793)*FL(0.5)*(fw[j+2].im + fw[j-2].im);
-        }
-        ff[0].re    += -FL(0.4973406) * fw[1].re    + FL(0.0782793) * fw[2].re;
-        ff[NB-1].re += -FL(0.4973406) * fw[NB-2].re + FL(0.0782793) * fw[NB-3].re;
-        ff[1].re    += -FL(0.4973406) * fw[2].re    + FL(0.0782793) * fw[3].re;
-        ff[NB-2].re += -FL(0.4973406) * fw[NB-3].re + FL(0.0782793) * fw[NB-4].re;
-        ff[1].re = 0.5 * (fw[2].re + fw[0].re); /* HACK???? */
-        ff[1].im = 0.5 * (fw[2].im + fw[0].im);
-        break;
+      /* Leave room for the guard bins at the start of each row */
+      if (p->sfast) {
+        float *c = (float*)p->trig.auxp, *s = c+NBP;
+        sdft_rotatef(s+NBP, s+2*NBP, c, s, dx, xr+2, NBP, rowlen, n);
       }
-/*       if (i==9) { */
-/*         printf("Frame as Amp/Freq %d\n", i); */
-/*         for (j = 0; j < NB; j++) */
-/*           printf("%d: %f\t%f\n", j, ff[j].re, ff[j].im); */
-/*       } */
-      for (j = 0; j < NB; j++) { /* Convert to AMP_FREQ */
-        double thismag = hypot(ff[j].re, ff[j].im);
-        double phase = atan2(ff[j].im, ff[j].re);
-        double angleDif  = phase -  h[j];
-        h[j] = phase;
-            /*subtract expected phase difference */
-        angleDif -= (double)j * TWOPI/N;
-        angleDif =  mod2Pi(angleDif);
-        angleDif =  angleDif * N /TWOPI;
-        ff[j].re = thismag;
-        ff[j].im = csound->esr * (j + angleDif)/N;
+      else {
+        double *c = (double*)p->trig.auxp, *s = c+NBP;
+        sdft_rotate(s+NBP, s+2*NBP, c, s, dx, xr+2, NBP, rowlen, n);
+      }
+      /* apply window and convert to AMP_FREQ in each sample's frame */
+      for (k = 0; k < n; k++) {
+        CMPLX *ff = frame + (i+k)*NB;
+        MYFLT *yr = xr + 2*k*rowlen + 2;
+        sdft_window(p->wcoef, yr, yr + rowlen, ff, NB);
+        if (p->sfast)
+          sdft_polarf(csound, ff, (float*)p->oldInPhase.auxp, NB, N);
+        else
+          sdft_polar(csound, ff, (double*)p->oldInPhase.auxp, NB, N);
       }
-/*       if (i==9) { */
-/*         printf("Frame as Amp/Freq %d\n", i); */
-/*         for (j = 0; j < NB; j++) */
-/*           printf("%d: %f\t%f\n", j, ff[j].re, ff[j].im); */
-/*       } */
     }
-
     p->inptr = loc;
+    if (p->sfast && nsmps > offset) {
+      p->resync += nsmps - offset;
+      if (p->resync >= N)
+        sdft_resync(csound, p, loc);
+    }
     return OK;
 }
 
@@ -714,11 +794,34 @@ int pvsynthset(CSOUND *csound, PVSYNTH *p)
       /* get params from input fsig */
       /* we TRUST they are legal */
       int wintype = p->fsig->wintype;
+      int k, NB = p->fsig->NB;
       /* and put into locals */
       p->wintype = wintype;
       p->format = p->fsig->format;
-      csound->AuxAlloc(csound, p->fsig->NB * sizeof(double), &p->oldOutPhase);
-      csound->AuxAlloc(csound, p->fsig->NB * sizeof(double), &p->output);
+      p->sfast = (*p->fast != FL(0.0));
+      /* output gains, then SDFT_LANES partial sums for each of ksmps */
+      if (p->sfast) {
+        float *g;
+        csound->AuxAlloc(csound, NB * sizeof(float), &p->oldOutPhase);
+        csound->AuxAlloc(csound, (NB + CS_KSMPS*SDFT_LANES) * sizeof(float),
+                         &p->output);
+        g = (float*) p->output.auxp;
+        for (k=1; k<NB-1; k++)
+          g[k] = (float) ((k & 1 ? -2.0 : 2.0) / N);
+        g[0] = (float) (1.0 / N);
+        g[NB-1] = (float) (-1.0 / N);
+      }
+      else {
+        double *g;
+        csound->AuxAlloc(csound, NB * sizeof(double), &p->oldOutPhase);
+        csound->AuxAlloc(csound, (NB + CS_KSMPS*SDFT_LANES) * sizeof(double),
+                         &p->output);
+        g = (double*) p->output.auxp;
+        for (k=1; k<NB-1; k++)
+          g[k] = (k & 1 ? -2.0 : 2.0) / N;
+        g[0] = 1.0 / N;
+        g[NB-1] = -1.0 / N;
+      }
       return OK;
     }
     /* and put into locals */
@@ -730,6 +833,9 @@ int pvsynthset(CSOUND *csound, PVSYNTH *p)
     p->fund = csound->esr / (MYFLT) N;
     nBins = N/2 + 1;
     Lf = Mf = 1 - M%2;
+    p->setup = csound->CreateFFTPlan(csound, N, CS_FFT_INVERSE);
+    if (UNLIKELY(p->setup == NULL))
+      return csound->InitError(csound, Str("pvsynth: invalid fft size\n"));
     /* deal with iinit later on! */
     csound->AuxAlloc(csound, overlap * sizeof(MYFLT), &p->overlapbuf);
     csound->AuxAlloc(csound, (N+2) * sizeof(MYFLT), &p->synbuf);
@@ -929,14 +1035,9 @@ static void process_frame(CSOUND *csound, PVSYNTH *p)
        program must take care to zero each location which it "shifts"
        out (to standard output). The subroutines reals and fft
        together perform an efficient inverse FFT.  */
-    if (!(NO & (NO - 1))) {
-      /*printf("N %d %d \n", NO, NO & (NO-1));*/
-      syn[1] = syn[NO];
-      csound->InverseRealFFT(csound, syn, NO);
-      syn[NO] = syn[NO + 1] = FL(0.0);
-    }
-    else
-      csound->InverseRealFFTnp2(csound, syn, NO);
+    syn[1] = syn[NO];
+    csound->ExecuteFFTPlan(csound, p->setup, syn);
+    syn[NO] = syn[NO + 1] = FL(0.0);
     j = p->nO - synWinLen - 1;
     while (j < 0)
       j += p->buflen;
@@ -996,40 +1097,76 @@ static void process_frame(CSOUND *csound, PVSYNTH *p)
     p->IOi =  p->Ii;
 }
 
+/* Sliding resynthesis: each output sample is the centre of the inverse
+   DFT of its frame, a sum of the bin amplitudes times the cosines of
+   their running phases with gains g[k].  The bins are summed in tiles
+   over the whole ksmps block, each lane keeping its own partial sums. */
+
 int pvssynth(CSOUND *csound, PVSYNTH *p)
 {
-    int i, k;
+    int i, k, l, n;
     int ksmps = CS_KSMPS;
-    int N = p->fsig->N;
     int NB = p->fsig->NB;
     MYFLT *aout = p->aout;
-    CMPLX *ff;
-    double *h = (double*)p->oldOutPhase.auxp;
-    double *output = (double*)p->output.auxp;
-
-    /* Get real part from AMP/FREQ */
-    for (i=0; i<ksmps; i++) {
-      MYFLT a;
-      ff = (CMPLX*)(p->fsig->frame.auxp) + i*NB;
-      for (k=0; k<NB; k++) {
-        double tmp, phase;
-
-        tmp = ff[k].im; /* Actually frequency */
-        /* subtract bin mid frequency */
-        tmp -= (double)k * csound->esr/N;
-        /* get bin deviation from freq deviation */
-        tmp *= TWOPI /csound->esr;
-        /* add the overlap phase advance back in */
-        tmp += (double)k*TWOPI/N;
-        h[k] = phase = mod2Pi(h[k] + tmp);
-        output[k] = ff[k].re*cos(phase);
+    CMPLX *frame = (CMPLX*)(p->fsig->frame.auxp);
+
+    if (p->sfast) {
+      float *h = (float*)p->oldOutPhase.auxp;
+      float *g = (float*)p->output.auxp;
+      float *acc = g + NB;
+      float w = (float) (TWOPI / csound->esr);
+      memset(acc, 0, ksmps*SDFT_LANES*sizeof(float));
+      for (k=0; k<NB; k+=SDFT_LANES) {
+        float ph[SDFT_LANES];
+        n = (NB-k < SDFT_LANES ? NB-k : SDFT_LANES);
+        for (l=0; l<n; l++) ph[l] = h[k+l];
+        for (i=0; i<ksmps; i++) {
+          CMPLX *ff = frame + i*NB + k;
+          float *a = acc + i*SDFT_LANES;
+          for (l=0; l<n; l++) {
+            /* ff[].im is the frequency, which gives the phase advance */
+            float x = ph[l] + (float) ff[l].im * w;
+            x -= (float) TWOPI * (int) (x * (float) (1.0/TWOPI)
+                                        + (x < 0.0f ? -0.5f : 0.5f));
+            ph[l] = x;
+            a[l] += g[k+l] * (float) ff[l].re * sdft_cosf(x);
+          }
+        }
+        for (l=0; l<n; l++) h[k+l] = ph[l];
+      }
+      for (i=0; i<ksmps; i++) {
+        float a = 0.0f;
+        for (l=0; l<SDFT_LANES; l++) a += acc[i*SDFT_LANES+l];
+        aout[i] = (MYFLT) a;
+      }
+    }
+    else {
+      double *h = (double*)p->oldOutPhase.auxp;
+      double *g = (double*)p->output.auxp;
+      double *acc = g + NB;
+      double w = TWOPI / csound->esr;
+      memset(acc, 0, ksmps*SDFT_LANES*sizeof(double));
+      for (k=0; k<NB; k+=SDFT_LANES) {
+        double ph[SDFT_LANES];
+        n = (NB-k < SDFT_LANES ? NB-k : SDFT_LANES);
+        for (l=0; l<n; l++) ph[l] = h[k+l];
+        for (i=0; i<ksmps; i++) {
+          CMPLX *ff = frame + i*NB + k;
+          double *a = acc + i*SDFT_LANES;
+          for (l=0; l<n; l++) {
+            double x = ph[l] + ff[l].im * w;
+            x -= TWOPI * (int) (x * (1.0/TWOPI));
+            ph[l] = x;
+            a[l] += g[k+l] * ff[l].re * cos(x);
+          }
+        }
+        for (l=0; l<n; l++) h[k+l] = ph[l];
       }
-      a = FL(0.0);
-      for (k=1; k<NB-1; k++) {
-        a -= output[k];
-        if (k+1<NB-1) a+=output[++k];
+      for (i=0; i<ksmps; i++) {
+        double a = 0.0;
+        for (l=0; l<SDFT_LANES; l++) a += acc[i*SDFT_LANES+l];
+        aout[i] = (MYFLT) a;
       }
-      aout[i] = (a+a+output[0]-output[NB-1])/N;
     }
     return OK;
 }
@@ -1173,6 +1173,7 @@ int oscsetA(CSOUND *csound, OSC *p)
       p->lphs = ((int32)(*p->iphs * FMAXLEN)) & PHMASK;
     //check p->ifn is a valid array with power-of-two length
     p->ftp = ftp;
+    p->bl = 0;
     fill_func_from_array((ARRAYDAT*)p->ifn, ftp);
     return OK;
 }
@@ -1185,21 +1186,61 @@ int oscset(CSOUND *csound, OSC *p)
       p->ftp = ftp;
       if (*p->iphs >= 0)
         p->lphs = ((int32)(*p->iphs * FMAXLEN)) & PHMASK;
+      p->bl = 0;
+      if (*p->ibl != FL(0.0)) {
+        /* make the band-limited copies now rather than in the first k-cycle */
+        csound->GetBandLimitedTable(csound, ftp, FL(0.0));
+        if (ftp->bltables != NULL)
+          p->bl = 1;
+        else
+          csound->Warning(csound, Str("oscil: table %d cannot be "
+                                      "band-limited"), (int) ftp->fno);
+      }
       return OK;
     }
     return NOTOK;
 }
 
+/* Table read by an oscillator in a k-cycle: with ibl set, the copy of
+   the table that is band-limited for a phase increment of inc */
+
+static inline MYFLT *osc_table(CSOUND *csound, OSC *p, FUNC *ftp, MYFLT inc)
+{
+    if (LIKELY(!p->bl))
+      return ftp->ftable;
+    return csound->GetBandLimitedTable(csound, ftp, inc * ftp->lodiv);
+}
+
+/* the same for an a-rate frequency, using the largest increment in the
+   k-cycle */
+
+static MYFLT *osc_table_a(CSOUND *csound, OSC *p, FUNC *ftp, MYFLT sicvt)
+{
+    MYFLT   *cpsp = p->xcps, cps, mx = FL(0.0);
+    uint32_t n, nsmps = CS_KSMPS;
+
+    if (LIKELY(!p->bl))
+      return ftp->ftable;
+    for (n = p->h.insdshead->ksmps_offset; n < nsmps; n++) {
+      cps = FABS(cpsp[n]);
+      if (cps > mx)
+        mx = cps;
+    }
+    return csound->GetBandLimitedTable(csound, ftp, mx * sicvt * ftp->lodiv);
+}
+
 int koscil(CSOUND *csound, OSC *p)
 {
     FUNC    *ftp;
+    MYFLT   *ftbl;
     int32    phs, inc;
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
     phs = p->lphs;
     inc = (int32) (*p->xcps * CS_KICVT);
-    *p->sr = ftp->ftable[phs >> ftp->lobits] * *p->xamp;
+    ftbl = osc_table(csound, p, ftp, *p->xcps * CS_KICVT);
+    *p->sr = ftbl[phs >> ftp->lobits] * *p->xamp;
     phs += inc;
     phs &= PHMASK;
     p->lphs = phs;
@@ -1220,7 +1261,7 @@ int osckk(CSOUND *csound, OSC *p)
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftbl = ftp->ftable;
+    ftbl = osc_table(csound, p, ftp, *p->xcps * csound->sicvt);
     phs = p->lphs;
     inc = MYFLT2LONG(*p->xcps * csound->sicvt);
     lobits = ftp->lobits;
@@ -1257,7 +1298,7 @@ int oscka(CSOUND *csound, OSC *p)
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftbl = ftp->ftable;
+    ftbl = osc_table_a(csound, p, ftp, sicvt);
     lobits = ftp->lobits;
     amp = *p->xamp;
     cpsp = p->xcps;
@@ -1292,7 +1333,7 @@ int oscak(CSOUND *csound, OSC *p)
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftbl = ftp->ftable;
+    ftbl = osc_table(csound, p, ftp, *p->xcps * csound->sicvt);
     lobits = ftp->lobits;
     phs = p->lphs;
     inc = MYFLT2LONG(*p->xcps * csound->sicvt);
@@ -1326,7 +1367,7 @@ int oscaa(CSOUND *csound, OSC *p)
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftbl = ftp->ftable;
+    ftbl = osc_table_a(csound, p, ftp, sicvt);
     lobits = ftp->lobits;
     phs = p->lphs;
     ampp = p->xamp;
@@ -1359,7 +1400,8 @@ int koscli(CSOUND *csound, OSC   *p)
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
     fract = PFRAC(phs);
-    ftab = ftp->ftable + (phs >> ftp->lobits);
+    ftab = osc_table(csound, p, ftp, *p->xcps * CS_KICVT) +
+           (phs >> ftp->lobits);
     v1 = ftab[0];
     *p->sr = (v1 + (ftab[1] - v1) * fract) * *p->xamp;
     inc = (int32)(*p->xcps * CS_KICVT);
@@ -1392,7 +1434,7 @@ int osckki(CSOUND *csound, OSC   *p)
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    ft = ftp->ftable;
+    ft = osc_table(csound, p, ftp, *p->xcps * csound->sicvt);
     for (n=offset; n<nsmps; n++) {
       fract = PFRAC(phs);
       ftab = ft + (phs >> lobits);
@@ -1429,7 +1471,7 @@ int osckai(CSOUND *csound, OSC   *p)
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    ft = ftp->ftable;
+    ft = osc_table_a(csound, p, ftp, sicvt);
     for (n=offset;n<nsmps;n++) {
       int32 inc;
       inc = MYFLT2LONG(cpsp[n] * sicvt);
@@ -1468,7 +1510,7 @@ int oscaki(CSOUND *csound, OSC   *p)
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    ft = ftp->ftable;
+    ft = osc_table(csound, p, ftp, *p->xcps * csound->sicvt);
     for (n=offset;n<nsmps;n++) {
       fract = (MYFLT) PFRAC(phs);
       ftab = ft + (phs >> lobits);
@@ -1495,7 +1537,7 @@ int oscaai(CSOUND *csound, OSC   *p)
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ft = ftp->ftable;
+    ft = osc_table_a(csound, p, ftp, sicvt);
     lobits = ftp->lobits;
     phs = p->lphs;
     ampp = p->xamp;
@@ -1533,7 +1575,7 @@ int koscl3(CSOUND *csound, OSC   *p)
     phs = p->lphs;
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftab = ftp->ftable;
+    ftab = osc_table(csound, p, ftp, *p->xcps * CS_KICVT);
     fract = PFRAC(phs);
     x0 = (phs >> ftp->lobits);
     x0--;
@@ -1576,7 +1618,7 @@ int osckk3(CSOUND *csound, OSC   *p)
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftab = ftp->ftable;
+    ftab = osc_table(csound, p, ftp, *p->xcps * csound->sicvt);
     lobits = ftp->lobits;
     phs = p->lphs;
     inc = MYFLT2LONG(*p->xcps * csound->sicvt);
@@ -1636,7 +1678,7 @@ int oscka3(CSOUND *csound, OSC   *p)
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftab = ftp->ftable;
+    ftab = osc_table_a(csound, p, ftp, sicvt);
     lobits = ftp->lobits;
     amp = *p->xamp;
     cpsp = p->xcps;
@@ -1691,7 +1733,7 @@ int oscak3(CSOUND *csound, OSC   *p)
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftab = ftp->ftable;
+    ftab = osc_table(csound, p, ftp, *p->xcps * csound->sicvt);
     lobits = ftp->lobits;
     phs = p->lphs;
     inc = MYFLT2LONG(*p->xcps * csound->sicvt);
@@ -1745,7 +1787,7 @@ int oscaa3(CSOUND *csound, OSC   *p)
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftab = ftp->ftable;
+    ftab = osc_table_a(csound, p, ftp, sicvt);
     lobits = ftp->lobits;
     phs = p->lphs;
     ampp = p->xamp;
@@ -0,0 +1,668 @@
+/*
+    vecops.c:
+
+    Copyright (C) 2026 The Csound developers
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+#include "csoundCore.h"                         /*      VECOPS.C        */
+#include "vecops.h"
+#include <math.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  if defined(__SSE2__)
+#    define VECOPS_SSE2 1
+#    include <emmintrin.h>
+#  endif
+#  if (defined(__clang__) || __GNUC__ >= 5) && !defined(__MINGW32__)
+#    define VECOPS_AVX2 1
+#    include <immintrin.h>
+#  endif
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#  define VECOPS_NEON 1
+#  include <arm_neon.h>
+#endif
+
+/* the rounding of int1_floor() and int1_ceil() in aops.c */
+#define MYFLOOR(x) ((int32)((double)(x) >= 0.0 ? (x) : (x) - 0.99999999))
+#define MYCEIL(x) ((int32)((double)(x) >= 0.0 ? (x) + 0.99999999 : (x)))
+
+/* Kernel generators.  They expand to a function named NAME_ISA using the
+   V... macros of the instruction set, which are defined before each set
+   of kernels is made and undefined afterwards; VW is the number of
+   samples in a vector, and the samples left over are done in C.  */
+
+#define VK_VV(ISA, NAME, VOP, OP)                                       \
+  VK_ATTR static void NAME##_##ISA(MYFLT *r, const MYFLT *a,            \
+                                   const MYFLT *b, uint32_t n)          \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      for (; i + VW <= n; i += VW)                                      \
+        VSTORE(r + i, VOP(VLOAD(a + i), VLOAD(b + i)));                 \
+      for (; i < n; i++)                                                \
+        r[i] = a[i] OP b[i];                                            \
+  }
+
+#define VK_SV(ISA, NAME, VOP, OP)                                       \
+  VK_ATTR static void NAME##_##ISA(MYFLT *r, MYFLT a,                   \
+                                   const MYFLT *b, uint32_t n)          \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      VT       va = VSET1(a);                                           \
+      for (; i + VW <= n; i += VW)                                      \
+        VSTORE(r + i, VOP(va, VLOAD(b + i)));                           \
+      for (; i < n; i++)                                                \
+        r[i] = a OP b[i];                                               \
+  }
+
+#define VK_VS(ISA, NAME, VOP, OP)                                       \
+  VK_ATTR static void NAME##_##ISA(MYFLT *r, const MYFLT *a,            \
+                                   MYFLT b, uint32_t n)                 \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      VT       vb = VSET1(b);                                           \
+      for (; i + VW <= n; i += VW)                                      \
+        VSTORE(r + i, VOP(VLOAD(a + i), vb));                           \
+      for (; i < n; i++)                                                \
+        r[i] = a[i] OP b;                                               \
+  }
+
+#define VK_ARITH(ISA)                                                   \
+  VK_VV(ISA, add_vv, VADD, +)                                           \
+  VK_VV(ISA, sub_vv, VSUB, -)                                           \
+  VK_VV(ISA, mul_vv, VMUL, *)                                           \
+  VK_VV(ISA, div_vv, VDIV, /)                                           \
+  VK_SV(ISA, add_sv, VADD, +)                                           \
+  VK_SV(ISA, sub_sv, VSUB, -)                                           \
+  VK_SV(ISA, mul_sv, VMUL, *)                                           \
+  VK_SV(ISA, div_sv, VDIV, /)                                           \
+  VK_VS(ISA, add_vs, VADD, +)                                           \
+  VK_VS(ISA, sub_vs, VSUB, -)                                           \
+  VK_VS(ISA, mul_vs, VMUL, *)                                           \
+  VK_VS(ISA, div_vs, VDIV, /)                                           \
+                                                                        \
+  VK_ATTR static void divz_vv_##ISA(MYFLT *r, const MYFLT *a,           \
+                                    const MYFLT *b, MYFLT def,          \
+                                    uint32_t n)                         \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      VT       vd = VSET1(def);                                         \
+      for (; i + VW <= n; i += VW) {                                    \
+        VT vb = VLOAD(b + i);                                           \
+        VSTORE(r + i, VSEL(VEQZ(vb), vd, VDIV(VLOAD(a + i), vb)));      \
+      }                                                                 \
+      for (; i < n; i++)                                                \
+        r[i] = (b[i]==FL(0.0) ? def : a[i] / b[i]);                     \
+  }                                                                     \
+                                                                        \
+  VK_ATTR static void divz_sv_##ISA(MYFLT *r, MYFLT a, const MYFLT *b,  \
+                                    MYFLT def, uint32_t n)              \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      VT       va = VSET1(a), vd = VSET1(def);                          \
+      for (; i + VW <= n; i += VW) {                                    \
+        VT vb = VLOAD(b + i);                                           \
+        VSTORE(r + i, VSEL(VEQZ(vb), vd, VDIV(va, vb)));                \
+      }                                                                 \
+      for (; i < n; i++)                                                \
+        r[i] = (b[i]==FL(0.0) ? def : a / b[i]);                        \
+  }
+
+/* Rounding, for instruction sets with VTRUNC (towards zero) and VRINT
+   (in the current rounding mode, like lrint()).  frac() gives the sign
+   of a to a zero result, as modf() does, while round(), floor() and
+   ceil() go through an int32 in C, so adding zero turns -0 into +0.
+   Without lrint(), MYFLT2LRND() rounds halves away from zero.  */
+
+#if defined(USE_LRINT) || \
+    (defined(HAVE_GCC3) && defined(__i386__) && !defined(__ICC))
+#  define VK_NEAREST(x) VRINT(x)
+#else
+#  define VK_NEAREST(x) \
+    VTRUNC(VADD(x, VSEL(VGE(x, zero), half, VSUB(zero, half))))
+#endif
+
+#define VK_ROUND(ISA)                                                   \
+  VK_ATTR static void trunc_##ISA(MYFLT *r, const MYFLT *a, uint32_t n) \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      MYFLT    ip;                                                      \
+      for (; i + VW <= n; i += VW)                                      \
+        VSTORE(r + i, VTRUNC(VLOAD(a + i)));                            \
+      for (; i < n; i++) {                                              \
+        MODF(a[i], &ip);                                                \
+        r[i] = ip;                                                      \
+      }                                                                 \
+  }                                                                     \
+                                                                        \
+  VK_ATTR static void frac_##ISA(MYFLT *r, const MYFLT *a, uint32_t n)  \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      MYFLT    ip;                                                      \
+      VT       zero = VSET1(FL(0.0));                                   \
+      for (; i + VW <= n; i += VW) {                                    \
+        VT x = VLOAD(a + i);                                            \
+        VT f = VSUB(x, VTRUNC(x));                                      \
+        VSTORE(r + i, VSEL(VEQZ(f), VMUL(x, zero), f));                 \
+      }                                                                 \
+      for (; i < n; i++)                                                \
+        r[i] = MODF(a[i], &ip);                                         \
+  }                                                                     \
+                                                                        \
+  VK_ATTR static void round_##ISA(MYFLT *r, const MYFLT *a, uint32_t n) \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      VT       zero = VSET1(FL(0.0)), half = VSET1(FL(0.5));            \
+      for (; i + VW <= n; i += VW)                                      \
+        VSTORE(r + i, VADD(VK_NEAREST(VLOAD(a + i)), zero));            \
+      for (; i < n; i++)                                                \
+        r[i] = (MYFLT) MYFLT2LRND(a[i]);                                \
+  }
+
+/* floor() and ceil() add 0.99999999 in double precision before
+   truncating, so only double builds can do them a vector at a time.  */
+
+#define VK_FLOOR(ISA)                                                   \
+  VK_ATTR static void floor_##ISA(MYFLT *r, const MYFLT *a, uint32_t n) \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      VT       d = VSET1(0.99999999), zero = VSET1(FL(0.0));            \
+      for (; i + VW <= n; i += VW) {                                    \
+        VT x = VLOAD(a + i);                                            \
+        VT y = VTRUNC(VSEL(VGE(x, zero), x, VSUB(x, d)));               \
+        VSTORE(r + i, VADD(y, zero));                                   \
+      }                                                                 \
+      for (; i < n; i++)                                                \
+        r[i] = (MYFLT) MYFLOOR(a[i]);                                   \
+  }                                                                     \
+                                                                        \
+  VK_ATTR static void ceil_##ISA(MYFLT *r, const MYFLT *a, uint32_t n)  \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      VT       d = VSET1(0.99999999), zero = VSET1(FL(0.0));            \
+      for (; i + VW <= n; i += VW) {                                    \
+        VT x = VLOAD(a + i);                                            \
+        VT y = VTRUNC(VSEL(VGE(x, zero), VADD(x, d), x));               \
+        VSTORE(r + i, VADD(y, zero));                                   \
+      }                                                                 \
+      for (; i < n; i++)                                                \
+        r[i] = (MYFLT) MYCEIL(a[i]);                                    \
+  }
+
+/* Sample format conversion.  The vector conversions to int32 round in
+   the current rounding mode, or to nearest even on NEON, like lrint().  */
+
+#ifdef USE_DOUBLE
+#  define VK_LRINT(x)   ((int32_t) lrint(x))
+#else
+#  define VK_LRINT(x)   ((int32_t) lrintf(x))
+#endif
+
+#define VK_CONV(ISA)                                                    \
+  VK_ATTR static void quant_##ISA(int32_t *r, const MYFLT *a,           \
+                                  const MYFLT *d, MYFLT scale,          \
+                                  MYFLT lo, MYFLT hi, uint32_t n)       \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      VT       vs = VSET1(scale), vl = VSET1(lo), vh = VSET1(hi);       \
+      MYFLT    y;                                                       \
+      if (d == NULL) {                                                  \
+        for (; i + VW <= n; i += VW)                                    \
+          VSTORE_I(r + i, VMAX(VMIN(VMUL(VLOAD(a + i), vs), vh), vl));  \
+      }                                                                 \
+      else {                                                            \
+        for (; i + VW <= n; i += VW) {                                  \
+          VT x = VADD(VMUL(VLOAD(a + i), vs), VLOAD(d + i));            \
+          VSTORE_I(r + i, VMAX(VMIN(x, vh), vl));                       \
+        }                                                               \
+      }                                                                 \
+      for (; i < n; i++) {                                              \
+        y = (d == NULL ? a[i] * scale : a[i] * scale + d[i]);           \
+        r[i] = VK_LRINT(y < lo ? lo : (y > hi ? hi : y));               \
+      }                                                                 \
+  }                                                                     \
+                                                                        \
+  VK_ATTR static void from_int_##ISA(MYFLT *r, const int32_t *a,        \
+                                     MYFLT scale, uint32_t n)           \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      VT       vs = VSET1(scale);                                       \
+      for (; i + VW <= n; i += VW)                                      \
+        VSTORE(r + i, VMUL(VLOAD_I(a + i), vs));                        \
+      for (; i < n; i++)                                                \
+        r[i] = (MYFLT) a[i] * scale;                                    \
+  }                                                                     \
+                                                                        \
+  VK_ATTR static void from_float_##ISA(MYFLT *r, const float *a,        \
+                                       MYFLT scale, uint32_t n)         \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      VT       vs = VSET1(scale);                                       \
+      for (; i + VW <= n; i += VW)                                      \
+        VSTORE(r + i, VMUL(VLOAD_F(a + i), vs));                        \
+      for (; i < n; i++)                                                \
+        r[i] = (MYFLT) a[i] * scale;                                    \
+  }                                                                     \
+                                                                        \
+  VK_ATTR static void to_float_##ISA(float *r, const MYFLT *a,          \
+                                     MYFLT scale, uint32_t n)           \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      VT       vs = VSET1(scale);                                       \
+      for (; i + VW <= n; i += VW)                                      \
+        VSTORE_F(r + i, VMUL(VLOAD(a + i), vs));                        \
+      for (; i < n; i++)                                                \
+        r[i] = (float) (a[i] * scale);                                  \
+  }
+
+/* ---------------------------------------------------------------------- */
+/* plain C, which also does what the vector sets cannot */
+
+#define VK_ATTR
+#define VW      1
+#define VT      MYFLT
+#define VLOAD(p)        (*(p))
+#define VSTORE(p, x)    (*(p) = (x))
+#define VSET1(x)        (x)
+#define VADD(x, y)      ((x) + (y))
+#define VSUB(x, y)      ((x) - (y))
+#define VMUL(x, y)      ((x) * (y))
+#define VDIV(x, y)      ((x) / (y))
+#define VEQZ(x)         ((x) == FL(0.0))
+#define VSEL(m, x, y)   ((m) ? (x) : (y))
+#define VMIN(x, y)      ((x) < (y) ? (x) : (y))
+#define VMAX(x, y)      ((x) > (y) ? (x) : (y))
+#define VSTORE_I(p, x)  (*(p) = VK_LRINT(x))
+#define VLOAD_I(p)      ((MYFLT) *(p))
+#define VSTORE_F(p, x)  (*(p) = (float) (x))
+#define VLOAD_F(p)      ((MYFLT) *(p))
+
+VK_ARITH(c)
+VK_CONV(c)
+
+#undef VK_ATTR
+#undef VW
+#undef VT
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VDIV
+#undef VEQZ
+#undef VSEL
+#undef VMIN
+#undef VMAX
+#undef VSTORE_I
+#undef VLOAD_I
+#undef VSTORE_F
+#undef VLOAD_F
+
+static void trunc_c(MYFLT *r, const MYFLT *a, uint32_t n)
+{
+    uint32_t i;
+    MYFLT    ip;
+    for (i = 0; i < n; i++) {
+      MODF(a[i], &ip);
+      r[i] = ip;
+    }
+}
+
+static void frac_c(MYFLT *r, const MYFLT *a, uint32_t n)
+{
+    uint32_t i;
+    MYFLT    ip;
+    for (i = 0; i < n; i++)
+      r[i] = MODF(a[i], &ip);
+}
+
+static void round_c(MYFLT *r, const MYFLT *a, uint32_t n)
+{
+    uint32_t i;
+    for (i = 0; i < n; i++)
+      r[i] = (MYFLT) MYFLT2LRND(a[i]);
+}
+
+static void floor_c(MYFLT *r, const MYFLT *a, uint32_t n)
+{
+    uint32_t i;
+    for (i = 0; i < n; i++)
+      r[i] = (MYFLT) MYFLOOR(a[i]);
+}
+
+static void ceil_c(MYFLT *r, const MYFLT *a, uint32_t n)
+{
+    uint32_t i;
+    for (i = 0; i < n; i++)
+      r[i] = (MYFLT) MYCEIL(a[i]);
+}
+
+static const CS_VECOPS vecops_c = {
+    "c",
+    add_vv_c, sub_vv_c, mul_vv_c, div_vv_c,
+    add_sv_c, sub_sv_c, mul_sv_c, div_sv_c,
+    add_vs_c, sub_vs_c, mul_vs_c, div_vs_c,
+    divz_vv_c, divz_sv_c,
+    trunc_c, frac_c, round_c, floor_c, ceil_c,
+    quant_c, from_int_c, from_float_c, to_float_c
+};
+
+/* ---------------------------------------------------------------------- */
+/* SSE2, which has no rounding instructions */
+
+#ifdef VECOPS_SSE2
+
+#define VK_ATTR
+#ifdef USE_DOUBLE
+#  define VW    2
+#  define VT    __m128d
+#  define VLOAD(p)      _mm_loadu_pd(p)
+#  define VSTORE(p, x)  _mm_storeu_pd(p, x)
+#  define VSET1(x)      _mm_set1_pd(x)
+#  define VADD(x, y)    _mm_add_pd(x, y)
+#  define VSUB(x, y)    _mm_sub_pd(x, y)
+#  define VMUL(x, y)    _mm_mul_pd(x, y)
+#  define VDIV(x, y)    _mm_div_pd(x, y)
+#  define VEQZ(x)       _mm_cmpeq_pd(x, _mm_setzero_pd())
+#  define VSEL(m, x, y) _mm_or_pd(_mm_and_pd(m, x), _mm_andnot_pd(m, y))
+#  define VMIN(x, y)    _mm_min_pd(x, y)
+#  define VMAX(x, y)    _mm_max_pd(x, y)
+#  define VSTORE_I(p, x) _mm_storel_epi64((__m128i*) (p), _mm_cvtpd_epi32(x))
+#  define VLOAD_I(p)    _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*) (p)))
+#  define VSTORE_F(p, x) _mm_storel_pi((__m64*) (p), _mm_cvtpd_ps(x))
+#  define VLOAD_F(p)    \
+    _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*) (p))))
+#else
+#  define VW    4
+#  define VT    __m128
+#  define VLOAD(p)      _mm_loadu_ps(p)
+#  define VSTORE(p, x)  _mm_storeu_ps(p, x)
+#  define VSET1(x)      _mm_set1_ps(x)
+#  define VADD(x, y)    _mm_add_ps(x, y)
+#  define VSUB(x, y)    _mm_sub_ps(x, y)
+#  define VMUL(x, y)    _mm_mul_ps(x, y)
+#  define VDIV(x, y)    _mm_div_ps(x, y)
+#  define VEQZ(x)       _mm_cmpeq_ps(x, _mm_setzero_ps())
+#  define VSEL(m, x, y) _mm_or_ps(_mm_and_ps(m, x), _mm_andnot_ps(m, y))
+#  define VMIN(x, y)    _mm_min_ps(x, y)
+#  define VMAX(x, y)    _mm_max_ps(x, y)
+#  define VSTORE_I(p, x) _mm_storeu_si128((__m128i*) (p), _mm_cvtps_epi32(x))
+#  define VLOAD_I(p)    _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*) (p)))
+#  define VSTORE_F(p, x) _mm_storeu_ps(p, x)
+#  define VLOAD_F(p)    _mm_loadu_ps(p)
+#endif
+
+VK_ARITH(sse2)
+VK_CONV(sse2)
+
+#undef VK_ATTR
+#undef VW
+#undef VT
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VDIV
+#undef VEQZ
+#undef VSEL
+#undef VMIN
+#undef VMAX
+#undef VSTORE_I
+#undef VLOAD_I
+#undef VSTORE_F
+#undef VLOAD_F
+
+static const CS_VECOPS vecops_sse2 = {
+    "sse2",
+    add_vv_sse2, sub_vv_sse2, mul_vv_sse2, div_vv_sse2,
+    add_sv_sse2, sub_sv_sse2, mul_sv_sse2, div_sv_sse2,
+    add_vs_sse2, sub_vs_sse2, mul_vs_sse2, div_vs_sse2,
+    divz_vv_sse2, divz_sv_sse2,
+    trunc_c, frac_c, round_c, floor_c, ceil_c,
+    quant_sse2, from_int_sse2, from_float_sse2, to_float_sse2
+};
+
+#endif  /* VECOPS_SSE2 */
+
+/* ---------------------------------------------------------------------- */
+/* AVX2, compiled for that target whatever the compiler flags, and only
+   used if the CPU has it */
+
+#ifdef VECOPS_AVX2
+
+#define VK_ATTR __attribute__((target("avx2")))
+#ifdef USE_DOUBLE
+#  define VW    4
+#  define VT    __m256d
+#  define VLOAD(p)      _mm256_loadu_pd(p)
+#  define VSTORE(p, x)  _mm256_storeu_pd(p, x)
+#  define VSET1(x)      _mm256_set1_pd(x)
+#  define VADD(x, y)    _mm256_add_pd(x, y)
+#  define VSUB(x, y)    _mm256_sub_pd(x, y)
+#  define VMUL(x, y)    _mm256_mul_pd(x, y)
+#  define VDIV(x, y)    _mm256_div_pd(x, y)
+#  define VEQZ(x)       _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_EQ_OQ)
+#  define VGE(x, y)     _mm256_cmp_pd(x, y, _CMP_GE_OQ)
+#  define VSEL(m, x, y) _mm256_blendv_pd(y, x, m)
+#  define VTRUNC(x)     _mm256_round_pd(x, _MM_FROUND_TO_ZERO|_MM_FROUND_NO_EXC)
+#  define VRINT(x)      _mm256_round_pd(x, _MM_FROUND_CUR_DIRECTION)
+#  define VMIN(x, y)    _mm256_min_pd(x, y)
+#  define VMAX(x, y)    _mm256_max_pd(x, y)
+#  define VSTORE_I(p, x) _mm_storeu_si128((__m128i*) (p), _mm256_cvtpd_epi32(x))
+#  define VLOAD_I(p)    _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*) (p)))
+#  define VSTORE_F(p, x) _mm_storeu_ps(p, _mm256_cvtpd_ps(x))
+#  define VLOAD_F(p)    _mm256_cvtps_pd(_mm_loadu_ps(p))
+#else
+#  define VW    8
+#  define VT    __m256
+#  define VLOAD(p)      _mm256_loadu_ps(p)
+#  define VSTORE(p, x)  _mm256_storeu_ps(p, x)
+#  define VSET1(x)      _mm256_set1_ps(x)
+#  define VADD(x, y)    _mm256_add_ps(x, y)
+#  define VSUB(x, y)    _mm256_sub_ps(x, y)
+#  define VMUL(x, y)    _mm256_mul_ps(x, y)
+#  define VDIV(x, y)    _mm256_div_ps(x, y)
+#  define VEQZ(x)       _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_EQ_OQ)
+#  define VGE(x, y)     _mm256_cmp_ps(x, y, _CMP_GE_OQ)
+#  define VSEL(m, x, y) _mm256_blendv_ps(y, x, m)
+#  define VTRUNC(x)     _mm256_round_ps(x, _MM_FROUND_TO_ZERO|_MM_FROUND_NO_EXC)
+#  define VRINT(x)      _mm256_round_ps(x, _MM_FROUND_CUR_DIRECTION)
+#  define VMIN(x, y)    _mm256_min_ps(x, y)
+#  define VMAX(x, y)    _mm256_max_ps(x, y)
+#  define VSTORE_I(p, x) \
+    _mm256_storeu_si256((__m256i*) (p), _mm256_cvtps_epi32(x))
+#  define VLOAD_I(p)    \
+    _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*) (p)))
+#  define VSTORE_F(p, x) _mm256_storeu_ps(p, x)
+#  define VLOAD_F(p)    _mm256_loadu_ps(p)
+#endif
+
+VK_ARITH(avx2)
+VK_CONV(avx2)
+VK_ROUND(avx2)
+#ifdef USE_DOUBLE
+VK_FLOOR(avx2)
+#else
+#  define floor_avx2 floor_c
+#  define ceil_avx2  ceil_c
+#endif
+
+#undef VK_ATTR
+#undef VW
+#undef VT
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VDIV
+#undef VEQZ
+#undef VGE
+#undef VSEL
+#undef VMIN
+#undef VMAX
+#undef VSTORE_I
+#undef VLOAD_I
+#undef VSTORE_F
+#undef VLOAD_F
+#undef VTRUNC
+#undef VRINT
+
+static const CS_VECOPS vecops_avx2 = {
+    "avx2",
+    add_vv_avx2, sub_vv_avx2, mul_vv_avx2, div_vv_avx2,
+    add_sv_avx2, sub_sv_avx2, mul_sv_avx2, div_sv_avx2,
+    add_vs_avx2, sub_vs_avx2, mul_vs_avx2, div_vs_avx2,
+    divz_vv_avx2, divz_sv_avx2,
+    trunc_avx2, frac_avx2, round_avx2, floor_avx2, ceil_avx2,
+    quant_avx2, from_int_avx2, from_float_avx2, to_float_avx2
+};
+
+#endif  /* VECOPS_AVX2 */
+
+/* ---------------------------------------------------------------------- */
+/* NEON on AArch64, which has vector division and rounding */
+
+#ifdef VECOPS_NEON
+
+#define VK_ATTR
+#ifdef USE_DOUBLE
+#  define VW    2
+#  define VT    float64x2_t
+#  define VLOAD(p)      vld1q_f64(p)
+#  define VSTORE(p, x)  vst1q_f64(p, x)
+#  define VSET1(x)      vdupq_n_f64(x)
+#  define VADD(x, y)    vaddq_f64(x, y)
+#  define VSUB(x, y)    vsubq_f64(x, y)
+#  define VMUL(x, y)    vmulq_f64(x, y)
+#  define VDIV(x, y)    vdivq_f64(x, y)
+#  define VEQZ(x)       vceqzq_f64(x)
+#  define VGE(x, y)     vcgeq_f64(x, y)
+#  define VSEL(m, x, y) vbslq_f64(m, x, y)
+#  define VTRUNC(x)     vrndq_f64(x)
+#  define VRINT(x)      vrndiq_f64(x)
+#  define VMIN(x, y)    vminq_f64(x, y)
+#  define VMAX(x, y)    vmaxq_f64(x, y)
+#  define VSTORE_I(p, x) vst1_s32(p, vmovn_s64(vcvtnq_s64_f64(x)))
+#  define VLOAD_I(p)    vcvtq_f64_s64(vmovl_s32(vld1_s32(p)))
+#  define VSTORE_F(p, x) vst1_f32(p, vcvt_f32_f64(x))
+#  define VLOAD_F(p)    vcvt_f64_f32(vld1_f32(p))
+#else
+#  define VW    4
+#  define VT    float32x4_t
+#  define VLOAD(p)      vld1q_f32(p)
+#  define VSTORE(p, x)  vst1q_f32(p, x)
+#  define VSET1(x)      vdupq_n_f32(x)
+#  define VADD(x, y)    vaddq_f32(x, y)
+#  define VSUB(x, y)    vsubq_f32(x, y)
+#  define VMUL(x, y)    vmulq_f32(x, y)
+#  define VDIV(x, y)    vdivq_f32(x, y)
+#  define VEQZ(x)       vceqzq_f32(x)
+#  define VGE(x, y)     vcgeq_f32(x, y)
+#  define VSEL(m, x, y) vbslq_f32(m, x, y)
+#  define VTRUNC(x)     vrndq_f32(x)
+#  define VRINT(x)      vrndiq_f32(x)
+#  define VMIN(x, y)    vminq_f32(x, y)
+#  define VMAX(x, y)    vmaxq_f32(x, y)
+#  define VSTORE_I(p, x) vst1q_s32(p, vcvtnq_s32_f32(x))
+#  define VLOAD_I(p)    vcvtq_f32_s32(vld1q_s32(p))
+#  define VSTORE_F(p, x) vst1q_f32(p, x)
+#  define VLOAD_F(p)    vld1q_f32(p)
+#endif
+
+VK_ARITH(neon)
+VK_CONV(neon)
+VK_ROUND(neon)
+#ifdef USE_DOUBLE
+VK_FLOOR(neon)
+#else
+#  define floor_neon floor_c
+#  define ceil_neon  ceil_c
+#endif
+
+#undef VK_ATTR
+#undef VW
+#undef VT
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VDIV
+#undef VEQZ
+#undef VGE
+#undef VSEL
+#undef VMIN
+#undef VMAX
+#undef VSTORE_I
+#undef VLOAD_I
+#undef VSTORE_F
+#undef VLOAD_F
+#undef VTRUNC
+#undef VRINT
+
+static const CS_VECOPS vecops_neon = {
+    "neon",
+    add_vv_neon, sub_vv_neon, mul_vv_neon, div_vv_neon,
+    add_sv_neon, sub_sv_neon, mul_sv_neon, div_sv_neon,
+    add_vs_neon, sub_vs_neon, mul_vs_neon, div_vs_neon,
+    divz_vv_neon, divz_sv_neon,
+    trunc_neon, frac_neon, round_neon, floor_neon, ceil_neon,
+    quant_neon, from_int_neon, from_float_neon, to_float_neon
+};
+
+#endif  /* VECOPS_NEON */
+
+/* ---------------------------------------------------------------------- */
+
+const CS_VECOPS *cs_vecops = NULL;
+
+const CS_VECOPS *cs_vecops_find(const char *name)
+{
+#ifdef VECOPS_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") &&
+        (name == NULL || !strcmp(name, "avx2")))
+      return &vecops_avx2;
+#endif
+#ifdef VECOPS_SSE2
+    if (name == NULL || !strcmp(name, "sse2"))
+      return &vecops_sse2;
+#endif
+#ifdef VECOPS_NEON
+    if (name == NULL || !strcmp(name, "neon"))
+      return &vecops_neon;
+#endif
+    if (name == NULL || !strcmp(name, "c"))
+      return &vecops_c;
+    return NULL;
+}
+
+const CS_VECOPS *cs_vecops_init(void)
+{
+    /* any thread may get here first, but they all store the same value */
+    cs_vecops = cs_vecops_find(NULL);
+    return cs_vecops;
+}
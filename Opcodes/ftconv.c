@@ -22,9 +22,15 @@
 */
 
 #include "stdopcod.h"
+#include "partconv.h"
 #include <math.h>
 
-#define FTCONV_MAXCHN   8
+#define FTCONV_MAXCHN   PARTCONV_MAXCHN
+
+/* IRs longer than (2 * FTCONV_TAIL_RATIO + 1) partitions are split into
+   a head of short partitions, and a tail of partitions this many times
+   longer that is convolved in a worker thread */
+#define FTCONV_TAIL_RATIO   8
 
 typedef struct {
     OPDS    h;
@@ -47,70 +53,10 @@ typedef struct {
     MYFLT   *IR_Data[FTCONV_MAXCHN];    /* impulse responses (scaled)       */
     MYFLT   *outBuffers[FTCONV_MAXCHN]; /* output buffer (size=partSize*2)  */
     AUXCH   auxData;
+    CS_FFT_PLAN *fwdPlan, *invPlan;
+    PARTCONV_TAIL tail;         /* long partitions, nPartitions = 0 if none */
 } FTCONV;
 
-static void multiply_fft_buffers(MYFLT *outBuf, MYFLT *ringBuf,
-                                 MYFLT *IR_Data, int partSize, int nPartitions,
-                                 int ringBuf_startPos)
-{
-    MYFLT   re, im, re1, re2, im1, im2;
-    MYFLT   *rbPtr, *irPtr, *outBufPtr, *outBufEndPm2, *rbEndP;
-
-    /* note: partSize must be at least 2 samples */
-    partSize <<= 1;
-    outBufEndPm2 = (MYFLT*) outBuf + (int) (partSize - 2);
-    rbEndP = (MYFLT*) ringBuf + (int) (partSize * nPartitions);
-    rbPtr = &(ringBuf[ringBuf_startPos]);
-    irPtr = IR_Data;
-    outBufPtr = outBuf;
-    /* clear output buffer to zero */
-    memset(outBuf, 0, sizeof(MYFLT)*(partSize));
-    /* do { */
-    /*   *(outBufPtr++) = FL(0.0); */
-    /*   *(outBufPtr++) = FL(0.0); */
-    /* } while (outBufPtr <= outBufEndPm2); */
-    /* multiply FFTs for each partition, and mix to output buffer */
-    /* note: IRs are stored in reverse partition order */
-    do {
-      /* wrap ring buffer position */
-      if (rbPtr >= rbEndP)
-        rbPtr = ringBuf;
-      outBufPtr = outBuf;
-      *(outBufPtr++) += *(rbPtr++) * *(irPtr++);    /* convolve DC */
-      *(outBufPtr++) += *(rbPtr++) * *(irPtr++);    /* convolve Nyquist */
-      re1 = *(rbPtr++);
-      im1 = *(rbPtr++);
-      re2 = *(irPtr++);
-      im2 = *(irPtr++);
-      re = re1 * re2 - im1 * im2;
-      im = re1 * im2 + re2 * im1;
-      while (outBufPtr < outBufEndPm2) {
-        /* complex multiply */
-        re1 = rbPtr[0];
-        im1 = rbPtr[1];
-        re2 = irPtr[0];
-        im2 = irPtr[1];
-        outBufPtr[0] += re;
-        outBufPtr[1] += im;
-        re = re1 * re2 - im1 * im2;
-        im = re1 * im2 + re2 * im1;
-        re1 = rbPtr[2];
-        im1 = rbPtr[3];
-        re2 = irPtr[2];
-        im2 = irPtr[3];
-        outBufPtr[2] += re;
-        outBufPtr[3] += im;
-        re = re1 * re2 - im1 * im2;
-        im = re1 * im2 + re2 * im1;
-        outBufPtr += 4;
-        rbPtr += 4;
-        irPtr += 4;
-      }
-      outBufPtr[0] += re;
-      outBufPtr[1] += im;
-    } while (--nPartitions);
-}
-
 static inline int buf_bytes_alloc(int nChannels, int partSize, int nPartitions)
 {
     int nSmps;
@@ -144,11 +90,26 @@ static void set_buf_pointers(FTCONV *p,
     }
 }
 
+static int ftconv_deinit(CSOUND *csound, FTCONV *p)
+{
+    return partconv_tail_stop(csound, &(p->tail));
+}
+
+static int ftconv_tail_start(CSOUND *csound, FTCONV *p)
+{
+    if (p->tail.nPartitions < 1 || p->tail.thread != NULL)
+      return OK;
+    if (partconv_tail_start(csound, &(p->tail)) != OK)
+      return OK;            /* convolve the tail in line */
+    return csound->RegisterDeinitCallback(csound, p,
+                                          (int (*)(CSOUND *, void *))
+                                          ftconv_deinit);
+}
+
 static int ftconv_init(CSOUND *csound, FTCONV *p)
 {
     FUNC    *ftp;
-    int     i, j, k, n, nBytes, skipSamples;
-    MYFLT   FFTscale;
+    int     i, j, n, nBytes, skipSamples, irLen, headLen, tailLen;
 
     /* check parameters */
     p->nChannels = (int) p->OUTOCOUNT;
@@ -175,13 +136,22 @@ static int ftconv_init(CSOUND *csound, FTCONV *p)
                                Str("ftconv: invalid length, or insufficient"
                                    " IR data for convolution"));
     }
-    p->nPartitions = (n + (p->partSize - 1)) / p->partSize;
+    irLen = n;
+    /* the tail output for a block is due one block after it was queued,
+       so the head has to cover the first 2 * tailLen - partSize frames */
+    tailLen = p->partSize * FTCONV_TAIL_RATIO;
+    headLen = (tailLen << 1) - p->partSize;
+    if (irLen < headLen + tailLen) {
+      headLen = irLen;
+      tailLen = 0;
+    }
+    p->nPartitions = (headLen + (p->partSize - 1)) / p->partSize;
     /* calculate the amount of aux space to allocate (in bytes) */
     nBytes = buf_bytes_alloc(p->nChannels, p->partSize, p->nPartitions);
     if (nBytes != (int) p->auxData.size)
       csound->AuxAlloc(csound, (int32) nBytes, &(p->auxData));
     else if (p->initDone > 0 && *(p->iSkipInit) != FL(0.0))
-      return OK;    /* skip initialisation if requested */
+      return ftconv_tail_start(csound, p);  /* skip initialisation if requested */
     /* if skipping samples: check for possible truncation of IR */
     if (skipSamples > 0 && (csound->oparms->msglevel & WARNMSG)) {
       n = skipSamples * p->nChannels;
@@ -201,48 +171,38 @@ static int ftconv_init(CSOUND *csound, FTCONV *p)
     /* clear ring buffer to zero */
     n = (p->partSize << 1) * p->nPartitions;
     memset(p->ringBuf, 0, n*sizeof(MYFLT));
-    /* for (i = 0; i < n; i++) */
-    /*   p->ringBuf[i] = FL(0.0); */
     /* initialise buffer index */
     p->cnt = 0;
     p->rbCnt = 0;
+    p->fwdPlan = csound->CreateFFTPlan(csound, (p->partSize << 1), 0);
+    p->invPlan = csound->CreateFFTPlan(csound, (p->partSize << 1),
+                                       CS_FFT_INVERSE);
     /* calculate FFT of impulse response partitions, in reverse order */
-    /* also apply FFT amplitude scale here */
-    FFTscale = csound->GetInverseRealFFTScale(csound, (p->partSize << 1));
-    for (j = 0; j < p->nChannels; j++) {
-      i = (skipSamples * p->nChannels) + j;           /* table read position */
-      n = (p->partSize << 1) * (p->nPartitions - 1);  /* IR write position */
-      do {
-        for (k = 0; k < p->partSize; k++) {
-          if (i >= 0 && i < (int) ftp->flen)
-            p->IR_Data[j][n + k] = ftp->ftable[i] * FFTscale;
-          else
-            p->IR_Data[j][n + k] = FL(0.0);
-          i += p->nChannels;
-        }
-        /* pad second half of IR to zero */
-        for (k = p->partSize; k < (p->partSize << 1); k++)
-          p->IR_Data[j][n + k] = FL(0.0);
-        /* calculate FFT */
-        csound->RealFFT(csound, &(p->IR_Data[j][n]), (p->partSize << 1));
-        n -= (p->partSize << 1);
-      } while (n >= 0);
-    }
+    for (j = 0; j < p->nChannels; j++)
+      partconv_ir_spectra(csound, p->IR_Data[j], ftp->ftable, (int) ftp->flen,
+                          p->nChannels, j, skipSamples,
+                          p->partSize, p->nPartitions);
     /* clear output buffers to zero */
-    /*memset(p->outBuffers, 0, p->nChannels*(p->partSize << 1)*sizeof(MYFLT));*/
-    for (j = 0; j < p->nChannels; j++) {
-      for (i = 0; i < (p->partSize << 1); i++)
-        p->outBuffers[j][i] = FL(0.0);
+    for (j = 0; j < p->nChannels; j++)
+      memset(p->outBuffers[j], 0, (p->partSize << 1) * sizeof(MYFLT));
+    /* long partitions after the head */
+    if (tailLen > 0)
+      partconv_tail_init(csound, &(p->tail), ftp->ftable, (int) ftp->flen,
+                         p->nChannels, skipSamples + headLen, irLen - headLen,
+                         tailLen);
+    else {
+      partconv_tail_stop(csound, &(p->tail));
+      p->tail.nPartitions = 0;
     }
     p->initDone = 1;
 
-    return OK;
+    return ftconv_tail_start(csound, p);
 }
 
 static int ftconv_perf(CSOUND *csound, FTCONV *p)
 {
-    MYFLT         *x, *rBuf;
-    int           i, n, nSamples, rBufPos;
+    MYFLT         *x, *y, *rBuf;
+    int           i, k, n, nSamples, rBufPos;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t nn, nsmps = CS_KSMPS;
@@ -258,21 +218,39 @@ static int ftconv_perf(CSOUND *csound, FTCONV *p)
       for (n = 0; n < p->nChannels; n++)
         memset(&p->aOut[n][nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (nn = offset; nn < nsmps; nn++) {
+    /* a partition boundary at a time; the input is always read before
+       the output at the same position is written, as they may share a
+       buffer */
+    for (nn = offset; nn < nsmps; nn += k) {
+      k = nSamples - p->cnt;
+      if (k > (int) (nsmps - nn))
+        k = (int) (nsmps - nn);
       /* store input signal in buffer */
-      rBuf[p->cnt] = p->aIn[nn];
-      /* copy output signals from buffer */
-      for (n = 0; n < p->nChannels; n++)
-        p->aOut[n][nn] = p->outBuffers[n][p->cnt];
+      memcpy(&rBuf[p->cnt], &p->aIn[nn], k * sizeof(MYFLT));
+      /* copy output signals from buffer, adding the tail if there is one */
+      if (p->tail.nPartitions) {
+        partconv_tail_process(&(p->tail), &p->aIn[nn], p->aOut, (int) nn, k);
+        for (n = 0; n < p->nChannels; n++) {
+          x = &(p->outBuffers[n][p->cnt]);
+          y = &(p->aOut[n][nn]);
+          for (i = 0; i < k; i++)
+            y[i] += x[i];
+        }
+      }
+      else {
+        for (n = 0; n < p->nChannels; n++)
+          memcpy(&(p->aOut[n][nn]), &(p->outBuffers[n][p->cnt]),
+                 k * sizeof(MYFLT));
+      }
       /* is input buffer full ? */
-      if (++p->cnt < nSamples)
+      if ((p->cnt += k) < nSamples)
         continue;                   /* no, continue with next sample */
       /* reset buffer position */
       p->cnt = 0;
       /* calculate FFT of input */
       for (i = nSamples; i < (nSamples << 1); i++)
         rBuf[i] = FL(0.0);          /* pad to double length */
-      csound->RealFFT(csound, rBuf, (nSamples << 1));
+      csound->ExecuteFFTPlan(csound, p->fwdPlan, rBuf);
       /* update ring buffer position */
       p->rbCnt++;
       if (p->rbCnt >= p->nPartitions)
@@ -282,10 +260,10 @@ static int ftconv_perf(CSOUND *csound, FTCONV *p)
       /* for each channel: */
       for (n = 0; n < p->nChannels; n++) {
         /* multiply complex arrays */
-        multiply_fft_buffers(p->tmpBuf, p->ringBuf, p->IR_Data[n],
-                             nSamples, p->nPartitions, rBufPos);
+        partconv_multiply(p->tmpBuf, p->ringBuf, p->IR_Data[n],
+                          nSamples, p->nPartitions, rBufPos);
         /* inverse FFT */
-        csound->InverseRealFFT(csound, p->tmpBuf, (nSamples << 1));
+        csound->ExecuteFFTPlan(csound, p->invPlan, p->tmpBuf);
         /* copy to output buffer, overlap with "tail" of previous block */
         x = &(p->outBuffers[n][0]);
         for (i = 0; i < nSamples; i++) {
@@ -268,13 +268,16 @@ static int ftload_(CSOUND *csound, FTLOAD *p, int istring)
 
         memset(&header, 0, sizeof(FUNC));
         /* ***** Need to do byte order here ***** */
-        n = fread(&header, sizeof(FUNC) - sizeof(MYFLT) - SSTRSIZ, 1, file);
+        n = fread(&header,
+                  sizeof(FUNC) - sizeof(MYFLT) - sizeof(MYFLT**) - SSTRSIZ,
+                  1, file);
         if (UNLIKELY(n!=1)) goto err4;
         header.fno = (int32) fno;
         if (UNLIKELY(csound->FTAlloc(csound, fno, (int) header.flen) != 0))
           goto err;
         ftp = ft_func(csound, &fno_f);
-        memcpy(ftp, &header, sizeof(FUNC) - sizeof(MYFLT*) - SSTRSIZ);
+        memcpy(ftp, &header,
+               sizeof(FUNC) - sizeof(MYFLT*) - sizeof(MYFLT**) - SSTRSIZ);
         memset(ftp->ftable, 0, sizeof(MYFLT) * (ftp->flen + 1));
         n = fread(ftp->ftable, sizeof(MYFLT), ftp->flen + 1l, file);
         if (UNLIKELY(n!=ftp->flen + 1)) goto err4;
@@ -375,7 +378,7 @@ static int ftload_(CSOUND *csound, FTLOAD *p, int istring)
         if (UNLIKELY(csound->FTAlloc(csound, fno, (int) header.flen) != 0))
           goto err;
         ftp = ft_func(csound, &fno_f);
-        memcpy(ftp, &header, sizeof(FUNC) - sizeof(MYFLT));
+        memcpy(ftp, &header, sizeof(FUNC) - sizeof(MYFLT) - sizeof(MYFLT**));
         memset(ftp->ftable, 0, sizeof(MYFLT) * (ftp->flen + 1));
         for (j = 0; j <= ftp->flen; j++) {
           if (UNLIKELY(NULL==fgets(s, 64, file))) goto err4;
@@ -470,7 +473,9 @@ static int ftsave_(CSOUND *csound, FTLOAD *p, int istring)
           MYFLT *table = ftp->ftable;
           int32 flen = ftp->flen;
           int n;
-          n = fwrite(ftp, sizeof(FUNC) - sizeof(MYFLT) - SSTRSIZ, 1, file);
+          n = fwrite(ftp,
+                     sizeof(FUNC) - sizeof(MYFLT) - sizeof(MYFLT**) - SSTRSIZ,
+                     1, file);
           if (UNLIKELY(n!=1)) goto err4;
           n = fwrite(table, sizeof(MYFLT), flen + 1, file);
           if (UNLIKELY(n!=flen + 1)) goto err4;
@@ -0,0 +1,304 @@
+/*
+    partconv.c:
+
+    Copyright (C) 2026 The Csound developers
+
+    partconv_multiply() and partconv_ir_spectra() come from ftconv.c,
+    Copyright (C) 2005 Istvan Varga.
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+#include "partconv.h"
+
+void partconv_multiply(MYFLT *outBuf, MYFLT *ringBuf, MYFLT *IR_Data,
+                       int partSize, int nPartitions, int ringBuf_startPos)
+{
+    MYFLT   re, im, re1, re2, im1, im2;
+    MYFLT   *rbPtr, *irPtr, *outBufPtr, *outBufEndPm2, *rbEndP;
+
+    /* note: partSize must be at least 2 samples */
+    partSize <<= 1;
+    outBufEndPm2 = (MYFLT*) outBuf + (int) (partSize - 2);
+    rbEndP = (MYFLT*) ringBuf + (int) (partSize * nPartitions);
+    rbPtr = &(ringBuf[ringBuf_startPos]);
+    irPtr = IR_Data;
+    outBufPtr = outBuf;
+    /* clear output buffer to zero */
+    memset(outBuf, 0, sizeof(MYFLT)*(partSize));
+    /* multiply FFTs for each partition, and mix to output buffer */
+    /* note: IRs are stored in reverse partition order */
+    do {
+      /* wrap ring buffer position */
+      if (rbPtr >= rbEndP)
+        rbPtr = ringBuf;
+      outBufPtr = outBuf;
+      *(outBufPtr++) += *(rbPtr++) * *(irPtr++);    /* convolve DC */
+      *(outBufPtr++) += *(rbPtr++) * *(irPtr++);    /* convolve Nyquist */
+      re1 = *(rbPtr++);
+      im1 = *(rbPtr++);
+      re2 = *(irPtr++);
+      im2 = *(irPtr++);
+      re = re1 * re2 - im1 * im2;
+      im = re1 * im2 + re2 * im1;
+      while (outBufPtr < outBufEndPm2) {
+        /* complex multiply */
+        re1 = rbPtr[0];
+        im1 = rbPtr[1];
+        re2 = irPtr[0];
+        im2 = irPtr[1];
+        outBufPtr[0] += re;
+        outBufPtr[1] += im;
+        re = re1 * re2 - im1 * im2;
+        im = re1 * im2 + re2 * im1;
+        re1 = rbPtr[2];
+        im1 = rbPtr[3];
+        re2 = irPtr[2];
+        im2 = irPtr[3];
+        outBufPtr[2] += re;
+        outBufPtr[3] += im;
+        re = re1 * re2 - im1 * im2;
+        im = re1 * im2 + re2 * im1;
+        outBufPtr += 4;
+        rbPtr += 4;
+        irPtr += 4;
+      }
+      outBufPtr[0] += re;
+      outBufPtr[1] += im;
+    } while (--nPartitions);
+}
+
+void partconv_ir_spectra(CSOUND *csound, MYFLT *IR_Data, const MYFLT *ftable,
+                         int flen, int nChannels, int chn, int startFrame,
+                         int partSize, int nPartitions)
+{
+    CS_FFT_PLAN *plan;
+    MYFLT   FFTscale;
+    int     i, k, n;
+
+    plan = csound->CreateFFTPlan(csound, (partSize << 1), 0);
+    /* also apply FFT amplitude scale here */
+    FFTscale = csound->GetInverseRealFFTScale(csound, (partSize << 1));
+    i = (startFrame * nChannels) + chn;           /* table read position */
+    n = (partSize << 1) * (nPartitions - 1);      /* IR write position */
+    do {
+      for (k = 0; k < partSize; k++) {
+        if (i >= 0 && i < flen)
+          IR_Data[n + k] = ftable[i] * FFTscale;
+        else
+          IR_Data[n + k] = FL(0.0);
+        i += nChannels;
+      }
+      /* pad second half of IR to zero */
+      memset(&IR_Data[n + partSize], 0, partSize * sizeof(MYFLT));
+      /* calculate FFT */
+      csound->ExecuteFFTPlan(csound, plan, &IR_Data[n]);
+      n -= (partSize << 1);
+    } while (n >= 0);
+}
+
+/* convolve the last complete tail block; runs in the worker thread */
+
+static void partconv_tail_block(PARTCONV_TAIL *t)
+{
+    CSOUND  *csound = t->csound;
+    MYFLT   *rBuf, *x, *ov;
+    int     i, n, L = t->blockSize, rBufPos;
+
+    rBuf = &(t->ringBuf[t->rbCnt * (L << 1)]);
+    memcpy(rBuf, t->jobBuf, L * sizeof(MYFLT));
+    memset(&rBuf[L], 0, L * sizeof(MYFLT));     /* pad to double length */
+    csound->ExecuteFFTPlan(csound, t->fwdPlan, rBuf);
+    if (++t->rbCnt >= t->nPartitions)
+      t->rbCnt = 0;
+    rBufPos = t->rbCnt * (L << 1);
+    for (n = 0; n < t->nChannels; n++) {
+      partconv_multiply(t->tmpBuf, t->ringBuf, t->IR_Data[n],
+                        L, t->nPartitions, rBufPos);
+      csound->ExecuteFFTPlan(csound, t->invPlan, t->tmpBuf);
+      /* overlap with the tail of the previous block */
+      x = t->outBuffers[t->wr][n];
+      ov = t->overlap[n];
+      for (i = 0; i < L; i++) {
+        x[i] = t->tmpBuf[i] + ov[i];
+        ov[i] = t->tmpBuf[i + L];
+      }
+    }
+}
+
+static uintptr_t partconv_tail_thread(void *userData)
+{
+    PARTCONV_TAIL *t = (PARTCONV_TAIL*) userData;
+    CSOUND  *csound = t->csound;
+
+    for (;;) {
+      csound->WaitThreadLockNoTimeout(t->start);
+      if (!t->running)
+        break;
+      partconv_tail_block(t);
+      csound->NotifyThreadLock(t->done);
+    }
+    return (uintptr_t) 0;
+}
+
+/* a tail block is complete: collect the previous one, which is due now,
+   and pass this one on */
+
+static void partconv_tail_submit(PARTCONV_TAIL *t)
+{
+    CSOUND  *csound = t->csound;
+    MYFLT   *tmp;
+
+    if (t->thread != NULL) {
+      if (csound->WaitThreadLock(t->done, 0) != 0) {
+        t->misses++;
+        csound->WaitThreadLockNoTimeout(t->done);
+      }
+    }
+    t->rd = t->wr;
+    t->wr ^= 1;
+    tmp = t->jobBuf;
+    t->jobBuf = t->inBuf;
+    t->inBuf = tmp;
+    if (t->thread != NULL)
+      csound->NotifyThreadLock(t->start);
+    else
+      partconv_tail_block(t);
+}
+
+int partconv_tail_init(CSOUND *csound, PARTCONV_TAIL *t, const MYFLT *ftable,
+                       int flen, int nChannels, int startFrame, int nFrames,
+                       int blockSize)
+{
+    MYFLT   *ptr;
+    int     i, j, nPartitions, nSmps;
+
+    partconv_tail_stop(csound, t);
+    nPartitions = (nFrames + (blockSize - 1)) / blockSize;
+    nSmps = (blockSize << 1) * (nPartitions + 2);           /* in/job/tmp */
+    nSmps += (blockSize << 1) * nChannels * nPartitions;    /* IR_Data    */
+    nSmps += blockSize * nChannels * 3;                     /* overlap/out */
+    if ((int) t->auxData.size != nSmps * (int) sizeof(MYFLT))
+      csound->AuxAlloc(csound, (int32) nSmps * sizeof(MYFLT), &(t->auxData));
+    else
+      memset(t->auxData.auxp, 0, t->auxData.size);
+    t->csound = csound;
+    t->nChannels = nChannels;
+    t->blockSize = blockSize;
+    t->nPartitions = nPartitions;
+    t->cnt = t->rbCnt = 0;
+    t->rd = t->wr = 0;
+    t->misses = 0;
+    t->fwdPlan = csound->CreateFFTPlan(csound, (blockSize << 1), 0);
+    t->invPlan = csound->CreateFFTPlan(csound, (blockSize << 1),
+                                       CS_FFT_INVERSE);
+    ptr = (MYFLT*) t->auxData.auxp;
+    t->inBuf = ptr;         ptr += blockSize;
+    t->jobBuf = ptr;        ptr += blockSize;
+    t->tmpBuf = ptr;        ptr += (blockSize << 1);
+    t->ringBuf = ptr;       ptr += (blockSize << 1) * nPartitions;
+    for (i = 0; i < nChannels; i++) {
+      t->IR_Data[i] = ptr;
+      ptr += (blockSize << 1) * nPartitions;
+      t->overlap[i] = ptr;
+      ptr += blockSize;
+      for (j = 0; j < 2; j++) {
+        t->outBuffers[j][i] = ptr;
+        ptr += blockSize;
+      }
+      partconv_ir_spectra(csound, t->IR_Data[i], ftable, flen, nChannels, i,
+                          startFrame, blockSize, nPartitions);
+    }
+    return OK;
+}
+
+/* Start the worker.  It only uses the FFT plans made by
+   partconv_tail_init(), which are not modified after creation.  If
+   no thread can be created the tail is convolved in line.               */
+
+int partconv_tail_start(CSOUND *csound, PARTCONV_TAIL *t)
+{
+    if (t->thread != NULL || t->nPartitions < 1)
+      return OK;
+    t->start = csound->CreateThreadLock();
+    t->done = csound->CreateThreadLock();
+    if (UNLIKELY(t->start == NULL || t->done == NULL))
+      goto err1;
+    csound->WaitThreadLock(t->start, 0);    /* no block pending yet */
+    t->running = 1;
+    t->thread = csound->CreateThread(partconv_tail_thread, (void*) t);
+    if (UNLIKELY(t->thread == NULL))
+      goto err1;
+    return OK;
+ err1:
+    t->running = 0;
+    if (t->start != NULL)
+      csound->DestroyThreadLock(t->start);
+    if (t->done != NULL)
+      csound->DestroyThreadLock(t->done);
+    t->start = t->done = NULL;
+    return NOTOK;
+}
+
+int partconv_tail_stop(CSOUND *csound, PARTCONV_TAIL *t)
+{
+    if (t->thread == NULL)
+      return OK;
+    /* let a pending block finish */
+    csound->WaitThreadLockNoTimeout(t->done);
+    t->running = 0;
+    csound->NotifyThreadLock(t->start);
+    csound->JoinThread(t->thread);
+    t->thread = NULL;
+    csound->DestroyThreadLock(t->start);
+    csound->DestroyThreadLock(t->done);
+    t->start = t->done = NULL;
+    /* offline the audio thread simply runs ahead of the worker */
+    if (t->misses && csound->oparms->realtime)
+      csound->Warning(csound, Str("convolution tail missed its deadline "
+                                  "%u times\n"), (unsigned int) t->misses);
+    return OK;
+}
+
+void partconv_tail_process(PARTCONV_TAIL *t, MYFLT *in, MYFLT **out,
+                           int offset, int n)
+{
+    MYFLT   *x, *y;
+    int     i, j, k;
+
+    while (n > 0) {
+      k = t->blockSize - t->cnt;
+      if (k > n)
+        k = n;
+      memcpy(&(t->inBuf[t->cnt]), in, k * sizeof(MYFLT));
+      for (j = 0; j < t->nChannels; j++) {
+        x = &(t->outBuffers[t->rd][j][t->cnt]);
+        y = &(out[j][offset]);
+        for (i = 0; i < k; i++)
+          y[i] = x[i];
+      }
+      in += k;
+      offset += k;
+      n -= k;
+      t->cnt += k;
+      if (t->cnt >= t->blockSize) {
+        t->cnt = 0;
+        partconv_tail_submit(t);
+      }
+    }
+}
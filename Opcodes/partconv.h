@@ -0,0 +1,88 @@
+/*
+    partconv.h:
+
+    Copyright (C) 2026 The Csound developers
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+/* Partitioned FFT convolution shared by the convolution opcodes.
+
+   An impulse response is split into a "head" of short partitions that
+   the opcode convolves in the audio thread, and a "tail" of long
+   partitions handled here.  A tail block of blockSize input frames is
+   handed to a worker thread when it is complete, and its result is not
+   needed until one block later, so the cost of the long partitions no
+   longer lands on a single k-cycle.  For an opcode with head partition
+   length N, the tail must start at IR frame (2 * blockSize - N) to keep
+   the output identical to a uniformly partitioned convolution with the
+   same N.                                                               */
+
+#ifndef CSOUND_PARTCONV_H
+#define CSOUND_PARTCONV_H
+
+#include "csoundCore.h"
+
+#define PARTCONV_MAXCHN 8
+
+typedef struct {
+    CSOUND  *csound;
+    int     nChannels;
+    int     blockSize;          /* tail partition length in sample frames   */
+    int     nPartitions;        /* number of tail partitions, 0 if unused   */
+    int     cnt;                /* input position, 0 to blockSize - 1       */
+    int     rbCnt;              /* ring buffer index (worker only)          */
+    int     rd, wr;             /* output buffers being read / written      */
+    uint32_t misses;            /* blocks not finished by their deadline    */
+    MYFLT   *inBuf;             /* input collected by the audio thread      */
+    MYFLT   *jobBuf;            /* complete block handed to the worker      */
+    MYFLT   *tmpBuf;            /* temporary buffer for accumulating FFTs   */
+    MYFLT   *ringBuf;           /* ring buffer of FFTs of input blocks      */
+    MYFLT   *IR_Data[PARTCONV_MAXCHN];      /* tail partitions (scaled)     */
+    MYFLT   *overlap[PARTCONV_MAXCHN];      /* second half of last IFFT     */
+    MYFLT   *outBuffers[2][PARTCONV_MAXCHN];
+    CS_FFT_PLAN *fwdPlan, *invPlan;
+    void    *thread;            /* worker, NULL to process in line          */
+    void    *start, *done;      /* thread locks used as semaphores          */
+    volatile int running;
+    AUXCH   auxData;
+} PARTCONV_TAIL;
+
+/* multiply the FFTs of nPartitions input blocks in a ring buffer with
+   the IR partitions (stored in reverse order) and sum them to outBuf */
+void partconv_multiply(MYFLT *outBuf, MYFLT *ringBuf, MYFLT *IR_Data,
+                       int partSize, int nPartitions, int ringBuf_startPos);
+
+/* FFT of nPartitions IR partitions of channel chn of an interleaved
+   table, starting at sample frame startFrame, in reverse order */
+void partconv_ir_spectra(CSOUND *csound, MYFLT *IR_Data, const MYFLT *ftable,
+                         int flen, int nChannels, int chn, int startFrame,
+                         int partSize, int nPartitions);
+
+int  partconv_tail_init(CSOUND *csound, PARTCONV_TAIL *t, const MYFLT *ftable,
+                        int flen, int nChannels, int startFrame, int nFrames,
+                        int blockSize);
+int  partconv_tail_start(CSOUND *csound, PARTCONV_TAIL *t);
+int  partconv_tail_stop(CSOUND *csound, PARTCONV_TAIL *t);
+
+/* replace out[chn][offset] to out[chn][offset + n - 1] with the tail
+   output; in[] is read before out[] is written, so they may alias */
+void partconv_tail_process(PARTCONV_TAIL *t, MYFLT *in, MYFLT **out,
+                           int offset, int n);
+
+#endif  /* CSOUND_PARTCONV_H */
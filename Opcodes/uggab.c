@@ -238,9 +238,44 @@ static int posc_set(CSOUND *csound, POSC *p)
     p->tablen     = ftp->flen;
     p->tablenUPsr = p->tablen * csound->onedsr;
     p->phs        = *p->iphs * p->tablen;
+    p->bl         = 0;
+    if (*p->ibl != FL(0.0)) {
+      csound->GetBandLimitedTable(csound, ftp, FL(0.0));
+      if (ftp->bltables != NULL)
+        p->bl = 1;
+      else
+        csound->Warning(csound, Str("poscil: table %d cannot be band-limited"),
+                        (int) ftp->fno);
+    }
     return OK;
 }
 
+/* table to read in a k-cycle: with ibl set, the copy that is band-limited
+   for an increment of si table samples per sample */
+
+static inline MYFLT *posc_table(CSOUND *csound, POSC *p, double si)
+{
+    if (LIKELY(!p->bl))
+      return p->ftp->ftable;
+    return csound->GetBandLimitedTable(csound, p->ftp, (MYFLT) si);
+}
+
+static MYFLT *posc_table_a(CSOUND *csound, POSC *p)
+{
+    MYFLT   *freq = p->freq, ff, mx = FL(0.0);
+    uint32_t n, nsmps = CS_KSMPS;
+
+    if (LIKELY(!p->bl))
+      return p->ftp->ftable;
+    for (n = p->h.insdshead->ksmps_offset; n < nsmps; n++) {
+      ff = FABS(freq[n]);
+      if (ff > mx)
+        mx = ff;
+    }
+    return csound->GetBandLimitedTable(csound, p->ftp,
+                                       (MYFLT) (mx * p->tablenUPsr));
+}
+
 static int posckk(CSOUND *csound, POSC *p)
 {
     FUNC        *ftp = p->ftp;
@@ -256,7 +291,7 @@ static int posckk(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, p->h.insdshead,
                                Str("poscil: not initialised"));
-    ft = p->ftp->ftable;
+    ft = posc_table(csound, p, si);
     if (UNLIKELY(early)) nsmps -= early;
     for (n=offset; n<nsmps; n++) {
       curr_samp = ft + (int32)phs;
@@ -287,7 +322,7 @@ static int poscaa(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, p->h.insdshead,
                                Str("poscil: not initialised"));
-    ft = p->ftp->ftable;
+    ft = posc_table_a(csound, p);
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
@@ -324,7 +359,7 @@ static int poscka(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, p->h.insdshead,
                                Str("poscil: not initialised"));
-    ft = p->ftp->ftable;
+    ft = posc_table_a(csound, p);
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
@@ -361,7 +396,7 @@ static int poscak(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, p->h.insdshead,
                                Str("poscil: not initialised"));
-    ft = p->ftp->ftable;
+    ft = posc_table(csound, p, si);
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
@@ -386,7 +421,7 @@ static int kposc(CSOUND *csound, POSC *p)
 {
     double      phs = p->phs;
     double      si = *p->freq * p->tablen * CS_ONEDKR;
-    MYFLT       *curr_samp = p->ftp->ftable + (int32)phs;
+    MYFLT       *curr_samp = posc_table(csound, p, si) + (int32)phs;
     MYFLT       fract = (MYFLT)(phs - (double)((int32)phs));
 
     *p->out = *p->amp * (*curr_samp +(*(curr_samp+1)-*curr_samp)*fract);
@@ -416,7 +451,7 @@ static int posc3kk(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, p->h.insdshead,
                                Str("poscil3: not initialised"));
-    ftab = p->ftp->ftable;
+    ftab = posc_table(csound, p, si);
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
@@ -471,7 +506,7 @@ static int posc3ak(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, p->h.insdshead,
                                Str("poscil3: not initialised"));
-    ftab = p->ftp->ftable;
+    ftab = posc_table(csound, p, si);
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
@@ -527,7 +562,7 @@ static int posc3ka(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, p->h.insdshead,
                                Str("poscil3: not initialised"));
-    ftab = p->ftp->ftable;
+    ftab = posc_table_a(csound, p);
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
@@ -584,7 +619,7 @@ static int posc3aa(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, p->h.insdshead,
                                Str("poscil3: not initialised"));
-    ftab = p->ftp->ftable;
+    ftab = posc_table_a(csound, p);
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
@@ -627,7 +662,7 @@ static int kposc3(CSOUND *csound, POSC *p)
 {
     double      phs   = p->phs;
     double      si    = *p->freq * p->tablen * CS_ONEDKR;
-    MYFLT       *ftab = p->ftp->ftable;
+    MYFLT       *ftab = posc_table(csound, p, si);
     int         x0    = (int32)phs;
     MYFLT       fract = (MYFLT)(phs - (double)x0);
     MYFLT       y0, y1, ym1, y2;
@@ -2069,20 +2104,20 @@ static OENTRY localops[] = {
 { "duserrnd.a", S(DURAND),0,4, "a", "k",
                                 (SUBR)Cuserrnd_set,NULL,(SUBR)aDiscreteUserRand },
 { "poscil", 0xfffe, TR                                                          },
-{ "poscil.a", S(POSC), 0,5, "a", "kkjo", (SUBR)posc_set,(SUBR)NULL,(SUBR)posckk },
-{ "poscil.kk", S(POSC), 0,3, "k", "kkjo", (SUBR)posc_set,(SUBR)kposc,NULL },
-{ "poscil.ka", S(POSC), 0,5, "a", "kajo", (SUBR)posc_set, NULL,  (SUBR)poscka },
-{ "poscil.ak", S(POSC), 0,5, "a", "akjo", (SUBR)posc_set, NULL,  (SUBR)poscak },
-{ "poscil.aa", S(POSC), 0,5, "a", "aajo", (SUBR)posc_set, NULL,  (SUBR)poscaa },
+{ "poscil.a", S(POSC), 0,5, "a", "kkjoo", (SUBR)posc_set,(SUBR)NULL,(SUBR)posckk },
+{ "poscil.kk", S(POSC), 0,3, "k", "kkjoo", (SUBR)posc_set,(SUBR)kposc,NULL },
+{ "poscil.ka", S(POSC), 0,5, "a", "kajoo", (SUBR)posc_set, NULL,  (SUBR)poscka },
+{ "poscil.ak", S(POSC), 0,5, "a", "akjoo", (SUBR)posc_set, NULL,  (SUBR)poscak },
+{ "poscil.aa", S(POSC), 0,5, "a", "aajoo", (SUBR)posc_set, NULL,  (SUBR)poscaa },
 { "lposcil",  S(LPOSC), TR, 5, "a", "kkkkjo", (SUBR)lposc_set, NULL, (SUBR)lposc},
 { "poscil3", 0xfffe, TR                                                          },
-{ "poscil3.a",S(POSC), 0,5, "a", "kkjo",
+{ "poscil3.a",S(POSC), 0,5, "a", "kkjoo",
                                      (SUBR)posc_set,(SUBR)NULL,(SUBR)posc3kk },
-{ "poscil3.kk",S(POSC), 0,7, "k", "kkjo",
+{ "poscil3.kk",S(POSC), 0,7, "k", "kkjoo",
                                      (SUBR)posc_set,(SUBR)kposc3,NULL},
-{ "poscil3.ak", S(POSC), 0,5, "a", "akjo", (SUBR)posc_set, NULL, (SUBR)posc3ak },
-{ "poscil3.ka", S(POSC), 0,5, "a", "kajo", (SUBR)posc_set, NULL, (SUBR)posc3ka },
-{ "poscil3.aa", S(POSC), 0,5, "a", "aajo", (SUBR)posc_set, NULL, (SUBR)posc3aa },
+{ "poscil3.ak", S(POSC), 0,5, "a", "akjoo", (SUBR)posc_set, NULL, (SUBR)posc3ak },
+{ "poscil3.ka", S(POSC), 0,5, "a", "kajoo", (SUBR)posc_set, NULL, (SUBR)posc3ka },
+{ "poscil3.aa", S(POSC), 0,5, "a", "aajoo", (SUBR)posc_set, NULL, (SUBR)posc3aa },
 { "lposcil3", S(LPOSC), TR, 5, "a", "kkkkjo", (SUBR)lposc_set, NULL,(SUBR)lposc3},
 { "trigger",  S(TRIG),  0,3, "k", "kkk",  (SUBR)trig_set, (SUBR)trig,   NULL  },
 { "sum",      S(SUM),   0,4, "a", "y",    NULL, NULL, (SUBR)sum               },
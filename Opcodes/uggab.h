@@ -46,9 +46,10 @@ typedef struct {
 
 typedef struct  {
     OPDS        h;
-    MYFLT       *out, *amp, *freq, *ift, *iphs;
+    MYFLT       *out, *amp, *freq, *ift, *iphs, *ibl;
     FUNC        *ftp;
     int32        tablen;
+    int         bl;             /* read band-limited copies of the table */
     double      tablenUPsr;
     double      phs;
 } POSC;
@@ -196,6 +196,7 @@ static const char *longUsageList[] = {
   Str_noop("--dither\t\tDither output"),
   Str_noop("--dither-triangular\t\tDither output with triangular distribution"),
   Str_noop("--dither-uniform\t\tDither output with rectanular distribution"),
+  Str_noop("--dither-shaped\t\tDither output with noise shaping"),
   Str_noop("--sched\t\t\tSet real-time scheduling priority and lock memory"),
   Str_noop("--sched=N\t\tSet priority to N and lock memory"),
   Str_noop("--opcode-lib=NAMES\tDynamic libraries to load"),
@@ -217,6 +218,8 @@ static const char *longUsageList[] = {
   Str_noop("--no-default-paths\tTurn off relative paths from CSD/ORC/SCO"),
   Str_noop("--sample-accurate\t\tUse sample-accurate timing of score events"),
   Str_noop("--realtime\t\trealtime priority mode"),
+  Str_noop("--init-deadline=N\tin realtime mode, wait for an init pass"),
+  Str_noop("\t\t\tthat is not done after N k-cycles"),
   Str_noop("--nchnls=N\t\t override number of audio channels"),
   Str_noop("--nchnls_i=N\t\t override number of input audio channels"),
   Str_noop("--0dbfs=N\t\t override 0dbfs (max positive signal amplitude)"),
@@ -824,6 +827,10 @@ static int decode_long(CSOUND *csound, char *s, int argc, char **argv)
       csound->dither_output = 1;
       return 1;
     }
+    else if (!(strcmp (s, "dither-shaped"))) {
+      csound->dither_output = 3;
+      return 1;
+    }
     else if (!(strncmp (s, "midi-key=", 9))) {
       s += 9;
       O->midiKey = atoi(s);
@@ -906,6 +913,11 @@ static int decode_long(CSOUND *csound, char *s, int argc, char **argv)
       O->realtime = 1;
       return 1;
     }
+    else if (!(strncmp(s, "init-deadline=", 14))) {
+      s += 14;
+      O->initDeadline = atoi(s);
+      return 1;
+    }
     else if (!(strncmp(s, "nchnls=", 7))) {
       s += 7;
       O->nchnls_override = atoi(s);
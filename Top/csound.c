@@ -55,6 +55,7 @@
 #include "namedins.h"
 #include "pvfileio.h"
 #include "fftlib.h"
+#include "sampconv.h"
 #include "cs_par_base.h"
 #include "cs_par_orc_semantics.h"
 #include "cs_par_dispatch.h"
@@ -85,6 +86,14 @@ static int  defaultCsoundYield(CSOUND *);
 static int  csoundDoCallback_(CSOUND *, void *, unsigned int);
 static void reset(CSOUND *);
 static int  csoundPerformKsmpsInternal(CSOUND *csound);
+static void csoundSetAudioTransfer(CSOUND *csound,
+                                   void (*spinrecv)(CSOUND *),
+                                   void (*spoutran)(CSOUND *));
+static CS_NORETURN void csoundHandOverPerformance(CSOUND *csound,
+                                                  int (*wait)(CSOUND *, void *),
+                                                  void *userData);
+static int  csoundPerformKsmpsBatch(CSOUND *csound, int ncycles, int *done);
+static int  perf_handed_over(CSOUND *csound);
 static void csoundTableSetInternal(CSOUND *csound, int table, int index,
                                    MYFLT value);
 static INSTRTXT **csoundGetInstrumentList(CSOUND *csound);
@@ -106,17 +115,13 @@ void csoundDebuggerBreakpointReached(CSOUND *csound);
 extern OENTRY opcodlst_1[];
 
 static void free_opcode_table(CSOUND* csound) {
-    int i;
-    CS_HASH_TABLE_ITEM* bucket;
-    CONS_CELL* head;
-
-    for (i = 0; i < HASH_SIZE; i++) {
-        bucket = csound->opcodes->buckets[i];
+    unsigned int i;
+    CS_HASH_TABLE_ITEM* item;
 
-        while(bucket != NULL) {
-            head = bucket->value;
-            cs_cons_free(csound, head);
-            bucket = bucket->next;
+    for (i = 0; i < csound->opcodes->size; i++) {
+        item = &csound->opcodes->items[i];
+        if (item->key != NULL) {
+            cs_cons_free(csound, item->value);
         }
     }
 
@@ -441,12 +446,31 @@ static const CSOUND cenviron_ = {
     csoundSetScoreOffsetSeconds,
     csoundRewindScore,
     csoundInputMessageInternal,
+    csoundReserveCircularBufferWrite,
+    csoundCommitCircularBufferWrite,
+    csoundReserveCircularBufferRead,
+    csoundCommitCircularBufferRead,
+    csoundCreateFFTPlan,
+    csoundExecuteFFTPlan,
+    csoundExecuteFFTPlanBatch,
+    csoundGetBandLimitedTable,
+    csoundSetAudioTransfer,
+    csoundGetSpin,
+    csoundGetSpout,
+    csoundHandOverPerformance,
+    csoundPerformKsmpsBatch,
+    csoundPushMidiInput,
+    cs_sampconv_create,
+    cs_sampconv_destroy,
+    cs_sampconv_size,
+    cs_sampconv_out,
+    cs_sampconv_in,
+    cs_deinterleave,
+    cs_interleave,
     {
       NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
       NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-      NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-      NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-      NULL, NULL, NULL,
+      NULL, NULL
     },
     /* ------- private data (not to be used by hosts or externals) ------- */
     /* callback function pointers */
@@ -607,6 +631,8 @@ static const CSOUND cenviron_ = {
     0, 0,           /*  rngflg, multichan   */
     NULL,           /*  evtFuncChain        */
     NULL,           /*  OrcTrigEvts         */
+    0, 0,           /*  OrcTrigEvtsCnt, OrcTrigEvtsMax */
+    0,              /*  OrcTrigEvtsSeq      */
     NULL,           /*  freeEvtNodes        */
     1,              /*  csoundIsScorePending_ */
     0,              /*  advanceCnt          */
@@ -626,6 +652,7 @@ static const CSOUND cenviron_ = {
     0,              /*  cyclesRemaining     */
     { 0, NULL, NULL, '\0', 0, FL(0.0), FL(0.0), { FL(0.0) }, {NULL}},   /*  evt */
     NULL,           /*  memalloc_db         */
+    NULL,           /*  memalloc_pool       */
     (MGLOBAL*) NULL, /* midiGlobals         */
     NULL,           /*  envVarDB            */
     (MEMFIL*) NULL, /*  memfiles            */
@@ -633,6 +660,8 @@ static const CSOUND cenviron_ = {
     0,              /*  FFT_max_size        */
     NULL,           /*  FFT_table_1         */
     NULL,           /*  FFT_table_2         */
+    NULL,           /*  FFT_plans           */
+    0,              /*  FFT_lock            */
     NULL, NULL, NULL, /* tseg, tpsave, tplim */
     0, 0, 0, 0, 0, 0, /*  acount, kcount, icount, Bcount, bcount, tcount */
     (MYFLT*) NULL,  /*  gbloffbas           */
@@ -651,6 +680,7 @@ static const CSOUND cenviron_ = {
 #endif
     0,              /* init pass loop  */
     NULL,           /* init pass threadlock */
+    NULL,           /* init pass queue */
     NULL,           /* API_lock */
 #if defined(HAVE_PTHREAD_SPIN_LOCK)
     PTHREAD_SPINLOCK_INITIALIZER,              /*  spoutlock           */
@@ -774,10 +804,13 @@ static const CSOUND cenviron_ = {
     0,              /*  currentLPCSlot      */
     0,              /*  max_lpc_slot        */
     NULL,           /*  chn_db              */
+    0,              /*  chn_db_lock         */
+    0,              /*  chn_host_pending    */
     1,              /*  opcodedirWasOK      */
     0,              /*  disable_csd_options */
     { 0, { 0U } },  /*  randState_          */
     0,              /*  performState        */
+    0,              /*  handoverDone        */
     1000,           /*  ugens4_rand_16      */
     1000,           /*  ugens4_rand_15      */
     NULL,           /*  schedule_kicked     */
@@ -820,7 +853,8 @@ static const CSOUND cenviron_ = {
       0,            /*    realtime  */
       0.0,          /*    0dbfs override */
       0,            /*    no exit on compile error */
-      0.4           /*    vbr quality  */
+      0.4,          /*    vbr quality  */
+      0             /*    initDeadline  */
     },
 
     {0, 0, {0}}, /* REMOT_BUF */
@@ -848,8 +882,18 @@ static const CSOUND cenviron_ = {
     NULL,           /* dag_task_status */
     NULL,           /* dag_task_watch */
     NULL,           /* dag_wlmm */
-    NULL,           /* dag_task_dep */
+    NULL,           /* dag_task_group */
+    NULL,           /* dag_groups */
+    0,              /* dag_num_groups */
+    NULL,           /* dag_group_deps */
+    0,              /* dag_group_deps_size */
+    NULL,           /* dag_instr_dep */
+    0,              /* dag_instr_max */
+    0,              /* dag_instr_cnt */
     100,            /* dag_task_max_size */
+    NULL,           /* dag_ready */
+    0,              /* dag_num_ready */
+    0,              /* dag_num_done */
     0,              /* tempStatus */
     0,              /* orcLineOffset */
     0,              /* scoLineOffset */
@@ -1265,6 +1309,7 @@ PUBLIC void csoundSetHostData(CSOUND *csound, void *hostData)
  */
 
 extern int sensevents(CSOUND *);
+extern void chn_merge_host(CSOUND *);
 
 /**
  * perform currently active instrs for one kperiod
@@ -1319,8 +1364,8 @@ inline void advanceINSDSPointer(INSDS ***start, int num)
     **start = s;
 }
 
-int dag_get_task(CSOUND *csound);
-int dag_end_task(CSOUND *csound, int task);
+int dag_get_task(CSOUND *csound, int index);
+int dag_end_task(CSOUND *csound, int index, int task);
 void dag_build(CSOUND *csound, INSDS *chain);
 void dag_reinit(CSOUND *csound);
 
@@ -1334,11 +1379,10 @@ inline static int nodePerf(CSOUND *csound, int index)
     double time_end;
 #define INVALID (-1)
 #define WAIT    (-2)
-    IGN(index);
 
     while(1) {
       int done;
-      which_task = dag_get_task(csound);
+      which_task = dag_get_task(csound, index);
       //printf("******** Select task %d\n", which_task);
       if (which_task==WAIT) continue;
       if (which_task==INVALID) return played_count;
@@ -1354,6 +1398,8 @@ inline static int nodePerf(CSOUND *csound, int index)
 #else
         done = insds->init_done;
 #endif
+        if (UNLIKELY(!done))
+          done = init_pass_join(csound, insds);
         if(done) {
         opstart = (OPDS*)task_map[which_task];
         if(insds->ksmps == csound->ksmps) {
@@ -1406,7 +1452,7 @@ inline static int nodePerf(CSOUND *csound, int index)
         played_count++;
         }
         //printf("******** finished task %d\n", which_task);
-        dag_end_task(csound, which_task);
+        dag_end_task(csound, index, which_task);
     }
     return played_count;
 }
@@ -1485,6 +1531,8 @@ int kperf_nodebug(CSOUND *csound)
     csound->spoutactive = 0;            /*   make spout inactive   */
     /* clear spout */
     memset(csound->spout, 0, csound->nspout*sizeof(MYFLT));
+    if (UNLIKELY(csound->chn_host_pending))   /* audio from the host */
+      chn_merge_host(csound);
     ip = csound->actanchor.nxtact;
 
     if (ip != NULL) {
@@ -1523,6 +1571,8 @@ int kperf_nodebug(CSOUND *csound)
 #else
           done = ip->init_done;
 #endif
+          if (UNLIKELY(!done))
+            done = init_pass_join(csound, ip);
 
           if (done == 1) {/* if init-pass has been done */
             OPDS  *opstart = (OPDS*) ip;
@@ -1664,6 +1714,8 @@ int kperf_debug(CSOUND *csound)
       csound->spoutactive = 0;            /*   make spout inactive   */
       /* clear spout */
       memset(csound->spout, 0, csound->nspout*sizeof(MYFLT));
+      if (UNLIKELY(csound->chn_host_pending))   /* audio from the host */
+        chn_merge_host(csound);
     }
     ip = csound->actanchor.nxtact;
 
@@ -1703,6 +1755,8 @@ int kperf_debug(CSOUND *csound)
 #else
           done = ip->init_done;
 #endif
+          if (UNLIKELY(!done))
+            done = init_pass_join(csound, ip);
 
           if (done == 1) {/* if init-pass has been done */
           if(data) {
@@ -1849,8 +1903,11 @@ PUBLIC int csoundPerformKsmps(CSOUND *csound)
       int returnValue;
       csound->jumpset = 1;
       /* setup jmp for return after an exit() */
-      if (UNLIKELY((returnValue = setjmp(csound->exitjmp))))
+      if (UNLIKELY((returnValue = setjmp(csound->exitjmp)))) {
+        if ((done = perf_handed_over(csound)) != 0)
+          return done;
         return ((returnValue - CSOUND_EXITJMP_SUCCESS) | CSOUND_EXITJMP_SUCCESS);
+      }
     }
     csoundLockMutex(csound->API_lock);
     do {
@@ -1879,6 +1936,8 @@ static int csoundPerformKsmpsInternal(CSOUND *csound)
     }
     /* setup jmp for return after an exit() */
         if (UNLIKELY((returnValue = setjmp(csound->exitjmp)))) {
+      if ((done = perf_handed_over(csound)) != 0)
+        return done;
 #ifndef MACOSX
       csoundMessage(csound, Str("Early return from csoundPerformKsmps().\n"));
 #endif
@@ -1893,6 +1952,107 @@ static int csoundPerformKsmpsInternal(CSOUND *csound)
     return 0;
 }
 
+/* Audio modules that run the performance from their own callback     */
+/* thread.  The module installs its own spinrecv and spoutran, and the */
+/* thread running csoundPerform() (or csoundPerformKsmps(), or         */
+/* csoundPerformBuffer()) hands the performance over from inside a     */
+/* k-cycle with csoundHandOverPerformance().  The callback thread then */
+/* runs k-cycles with csoundPerformKsmpsBatch() until the end.         */
+/* That host call does not return before then, so a host running      */
+/* csoundPerformKsmps() in a loop (such as CsoundPerformanceThread)    */
+/* can no longer pause between k-cycles, and can only end the          */
+/* performance with csoundStop().                                      */
+
+static void csoundSetAudioTransfer(CSOUND *csound,
+                                   void (*spinrecv)(CSOUND *),
+                                   void (*spoutran)(CSOUND *))
+{
+    if (spinrecv != NULL)
+      csound->spinrecv = spinrecv;
+    if (spoutran != NULL)
+      csound->spoutran = spoutran;
+}
+
+/* Releases the API lock and calls wait(), which should return when the */
+/* callback thread has finished the performance.  This then returns    */
+/* from the host's performance call: at the end of the score wait()    */
+/* returns the positive code that sensevents() gave, and the host's    */
+/* call returns it as if it had run the score itself; otherwise the    */
+/* result is as for csoundLongJmp().                                   */
+
+static CS_NORETURN void csoundHandOverPerformance(CSOUND *csound,
+                                                  int (*wait)(CSOUND *, void *),
+                                                  void *userData)
+{
+    jmp_buf saved;
+    int     retval;
+
+    /* the callback thread sets its own exit point in exitjmp */
+    memcpy((void*) &saved, (void*) &(csound->exitjmp), sizeof(jmp_buf));
+    csoundUnlockMutex(csound->API_lock);
+    retval = wait(csound, userData);
+    memcpy((void*) &(csound->exitjmp), (void*) &saved, sizeof(jmp_buf));
+    if (retval > 0) {
+      /* the end of the score: see perf_handed_over() */
+      csound->handoverDone = retval;
+      longjmp(csound->exitjmp, CSOUND_EXITJMP_SUCCESS);
+    }
+    csoundLockMutex(csound->API_lock);
+    csoundLongJmp(csound, retval);
+}
+
+/* The return value of a host performance call that lands in its exitjmp */
+/* after csoundHandOverPerformance() at the end of the score, or zero.  */
+
+static int perf_handed_over(CSOUND *csound)
+{
+    int done = csound->handoverDone;
+
+    csound->handoverDone = 0;
+    return done;
+}
+
+/* Runs up to ncycles k-cycles and returns how many were run.  Never  */
+/* waits for the API lock: if another thread holds it, nothing is run. */
+/* *done is set as by csoundPerformKsmps() when the performance ends,  */
+/* which includes a csoundStop() from any thread.                      */
+
+static int csoundPerformKsmpsBatch(CSOUND *csound, int ncycles, int *done)
+{
+    volatile int  n = 0;
+    int           returnValue;
+
+    *done = 0;
+    if (UNLIKELY(!(csound->engineStatus & CS_STATE_COMP))) {
+      *done = CSOUND_ERROR;
+      return 0;
+    }
+    if (csoundLockMutexNoWait(csound->API_lock) != 0)
+      return 0;
+    if (UNLIKELY((returnValue = setjmp(csound->exitjmp)))) {
+      csoundUnlockMutex(csound->API_lock);
+      *done = ((returnValue - CSOUND_EXITJMP_SUCCESS) | CSOUND_EXITJMP_SUCCESS);
+      return n;
+    }
+    for ( ; n < ncycles; n++) {
+      if (UNLIKELY(csound->performState != 0)) {
+        /* stopped by csoundStop(): end as at the end of the score */
+        csoundMessage(csound, Str("csoundPerform(): stopped.\n"));
+        csound->performState = 0;
+        *done = 1;
+        break;
+      }
+      do {
+        if (UNLIKELY((*done = sensevents(csound)) != 0)) {
+          csoundUnlockMutex(csound->API_lock);
+          return n;
+        }
+      } while (csound->kperf(csound));
+    }
+    csoundUnlockMutex(csound->API_lock);
+    return n;
+}
+
 /* external host's outbuffer passed in csoundPerformBuffer() */
 PUBLIC int csoundPerformBuffer(CSOUND *csound)
 {
@@ -1907,6 +2067,8 @@ PUBLIC int csoundPerformBuffer(CSOUND *csound)
     }
     /* Setup jmp for return after an exit(). */
     if (UNLIKELY((returnValue = setjmp(csound->exitjmp)))) {
+      if ((done = perf_handed_over(csound)) != 0)
+        return done;
 #ifndef MACOSX
       csoundMessage(csound, Str("Early return from csoundPerformBuffer().\n"));
 #endif
@@ -1945,6 +2107,8 @@ PUBLIC int csoundPerform(CSOUND *csound)
     csound->performState = 0;
     /* setup jmp for return after an exit() */
     if (UNLIKELY((returnValue = setjmp(csound->exitjmp)))) {
+      if ((done = perf_handed_over(csound)) != 0)
+        return done;
 #ifndef MACOSX
       csoundMessage(csound, Str("Early return from csoundPerform().\n"));
 #endif
@@ -2377,6 +2541,35 @@ PUBLIC int csoundScoreEventAbsolute(CSOUND *csound, char type,
     return ret;
 }
 
+PUBLIC int csoundScoreEventBatch(CSOUND *csound,
+                                 const CS_SCOREEVENT *events, int n)
+{
+    EVTBLK  evt;
+    int     i, nerr = 0;
+
+    /* only the fields that insert_score_event_at_sample() reads are set, */
+    /* as clearing all PMAX p-fields would be most of the cost of an event */
+    evt.strarg = NULL; evt.scnt = 0;
+    evt.pinstance = NULL;
+    csoundLockMutex(csound->API_lock);
+    for (i = 0; i < n; i++) {
+      const CS_SCOREEVENT *e = &events[i];
+      if (UNLIKELY(e->pcnt < 0 || e->pcnt > PMAX ||
+                   (e->pcnt > 0 && e->p == NULL))) {
+        nerr++;
+        continue;
+      }
+      evt.opcod = e->opcod;
+      evt.pcnt = (int16) e->pcnt;
+      if (e->pcnt > 0)
+        memcpy(&evt.p[1], e->p, sizeof(MYFLT) * (size_t) e->pcnt);
+      if (insert_score_event_at_sample(csound, &evt, e->time) != 0)
+        nerr++;
+    }
+    csoundUnlockMutex(csound->API_lock);
+    return nerr;
+}
+
 /*
  *    REAL-TIME AUDIO
  */
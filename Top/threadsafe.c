@@ -22,12 +22,6 @@
 #include "csoundCore.h"
 #include <stdlib.h>
 
-#ifdef USE_DOUBLE
-#  define MYFLT_INT_TYPE int64_t
-#else
-#  define MYFLT_INT_TYPE int32_t
-#endif
-
 extern void csoundInputMessageInternal(CSOUND *csound, const char *message);
 extern void set_channel_data_ptr(CSOUND *csound, const char *name,
                                  void *ptr, int newSize);
@@ -67,77 +61,47 @@ void csoundTableCopyIn(CSOUND *csound, int table, MYFLT *ptable){
 
 MYFLT csoundGetControlChannel(CSOUND *csound, const char *name, int *err)
 {
+    CSOUND_CHANNEL *h;
     MYFLT *pval;
-    int err_;
-    union {
-      MYFLT d;
-      MYFLT_INT_TYPE i;
-    } x;
-    x.d = FL(0.0);
-    if ((err_ = csoundGetChannelPtr(csound, &pval, name,
-                            CSOUND_CONTROL_CHANNEL | CSOUND_OUTPUT_CHANNEL))
-         == CSOUND_SUCCESS) {
-#ifdef HAVE_ATOMIC_BUILTIN
-      x.i = __sync_fetch_and_add((MYFLT_INT_TYPE *)pval, 0);
-#else
-      x.d = *pval;
-#endif
-    }
+    MYFLT val = FL(0.0);
+    int err_ = CSOUND_SUCCESS;
+    h = csoundGetChannelHandle(csound, name,
+                               CSOUND_CONTROL_CHANNEL | CSOUND_OUTPUT_CHANNEL);
+    if (LIKELY(h != NULL))
+      val = csoundGetControlChannelByHandle(csound, h);
+    else   /* only to recover the error code */
+      err_ = csoundGetChannelPtr(csound, &pval, name,
+                                 CSOUND_CONTROL_CHANNEL | CSOUND_OUTPUT_CHANNEL);
     if (err) {
         *err = err_;
     }
-    return x.d;
+    return val;
 }
 
 void csoundSetControlChannel(CSOUND *csound, const char *name, MYFLT val){
-    MYFLT *pval;
-    union {
-      MYFLT d;
-      MYFLT_INT_TYPE i;
-    } x;
-    x.d = val;
-    if(csoundGetChannelPtr(csound, &pval, name,
-                           CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL)
-            == CSOUND_SUCCESS)
-#ifdef HAVE_ATOMIC_BUILTIN
-      __sync_lock_test_and_set((MYFLT_INT_TYPE *)pval,x.i);
-#else
-    {
-      int    *lock =
-        csoundGetChannelLock(csound, (char*) name);
-      csoundSpinLock(lock);
-      *pval  = val;
-      csoundSpinUnLock(lock);
-    }
-#endif
+    csoundSetControlChannelByHandle(csound,
+                                    csoundGetChannelHandle(csound, name,
+                                                   CSOUND_CONTROL_CHANNEL |
+                                                   CSOUND_INPUT_CHANNEL),
+                                    val);
 }
 
 void csoundGetAudioChannel(CSOUND *csound, const char *name, MYFLT *samples)
 {
-
-    MYFLT  *psamples;
-
-    if (csoundGetChannelPtr(csound, &psamples, name,
-                           CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL)
-            == CSOUND_SUCCESS) {
-      int *lock = csoundGetChannelLock(csound, (char*) name);
-      csoundSpinLock(lock);
-      memcpy(samples, psamples, csoundGetKsmps(csound)*sizeof(MYFLT));
-      csoundSpinUnLock(lock);
-    }
+    csoundGetAudioChannelByHandle(csound,
+                                  csoundGetChannelHandle(csound, name,
+                                                  CSOUND_AUDIO_CHANNEL |
+                                                  CSOUND_OUTPUT_CHANNEL),
+                                  samples);
 }
 
 void csoundSetAudioChannel(CSOUND *csound, const char *name, MYFLT *samples)
 {
-    MYFLT  *psamples;
-    if (csoundGetChannelPtr(csound, &psamples, name,
-                           CSOUND_AUDIO_CHANNEL | CSOUND_INPUT_CHANNEL)
-            == CSOUND_SUCCESS){
-      int *lock = csoundGetChannelLock(csound, (char*) name);
-      csoundSpinLock(lock);
-      memcpy(psamples, samples, csoundGetKsmps(csound)*sizeof(MYFLT));
-      csoundSpinUnLock(lock);
-    }
+    csoundSetAudioChannelByHandle(csound,
+                                  csoundGetChannelHandle(csound, name,
+                                                  CSOUND_AUDIO_CHANNEL |
+                                                  CSOUND_INPUT_CHANNEL),
+                                  samples);
 }
 
 void csoundSetStringChannel(CSOUND *csound, const char *name, char *string)
@@ -20,6 +20,7 @@ $(CSOUND_SRC_ROOT)/Engine/entry1.c \
 $(CSOUND_SRC_ROOT)/Engine/envvar.c \
 $(CSOUND_SRC_ROOT)/Engine/extract.c \
 $(CSOUND_SRC_ROOT)/Engine/fgens.c \
+$(CSOUND_SRC_ROOT)/Engine/ftcache.c \
 $(CSOUND_SRC_ROOT)/Engine/insert.c \
 $(CSOUND_SRC_ROOT)/Engine/linevent.c \
 $(CSOUND_SRC_ROOT)/Engine/memalloc.c \
@@ -47,7 +48,9 @@ $(CSOUND_SRC_ROOT)/InOut/windin.c \
 $(CSOUND_SRC_ROOT)/InOut/window.c \
 $(CSOUND_SRC_ROOT)/InOut/winEPS.c \
 $(CSOUND_SRC_ROOT)/InOut/circularbuffer.c \
+$(CSOUND_SRC_ROOT)/InOut/sampconv.c \
 $(CSOUND_SRC_ROOT)/OOps/aops.c \
+$(CSOUND_SRC_ROOT)/OOps/vecops.c \
 $(CSOUND_SRC_ROOT)/OOps/bus.c \
 $(CSOUND_SRC_ROOT)/OOps/cmath.c \
 $(CSOUND_SRC_ROOT)/OOps/diskin2.c \
@@ -46,4 +46,23 @@ typedef struct _watchList {
   struct _watchList *next;
 } watchList;
 
+/* A run of consecutive active instances of one instrument.  Dependencies
+   only depend on the instrument, so they are held per group */
+typedef struct _taskGroup {
+  int insno;
+  int start, count;       /* range of task indices */
+  int self;               /* instances wait for earlier ones of this instr */
+  int deps, ndeps;        /* offset and length in dag_group_deps */
+} taskGroup;
+
+/* Per-thread double ended queue of tasks ready to run.  The owning thread
+   pushes and pops at the bottom, idle threads steal from the top.  Each task
+   is queued at most once per k-cycle so the array never needs to wrap */
+typedef struct _taskDeque {
+  volatile int top;
+  volatile int bottom;
+  taskID       *tasks;
+  char         pad[64-2*sizeof(int)-sizeof(taskID*)]; /* one per cache line */
+} taskDeque;
+
 #endif
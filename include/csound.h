@@ -454,6 +454,21 @@ extern "C" {
         uint32_t    mt[624];
     } CsoundRandMTState;
 
+    /**
+     * A score event for csoundScoreEventBatch()
+     */
+    typedef struct {
+        /** event type ('a', 'i', 'q', 'f' or 'e') */
+        char          opcod;
+        /** number of p-fields */
+        int           pcnt;
+        /** p-fields, p[0] is p1 */
+        const MYFLT   *p;
+        /** start in samples from the beginning of performance, to which
+            p2 (in seconds) is added */
+        int64_t       time;
+    } CS_SCOREEVENT;
+
     /* PVSDATEXT is a variation on PVSDAT used in
        the pvs bus interface */
     typedef struct pvsdat_ext {
@@ -541,6 +556,11 @@ extern "C" {
         controlChannelHints_t    hints;
     } controlChannelInfo_t;
 
+    /**
+     * Opaque handle to a channel, see csoundGetChannelHandle().
+     */
+    typedef struct channelEntry_s CSOUND_CHANNEL;
+
     typedef void (*channelCallback_t)(CSOUND *csound,
             const char *channelName,
             void *channelValuePtr,
@@ -1165,6 +1185,17 @@ extern "C" {
     PUBLIC void csoundSetExternalMidiErrorStringCallback(CSOUND *,
             const char *(*func)(int));
 
+    /**
+     * Queues one complete MIDI message (1 to 3 bytes) received 'age'
+     * seconds ago, for drivers and hosts that read MIDI input in their
+     * own thread.  Note on messages are started at the matching sample
+     * offset within the next k-cycle.  Only one thread may push messages.
+     * Returns zero on success, or non-zero if MIDI input is not open or
+     * the queue is full.
+     */
+    PUBLIC int csoundPushMidiInput(CSOUND *csound, const unsigned char *msg,
+                                   int nbytes, double age);
+
 
     /**
      * Sets a function that is called to obtain a list of MIDI devices.
@@ -1494,6 +1525,50 @@ extern "C" {
     PUBLIC  void csoundSetStringChannel(CSOUND *csound,
                                         const char *name, char *string);
 
+    /**
+     * Returns a handle to the channel called 'name', creating it as
+     * csoundGetChannelPtr() would, or NULL if the channel exists with a
+     * different type or could not be created.  The handle stays valid
+     * until csoundReset(); resolving it once lets hosts that update many
+     * channels per block skip the name lookup in the calls below.
+     */
+    PUBLIC CSOUND_CHANNEL *csoundGetChannelHandle(CSOUND *csound,
+                                                  const char *name, int type);
+
+    /**
+     * retrieves the value of the control channel h (threadsafe);
+     * returns 0 if h is NULL or not a control channel
+     */
+    PUBLIC MYFLT csoundGetControlChannelByHandle(CSOUND *csound,
+                                                 CSOUND_CHANNEL *h);
+
+    /**
+     * sets the value of the control channel h (threadsafe)
+     */
+    PUBLIC void csoundSetControlChannelByHandle(CSOUND *csound,
+                                                CSOUND_CHANNEL *h, MYFLT val);
+
+    /**
+     * copies the audio channel h into *samples (ksmps MYFLTs)
+     */
+    PUBLIC void csoundGetAudioChannelByHandle(CSOUND *csound,
+                                              CSOUND_CHANNEL *h,
+                                              MYFLT *samples);
+
+    /**
+     * sets the audio channel h from *samples (ksmps MYFLTs)
+     */
+    PUBLIC void csoundSetAudioChannelByHandle(CSOUND *csound,
+                                              CSOUND_CHANNEL *h,
+                                              MYFLT *samples);
+
+    /**
+     * adds *samples (ksmps MYFLTs) to the audio channel h
+     */
+    PUBLIC void csoundMixAudioChannelByHandle(CSOUND *csound,
+                                              CSOUND_CHANNEL *h,
+                                              MYFLT *samples);
+
     /**
      * returns the size of data stored in a channel; for string channels
      * this might change if the channel space gets reallocated
@@ -1551,6 +1626,18 @@ extern "C" {
     PUBLIC int csoundScoreEventAbsolute(CSOUND *,
             char type, const MYFLT *pfields, long numFields, double time_ofs);
 
+    /**
+     * Inserts the n score events of the array 'events' together, taking
+     * the API lock once, which is much faster than calling
+     * csoundScoreEvent() or csoundInputMessage() for each when there are
+     * many. The start of each event is given in samples from the beginning
+     * of performance (csoundGetCurrentTimeSamples() gives the current
+     * time), and is rounded to a control period, as for other score
+     * events. Returns the number of events that could not be inserted.
+     */
+    PUBLIC int csoundScoreEventBatch(CSOUND *,
+            const CS_SCOREEVENT *events, int n);
+
     /**
      * Input a NULL-terminated string (as if from a console),
      * used for line events.
@@ -2227,6 +2314,38 @@ extern "C" {
    */
   PUBLIC void csoundFlushCircularBuffer(CSOUND *csound, void *p);
 
+  /**
+   * Zero-copy write access to a circular buffer.
+   * Sets *ptr to the next free element and returns how many contiguous
+   * elements (0 <= n <= items) may be written there.  The data become
+   * visible to the reader only after csoundCommitCircularBufferWrite().
+   * As with the other functions, there must be a single writer and a
+   * single reader.
+   */
+  PUBLIC int csoundReserveCircularBufferWrite(CSOUND *csound, void *p,
+                                              void **ptr, int items);
+
+  /**
+   * Publish items elements written through csoundReserveCircularBufferWrite().
+   */
+  PUBLIC void csoundCommitCircularBufferWrite(CSOUND *csound, void *p,
+                                              int items);
+
+  /**
+   * Zero-copy read access to a circular buffer.
+   * Sets *ptr to the oldest unread element and returns how many contiguous
+   * elements (0 <= n <= items) may be read there.  They stay in the buffer
+   * until released with csoundCommitCircularBufferRead().
+   */
+  PUBLIC int csoundReserveCircularBufferRead(CSOUND *csound, void *p,
+                                             void **ptr, int items);
+
+  /**
+   * Release items elements read through csoundReserveCircularBufferRead().
+   */
+  PUBLIC void csoundCommitCircularBufferRead(CSOUND *csound, void *p,
+                                             int items);
+
  /**
   * Free circular buffer
   */
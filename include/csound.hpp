@@ -520,6 +520,10 @@ public:
   {
     return csoundScoreEventAbsolute(csound, type, pFields, numFields, time_ofs);
   }
+  virtual int ScoreEventBatch(const CS_SCOREEVENT *events, int n)
+  {
+    return csoundScoreEventBatch(csound, events, n);
+  }
   // MIDI
   virtual void SetExternalMidiInOpenCallback(
       int (*func)(CSOUND *, void **, const char *))
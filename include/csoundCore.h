@@ -217,6 +217,7 @@ typedef struct {
     MYFLT   e0dbfs_override;
     int     daemon;
     double  quality;        /* for ogg encoding */
+    int     initDeadline;   /* k-cycles a realtime init pass may take */
   } OPARMS;
 
   typedef struct arglst {
@@ -517,6 +518,7 @@ typedef struct {
     MYFLT  *spin;         /* offset into csound->spin */
     MYFLT  *spout;        /* offset into csound->spout, or local spout, if needed */
     int    init_done;
+    long   initqcnt;      /* kcounter when its init pass was queued */
     int    tieflag;
     int    reinitflag;
     MYFLT  retval;
@@ -629,6 +631,10 @@ typedef struct {
     GEN01ARGS gen01args;
     /** table data (flen + 1 MYFLT values) */
     MYFLT   *ftable;
+    /** band-limited copies of a power of two table for oscillators, NULL
+        terminated; copy k keeps the harmonics up to flen >> (k + 2).
+        NULL until first requested with GetBandLimitedTable() */
+    MYFLT   **bltables;
   } FUNC;
 
   typedef struct {
@@ -735,6 +741,7 @@ typedef struct {
 #define MBUFSIZ         (4096)
 #define MIDIINBUFMAX    (1024)
 #define MIDIINBUFMSK    (MIDIINBUFMAX-1)
+#define MIDITSQSIZE     (1024)
 
 
 
@@ -743,6 +750,13 @@ typedef struct {
     unsigned char bData[4];
   } MIDIMESSAGE;
 
+  /* timestamped MIDI message queued by a driver thread */
+  typedef struct {
+    double  time;               /* csRtClock time of arrival, in seconds */
+    unsigned char msg[3];
+    unsigned char nbytes;
+  } MIDITSMSG;
+
   /* MIDI globals */
 
   typedef struct midiglobals {
@@ -767,11 +781,16 @@ typedef struct {
     unsigned char mbuf[MBUFSIZ];
     unsigned char *bufp, *endatp;
     int16   datreq, datcnt;
+    void    *tsQueue;           /* MIDITSMSG queue from csoundPushMidiInput() */
+    double  tsPrev, tsNow;      /* clock at the last two k-cycles */
+    long    tsKcnt;             /* k-cycle of tsNow */
+    int     tsOffset;           /* sample offset of the event in Midevtblk */
   } MGLOBAL;
 
   typedef struct eventnode {
     struct eventnode  *nxt;
     uint32     start_kcnt;
+    uint32     seq;             /* insertion order, breaks start_kcnt ties */
     EVTBLK            evt;
   } EVTNODE;
 
@@ -898,6 +917,20 @@ typedef struct NAME__ {
     char type[12];
   } MODULE_INFO;
 
+  /**
+   * FFT plan, see csoundCreateFFTPlan()
+   */
+  typedef struct CS_FFT_PLAN_ CS_FFT_PLAN;
+
+  /**
+   * sample format converter, see sampconv.h
+   */
+  typedef struct CS_SAMPCONV_ CS_SAMPCONV;
+
+  /* flags for csoundCreateFFTPlan() */
+#define CS_FFT_INVERSE  1       /* inverse transform                    */
+#define CS_FFT_COMPLEX  2       /* complex data (default is real)       */
+
   /**
    * Contains all function pointers, data, and data pointers required
    * to run one instance of Csound.
@@ -1274,10 +1307,59 @@ typedef struct NAME__ {
     void (*RewindScore)(CSOUND *);
     void (*InputMessage)(CSOUND *, const char *message__);
        /**@}*/
+    /** @name Circular buffer zero-copy access */
+    /**@{ */
+    int (*ReserveCircularBufferWrite)(CSOUND *, void *, void **, int);
+    void (*CommitCircularBufferWrite)(CSOUND *, void *, int);
+    int (*ReserveCircularBufferRead)(CSOUND *, void *, void **, int);
+    void (*CommitCircularBufferRead)(CSOUND *, void *, int);
+    /**@}*/
+    /** @name FFT plans */
+    /**@{ */
+    CS_FFT_PLAN *(*CreateFFTPlan)(CSOUND *, int FFTsize, int flags);
+    void (*ExecuteFFTPlan)(CSOUND *, CS_FFT_PLAN *, MYFLT *buf);
+    void (*ExecuteFFTPlanBatch)(CSOUND *, CS_FFT_PLAN *, MYFLT *buf,
+                                int howmany, int dist);
+    /**@}*/
+    /** @name Band-limited tables */
+    /**@{ */
+    MYFLT *(*GetBandLimitedTable)(CSOUND *, FUNC *, MYFLT inc);
+    /**@}*/
+    /** @name Callback-driven audio modules */
+    /**@{ */
+    void (*SetAudioTransfer)(CSOUND *, void (*spinrecv)(CSOUND *),
+                             void (*spoutran)(CSOUND *));
+    MYFLT *(*GetSpin)(CSOUND *);
+    MYFLT *(*GetSpout)(CSOUND *);
+    CS_NORETURN void (*HandOverPerformance)(CSOUND *,
+                                            int (*wait)(CSOUND *, void *),
+                                            void *userData);
+    int (*PerformKsmpsBatch)(CSOUND *, int ncycles, int *done);
+    /**@}*/
+    /** @name Timestamped MIDI input */
+    /**@{ */
+    int (*PushMidiInput)(CSOUND *, const unsigned char *msg, int nbytes,
+                         double age);
+    /**@}*/
+    /** @name Sample format conversion */
+    /**@{ */
+    CS_SAMPCONV *(*CreateSampleConverter)(CSOUND *, int format, int nchnls,
+                                          int dither);
+    void (*DestroySampleConverter)(CSOUND *, CS_SAMPCONV *);
+    int (*SampleConverterSize)(CS_SAMPCONV *);
+    void (*ConvertSamplesOut)(CS_SAMPCONV *, void *out, const MYFLT *in,
+                              int nframes);
+    void (*ConvertSamplesIn)(CS_SAMPCONV *, MYFLT *out, const void *in,
+                             int nframes);
+    void (*Deinterleave)(float *const *out, int offset, const MYFLT *in,
+                         int nchnls, int nframes, MYFLT scale);
+    void (*Interleave)(MYFLT *out, const float *const *in, int offset,
+                       int nchnls, int nframes, MYFLT scale);
+    /**@}*/
     /** @name Placeholders
         To allow the API to grow while maintining backward binary compatibility. */
     /**@{ */
-    SUBR dummyfn_2[43];
+    SUBR dummyfn_2[22];
     /**@}*/
 #ifdef __BUILDING_LIBCSOUND
     /* ------- private data (not to be used by hosts or externals) ------- */
@@ -1427,7 +1509,9 @@ typedef struct NAME__ {
     int32         rngcnt[MAXCHNLS];
     int16         rngflg, multichan;
     void          *evtFuncChain;
-    EVTNODE       *OrcTrigEvts;             /* List of events to be started */
+    EVTNODE       **OrcTrigEvts;            /* Heap of events to be started */
+    int           OrcTrigEvtsCnt, OrcTrigEvtsMax;
+    uint32        OrcTrigEvtsSeq;
     EVTNODE       *freeEvtNodes;
     int           csoundIsScorePending_;
     int64_t       advanceCnt;
@@ -1447,6 +1531,7 @@ typedef struct NAME__ {
     int64_t       cyclesRemaining;
     EVTBLK        evt;
     void          *memalloc_db;
+    void          *memalloc_pool;   /* recycled instance memory */
     MGLOBAL       *midiGlobals;
     CS_HASH_TABLE *envVarDB;
     MEMFIL        *memfiles;
@@ -1454,6 +1539,8 @@ typedef struct NAME__ {
     int           FFT_max_size;
     void          *FFT_table_1;
     void          *FFT_table_2;
+    CS_FFT_PLAN   *FFT_plans;
+    int32_t       FFT_lock;         /* for FFT_plans and the FFT tables */
     /* statics from twarp.c should be TSEG* */
     void          *tseg, *tpsave, *tplim;
     /* Statics from express.c */
@@ -1466,6 +1553,7 @@ typedef struct NAME__ {
     pthread_t    init_pass_thread;
     int          init_pass_loop;
     void         *init_pass_threadlock;
+    void         *init_pass_queue;
     void         *API_lock;
     #if defined(HAVE_PTHREAD_SPIN_LOCK)
     pthread_spinlock_t spoutlock, spinlock;
@@ -1555,7 +1643,7 @@ typedef struct NAME__ {
       int           pipdevin, pipdevout;  /* 0: file, 1: pipe, 2: rtaudio */
       uint32        nframes               /* = 1UL */;
       FILE          *pin, *pout;
-      int           dither;
+      CS_SAMPCONV   *dither;              /* see sampconv.h               */
     } libsndStatics;
 
     int           warped;               /* rdscor.c */
@@ -1615,10 +1703,13 @@ typedef struct NAME__ {
     int           currentLPCSlot;
     int           max_lpc_slot;
     CS_HASH_TABLE *chn_db;
+    int32_t       chn_db_lock;      /* for lookups and inserts in chn_db */
+    volatile int  chn_host_pending; /* host audio channel data to merge */
     int           opcodedirWasOK;
     int           disable_csd_options;
     CsoundRandMTState randState_;
     int           performState;
+    int           handoverDone;   /* end of score of a handed over perf. */
     int           ugens4_rand_16;
     int           ugens4_rand_15;
     void          *schedule_kicked;
@@ -1652,8 +1743,18 @@ typedef struct NAME__ {
     volatile enum state    *dag_task_status;
     watchList     * volatile *dag_task_watch;
     watchList     *dag_wlmm;
-    char          **dag_task_dep;
+    int           *dag_task_group;  /* group of each task */
+    taskGroup     *dag_groups;      /* runs of instances of one instr */
+    int           dag_num_groups;
+    int           *dag_group_deps;  /* earlier groups each group waits on */
+    int           dag_group_deps_size;
+    void          *dag_instr_dep;   /* cached instr pair dependencies */
+    int           dag_instr_max;    /* slots in dag_instr_dep */
+    int           dag_instr_cnt;    /* slots in use */
     int           dag_task_max_size;
+    taskDeque     *dag_ready;     /* one ready queue per thread */
+    volatile int  dag_num_ready;  /* tasks queued but not yet taken */
+    volatile int  dag_num_done;   /* tasks completed this k-cycle */
     uint32_t      tempStatus;    /* keeps track of which files are temps */
     int           orcLineOffset; /* 1 less than 1st orch line in the CSD */
     int           scoLineOffset; /* 1 less than 1st score line in the CSD */
@@ -28,8 +28,6 @@
 extern "C" {
 #endif
 
-#define HASH_SIZE 4099
-
 typedef struct _cons {
     void* value; // should be car, but using value
     struct _cons* next; // should be cdr, but to follow csound
@@ -37,13 +35,17 @@ typedef struct _cons {
 } CONS_CELL;
 
 typedef struct _cs_hash_bucket_item {
-    char* key;
+    char* key;          /* NULL for an empty slot */
     void* value;
-    struct _cs_hash_bucket_item* next;
+    unsigned int hash;  /* full hash of key, compared before strcmp */
 } CS_HASH_TABLE_ITEM;
 
+/* Open addressing with linear probing; size is a power of two and the
+   table is grown to keep it at most half full. */
 typedef struct _cs_hash_table {
-    CS_HASH_TABLE_ITEM* buckets[HASH_SIZE];
+    CS_HASH_TABLE_ITEM* items;
+    unsigned int size;
+    unsigned int count;
 } CS_HASH_TABLE;
 
 /* FUNCTIONS FOR CONS CELL */
@@ -78,6 +80,17 @@ PUBLIC CS_HASH_TABLE* cs_hash_table_create(CSOUND* csound);
 PUBLIC void* cs_hash_table_get(CSOUND* csound,
                                CS_HASH_TABLE* hashTable, char* key);
 
+/** Returns the hash of key as used by CS_HASH_TABLE.  Callers that look
+    up the same key repeatedly can compute it once and pass it to
+    cs_hash_table_get_hashed(). */
+PUBLIC unsigned int cs_hash_table_hash(const char* key);
+
+/** As cs_hash_table_get(), with hash precomputed by
+    cs_hash_table_hash(). */
+PUBLIC void* cs_hash_table_get_hashed(CSOUND* csound,
+                                      CS_HASH_TABLE* hashTable,
+                                      const char* key, unsigned int hash);
+
 /** Retreive char* key from internal hash item for given char* key.
     Useful when using CS_HASH_TABLE as a Set<String> type. Returns
     NULL if there is no entry for given key. */
@@ -90,6 +103,22 @@ PUBLIC char* cs_hash_table_get_key(CSOUND* csound,
 PUBLIC void cs_hash_table_put(CSOUND* csound,
                               CS_HASH_TABLE* hashTable, char* key, void* value);
 
+/** As cs_hash_table_put(), but if the entry is new, key itself (which
+ must be allocated with csound->Malloc) becomes the item's key rather
+ than a copy.  Returns the internal char* used for the hash item key. */
+char* cs_hash_table_put_no_key_copy(CSOUND* csound,
+                                    CS_HASH_TABLE* hashTable,
+                                    char* key, void* value);
+
+/** Returns non-zero if adding a new key would grow the table. */
+int cs_hash_table_full(CS_HASH_TABLE* hashTable);
+
+/** Grows the table into newItems, zeroed and of twice the size of the
+ table, and returns the old items for the caller to free.  For tables
+ that are changed with a spinlock held, and so must not allocate. */
+CS_HASH_TABLE_ITEM* cs_hash_table_grow_into(CS_HASH_TABLE* hashTable,
+                                            CS_HASH_TABLE_ITEM* newItems);
+
 /** Adds an entry into the hashtable using the given key and NULL
  value.  Returns the internal char* used for the hash item key. */
 PUBLIC char* cs_hash_table_put_key(CSOUND* csound,
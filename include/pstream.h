@@ -127,6 +127,7 @@ typedef struct {
         MYFLT   *wintype;
         MYFLT   *format;                /* always PVS_AMP_FREQ at present */
         MYFLT   *init;                  /* not yet implemented */
+        MYFLT   *fast;                  /* single precision sliding DFT */
         /* internal */
         int32    buflen;
         float   fund,arate;
@@ -140,8 +141,12 @@ typedef struct {
         AUXCH   analbuf;
         AUXCH   analwinbuf;     /* prewin in SDFT case */
         AUXCH   oldInPhase;
-        AUXCH           trig;
-        double          *cosine, *sine;
+        AUXCH           trig;           /* SDFT rotations and state */
+        int32           NBP;            /* SDFT bins rounded up to a tile */
+        int32           resync;         /* samples since the state was rebuilt */
+        int             sfast;
+        MYFLT           wcoef[3];       /* SDFT window as a spectral kernel */
+        CS_FFT_PLAN     *setup;         /* forward FFT of fftsize */
 } PVSANAL;
 
 typedef struct {
@@ -149,9 +154,11 @@ typedef struct {
         MYFLT   *aout;                  /* audio output signal */
         PVSDAT  *fsig;                  /* input signal is an analysis frame */
         MYFLT   *init;                  /* not yet implemented */
+        MYFLT   *fast;                  /* single precision sliding synthesis */
         /* internal */
         /* check these against fsig vals */
         int32    overlap,winsize,fftsize,wintype,format;
+        int      sfast;
         /* can we allow variant window tpes?  */
         int32    buflen;
         MYFLT   fund,arate;
@@ -168,6 +175,7 @@ typedef struct {
         AUXCH   analwinbuf;     /* may get away with a local alloc and free */
         AUXCH   synwinbuf;
         AUXCH   oldOutPhase;
+        CS_FFT_PLAN *setup;     /* inverse FFT of fftsize */
 
 } PVSYNTH;
 
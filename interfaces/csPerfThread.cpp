@@ -29,230 +29,332 @@
 
 // ----------------------------------------------------------------------------
 
+// The messages are passed from any number of threads to the performance
+// thread in a ring of CSPT_QUEUE_SIZE slots, allocated with the object.
+// A writer takes the slots of a message by moving queueTail forward with
+// a compare and swap, fills them in, and marks them as ready; it never
+// waits for the performance thread or for other writers, and drops the
+// message if the queue is full. The performance thread reads ready
+// messages in order at the start of each control period, without locks
+// and without allocating memory. Each slot has a sequence number, which
+// is its position in the stream of slots while it is free, and one more
+// than that once it holds a message ready to be read.
+//
+// Play, Pause, TogglePause and Stop must never be dropped, so they do not
+// use the queue: a stop sets stopRequested, and the others are merged into
+// the one pause request in control, which the performance thread takes
+// before reading the queue.
+
+#define CSPT_QUEUE_SIZE     1024    // slots in the queue, a power of two
+#define CSPT_SLOT_PFIELDS   32      // p-fields held in a slot
+#define CSPT_MAX_SLOTS      64      // slots a message may take
+#define CSPT_SLOT_BYTES     (CSPT_SLOT_PFIELDS * sizeof(MYFLT))
+#define CSPT_MAX_BYTES      (CSPT_MAX_SLOTS * CSPT_SLOT_BYTES)
+
+#ifdef HAVE_ATOMIC_BUILTIN
+#  define CSPT_BARRIER()            __sync_synchronize()
+#  define CSPT_INCREMENT(x, n)      __sync_fetch_and_add(&(x), (n))
+#  define CSPT_CAS(x, o, n)         __sync_val_compare_and_swap(&(x), (o), (n))
+#else
+// writers take queueLock instead of using compare and swap
+#  define CSPT_BARRIER()            ((void) 0)
+#  define CSPT_INCREMENT(x, n)      ((x) += (n))
+#endif
+
+// pause requests
+enum {
+    CSPT_NONE,
+    CSPT_PLAY,
+    CSPT_PAUSE,
+    CSPT_TOGGLE_PAUSE
+};
+
+// queued messages
+enum {
+    CSPT_SCORE_EVENT,
+    CSPT_INPUT_MESSAGE,
+    CSPT_SCORE_OFFSET
+};
+
 /**
- * Base class for event messages.
+ * A slot of the message queue. A message whose p-fields or string do not
+ * fit in one slot continues in the data of the slots after it.
+ *
+ * absp2mode: if non-zero, start times are measured from the beginning of
+ *            performance, instead of the current time
+ * opcod:     score opcode (e.g. 'i' for a note event)
+ * pcnt:      number of p-fields
+ * p:         array of p-fields, p[0] is p1
  */
 
 class CsoundPerformanceThreadMessage {
- protected:
-    CsoundPerformanceThread *pt_;
-    void SetPaused(int state)
-    {
-      pt_->paused = state;
-    }
-    int GetPaused()
-    {
-      return pt_->paused;
-    }
  public:
-    CsoundPerformanceThreadMessage *nxt;
-    virtual int run() = 0;
-    CsoundPerformanceThreadMessage(CsoundPerformanceThread *pt)
-    {
-      pt_ = pt;
-      nxt = (CsoundPerformanceThreadMessage*) 0;
-    }
-    virtual ~CsoundPerformanceThreadMessage()
-    {
-    }
+    volatile unsigned long seq;
+    int     type;
+    int     nslots;
+    int     absp2mode;
+    int     pcnt;
+    char    opcod;
+    double  timeVal;
+    union {
+      MYFLT p[CSPT_SLOT_PFIELDS];
+      char  s[CSPT_SLOT_BYTES];
+    } u;
 };
 
+static inline int slotsForBytes(size_t bytes)
+{
+    return (bytes <= CSPT_SLOT_BYTES ?
+            1 : (int) ((bytes + CSPT_SLOT_BYTES - 1) / CSPT_SLOT_BYTES));
+}
+
 /**
- * Unpause performance
+ * Takes n consecutive slots for a message, and stores the position of the
+ * first in *pos. Returns zero if the queue is full.
  */
 
-class CsPerfThreadMsg_Play : public CsoundPerformanceThreadMessage {
- public:
-    CsPerfThreadMsg_Play(CsoundPerformanceThread *pt)
-    : CsoundPerformanceThreadMessage(pt)
-    {
+int CsoundPerformanceThread::ReserveSlots(int n, unsigned long *pos)
+{
+    unsigned long p, last;
+    long    d;
+
+#ifdef HAVE_ATOMIC_BUILTIN
+    p = queueTail;
+    for (;;) {
+      // as slots are freed in order, the others are free if the last is
+      last = p + (unsigned long) (n - 1);
+      d = (long) (queue[last & (CSPT_QUEUE_SIZE - 1)].seq - last);
+      if (d == 0) {
+        unsigned long q = __sync_val_compare_and_swap(&queueTail, p,
+                                                      p + (unsigned long) n);
+        if (q == p)
+          break;
+        p = q;
+      }
+      else if (d < 0)
+        return 0;
+      else
+        p = queueTail;
     }
-    int run()
-    {
-      SetPaused(0);
+#else
+    csoundLockMutex(queueLock);
+    p = queueTail;
+    last = p + (unsigned long) (n - 1);
+    d = (long) (queue[last & (CSPT_QUEUE_SIZE - 1)].seq - last);
+    if (d == 0)
+      queueTail = p + (unsigned long) n;
+    csoundUnlockMutex(queueLock);
+    if (d != 0)
       return 0;
-    }
-    ~CsPerfThreadMsg_Play()
-    {
-    }
-};
+#endif
+    *pos = p;
+    return 1;
+}
 
 /**
- * Pause performance
+ * Marks the n slots at pos as ready, the first last, and wakes up the
+ * performance thread if it is paused.
  */
 
-class CsPerfThreadMsg_Pause : public CsoundPerformanceThreadMessage {
- public:
-    CsPerfThreadMsg_Pause(CsoundPerformanceThread *pt)
-    : CsoundPerformanceThreadMessage(pt)
-    {
-    }
-    int run()
-    {
-      SetPaused(1);
-      return 0;
-    }
-    ~CsPerfThreadMsg_Pause()
-    {
+void CsoundPerformanceThread::PublishSlots(unsigned long pos, int n)
+{
+    int     i;
+
+    CSPT_BARRIER();
+    for (i = n - 1; i >= 0; i--) {
+      if (i == 0)
+        CSPT_BARRIER();
+      queue[(pos + i) & (CSPT_QUEUE_SIZE - 1)].seq = pos + i + 1UL;
     }
-};
+    CSPT_BARRIER();
+    if (paused)
+      csoundNotifyThreadLock(pauseLock);
+}
 
 /**
- * Toggle pause mode
+ * Copies the data of a message to the slots starting at pos.
  */
 
-class CsPerfThreadMsg_TogglePause : public CsoundPerformanceThreadMessage {
- public:
-    CsPerfThreadMsg_TogglePause(CsoundPerformanceThread *pt)
-    : CsoundPerformanceThreadMessage(pt)
-    {
-    }
-    int run()
-    {
-      SetPaused(GetPaused() ? 0 : 1);
-      return 0;
-    }
-    ~CsPerfThreadMsg_TogglePause()
-    {
+void CsoundPerformanceThread::WritePayload(unsigned long pos,
+                                           const void *data, size_t bytes)
+{
+    const char  *src = (const char*) data;
+
+    while (bytes > 0) {
+      size_t  n = (bytes < CSPT_SLOT_BYTES ? bytes : CSPT_SLOT_BYTES);
+      memcpy(queue[pos++ & (CSPT_QUEUE_SIZE - 1)].u.s, src, n);
+      src += n;
+      bytes -= n;
     }
-};
+}
 
 /**
- * Stop performance (cannot be continued)
+ * Returns the data of the message at pos, copied to the scratch buffer if
+ * the message takes more than one slot.
  */
 
-class CsPerfThreadMsg_Stop : public CsoundPerformanceThreadMessage {
- public:
-    CsPerfThreadMsg_Stop(CsoundPerformanceThread *pt)
-    : CsoundPerformanceThreadMessage(pt)
-    {
-    }
-    int run()
-    {
-      return 1;
-    }
-    ~CsPerfThreadMsg_Stop()
-    {
-    }
-};
+void *CsoundPerformanceThread::ReadPayload(unsigned long pos)
+{
+    CsoundPerformanceThreadMessage *msg;
+    int     i;
+
+    msg = &(queue[pos & (CSPT_QUEUE_SIZE - 1)]);
+    if (msg->nslots == 1)
+      return (void*) msg->u.p;
+    for (i = 0; i < msg->nslots; i++)
+      memcpy(&(scratch[i * CSPT_SLOT_PFIELDS]),
+             queue[(pos + i) & (CSPT_QUEUE_SIZE - 1)].u.p, CSPT_SLOT_BYTES);
+    return (void*) scratch;
+}
 
 /**
- * Score event message
- *
- * absp2mode: if non-zero, start times are measured from the beginning of
- *            performance, instead of the current time
- * opcod:     score opcode (e.g. 'i' for a note event)
- * pcnt:      number of p-fields
- * *p:        array of p-fields, p[0] is p1
+ * Performs the message at pos.
  */
 
-class CsPerfThreadMsg_ScoreEvent : public CsoundPerformanceThreadMessage {
- private:
-    char    opcod;
-    int     absp2mode;
-    int     pcnt;
-    MYFLT   *pp;
-    MYFLT   p[10];
- public:
-    CsPerfThreadMsg_ScoreEvent(CsoundPerformanceThread *pt,
-                               int absp2mode, char opcod,
-                               int pcnt, const MYFLT *p)
-    : CsoundPerformanceThreadMessage(pt)
-    {
-      this->opcod = opcod;
-      this->absp2mode = absp2mode;
-      this->pcnt = pcnt;
-      if (pcnt <= 10)
-        this->pp = &(this->p[0]);
-      else
-        this->pp = new MYFLT[(unsigned int) pcnt];
-      for (int i = 0; i < pcnt; i++)
-        this->pp[i] = p[i];
-    }
-    int run()
-    {
-      CSOUND  *csound = pt_->GetCsound();
-      if (absp2mode && pcnt > 1) {
-        double  p2 = (double) pp[1] - csoundGetScoreTime(csound);
-        if (p2 < 0.0) {
-          if (pcnt > 2 && pp[2] >= (MYFLT) 0 &&
-              (opcod == 'a' || opcod == 'i')) {
-            pp[2] = (MYFLT) ((double) pp[2] + p2);
-            if (pp[2] <= (MYFLT) 0)
-              return 0;
+void CsoundPerformanceThread::RunMessage(unsigned long pos)
+{
+    CsoundPerformanceThreadMessage *msg;
+
+    msg = &(queue[pos & (CSPT_QUEUE_SIZE - 1)]);
+    switch (msg->type) {
+    case CSPT_SCORE_EVENT:
+      {
+        MYFLT   *pp = (MYFLT*) ReadPayload(pos);
+        int     pcnt = msg->pcnt;
+        char    opcod = msg->opcod;
+        if (msg->absp2mode && pcnt > 1) {
+          double  p2 = (double) pp[1] - csoundGetScoreTime(csound);
+          if (p2 < 0.0) {
+            if (pcnt > 2 && pp[2] >= (MYFLT) 0 &&
+                (opcod == 'a' || opcod == 'i')) {
+              pp[2] = (MYFLT) ((double) pp[2] + p2);
+              if (pp[2] <= (MYFLT) 0)
+                break;
+            }
+            p2 = 0.0;
           }
-          p2 = 0.0;
+          pp[1] = (MYFLT) p2;
         }
-        pp[1] = (MYFLT) p2;
+        if (csoundScoreEvent(csound, opcod, pp, (long) pcnt) != 0)
+          csoundMessageS(csound, CSOUNDMSG_WARNING,
+                         "WARNING: could not create score event\n");
       }
-      if (csoundScoreEvent(csound, opcod, pp, (long) pcnt) != 0)
-        csoundMessageS(csound, CSOUNDMSG_WARNING,
-                       "WARNING: could not create score event\n");
-      return 0;
+      break;
+    case CSPT_INPUT_MESSAGE:
+      csoundInputMessage(csound, (const char*) ReadPayload(pos));
+      break;
+    case CSPT_SCORE_OFFSET:
+      csoundSetScoreOffsetSeconds(csound, (MYFLT) msg->timeVal);
+      break;
     }
-    ~CsPerfThreadMsg_ScoreEvent()
-    {
-      if (pcnt > 10)
-        delete[] pp;
-    }
-};
+}
 
 /**
- * Score event message as a string
+ * Performs (or if run is zero, discards) the messages that are ready,
+ * and frees their slots.
  */
 
-class CsPerfThreadMsg_InputMessage : public CsoundPerformanceThreadMessage {
- private:
-    int     len;
-    char    *sp;
-    char    s[128];
- public:
-    CsPerfThreadMsg_InputMessage(CsoundPerformanceThread *pt, const char *s)
-    : CsoundPerformanceThreadMessage(pt)
-    {
-      len = (int) strlen(s);
-      if (len < 128)
-        this->sp = &(this->s[0]);
-      else
-        this->sp = new char[(unsigned int) (len + 1)];
-      strcpy(this->sp, s);
-    }
-    int run()
-    {
-      csoundInputMessage(pt_->GetCsound(), sp);
-      return 0;
-    }
-    ~CsPerfThreadMsg_InputMessage()
-    {
-      if (len >= 128)
-        delete[] sp;
+void CsoundPerformanceThread::ProcessMessages(int run)
+{
+    for (;;) {
+      unsigned long pos = queueHead;
+      CsoundPerformanceThreadMessage *msg;
+      int     i, n;
+      msg = &(queue[pos & (CSPT_QUEUE_SIZE - 1)]);
+      if (msg->seq != pos + 1UL)
+        break;
+      CSPT_BARRIER();
+      if (run)
+        RunMessage(pos);
+      n = msg->nslots;
+      CSPT_BARRIER();
+      for (i = 0; i < n; i++)
+        queue[(pos + i) & (CSPT_QUEUE_SIZE - 1)].seq =
+            pos + i + (unsigned long) CSPT_QUEUE_SIZE;
+      queueHead = pos + (unsigned long) n;
     }
-};
+}
 
 /**
- * Seek to the specified score time
+ * Returns the result of adding the pause request op after old.
  */
 
-class CsPerfThreadMsg_SetScoreOffsetSeconds
-      : public CsoundPerformanceThreadMessage {
- private:
-    double  timeVal;
- public:
-    CsPerfThreadMsg_SetScoreOffsetSeconds(CsoundPerformanceThread *pt,
-                                          double timeVal)
-    : CsoundPerformanceThreadMessage(pt)
-    {
-      this->timeVal = timeVal;
-    }
-    int run()
-    {
-      csoundSetScoreOffsetSeconds(pt_->GetCsound(), (MYFLT) timeVal);
-      return 0;
-    }
-    ~CsPerfThreadMsg_SetScoreOffsetSeconds()
-    {
+static inline int mergeControl(int old, int op)
+{
+    if (op != CSPT_TOGGLE_PAUSE)
+      return op;
+    switch (old) {
+    case CSPT_PLAY:
+      return CSPT_PAUSE;
+    case CSPT_PAUSE:
+      return CSPT_PLAY;
+    case CSPT_TOGGLE_PAUSE:
+      return CSPT_NONE;
+    }
+    return CSPT_TOGGLE_PAUSE;
+}
+
+/**
+ * Adds a pause request for the performance thread, and wakes it up if it
+ * is paused.
+ */
+
+void CsoundPerformanceThread::QueueControl(int op)
+{
+#ifdef HAVE_ATOMIC_BUILTIN
+    int     old = control;
+    for (;;) {
+      int   prev = CSPT_CAS(control, old, mergeControl(old, op));
+      if (prev == old)
+        break;
+      old = prev;
+    }
+#else
+    csoundLockMutex(queueLock);
+    control = mergeControl(control, op);
+    csoundUnlockMutex(queueLock);
+#endif
+    CSPT_BARRIER();
+    if (paused)
+      csoundNotifyThreadLock(pauseLock);
+}
+
+/**
+ * Applies the pause request, if any, in the performance thread.
+ */
+
+void CsoundPerformanceThread::TakeControl()
+{
+    int     op;
+
+    if (control == CSPT_NONE)
+      return;
+#ifdef HAVE_ATOMIC_BUILTIN
+    op = control;
+    for (;;) {
+      int   prev = CSPT_CAS(control, op, CSPT_NONE);
+      if (prev == op)
+        break;
+      op = prev;
+    }
+#else
+    csoundLockMutex(queueLock);
+    op = control;
+    control = CSPT_NONE;
+    csoundUnlockMutex(queueLock);
+#endif
+    switch (op) {
+    case CSPT_PLAY:
+      paused = 0;
+      break;
+    case CSPT_PAUSE:
+      paused = 1;
+      break;
+    case CSPT_TOGGLE_PAUSE:
+      paused = (paused ? 0 : 1);
+      break;
     }
-};
+}
 
 // ----------------------------------------------------------------------------
 
@@ -265,36 +367,25 @@ int CsoundPerformanceThread::Perform()
 {
     int retval = 0;
     do {
-      while (firstMessage) {
-        csoundLockMutex(queueLock);
-        do {
-          CsoundPerformanceThreadMessage *msg;
-          // get oldest message
-          msg = (CsoundPerformanceThreadMessage*) firstMessage;
-          if (!msg)
-            break;
-          // unlink from FIFO
-          firstMessage = msg->nxt;
-          if (!msg->nxt)
-            lastMessage = (CsoundPerformanceThreadMessage*) 0;
-          // process and destroy message
-          retval = msg->run();
-          delete msg;
-        } while (!retval);
-        if (paused)
-          csoundWaitThreadLock(pauseLock, (size_t) 0);
-        // mark queue as empty
-        csoundNotifyThreadLock(flushLock);
-        csoundUnlockMutex(queueLock);
-        // if error or end of score, return now
-        if (retval)
+      for (;;) {
+        // a stop ends the performance without reading the queue
+        if (stopRequested) {
+          retval = 1;
           goto endOfPerf;
-        // if paused, wait until a new message is received, then loop back
+        }
+        TakeControl();
+        ProcessMessages(1);
+        if (flushWaiting)
+          csoundNotifyThreadLock(flushLock);
         if (!paused)
           break;
-        // VL: if this is paused, then it will double lock.
-        csoundWaitThreadLockNoTimeout(pauseLock);
-        csoundNotifyThreadLock(pauseLock);
+        // if paused, wait until a new message is received, then loop back;
+        // a wake up is not missed, as the senders check 'paused' after
+        // publishing, and a notify before the wait is kept by the lock
+        CSPT_BARRIER();
+        if (queue[queueHead & (CSPT_QUEUE_SIZE - 1)].seq != queueHead + 1UL &&
+            control == CSPT_NONE && !stopRequested)
+          csoundWaitThreadLockNoTimeout(pauseLock);
       }
       if(processcallback != NULL)
            processcallback(cdata);
@@ -303,21 +394,10 @@ int CsoundPerformanceThread::Perform()
  endOfPerf:
     status = retval;
     csoundCleanup(csound);
-    // delete any pending messages
-    csoundLockMutex(queueLock);
-    {
-      CsoundPerformanceThreadMessage *msg;
-      msg = (CsoundPerformanceThreadMessage*) firstMessage;
-      firstMessage = (CsoundPerformanceThreadMessage*) 0;
-      lastMessage = (CsoundPerformanceThreadMessage*) 0;
-      while (msg) {
-        CsoundPerformanceThreadMessage *nxt = msg->nxt;
-        delete msg;
-        msg = nxt;
-      }
-    }
+    // discard any pending messages
+    CSPT_BARRIER();
+    ProcessMessages(0);
     csoundNotifyThreadLock(flushLock);
-    csoundUnlockMutex(queueLock);
     running = 1;
     return retval;
 }
@@ -353,20 +433,29 @@ extern "C" {
 void CsoundPerformanceThread::csPerfThread_constructor(CSOUND *csound_)
 {
     csound = csound_;
-    firstMessage = (CsoundPerformanceThreadMessage*) 0;
-    lastMessage = (CsoundPerformanceThreadMessage*) 0;
+    queue = (CsoundPerformanceThreadMessage*) 0;
+    queueTail = 0UL;
+    queueHead = 0UL;
+    overflowCount = 0L;
+    rejectCount = 0L;
+    scratch = (MYFLT*) 0;
     queueLock = (void*) 0;
     pauseLock = (void*) 0;
     flushLock = (void*) 0;
+    flushWaiting = 0;
+    control = CSPT_NONE;
+    stopRequested = 0;
     perfThread = (void*) 0;
     paused = 1;
     status = CSOUND_MEMORY;
     cdata = 0;
     processcallback = 0;
     running = 0;
+#ifndef HAVE_ATOMIC_BUILTIN
     queueLock = csoundCreateMutex(0);
     if (!queueLock)
       return;
+#endif
     pauseLock = csoundCreateThreadLock();
     if (!pauseLock)
       return;
@@ -374,12 +463,15 @@ void CsoundPerformanceThread::csPerfThread_constructor(CSOUND *csound_)
     if (!flushLock)
       return;
     try {
-      lastMessage = new CsPerfThreadMsg_Pause(this);
+      queue = new CsoundPerformanceThreadMessage[CSPT_QUEUE_SIZE];
+      scratch = new MYFLT[CSPT_MAX_SLOTS * CSPT_SLOT_PFIELDS];
     }
     catch (std::bad_alloc&) {
       return;
     }
-    firstMessage = lastMessage;
+    for (unsigned long i = 0UL; i < (unsigned long) CSPT_QUEUE_SIZE; i++)
+      queue[i].seq = i;
+    // paused is set, so the performance thread waits for Play()
     perfThread = csoundCreateThread(csoundPerformanceThread_, (void*) this);
     if (perfThread)
       status = 0;
@@ -422,27 +514,51 @@ CsoundPerformanceThread::~CsoundPerformanceThread()
 // ----------------------------------------------------------------------------
 
 /**
- * Queue a message for being processed by the performance thread.
+ * Queues a message with no data for being processed by the performance
+ * thread. Returns zero if the message was dropped.
  */
 
-void CsoundPerformanceThread::QueueMessage(CsoundPerformanceThreadMessage *msg)
+int CsoundPerformanceThread::QueueMessage(int type, double timeVal)
 {
-    if (status) {
-      delete msg;
-      return;
+    CsoundPerformanceThreadMessage *msg;
+    unsigned long pos;
+
+    if (status)
+      return 0;
+    if (!ReserveSlots(1, &pos)) {
+      CSPT_INCREMENT(overflowCount, 1L);
+      return 0;
     }
-    csoundLockMutex(queueLock);
-    // link message into FIFO
-    if (!lastMessage)
-      firstMessage = msg;
-    else
-      lastMessage->nxt = msg;
-    lastMessage = msg;
-    // mark queue as non-empty
-    csoundWaitThreadLock(flushLock, (size_t) 0);
-    // wake up from pause
-    csoundNotifyThreadLock(pauseLock);
-    csoundUnlockMutex(queueLock);
+    msg = &(queue[pos & (CSPT_QUEUE_SIZE - 1)]);
+    msg->type = type;
+    msg->nslots = 1;
+    msg->timeVal = timeVal;
+    PublishSlots(pos, 1);
+    return 1;
+}
+
+/**
+ * Queues len characters of s as an input message.
+ */
+
+int CsoundPerformanceThread::QueueString(const char *s, size_t len)
+{
+    CsoundPerformanceThreadMessage *msg;
+    unsigned long pos;
+    int     n = slotsForBytes(len + 1);
+
+    if (!ReserveSlots(n, &pos)) {
+      CSPT_INCREMENT(overflowCount, 1L);
+      return 0;
+    }
+    WritePayload(pos, s, len);
+    queue[(pos + len / CSPT_SLOT_BYTES) & (CSPT_QUEUE_SIZE - 1)]
+        .u.s[len % CSPT_SLOT_BYTES] = '\0';
+    msg = &(queue[pos & (CSPT_QUEUE_SIZE - 1)]);
+    msg->type = CSPT_INPUT_MESSAGE;
+    msg->nslots = n;
+    PublishSlots(pos, n);
+    return 1;
 }
 
 /**
@@ -451,7 +567,7 @@ void CsoundPerformanceThread::QueueMessage(CsoundPerformanceThreadMessage *msg)
 
 void CsoundPerformanceThread::Play()
 {
-    QueueMessage(new CsPerfThreadMsg_Play(this));
+    QueueControl(CSPT_PLAY);
 }
 
 /**
@@ -460,7 +576,7 @@ void CsoundPerformanceThread::Play()
 
 void CsoundPerformanceThread::Pause()
 {
-    QueueMessage(new CsPerfThreadMsg_Pause(this));
+    QueueControl(CSPT_PAUSE);
 }
 
 /**
@@ -470,7 +586,7 @@ void CsoundPerformanceThread::Pause()
 
 void CsoundPerformanceThread::TogglePause()
 {
-    QueueMessage(new CsPerfThreadMsg_TogglePause(this));
+    QueueControl(CSPT_TOGGLE_PAUSE);
 }
 
 /**
@@ -479,7 +595,17 @@ void CsoundPerformanceThread::TogglePause()
 
 void CsoundPerformanceThread::Stop()
 {
-    QueueMessage(new CsPerfThreadMsg_Stop(this));
+    stopRequested = 1;
+    // also ends a performance that an audio module runs from its own
+    // callback, during which csoundPerformKsmps() does not return;
+    // once the performance has ended, csoundStop() would only be left
+    // over for the next one
+    CSPT_BARRIER();
+    if (!status)
+      csoundStop(csound);
+    CSPT_BARRIER();
+    if (pauseLock)
+      csoundNotifyThreadLock(pauseLock);
 }
 
 /**
@@ -492,8 +618,55 @@ void CsoundPerformanceThread::Stop()
 void CsoundPerformanceThread::ScoreEvent(int absp2mode, char opcod,
                                          int pcnt, const MYFLT *p)
 {
-    QueueMessage(new CsPerfThreadMsg_ScoreEvent(this,
-                                                absp2mode, opcod, pcnt, p));
+    ScoreEventBatch(absp2mode, opcod, 1, pcnt, p);
+}
+
+/**
+ * Sends nevents score events of 'pcnt' p-fields each, from consecutive
+ * elements of 'p'. Returns the number of events queued.
+ */
+
+int CsoundPerformanceThread::ScoreEventBatch(int absp2mode, char opcod,
+                                             int nevents, int pcnt,
+                                             const MYFLT *p)
+{
+    unsigned long pos;
+    int     slots, nqueued = 0;
+
+    if (status || nevents <= 0)
+      return 0;
+    if (pcnt < 0)
+      pcnt = 0;
+    slots = slotsForBytes((size_t) pcnt * sizeof(MYFLT));
+    if (slots > CSPT_MAX_SLOTS) {
+      CSPT_INCREMENT(rejectCount, (long) nevents);
+      return 0;
+    }
+    while (nqueued < nevents) {
+      // take slots for as many events as fit in a quarter of the queue
+      int     n = (CSPT_QUEUE_SIZE / 4) / slots, i;
+      if (n > nevents - nqueued)
+        n = nevents - nqueued;
+      if (!ReserveSlots(n * slots, &pos)) {
+        CSPT_INCREMENT(overflowCount, (long) (nevents - nqueued));
+        break;
+      }
+      for (i = 0; i < n; i++) {
+        unsigned long m = pos + (unsigned long) (i * slots);
+        CsoundPerformanceThreadMessage *msg;
+        msg = &(queue[m & (CSPT_QUEUE_SIZE - 1)]);
+        msg->type = CSPT_SCORE_EVENT;
+        msg->nslots = slots;
+        msg->absp2mode = absp2mode;
+        msg->pcnt = pcnt;
+        msg->opcod = opcod;
+        WritePayload(m, &(p[(size_t) (nqueued + i) * (size_t) pcnt]),
+                     (size_t) pcnt * sizeof(MYFLT));
+      }
+      PublishSlots(pos, n * slots);
+      nqueued += n;
+    }
+    return nqueued;
 }
 
 /**
@@ -502,7 +675,31 @@ void CsoundPerformanceThread::ScoreEvent(int absp2mode, char opcod,
 
 void CsoundPerformanceThread::InputMessage(const char *s)
 {
-    QueueMessage(new CsPerfThreadMsg_InputMessage(this, s));
+    size_t  len = strlen(s);
+
+    if (status)
+      return;
+    // a long message is sent a number of whole lines at a time
+    while (len >= CSPT_MAX_BYTES) {
+      size_t  n = CSPT_MAX_BYTES - 1;
+      while (n > 0 && s[n - 1] != '\n')
+        n--;
+      if (n == 0) {
+        // a line that does not fit is skipped
+        CSPT_INCREMENT(rejectCount, 1L);
+        while (len > 0 && *s != '\n')
+          s++, len--;
+        if (len == 0)
+          return;
+        n = 1;
+      }
+      else if (!QueueString(s, n))
+        return;
+      s += n;
+      len -= n;
+    }
+    if (len > 0)
+      QueueString(s, len);
 }
 
 /**
@@ -511,7 +708,7 @@ void CsoundPerformanceThread::InputMessage(const char *s)
 
 void CsoundPerformanceThread::SetScoreOffsetSeconds(double timeVal)
 {
-    QueueMessage(new CsPerfThreadMsg_SetScoreOffsetSeconds(this, timeVal));
+    QueueMessage(CSPT_SCORE_OFFSET, timeVal);
 }
 
 
@@ -533,17 +730,14 @@ int CsoundPerformanceThread::Join()
       perfThread = (void*) 0;
     }
 
-    // delete any pending messages
-    {
-      CsoundPerformanceThreadMessage *msg;
-      msg = (CsoundPerformanceThreadMessage*) firstMessage;
-      firstMessage = (CsoundPerformanceThreadMessage*) 0;
-      lastMessage = (CsoundPerformanceThreadMessage*) 0;
-      while (msg) {
-        CsoundPerformanceThreadMessage *nxt = msg->nxt;
-        delete msg;
-        msg = nxt;
-      }
+    // free the message queue
+    if (queue) {
+      delete[] queue;
+      queue = (CsoundPerformanceThreadMessage*) 0;
+    }
+    if (scratch) {
+      delete[] scratch;
+      scratch = (MYFLT*) 0;
     }
     // delete all thread locks
     if (queueLock) {
@@ -571,8 +765,13 @@ int CsoundPerformanceThread::Join()
 
 void CsoundPerformanceThread::FlushMessageQueue()
 {
-    if (firstMessage) {
-      csoundWaitThreadLockNoTimeout(flushLock);
-      csoundNotifyThreadLock(flushLock);
-    }
+    unsigned long tail = queueTail;
+
+    if (status)
+      return;
+    CSPT_INCREMENT(flushWaiting, 1);
+    while (((long) (queueHead - tail) < 0L || control != CSPT_NONE) &&
+           !status)
+      csoundWaitThreadLock(flushLock, (size_t) 10);
+    CSPT_INCREMENT(flushWaiting, -1);
 }
@@ -85,21 +85,42 @@ struct PUBLIC pycallbackdata {
 
 class PUBLIC CsoundPerformanceThread {
  private:
+    // N.B. the members below changed with the message queue, and so did
+    // the size of the class: code using it must be built with this header
     CSOUND  *csound;
-    volatile CsoundPerformanceThreadMessage *firstMessage;
-    CsoundPerformanceThreadMessage *lastMessage;
-    void    *queueLock;         // this is actually a mutex
+    // messages to the performance thread are passed in a ring of
+    // preallocated slots, which any number of threads may write to
+    // without locking, and which the performance thread reads
+    CsoundPerformanceThreadMessage *queue;
+    volatile unsigned long queueTail;   // next slot to be written
+    long    overflowCount;      // messages dropped as the queue was full
+    long    rejectCount;        // messages too large for the queue
+    volatile unsigned long queueHead;   // next slot to be read
+    MYFLT   *scratch;           // for messages of more than one slot
+    void    *queueLock;         // mutex, only without atomic builtins
     void    *pauseLock;
     void    *flushLock;
+    volatile int flushWaiting;
+    volatile int control;       // pause request not yet taken
+    volatile int stopRequested;
     void    *perfThread;
-    int     paused;
-    int     status;
+    volatile int paused;
+    volatile int status;
     void *    cdata;
     int  running;
     void (*processcallback)(void *cdata);
     int  Perform();
     void csPerfThread_constructor(CSOUND *);
-    void QueueMessage(CsoundPerformanceThreadMessage *);
+    int  ReserveSlots(int n, unsigned long *pos);
+    void PublishSlots(unsigned long pos, int n);
+    void WritePayload(unsigned long pos, const void *data, size_t bytes);
+    void *ReadPayload(unsigned long pos);
+    int  QueueMessage(int type, double timeVal);
+    int  QueueString(const char *s, size_t len);
+    void QueueControl(int op);
+    void TakeControl();
+    void RunMessage(unsigned long pos);
+    void ProcessMessages(int run);
  public:
     int isRunning() { return running;}
 #ifdef SWIGPYTHON
@@ -148,7 +169,9 @@ class PUBLIC CsoundPerformanceThread {
      */
     void TogglePause();
     /**
-     * Stops performance (cannot be continued).
+     * Stops performance (cannot be continued). Unlike score events, this
+     * and Play(), Pause() and TogglePause() are never dropped when the
+     * message queue is full.
      */
     void Stop();
     /**
@@ -162,6 +185,16 @@ class PUBLIC CsoundPerformanceThread {
      * Sends a score event as a string, similarly to line events (-L).
      */
     void InputMessage(const char *s);
+    /**
+     * Sends nevents score events of type 'opcod', each of 'pcnt' p-fields,
+     * from array 'p', which holds nevents * pcnt values (p[0] is p1 of the
+     * first event, p[pcnt] is p1 of the second, and so on). The events are
+     * queued together, with far fewer atomic operations than sending them
+     * one at a time. Returns the number of events queued, which is less
+     * than nevents if the queue was full.
+     */
+    int ScoreEventBatch(int absp2mode, char opcod, int nevents, int pcnt,
+                        const MYFLT *p);
     /**
      * Sets the playback time pointer to the specified value (in seconds).
      */
@@ -178,6 +211,26 @@ class PUBLIC CsoundPerformanceThread {
      * are actually received by the performance thread.
      */
     void FlushMessageQueue();
+    /**
+     * Returns the number of messages that were dropped because the
+     * message queue was full. Sending messages never waits for the
+     * performance thread, so a host sending events faster than they are
+     * performed should check this.
+     */
+    long GetOverflowCount()
+    {
+      return overflowCount;
+    }
+    /**
+     * Returns the number of messages that were dropped because they were
+     * too large for the message queue: score events of more than 2048
+     * p-fields, or lines of an input message of more than 16383 (8191
+     * with 32-bit floats) characters.
+     */
+    long GetRejectedCount()
+    {
+      return rejectCount;
+    }
     // --------
     CsoundPerformanceThread(Csound *);
     CsoundPerformanceThread(CSOUND *);
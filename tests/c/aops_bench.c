@@ -0,0 +1,150 @@
+/*
+ * File:   aops_bench.c
+ *
+ * Times the a-rate operators of OOps/aops.c with each set of vector
+ * kernels this build and CPU can run, and checks that every set gives
+ * the same samples as the plain C kernels, edges included.
+ *
+ * Usage: aopsBench [ksmps [k-cycles]]
+ */
+
+#define __BUILDING_LIBCSOUND
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "csoundCore.h"
+#include "aops.h"
+#include "vecops.h"
+
+extern int addaa(CSOUND *, void *), subaa(CSOUND *, void *);
+extern int mulaa(CSOUND *, void *), divaa(CSOUND *, void *);
+extern int addka(CSOUND *, void *), subka(CSOUND *, void *);
+extern int mulka(CSOUND *, void *), divka(CSOUND *, void *);
+extern int addak(CSOUND *, void *), subak(CSOUND *, void *);
+extern int mulak(CSOUND *, void *), divak(CSOUND *, void *);
+extern int divzaa(CSOUND *, void *), divzka(CSOUND *, void *);
+extern int divzak(CSOUND *, void *);
+extern int int1a(CSOUND *, void *), frac1a(CSOUND *, void *);
+extern int int1a_round(CSOUND *, void *), int1a_floor(CSOUND *, void *);
+extern int int1a_ceil(CSOUND *, void *), aampdb(CSOUND *, void *);
+extern int atan2aa(CSOUND *, void *), modaa(CSOUND *, void *);
+
+typedef int (*OPFN)(CSOUND *, void *);
+
+static const struct {
+    const char  *name;
+    OPFN        fn;
+    int         ka, kb;         /* a or b is a k-rate scalar */
+} ops[] = {
+    { "addaa", addaa, 0, 0 },   { "subaa", subaa, 0, 0 },
+    { "mulaa", mulaa, 0, 0 },   { "divaa", divaa, 0, 0 },
+    { "addka", addka, 1, 0 },   { "subka", subka, 1, 0 },
+    { "mulka", mulka, 1, 0 },   { "divka", divka, 1, 0 },
+    { "addak", addak, 0, 1 },   { "subak", subak, 0, 1 },
+    { "mulak", mulak, 0, 1 },   { "divak", divak, 0, 1 },
+    { "divzaa", divzaa, 0, 0 }, { "divzka", divzka, 1, 0 },
+    { "divzak", divzak, 0, 1 },
+    { "int", int1a, 0, 0 },     { "frac", frac1a, 0, 0 },
+    { "round", int1a_round, 0, 0 },
+    { "floor", int1a_floor, 0, 0 },
+    { "ceil", int1a_ceil, 0, 0 },
+    { "ampdb", aampdb, 0, 0 },  { "atan2aa", atan2aa, 0, 0 },
+    { "modaa", modaa, 0, 0 }
+};
+
+#define NOPS (sizeof(ops) / sizeof(ops[0]))
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1.0e9 + ts.tv_nsec;
+}
+
+/* run op once on a block with the given edges, leaving the result in r */
+
+static void run(CSOUND *csound, INSDS *ip, DIVZ *p, int i,
+                uint32_t offset, uint32_t early)
+{
+    ip->ksmps_offset = offset;
+    ip->ksmps_no_end = early;
+    ops[i].fn(csound, p);
+}
+
+int main(int argc, char **argv)
+{
+    static const char *isas[] = { "c", "sse2", "avx2", "neon" };
+    uint32_t    ksmps = (argc > 1 ? (uint32_t) atoi(argv[1]) : 64);
+    long        kcycles = (argc > 2 ? atol(argv[2]) : 20000);
+    CSOUND      *csound;
+    INSDS       *ip;
+    DIVZ        p;
+    MYFLT       *a, *b, *r, *ref, def = FL(-1.0);
+    uint32_t    n;
+    size_t      i, k;
+    int         failed = 0;
+
+    if (ksmps < 9) ksmps = 9;     /* room for the edges */
+    csound = csoundCreate(NULL);
+    csoundSetMessageLevel(csound, 0);
+    ip = (INSDS *) calloc(1, sizeof(INSDS));
+    a = (MYFLT *) malloc(ksmps * sizeof(MYFLT));
+    b = (MYFLT *) malloc(ksmps * sizeof(MYFLT));
+    r = (MYFLT *) malloc(ksmps * sizeof(MYFLT));
+    ref = (MYFLT *) malloc(ksmps * sizeof(MYFLT));
+    srand(1);
+    for (n = 0; n < ksmps; n++) {
+      a[n] = (MYFLT) (rand() % 4001 - 2000) / FL(64.0);
+      b[n] = (n % 5 == 0 ? FL(0.0) : (MYFLT) (rand() % 201 - 100) / FL(8.0));
+    }
+    ip->ksmps = ksmps;
+    memset(&p, 0, sizeof(DIVZ));
+    p.h.insdshead = ip;
+    p.r = r;
+    p.def = &def;
+
+    printf("%-8s", "ns/smp");
+    for (k = 0; k < sizeof(isas) / sizeof(isas[0]); k++)
+      if (cs_vecops_find(isas[k]) != NULL)
+        printf("%9s", isas[k]);
+    printf("\n");
+    for (i = 0; i < NOPS; i++) {
+      /* the k-rate operands must not be zero for divak */
+      p.a = (ops[i].ka ? &a[1] : a);
+      p.b = (ops[i].kb ? &b[1] : b);
+      printf("%-8s", ops[i].name);
+      for (k = 0; k < sizeof(isas) / sizeof(isas[0]); k++) {
+        const CS_VECOPS *v = cs_vecops_find(isas[k]);
+        double          t0;
+        long            c;
+        if (v == NULL)
+          continue;
+        cs_vecops = v;
+        for (n = 0; n < ksmps; n++) r[n] = FL(1.0);
+        run(csound, ip, &p, i, 3, 5);
+        if (k == 0) {
+          memcpy(ref, r, ksmps * sizeof(MYFLT));
+          for (n = 0; n < ksmps; n++)
+            if ((n < 3 || n >= ksmps - 5) && r[n] != FL(0.0)) {
+              printf("\n%s does not clear the edges\n", ops[i].name);
+              failed = 1;
+              break;
+            }
+        }
+        else if (memcmp(r, ref, ksmps * sizeof(MYFLT)) != 0) {
+          printf("\n%s differs from c for %s\n", isas[k], ops[i].name);
+          failed = 1;
+        }
+        t0 = now();
+        for (c = 0; c < kcycles; c++)
+          run(csound, ip, &p, i, 0, 0);
+        printf("%9.3f", (now() - t0) / ((double) kcycles * ksmps));
+      }
+      printf("\n");
+    }
+    free(a); free(b); free(r); free(ref); free(ip);
+    csoundDestroy(csound);
+    return failed;
+}
@@ -63,6 +63,33 @@ void test_control_channel(void)
     csoundDestroy(csound);
 }
 
+void test_channel_handle(void)
+{
+    csoundSetGlobalEnv("OPCODE6DIR64", "../../");
+    CSOUND *csound = csoundCreate(0);
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "--logfile=null");
+    csoundCompileOrc(csound, orc1);
+    int err = csoundStart(csound);
+    CU_ASSERT(err == CSOUND_SUCCESS);
+    CSOUND_CHANNEL *h =
+        csoundGetChannelHandle(csound, "testing",
+                               CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
+    CU_ASSERT_PTR_NOT_NULL(h);
+    CU_ASSERT_PTR_EQUAL(h, csoundGetChannelHandle(csound, "testing",
+                                                  CSOUND_CONTROL_CHANNEL));
+    CU_ASSERT_PTR_NULL(csoundGetChannelHandle(csound, "testing",
+                                              CSOUND_AUDIO_CHANNEL));
+    csoundSetControlChannelByHandle(csound, h, 7.0);
+    CU_ASSERT_EQUAL(7.0, csoundGetControlChannel(csound, "testing", NULL));
+    csoundSetControlChannel(csound, "testing", 3.0);
+    CU_ASSERT_EQUAL(3.0, csoundGetControlChannelByHandle(csound, h));
+
+    csoundCleanup(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
 const char orc2[] = "chn_k \"testing\", 3, 1, 1, 0, 10\n  chn_a \"testing2\", 3\n  instr 1\n  endin\n";
 
 void test_channel_list(void)
@@ -154,6 +181,44 @@ void test_channel_callbacks(void)
     csoundDestroy(csound);
 }
 
+const char orc_batch[] = "chn_k \"batch\", 3\n"
+        "instr 1\n"
+        "chnset p4, \"batch\"\n"
+        "endin\n";
+
+void test_score_event_batch(void)
+{
+    csoundSetGlobalEnv("OPCODE6DIR64", "../../");
+    CSOUND *csound = csoundCreate(0);
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "--logfile=null");
+    csoundCompileOrc(csound, orc_batch);
+    int err = csoundStart(csound);
+    CU_ASSERT(err == CSOUND_SUCCESS);
+    int64_t ksmps = csoundGetKsmps(csound);
+    MYFLT p1[] = {1.0, 0.0, 1.0, 1.0};
+    MYFLT p2[] = {1.0, 0.0, 1.0, 2.0};
+    MYFLT p3[] = {1.0, 0.0, 1.0, 3.0};
+    CS_SCOREEVENT events[] = {
+        { 'i', 4, p1, 0 },
+        { 'i', 4, p3, 4 * ksmps },
+        { 'i', 4, p2, 2 * ksmps },
+        { 'i', 1, p1, 0 }           /* too few p-fields */
+    };
+    CU_ASSERT_EQUAL(csoundScoreEventBatch(csound, events, 4), 1);
+    csoundPerformKsmps(csound);
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "batch", NULL), 1.0);
+    csoundPerformKsmps(csound);
+    csoundPerformKsmps(csound);
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "batch", NULL), 2.0);
+    csoundPerformKsmps(csound);
+    csoundPerformKsmps(csound);
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "batch", NULL), 3.0);
+    csoundCleanup(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
 
 const char orc4[] = "chn_k \"1\", 3\n"
         "chn_k \"2\", 3\n"
@@ -231,6 +296,53 @@ void test_channel_opcodes(void)
     csoundDestroy(csound);
 }
 
+const char orc6[] = "ksmps = 16\n"
+        "gain chnexport \"ain\", 1\n"
+        "instr 1\n"
+        "kval downsamp gain\n"
+        "chnset kval, \"aval\"\n"
+        "endin\n";
+
+/* audio written by the host reaches a channel exported from a global
+   variable in the next k-cycle, although no opcode touches the channel */
+
+void test_host_audio_chnexport(void)
+{
+    MYFLT samples[16];
+    int i;
+
+    csoundSetGlobalEnv("OPCODE6DIR64", "../../");
+    CSOUND *csound = csoundCreate(0);
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "--logfile=null");
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound, orc6);
+    int err = csoundStart(csound);
+    CU_ASSERT(err == CSOUND_SUCCESS);
+    CSOUND_CHANNEL *h =
+        csoundGetChannelHandle(csound, "ain", CSOUND_AUDIO_CHANNEL);
+    CU_ASSERT_PTR_NOT_NULL(h);
+    MYFLT pFields[] = {1.0, 0.0, 1.0};
+    err = csoundScoreEvent(csound, 'i', pFields, 3);
+    CU_ASSERT(err == CSOUND_SUCCESS);
+    for (i = 0; i < 16; i++)
+      samples[i] = 0.25;
+    csoundSetAudioChannelByHandle(csound, h, samples);
+    err = csoundPerformKsmps(csound);
+    CU_ASSERT(err == CSOUND_SUCCESS);
+    CU_ASSERT_EQUAL(0.25, csoundGetControlChannel(csound, "aval", NULL));
+    for (i = 0; i < 16; i++)
+      samples[i] = 0.5;
+    csoundMixAudioChannelByHandle(csound, h, samples);
+    err = csoundPerformKsmps(csound);
+    CU_ASSERT(err == CSOUND_SUCCESS);
+    CU_ASSERT_EQUAL(0.75, csoundGetControlChannel(csound, "aval", NULL));
+
+    csoundCleanup(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
 const char orc5[] = "chn_k \"winsize\", 3\n"
         "instr 1\n"
         "finput pvsin 1 \n"
@@ -375,9 +487,13 @@ int main()
    /* add the tests to the suite */
    if ((NULL == CU_add_test(pSuite, "Channel Lists", test_channel_list))
            || (NULL == CU_add_test(pSuite, "Control channel", test_control_channel))
+           || (NULL == CU_add_test(pSuite, "Channel handle", test_channel_handle))
            || (NULL == CU_add_test(pSuite, "Control channel parameters", test_control_channel_params))
            || (NULL == CU_add_test(pSuite, "Callbacks", test_channel_callbacks))
            || (NULL == CU_add_test(pSuite, "Opcodes", test_channel_opcodes))
+           || (NULL == CU_add_test(pSuite, "Host audio to chnexport",
+                                   test_host_audio_chnexport))
+           || (NULL == CU_add_test(pSuite, "Score event batch", test_score_event_batch))
            || (NULL == CU_add_test(pSuite, "PVS Opcodes", test_pvs_opcodes))
            || (NULL == CU_add_test(pSuite, "Invalid channels", test_invalid_channel))
            || (NULL == CU_add_test(pSuite, "Channel hints", test_chn_hints))
@@ -132,6 +132,69 @@ void test_wrap(void) {
     csoundDestroy(csound);
 }
 
+void test_bulk_wrap(void) {
+    int i, j;
+    CSOUND* csound = csoundCreate(NULL);
+    void *rb = csoundCreateCircularBuffer(csound, 32, sizeof(float));
+    CU_ASSERT_PTR_NOT_NULL(rb);
+    float invals[20];
+    float outvals[20];
+    int count = 0, readindex = 0;
+    for (i = 0 ; i < 10; i++) {
+        for (j = 0; j < 20; j++) invals[j] = count++;
+        int written = csoundWriteCircularBuffer(csound, rb, invals, 20);
+        CU_ASSERT_EQUAL(written, 20);
+        int read = csoundReadCircularBuffer(csound, rb, outvals, 20);
+        CU_ASSERT_EQUAL(read, 20);
+        for (j = 0; j < read; j++) {
+            CU_ASSERT_EQUAL(outvals[j], readindex++);
+        }
+    }
+    /* only numelem - 1 elements fit */
+    for (j = 0; j < 20; j++) invals[j] = j;
+    CU_ASSERT_EQUAL(csoundWriteCircularBuffer(csound, rb, invals, 20), 20);
+    CU_ASSERT_EQUAL(csoundWriteCircularBuffer(csound, rb, invals, 20), 11);
+    csoundFlushCircularBuffer(csound, rb);
+    CU_ASSERT_EQUAL(csoundReadCircularBuffer(csound, rb, outvals, 20), 0);
+    csoundDestroyCircularBuffer(csound, rb);
+    csoundDestroy(csound);
+}
+
+void test_reserve_commit(void) {
+    int i, j, n;
+    CSOUND* csound = csoundCreate(NULL);
+    void *rb = csoundCreateCircularBuffer(csound, 32, sizeof(float));
+    CU_ASSERT_PTR_NOT_NULL(rb);
+    int writeindex = 0, readindex = 0;
+    for (i = 0 ; i < 20; i++) {
+        void *ptr;
+        float *f;
+        /* a reservation never crosses the end of the buffer */
+        int total = 0;
+        while (total < 12) {
+            n = csoundReserveCircularBufferWrite(csound, rb, &ptr, 12 - total);
+            CU_ASSERT(n > 0);
+            f = (float *) ptr;
+            for (j = 0; j < n; j++) f[j] = writeindex++;
+            csoundCommitCircularBufferWrite(csound, rb, n);
+            total += n;
+        }
+        total = 0;
+        while (total < 12) {
+            n = csoundReserveCircularBufferRead(csound, rb, &ptr, 12 - total);
+            CU_ASSERT(n > 0);
+            f = (float *) ptr;
+            for (j = 0; j < n; j++) {
+                CU_ASSERT_EQUAL(f[j], readindex++);
+            }
+            csoundCommitCircularBufferRead(csound, rb, n);
+            total += n;
+        }
+        CU_ASSERT_EQUAL(csoundReserveCircularBufferRead(csound, rb, &ptr, 1), 0);
+    }
+    csoundDestroyCircularBuffer(csound, rb);
+    csoundDestroy(csound);
+}
 
 int main()
 {
@@ -153,6 +216,9 @@ int main()
             || (NULL == CU_add_test(pSuite, "Test read and write diff sizes", test_read_write_diff_size))
             || (NULL == CU_add_test(pSuite, "Test peek", test_peek))
             || (NULL == CU_add_test(pSuite, "Test wrap", test_wrap))
+            || (NULL == CU_add_test(pSuite, "Test bulk wrap", test_bulk_wrap))
+            || (NULL == CU_add_test(pSuite, "Test reserve and commit",
+                                    test_reserve_commit))
         )
     {
         CU_cleanup_registry();
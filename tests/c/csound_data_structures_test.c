@@ -147,6 +147,42 @@ void test_cs_hash_table_get_put_key(void) {
     csoundDestroy(csound);
 }
 
+void test_cs_hash_table_grow_remove(void) {
+    CSOUND* csound = csoundCreate(NULL);
+    char key[32];
+    int i;
+
+    CS_HASH_TABLE* hashTable = cs_hash_table_create(csound);
+
+    for (i = 0; i < 1000; i++) {
+        sprintf(key, "key%d", i);
+        cs_hash_table_put(csound, hashTable, key, (void*) (size_t) (i + 1));
+    }
+    CU_ASSERT_EQUAL(hashTable->count, 1000);
+
+    for (i = 0; i < 1000; i += 2) {
+        sprintf(key, "key%d", i);
+        cs_hash_table_remove(csound, hashTable, key);
+    }
+    CU_ASSERT_EQUAL(hashTable->count, 500);
+
+    for (i = 0; i < 1000; i++) {
+        sprintf(key, "key%d", i);
+        if (i & 1) {
+            CU_ASSERT_PTR_EQUAL(cs_hash_table_get(csound, hashTable, key),
+                                (void*) (size_t) (i + 1));
+            CU_ASSERT_PTR_EQUAL(cs_hash_table_get_hashed(csound, hashTable, key,
+                                                       cs_hash_table_hash(key)),
+                                (void*) (size_t) (i + 1));
+        } else {
+            CU_ASSERT_PTR_NULL(cs_hash_table_get(csound, hashTable, key));
+        }
+    }
+    CU_ASSERT_EQUAL(cs_cons_length(cs_hash_table_keys(csound, hashTable)), 500);
+
+    csoundDestroy(csound);
+}
+
 
 int main() {
     CU_pSuite pSuite = NULL;
@@ -167,7 +203,8 @@ int main() {
         (NULL == CU_add_test(pSuite, "Test cs_cons_append()", test_cs_cons_append)) ||
         (NULL == CU_add_test(pSuite, "Test cs_hash_table()", test_cs_hash_table)) ||
         (NULL == CU_add_test(pSuite, "Test cs_hash_table_merge()", test_cs_hash_table_merge)) ||
-        (NULL == CU_add_test(pSuite, "Test cs_hash_table_get_put_key()", test_cs_hash_table_get_put_key))) {
+        (NULL == CU_add_test(pSuite, "Test cs_hash_table_get_put_key()", test_cs_hash_table_get_put_key)) ||
+        (NULL == CU_add_test(pSuite, "Test cs_hash_table grow and remove", test_cs_hash_table_grow_remove))) {
         
         CU_cleanup_registry();
         return CU_get_error();
@@ -255,6 +255,54 @@ void test_midi_hostbased(void)
     csoundReset(csound);
 }
 
+/* a note on followed by data bytes only (running status), as sent by the */
+/* ALSA sequencer decoder and many keyboards, must start and stop every note */
+
+void test_midi_running_status(void)
+{
+    CSOUND  *csound;
+    csound = csoundCreate(NULL);
+    const char  *instrument =
+            "ksmps = 64\n"
+            "giNotes init 0\n"
+            "instr 1 \n"
+            "giNotes = giNotes + 1\n"
+            "chnset giNotes, \"notes\"\n"
+            "endin \n"
+            "instr 2 \n"
+            "chnset active(1), \"active\"\n"
+            "endin \n";
+    const unsigned char on[3] = { 0x90, 60, 100 };
+    const unsigned char rs[3][2] = { { 64, 100 }, { 67, 100 }, { 60, 0 } };
+    const unsigned char off[2][2] = { { 64, 0 }, { 67, 0 } };
+    int i;
+
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-M0");
+    csoundSetOption(csound, "-+rtmidi=null");
+    csoundCompileOrc(csound, instrument);
+    csoundReadScore(csound, "i 2 0 10\n");
+    int ret = csoundStart(csound);
+    CU_ASSERT(ret == 0);
+    CU_ASSERT(csoundPushMidiInput(csound, on, 3, 0.0) == 0);
+    for (i = 0; i < 2; i++)
+      CU_ASSERT(csoundPushMidiInput(csound, rs[i], 2, 0.0) == 0);
+    for (i = 0; i < 8; i++)
+      csoundPerformKsmps(csound);
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "notes", NULL), 3.0);
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "active", NULL), 3.0);
+    CU_ASSERT(csoundPushMidiInput(csound, rs[2], 2, 0.0) == 0);
+    for (i = 0; i < 2; i++)
+      CU_ASSERT(csoundPushMidiInput(csound, off[i], 2, 0.0) == 0);
+    for (i = 0; i < 8; i++)
+      csoundPerformKsmps(csound);
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "active", NULL), 0.0);
+    csoundCleanup(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
 
 int main(int argc, char **argv)
 {
@@ -278,6 +326,8 @@ int main(int argc, char **argv)
             || (NULL == CU_add_test(pSuite, "Audio Hostbased", test_audio_hostbased))
             || (NULL == CU_add_test(pSuite, "MIDI Modules", test_midi_modules))
             || (NULL == CU_add_test(pSuite, "MIDI Hostbased", test_midi_hostbased))
+            || (NULL == CU_add_test(pSuite, "MIDI Running Status",
+                                    test_midi_running_status))
         )
     {
        CU_cleanup_registry();
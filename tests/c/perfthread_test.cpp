@@ -43,6 +43,44 @@ void test_perfthread(void)
     csound.Reset();
 }
 
+void test_perfthread_batch(void)
+{
+    const char  *instrument =
+            "giCount init 0 \n"
+            "instr 1 \n"
+            "giCount = giCount + 1 \n"
+            "chnset giCount, \"count\" \n"
+            "endin \n";
+    MYFLT   p[300];
+    int     i;
+
+    Csound csound;
+    csound.SetOption((char*)"-n");
+    csound.CompileOrc(instrument);
+    csound.Start();
+    CsoundPerformanceThread performanceThread(csound.GetCsound());
+    performanceThread.Play();
+    for (i = 0; i < 100; i++) {
+      p[i * 3] = 1;
+      p[i * 3 + 1] = (MYFLT) i * 0.01;
+      p[i * 3 + 2] = 0.01;
+    }
+    CU_ASSERT_EQUAL(performanceThread.ScoreEventBatch(0, 'i', 100, 3, p), 100);
+    performanceThread.FlushMessageQueue();
+    CU_ASSERT_EQUAL(performanceThread.GetOverflowCount(), 0);
+    CU_ASSERT_EQUAL(performanceThread.GetRejectedCount(), 0);
+    // the events span one second of score time
+    while (csound.GetChannel("count") < 100 && csound.GetScoreTime() < 5.0)
+      csoundSleep(1);
+    CU_ASSERT_EQUAL(csound.GetChannel("count"), 100);
+    CU_ASSERT_EQUAL(performanceThread.ScoreEventBatch(0, 'i', 1, 3000, p), 0);
+    CU_ASSERT_EQUAL(performanceThread.GetRejectedCount(), 1);
+    performanceThread.Stop();
+    performanceThread.Join();
+    csound.Cleanup();
+    csound.Reset();
+}
+
 
 int main()
 {
@@ -77,6 +115,13 @@ int main()
         return CU_get_error();
     }
 
+    if (NULL == CU_add_test(pSuite, "Test batched score events",
+                            test_perfthread_batch))
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
     /* Run all tests using the CUnit Basic interface */
     CU_basic_set_mode(CU_BRM_VERBOSE);
     CU_basic_run_tests();
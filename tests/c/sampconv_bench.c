@@ -0,0 +1,175 @@
+/*
+ * File:   sampconv_bench.c
+ *
+ * Times the sample format conversion of InOut/sampconv.c with each set
+ * of vector kernels this build and CPU can run, checks that every set
+ * gives the same samples as the plain C kernels, and that a round trip
+ * through each format and dither type stays within a few LSBs.
+ *
+ * Usage: sampconvBench [channels [frames [blocks]]]
+ */
+
+#define __BUILDING_LIBCSOUND
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "csoundCore.h"
+#include "soundio.h"
+#include "vecops.h"
+#include "sampconv.h"
+
+static const char *isas[] = { "c", "sse2", "avx2", "neon" };
+
+#define NISAS (sizeof(isas) / sizeof(isas[0]))
+
+static const struct {
+    const char  *name;
+    int         format;
+} fmts[] = {
+    { "char", AE_CHAR },    { "unch", AE_UNCH },    { "short", AE_SHORT },
+    { "24int", AE_24INT },  { "long", AE_LONG },    { "float", AE_FLOAT }
+};
+
+#define NFMTS (sizeof(fmts) / sizeof(fmts[0]))
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1.0e9 + ts.tv_nsec;
+}
+
+/* compare the kernels of v with those of c, for n samples */
+
+static int check_kernels(const CS_VECOPS *c, const CS_VECOPS *v,
+                         const MYFLT *a, const MYFLT *d, uint32_t n)
+{
+    static const MYFLT scale[3] = { FL(32768.0), FL(8388608.0),
+                                    FL(2147483648.0) };
+    int32_t *q1 = (int32_t *) malloc(n * sizeof(int32_t));
+    int32_t *q2 = (int32_t *) malloc(n * sizeof(int32_t));
+    MYFLT   *r1 = (MYFLT *) malloc(n * sizeof(MYFLT));
+    MYFLT   *r2 = (MYFLT *) malloc(n * sizeof(MYFLT));
+    float   *f1 = (float *) malloc(n * sizeof(float));
+    float   *f2 = (float *) malloc(n * sizeof(float));
+    int     i, failed = 0;
+
+    for (i = 0; i < 3; i++) {
+      MYFLT hi = scale[i] - (i == 2 && sizeof(MYFLT) == 4 ? 128 : 1);
+      c->quant(q1, a, NULL, scale[i], -scale[i], hi, n);
+      v->quant(q2, a, NULL, scale[i], -scale[i], hi, n);
+      failed |= memcmp(q1, q2, n * sizeof(int32_t));
+      c->quant(q1, a, d, scale[i], -scale[i], hi, n);
+      v->quant(q2, a, d, scale[i], -scale[i], hi, n);
+      failed |= memcmp(q1, q2, n * sizeof(int32_t));
+    }
+    c->from_int(r1, q1, FL(1.0) / scale[2], n);
+    v->from_int(r2, q1, FL(1.0) / scale[2], n);
+    failed |= memcmp(r1, r2, n * sizeof(MYFLT));
+    c->to_float(f1, a, FL(0.5), n);
+    v->to_float(f2, a, FL(0.5), n);
+    failed |= memcmp(f1, f2, n * sizeof(float));
+    c->from_float(r1, f1, FL(2.0), n);
+    v->from_float(r2, f1, FL(2.0), n);
+    failed |= memcmp(r1, r2, n * sizeof(MYFLT));
+    free(q1); free(q2); free(r1); free(r2); free(f1); free(f2);
+    return (failed != 0);
+}
+
+int main(int argc, char **argv)
+{
+    int         nchnls = (argc > 1 ? atoi(argv[1]) : 64);
+    int         nframes = (argc > 2 ? atoi(argv[2]) : 256);
+    long        blocks = (argc > 3 ? atol(argv[3]) : 1000);
+    CSOUND      *csound;
+    MYFLT       *a, *d, *in, *out;
+    void        *buf;
+    int         n, i, dither, failed = 0;
+    size_t      f, k;
+
+    if (nchnls < 1) nchnls = 1;
+    if (nframes < 1) nframes = 1;
+    n = nchnls * nframes;
+    csound = csoundCreate(NULL);
+    csoundSetMessageLevel(csound, 0);
+    a = (MYFLT *) malloc(n * sizeof(MYFLT));
+    d = (MYFLT *) malloc(n * sizeof(MYFLT));
+    in = (MYFLT *) malloc(n * sizeof(MYFLT));
+    out = (MYFLT *) malloc(n * sizeof(MYFLT));
+    buf = malloc(n * 4);
+    srand(1);
+    for (i = 0; i < n; i++) {
+      /* some out of range, to clip */
+      a[i] = (MYFLT) (rand() % 2401 - 1200) / FL(1000.0);
+      d[i] = (MYFLT) (rand() % 65536 - 32768) / FL(65536.0);
+      in[i] = (MYFLT) (0.9 * sin(0.01 * i));
+    }
+
+    /* every kernel set against plain C, with each length up to a block */
+    for (k = 1; k < NISAS; k++) {
+      const CS_VECOPS *v = cs_vecops_find(isas[k]);
+      uint32_t        m;
+      if (v == NULL)
+        continue;
+      for (m = 0; m <= (uint32_t) n && m <= 67; m++)
+        if (check_kernels(cs_vecops_find("c"), v, a, d, m)) {
+          printf("%s differs from c for %u samples\n", isas[k], m);
+          failed = 1;
+          break;
+        }
+    }
+
+    /* round trips, in LSBs of the format */
+    for (f = 0; f < NFMTS; f++)
+      for (dither = CS_DITHER_NONE; dither <= CS_DITHER_SHAPED; dither++) {
+        CS_SAMPCONV *p = cs_sampconv_create(csound, fmts[f].format,
+                                            nchnls, dither);
+        double      lsb, err, maxerr = 0.0;
+        cs_sampconv_out(p, buf, in, nframes);
+        cs_sampconv_in(p, out, buf, nframes);
+        lsb = (fmts[f].format == AE_FLOAT ? 1.0e-7 : 1.0 / p->scale);
+        for (i = 0; i < n; i++) {
+          err = fabs((double) (out[i] - in[i])) / lsb;
+          if (err > maxerr) maxerr = err;
+        }
+        /* rounding 0.5, triangular 1.5, uniform 1, shaped about 4 */
+        if (maxerr > (dither == CS_DITHER_SHAPED ? 6.0 : 1.5 + 0.01)) {
+          printf("%s with dither %d is off by %.2f LSB\n",
+                 fmts[f].name, dither, maxerr);
+          failed = 1;
+        }
+        cs_sampconv_destroy(csound, p);
+      }
+
+    /* timing of the output conversion, with triangular dither */
+    printf("%-8s", "ns/smp");
+    for (k = 0; k < NISAS; k++)
+      if (cs_vecops_find(isas[k]) != NULL)
+        printf("%9s", isas[k]);
+    printf("\n");
+    for (f = 0; f < NFMTS; f++) {
+      CS_SAMPCONV *p = cs_sampconv_create(csound, fmts[f].format, nchnls,
+                                          CS_DITHER_TRIANGULAR);
+      printf("%-8s", fmts[f].name);
+      for (k = 0; k < NISAS; k++) {
+        const CS_VECOPS *v = cs_vecops_find(isas[k]);
+        double          t0;
+        long            c;
+        if (v == NULL)
+          continue;
+        cs_vecops = v;
+        t0 = now();
+        for (c = 0; c < blocks; c++)
+          cs_sampconv_out(p, buf, in, nframes);
+        printf("%9.3f", (now() - t0) / ((double) blocks * n));
+      }
+      printf("\n");
+      cs_sampconv_destroy(csound, p);
+    }
+    free(a); free(d); free(in); free(out); free(buf);
+    csoundDestroy(csound);
+    return failed;
+}
@@ -125,6 +125,9 @@ def runTest():
 	["test_invalid_ternary.csd", "test expression", 1],
 
 	["test_opcode_as_function.csd", "test expression"],
+	["test_expr_fusion.csd", "fused a-rate expressions match unfused ones"],
+	["test_optimize.csd", "constant folding, dead code and loop invariants"],
+	["test_poscil.csd", "all forms of poscil and poscil3"],
 	["test_fsig_udo.csd", "UDO with f-sig arg"],
 	["test_karrays_udo.csd", "UDO with k[] arg"],
 	["test_arrays_addition.csd", "test array arithmetic (i.e. k[] + k[]"],
@@ -171,6 +174,19 @@ def runTest():
             command = "%s %s %s %s &> %s"%(executable, parserType, runArgs, filename, tempfile)
             #print command
             retVal = os.system(command)
+
+        f = open(tempfile, "r")
+
+        csOutput = ""
+
+        for line in f:
+            csOutput += line
+
+        f.close()
+
+        # tests that check values at run time report a mismatch this way
+        if retVal == 0 and "TEST FAILED" in csOutput:
+            retVal = 1
   
         out = ""
         if (retVal == 0) == (expectedResult == 0):
@@ -186,17 +202,8 @@ def runTest():
         output += "%s\n"%("=" * 80)
         output += "Test %i: %s (%s)\nReturn Code: %i\n"%(counter, desc, filename, retVal)
         output += "%s\n\n"%("=" * 80)
-        f = open(tempfile, "r")
-
-        csOutput = ""
-
-        for line in f:
-            csOutput += line
-
         output += csOutput
 
-        f.close()
-
         retVals.append(t + [retVal, csOutput])
 
         output += "\n\n"